@@ -267,6 +267,15 @@
 #define MBEDTLS_GENPRIME
 #endif
 
+#if defined(CONFIG_MBEDTLS_SSL_CACHE_ENABLED)
+#define MBEDTLS_SSL_CACHE_C
+#endif
+
+#if defined(CONFIG_MBEDTLS_SSL_SESSION_TICKETS_ENABLED)
+#define MBEDTLS_SSL_SESSION_TICKETS
+#define MBEDTLS_SSL_TICKET_C
+#endif
+
 /* Automatic dependencies */
 
 #if defined(MBEDTLS_SSL_PROTO_TLS1) || \
@@ -466,6 +466,91 @@ int coap_handle_request(struct coap_packet *cpkt,
 			u8_t opt_num,
 			struct sockaddr *addr, socklen_t addr_len);
 
+/**
+ * @brief Node of a resource index, one for each distinct path prefix.
+ */
+struct coap_resource_node {
+	/** Path segment leading from the parent node to this one */
+	const char *segment;
+	u16_t len;
+	/** Resource whose path ends at this node, if any */
+	struct coap_resource *resource;
+	struct coap_resource_node *child;
+	struct coap_resource_node *sibling;
+};
+
+/**
+ * @brief Prefix tree of the paths of a resource array.
+ *
+ * Requests are dispatched by following the Uri-Path options of the
+ * request down the tree, instead of comparing the path of every
+ * resource.
+ */
+struct coap_resource_index {
+	/** Node storage, the first node is the root of the tree */
+	struct coap_resource_node *nodes;
+	size_t node_count;
+	size_t used;
+};
+
+/**
+ * @brief Builds the index of an array of resources.
+ *
+ * The index needs one node for the root and one for every distinct
+ * path prefix of the resources, e.g. "a/b" and "a/c" need four nodes.
+ * When several resources have the same path, the first one is used,
+ * as coap_handle_request() does. The resources are not copied, the
+ * index has to be built again if their paths change.
+ *
+ * @param index Index to be initialized
+ * @param resources Array of known resources
+ * @param nodes Storage for the nodes of the index
+ * @param node_count Number of elements of @a nodes
+ *
+ * @return 0 in case of success, -ENOMEM if @a nodes is too small or
+ * another negative value in case of error.
+ */
+int coap_resource_index_init(struct coap_resource_index *index,
+			     struct coap_resource *resources,
+			     struct coap_resource_node *nodes,
+			     size_t node_count);
+
+/**
+ * @brief Looks up the resource addressed by the Uri-Path options of a
+ * request.
+ *
+ * @param index Index built by coap_resource_index_init()
+ * @param options Parsed options from coap_packet_parse()
+ * @param opt_num Number of options
+ *
+ * @return The matching resource, or NULL if there is none.
+ */
+struct coap_resource *coap_resource_index_find(
+	const struct coap_resource_index *index,
+	const struct coap_option *options, u8_t opt_num);
+
+/**
+ * @brief When a request is received, call the appropriate methods of
+ * the resource found in @a index.
+ *
+ * Behaves like coap_handle_request(), without going through every
+ * resource to find the matching one.
+ *
+ * @param cpkt Packet received
+ * @param index Index built by coap_resource_index_init()
+ * @param options Parsed options from coap_packet_parse()
+ * @param opt_num Number of options
+ * @param addr Peer address
+ * @param addr_len Peer address length
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_handle_request_index(struct coap_packet *cpkt,
+			      const struct coap_resource_index *index,
+			      struct coap_option *options,
+			      u8_t opt_num,
+			      struct sockaddr *addr, socklen_t addr_len);
+
 /**
  * Represents the size of each block that will be transferred using
  * block-wise transfers [RFC7959]:
@@ -594,6 +679,88 @@ int coap_update_from_block(const struct coap_packet *cpkt,
 size_t coap_next_block(const struct coap_packet *cpkt,
 		       struct coap_block_context *ctx);
 
+/**
+ * @typedef coap_block_read_t
+ * @brief Type of the callback providing the data sent by
+ * coap_block2_response().
+ *
+ * @param offset Offset of @a buf in the body being transferred
+ * @param buf Buffer to fill, inside the response packet
+ * @param len Number of bytes wanted
+ * @param user_data User data passed to coap_block2_response()
+ *
+ * @return Number of bytes read, less than @a len only at the end of
+ * the body, or negative in case of error.
+ */
+typedef int (*coap_block_read_t)(size_t offset, u8_t *buf, size_t len,
+				 void *user_data);
+
+/**
+ * @typedef coap_block_write_t
+ * @brief Type of the callback receiving the data of
+ * coap_block1_receive().
+ *
+ * @param offset Offset of @a buf in the body being transferred, 0 at
+ * the start of every transfer
+ * @param buf Data of the block
+ * @param len Length of the data
+ * @param last True if this is the last block of the body
+ * @param user_data User data passed to coap_block1_receive()
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+typedef int (*coap_block_write_t)(size_t offset, const u8_t *buf,
+				  size_t len, bool last, void *user_data);
+
+/**
+ * @brief Appends to @a response the block of the body asked for by
+ * @a request, reading it with @a read.
+ *
+ * The block is read straight into the packet, so the body never has
+ * to be held in memory. The Block2 option of @a request, if any,
+ * selects the block, and its size if smaller than the one of @a ctx.
+ * The Block2 option, the Size2 option on the first block if the total
+ * size of @a ctx is known, and the payload are appended to
+ * @a response, so options with a number above Block2 cannot be added
+ * before. With an unknown total size, a body whose size is a multiple
+ * of the block size ends with an empty block.
+ *
+ * @param response Response being built
+ * @param request Request received, parsed with coap_packet_parse()
+ * @param ctx Block context of the transfer
+ * @param read Callback providing the data of the block
+ * @param user_data User data passed to @a read
+ *
+ * @return 1 if blocks remain after this one, 0 if it is the last one
+ * or negative in case of error.
+ */
+int coap_block2_response(struct coap_packet *response,
+			 const struct coap_packet *request,
+			 struct coap_block_context *ctx,
+			 coap_block_read_t read, void *user_data);
+
+/**
+ * @brief Passes the payload of a request, possibly one block of a
+ * Block1 transfer, to @a write at its offset in the body.
+ *
+ * The first block starts a new transfer, the next ones must arrive in
+ * order; a retransmission of the last block, other than the first
+ * one, is acknowledged without being written again. After this
+ * returns, coap_append_block1_option() on the response acknowledges
+ * the block.
+ *
+ * @param request Request received, parsed with coap_packet_parse()
+ * @param ctx Block context of the transfer
+ * @param write Callback receiving the data of the block
+ * @param user_data User data passed to @a write
+ *
+ * @return 1 if more blocks are expected, 0 if the body is complete,
+ * -EINVAL if the block is out of order or negative in case of error.
+ */
+int coap_block1_receive(const struct coap_packet *request,
+			struct coap_block_context *ctx,
+			coap_block_write_t write, void *user_data);
+
 /**
  * @brief Indicates that the remote device referenced by @a addr, with
  * @a request, wants to observe a resource.
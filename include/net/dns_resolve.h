@@ -173,6 +173,15 @@ struct dns_resolve_context {
 
 		/** Is this server LLMNR one */
 		u8_t is_llmnr : 1;
+
+		/** Number of consecutive queries this server did not answer */
+		u8_t failures;
+
+		/** Smoothed round trip time in ms, 0 if not measured yet */
+		u32_t rtt;
+
+		/** Uptime in ms until which this server is avoided */
+		u32_t backoff_until;
 	} servers[CONFIG_DNS_RESOLVER_MAX_SERVERS + DNS_MAX_MCAST_SERVERS];
 
 	/** This timeout is also used when a buffer is required from the
@@ -206,6 +215,14 @@ struct dns_resolve_context {
 		/** Query type */
 		enum dns_query_type query_type;
 
+		/** Uptime in ms when the query was sent */
+		u32_t sent;
+
+		/** Bit mask of the servers the query was sent to, which have
+		 * not answered yet.
+		 */
+		u32_t pending_servers;
+
 		/** DNS id of this query */
 		u16_t id;
 	} queries[CONFIG_DNS_NUM_CONCUR_QUERIES];
@@ -214,6 +231,28 @@ struct dns_resolve_context {
 	bool is_used;
 };
 
+/**
+ * DNS answer cache statistics.
+ */
+struct dns_resolve_cache_stats {
+	/** Queries answered with addresses from the cache */
+	u32_t hits;
+
+	/** Queries answered from the cache with a non-existent name */
+	u32_t negative_hits;
+
+	/** Queries answered with expired addresses, the DNS servers
+	 * not responding.
+	 */
+	u32_t stale_hits;
+
+	/** Queries sent to the DNS servers */
+	u32_t misses;
+
+	/** Entries dropped to make room for new answers */
+	u32_t evictions;
+};
+
 /**
  * @brief Init DNS resolving context.
  *
@@ -279,7 +318,7 @@ int dns_resolve_cancel(struct dns_resolve_context *ctx,
  * has occurred.
  * We might send the query to multiple servers (if there are more than one
  * server configured), but we only use the result of the first received
- * response.
+ * valid response. See CONFIG_DNS_RESOLVER_FANOUT.
  *
  * @param ctx DNS context
  * @param query What the caller wants to resolve.
@@ -295,6 +334,11 @@ int dns_resolve_cancel(struct dns_resolve_context *ctx,
  *            if it takes too long time to finish
  * >0: start the query and let the system timeout it after specified ms
  *
+ * @note With CONFIG_DNS_RESOLVER_CACHE, a query found in the cache is
+ * answered before this function returns, and the returned DNS id is 0.
+ * Otherwise the query string must stay valid until the query has
+ * finished, for the answer to be cached.
+ *
  * @return 0 if resolving was started ok, < 0 otherwise
  */
 int dns_resolve_name(struct dns_resolve_context *ctx,
@@ -374,6 +418,24 @@ static inline int dns_cancel_addr_info(u16_t dns_id)
 	return dns_resolve_cancel(dns_resolve_get_default(), dns_id);
 }
 
+/**
+ * @brief Get DNS answer cache statistics.
+ *
+ * @details Only available with CONFIG_DNS_RESOLVER_CACHE. The cache is
+ * shared by all the DNS contexts.
+ *
+ * @param stats Statistics are copied here.
+ */
+void dns_resolve_cache_stats_get(struct dns_resolve_cache_stats *stats);
+
+/**
+ * @brief Drop all the DNS answers from the cache.
+ *
+ * @details Only available with CONFIG_DNS_RESOLVER_CACHE. The statistics
+ * are not reset.
+ */
+void dns_resolve_cache_flush(void);
+
 /**
  * @}
  */
@@ -120,6 +120,9 @@ enum ethernet_hw_caps {
 
 	/** Link Layer Discovery Protocol supported */
 	ETHERNET_LLDP			= BIT(13),
+
+	/** TCP segmentation offload supported */
+	ETHERNET_HW_TX_TSO		= BIT(14),
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -257,6 +260,16 @@ struct ethernet_api {
 
 	/** Send a network packet */
 	int (*send)(struct device *dev, struct net_pkt *pkt);
+
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	/** Send several network packets, notifying the hardware only once.
+	 * Returns the number of packets, from the start of the array, that
+	 * were sent, or <0 if none was. The packets are owned by the caller
+	 * as with send(). Optional, send() is used if this is not set.
+	 */
+	int (*send_batch)(struct device *dev, struct net_pkt **pkts,
+			  int count);
+#endif
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -364,6 +377,22 @@ struct ethernet_context {
 	s8_t vlan_enabled;
 #endif
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	/** Packets waiting to be given to the driver in one send_batch()
+	 * call.
+	 */
+	struct net_pkt *tx_batch[CONFIG_NET_ETHERNET_TX_BATCH_SIZE];
+
+	/** Thread collecting the Tx batch, NULL if none */
+	k_tid_t tx_batch_owner;
+
+	/** Taken by the thread collecting the Tx batch */
+	struct k_sem tx_batch_lock;
+
+	/** Number of packets in tx_batch */
+	u8_t tx_batch_count;
+#endif
+
 	/** Is this context already initialized */
 	bool is_init;
 };
@@ -658,6 +687,29 @@ void net_eth_carrier_off(struct net_if *iface);
  */
 int net_eth_promisc_mode(struct net_if *iface, bool enable);
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+/**
+ * @brief Start collecting the packets sent to an interface into a batch.
+ *
+ * @details Until net_eth_tx_batch_flush() is called, the packets that the
+ * calling thread sends to the interface are queued in the Ethernet L2 and
+ * given to the driver together. Used by the network interface Tx queue.
+ *
+ * @param iface Network interface
+ *
+ * @return true if a batch was started, false if the driver does not
+ * support batches or another thread is collecting a batch for it.
+ */
+bool net_eth_tx_batch_start(struct net_if *iface);
+
+/**
+ * @brief Give the packets of the current batch to the driver.
+ *
+ * @param iface Network interface given to net_eth_tx_batch_start()
+ */
+void net_eth_tx_batch_flush(struct net_if *iface);
+#endif /* CONFIG_NET_ETHERNET_TX_BATCH */
+
 /**
  * @brief Return PTP clock that is tied to this ethernet network interface.
  *
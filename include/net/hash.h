@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Hashing for the hash tables of the network stack
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_HASH_H_
+#define ZEPHYR_INCLUDE_NET_HASH_H_
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Network hash library
+ * @defgroup net_hash Network Hash Library
+ * @ingroup networking
+ * @{
+ */
+
+/**
+ * @brief Multiplicative (Fibonacci) hash of a value.
+ *
+ * The high bits of the product are the best mixed ones, so the result is
+ * taken from them, and it spreads also consecutive values. The caller
+ * takes the result modulo the size of its table.
+ *
+ * @param value Value to hash, or a combination of the fields of a key
+ *
+ * @return Hash, in the range of 0 to 65535
+ */
+static inline u32_t net_hash_fib(u32_t value)
+{
+	return (value * 0x9e3779b1U) >> 16;
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_NET_HASH_H_ */
@@ -637,6 +637,287 @@ int lwm2m_engine_get_float32(char *pathstr, float32_value_t *buf);
  */
 int lwm2m_engine_get_float64(char *pathstr, float64_value_t *buf);
 
+/**
+ * @brief Pre-resolved LwM2M resource handle
+ *
+ * A resource handle is resolved once from a resource path string with
+ * lwm2m_engine_get_res_handle(). The lwm2m_engine_handle_set_*() and
+ * lwm2m_engine_handle_get_*() functions then access the resource without
+ * parsing the path and looking up the object instance and the resource
+ * again. When object instances are created or deleted, the handle is
+ * resolved again on its next use.
+ */
+struct lwm2m_res_handle {
+	/** Private resolved objects */
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res_inst *res;
+	u32_t generation;
+
+	/** Resource path */
+	u16_t obj_id;
+	u16_t obj_inst_id;
+	u16_t res_id;
+};
+
+/**
+ * @brief Resolve a resource handle
+ *
+ * @param[in] pathstr LwM2M resource path string (obj/obj-instance/resource)
+ * @param[out] handle Resource handle to initialize
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_get_res_handle(char *pathstr, struct lwm2m_res_handle *handle);
+
+/**
+ * @brief Set resource value by handle (opaque buffer)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] data_ptr Data buffer
+ * @param[in] data_len Length of buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_opaque(struct lwm2m_res_handle *handle,
+				   char *data_ptr, u16_t data_len);
+
+/**
+ * @brief Set resource value by handle (string)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] data_ptr NULL terminated char buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_string(struct lwm2m_res_handle *handle,
+				   char *data_ptr);
+/**
+ * @brief Set resource value by handle (u8)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value u8 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u8(struct lwm2m_res_handle *handle, u8_t value);
+/**
+ * @brief Set resource value by handle (u16)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value u16 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u16(struct lwm2m_res_handle *handle, u16_t value);
+/**
+ * @brief Set resource value by handle (u32)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value u32 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u32(struct lwm2m_res_handle *handle, u32_t value);
+/**
+ * @brief Set resource value by handle (u64)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value u64 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u64(struct lwm2m_res_handle *handle, u64_t value);
+/**
+ * @brief Set resource value by handle (s8)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value s8 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s8(struct lwm2m_res_handle *handle, s8_t value);
+/**
+ * @brief Set resource value by handle (s16)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value s16 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s16(struct lwm2m_res_handle *handle, s16_t value);
+/**
+ * @brief Set resource value by handle (s32)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value s32 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s32(struct lwm2m_res_handle *handle, s32_t value);
+/**
+ * @brief Set resource value by handle (s64)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value s64 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s64(struct lwm2m_res_handle *handle, s64_t value);
+/**
+ * @brief Set resource value by handle (bool)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value bool value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_bool(struct lwm2m_res_handle *handle, bool value);
+/**
+ * @brief Set resource value by handle (32-bit float structure)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value 32-bit float value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_float32(struct lwm2m_res_handle *handle,
+				    float32_value_t *value);
+/**
+ * @brief Set resource value by handle (64-bit float structure)
+ *
+ * @param[in] handle Resource handle
+ * @param[in] value 64-bit float value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_float64(struct lwm2m_res_handle *handle,
+				    float64_value_t *value);
+/**
+ * @brief Get resource value by handle (opaque buffer)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] buf Data buffer to copy data into
+ * @param[in] buflen Length of buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_opaque(struct lwm2m_res_handle *handle,
+				   void *buf, u16_t buflen);
+
+/**
+ * @brief Get resource value by handle (string)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] buf String buffer to copy data into
+ * @param[in] buflen Length of buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_string(struct lwm2m_res_handle *handle,
+				   void *buf, u16_t buflen);
+/**
+ * @brief Get resource value by handle (u8)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value u8 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_u8(struct lwm2m_res_handle *handle, u8_t *value);
+/**
+ * @brief Get resource value by handle (u16)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value u16 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_u16(struct lwm2m_res_handle *handle, u16_t *value);
+/**
+ * @brief Get resource value by handle (u32)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value u32 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_u32(struct lwm2m_res_handle *handle, u32_t *value);
+/**
+ * @brief Get resource value by handle (u64)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value u64 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_u64(struct lwm2m_res_handle *handle, u64_t *value);
+/**
+ * @brief Get resource value by handle (s8)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value s8 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_s8(struct lwm2m_res_handle *handle, s8_t *value);
+/**
+ * @brief Get resource value by handle (s16)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value s16 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_s16(struct lwm2m_res_handle *handle, s16_t *value);
+/**
+ * @brief Get resource value by handle (s32)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value s32 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_s32(struct lwm2m_res_handle *handle, s32_t *value);
+/**
+ * @brief Get resource value by handle (s64)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value s64 buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_s64(struct lwm2m_res_handle *handle, s64_t *value);
+/**
+ * @brief Get resource value by handle (bool)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] value bool buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_bool(struct lwm2m_res_handle *handle, bool *value);
+/**
+ * @brief Get resource value by handle (32-bit float structure)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] buf 32-bit float buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_float32(struct lwm2m_res_handle *handle,
+				    float32_value_t *buf);
+/**
+ * @brief Get resource value by handle (64-bit float structure)
+ *
+ * @param[in] handle Resource handle
+ * @param[out] buf 64-bit float buffer to copy data into
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_get_float64(struct lwm2m_res_handle *handle,
+				    float64_value_t *buf);
+
 /**
  * @brief Set resource read callback
  *
@@ -57,23 +57,38 @@ enum mqtt_evt_type {
 	 */
 	MQTT_EVT_PUBLISH,
 
-	/** Acknowledgment for published message with QoS 1. */
+	/** Acknowledgment for published message with QoS 1. The -ETIMEDOUT
+	 *  result indicates that the acknowledgment was not received in time,
+	 *  see :option:`CONFIG_MQTT_INFLIGHT_MAX`.
+	 */
 	MQTT_EVT_PUBACK,
 
-	/** Reception confirmation for published message with QoS 2. */
+	/** Reception confirmation for published message with QoS 2. The
+	 *  -ETIMEDOUT result indicates that the confirmation was not received
+	 *  in time.
+	 */
 	MQTT_EVT_PUBREC,
 
 	/** Release of published message with QoS 2. */
 	MQTT_EVT_PUBREL,
 
-	/** Confirmation to a publish release message with QoS 2. */
+	/** Confirmation to a publish release message with QoS 2. The
+	 *  -ETIMEDOUT result indicates that the confirmation was not received
+	 *  in time.
+	 */
 	MQTT_EVT_PUBCOMP,
 
 	/** Acknowledgment to a subscribe request. */
 	MQTT_EVT_SUBACK,
 
 	/** Acknowledgment to a unsubscribe request. */
-	MQTT_EVT_UNSUBACK
+	MQTT_EVT_UNSUBACK,
+
+	/** Chunk of the payload of a received PUBLISH message, which was not
+	 *  read from the @ref MQTT_EVT_PUBLISH handler. Only generated with
+	 *  :option:`CONFIG_MQTT_PAYLOAD_STREAM`.
+	 */
+	MQTT_EVT_PUBLISH_PAYLOAD
 };
 
 /** @brief MQTT version protocol level. */
@@ -168,6 +183,15 @@ struct mqtt_topic {
 	u8_t qos;
 };
 
+/** @brief Parameters for a chunk of a received publish message payload. */
+struct mqtt_publish_payload_param {
+	/** Payload data. Only valid during the event handler. */
+	struct mqtt_binstr data;
+
+	/** Payload length still to be received after this chunk. */
+	u32_t remaining;
+};
+
 /** @brief Parameters for a publish message. */
 struct mqtt_publish_message {
 	struct mqtt_topic topic;     /**< Topic on which data was published. */
@@ -285,6 +309,9 @@ union mqtt_evt_param {
 
 	/** Parameters accompanying MQTT_EVT_UNSUBACK event. */
 	struct mqtt_unsuback_param unsuback;
+
+	/** Parameters accompanying MQTT_EVT_PUBLISH_PAYLOAD event. */
+	struct mqtt_publish_payload_param publish_payload;
 };
 
 /** @brief Defines MQTT asynchronous event notified to the application. */
@@ -402,6 +429,20 @@ struct mqtt_transport {
 	};
 };
 
+/** @brief QoS 1 or QoS 2 message published and not yet acknowledged. */
+struct mqtt_inflight {
+	/** Wall clock value (in milliseconds) when the message, or its
+	 *  release, was sent.
+	 */
+	u32_t sent;
+
+	/** Message id, 0 if the entry is free. */
+	u16_t message_id;
+
+	/** Type of the acknowledgment packet awaited. */
+	u8_t ack_type;
+};
+
 /** @brief MQTT internal state. */
 struct mqtt_internal {
 	/** Internal. Mutex to protect access to the client instance. */
@@ -420,6 +461,11 @@ struct mqtt_internal {
 
 	/** Internal. Remaining payload length to read. */
 	u32_t remaining_payload;
+
+#if defined(CONFIG_MQTT_INFLIGHT_MAX) && (CONFIG_MQTT_INFLIGHT_MAX > 0)
+	/** Internal. Window of unacknowledged QoS 1 and QoS 2 messages. */
+	struct mqtt_inflight inflight[CONFIG_MQTT_INFLIGHT_MAX];
+#endif
 };
 
 /**
@@ -527,11 +573,45 @@ int mqtt_connect(struct mqtt_client *client);
  * @param[in] param Parameters to be used for the publish message.
  *                  Shall not be NULL.
  *
+ * @note The fixed header and the payload are sent in a single transport
+ *       write. With :option:`CONFIG_MQTT_INFLIGHT_MAX` set, QoS 1 and QoS 2
+ *       messages are tracked until acknowledged, and -EAGAIN is returned
+ *       when the window of unacknowledged messages is full. Publishing a
+ *       message again with the same message id, for example with the
+ *       duplicate flag set after a timeout, reuses its entry.
+ *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
  */
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
 
+/**
+ * @brief API to publish several messages at once. The PUBLISH packets are
+ *        packed together in the transmit buffer, and sent in as few
+ *        transport writes as possible, up to
+ *        :option:`CONFIG_MQTT_PUBLISH_BATCH_MAX` packets per write.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] params Array of parameters of the publish messages.
+ *                   Shall not be NULL.
+ * @param[in] count Number of messages in the array.
+ *
+ * @note Messages are published in order, and publishing stops at the first
+ *       one that fails. A count lower than the number of messages tells
+ *       that the message at that index was not published. The reason is
+ *       reported by publishing the remaining messages again, which then
+ *       fails with the error code, e.g. -EAGAIN while the window of
+ *       unacknowledged messages is full. A transport write failure also
+ *       disconnects the client, and is reported with
+ *       @ref MQTT_EVT_DISCONNECT.
+ *
+ * @return Number of messages published if at least one was, or a negative
+ *         error code (errno.h) if no message was published.
+ */
+int mqtt_publish_batch(struct mqtt_client *client,
+		       const struct mqtt_publish_param *params, size_t count);
+
 /**
  * @brief API used by client to send acknowledgment on receiving QoS1 publish
  *        message. Should be called on reception of @ref MQTT_EVT_PUBLISH with
@@ -658,6 +738,11 @@ int mqtt_abort(struct mqtt_client *client);
  *        makes it possible to respect the Keep Alive time agreed with the
  *        broker on connection. @ref mqtt_connect for details on Keep Alive
  *        time.
+ * @note  With :option:`CONFIG_MQTT_INFLIGHT_MAX` set, the published messages
+ *        which are not acknowledged within
+ *        :option:`CONFIG_MQTT_INFLIGHT_TIMEOUT` are reported from this
+ *        function, with the event of the awaited acknowledgment and the
+ *        -ETIMEDOUT result. They stay in the window until acknowledged.
  *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
  */
@@ -670,8 +755,13 @@ int mqtt_live(struct mqtt_client *client);
  * @note In case of PUBLISH message, the payload has to be read separately with
  *       @ref mqtt_read_publish_payload function. The size of the payload to
  *       read is provided in the publish event structure.
+ *       With :option:`CONFIG_MQTT_PAYLOAD_STREAM`, the part of the payload
+ *       not read from the @ref MQTT_EVT_PUBLISH handler is instead delivered
+ *       by the following calls, with @ref MQTT_EVT_PUBLISH_PAYLOAD events,
+ *       as it is received.
  *
- * @note This is a non-blocking call.
+ * @note This is a non-blocking call. Packets may be received across any
+ *       number of calls.
  *
  * @param[in] client Client instance for which the procedure is requested.
  *                   Shall not be NULL.
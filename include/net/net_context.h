@@ -267,6 +267,11 @@ struct net_context {
 	/** TLS context information */
 	struct tls_context *tls;
 #endif /* CONFIG_NET_SOCKETS_SOCKOPT_TLS */
+
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	/** epoll instances watching this socket */
+	sys_slist_t epoll_items;
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
 #endif /* CONFIG_NET_SOCKETS */
 
 #if defined(CONFIG_NET_OFFLOAD)
@@ -282,6 +287,10 @@ struct net_context {
 #endif
 #if defined(CONFIG_NET_CONTEXT_TIMESTAMP)
 		bool timestamp;
+#endif
+#if defined(CONFIG_NET_CONTEXT_REUSEPORT)
+		/** Port can be shared with other contexts that set this */
+		bool reuseport;
 #endif
 	} options;
 
@@ -797,6 +806,32 @@ int net_context_sendto(struct net_context *context,
 		       s32_t timeout,
 		       void *user_data);
 
+/**
+ * @brief Send data in iovec to a peer specified in msghdr struct.
+ *
+ * @details This function has similar semantics as Posix sendmsg() call.
+ * The data in the iovec array is written directly into the network
+ * packet, so it does not need to be copied into one buffer first.
+ * If the msg_name of the msghdr is not set, the data is sent to the
+ * address the context is connected to.
+ *
+ * @param context The network context to use.
+ * @param msghdr The data to send
+ * @param flags Flags for the sending.
+ * @param cb Caller-supplied callback function.
+ * @param timeout Timeout for the connection. Possible values
+ * are K_FOREVER, K_NO_WAIT, >0.
+ * @param user_data Caller-supplied user data.
+ *
+ * @return numbers of bytes sent on success, a negative errno otherwise
+ */
+int net_context_sendmsg(struct net_context *context,
+			const struct msghdr *msghdr,
+			int flags,
+			net_context_send_cb_t cb,
+			s32_t timeout,
+			void *user_data);
+
 /**
  * @brief Receive network data from a peer specified by context.
  *
@@ -864,8 +899,29 @@ int net_context_update_recv_wnd(struct net_context *context,
 enum net_context_option {
 	NET_OPT_PRIORITY	= 1,
 	NET_OPT_TIMESTAMP	= 2,
+	NET_OPT_RCVBUF		= 3,
+	NET_OPT_SNDBUF		= 4,
+	NET_OPT_REUSEPORT	= 5,
 };
 
+/**
+ * @brief Check if the port of this context can be shared.
+ *
+ * @param context Network context.
+ *
+ * @return True if the NET_OPT_REUSEPORT option is set, false otherwise.
+ */
+static inline bool net_context_is_reuseport_set(struct net_context *context)
+{
+#if defined(CONFIG_NET_CONTEXT_REUSEPORT)
+	return context->options.reuseport;
+#else
+	ARG_UNUSED(context);
+
+	return false;
+#endif
+}
+
 /**
  * @brief Set an connection option for this context.
  *
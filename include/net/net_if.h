@@ -432,6 +432,26 @@ struct net_if_dev {
 	u16_t mtu;
 };
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+/**
+ * @brief Packets of one Tx traffic class waiting to be given to the
+ * device driver of a network interface in a batch.
+ */
+struct net_if_tx_batch {
+	/** Work item run by the Tx queue thread of the traffic class */
+	struct k_work work;
+
+	/** Queued packets */
+	struct k_fifo fifo;
+
+	/** Network interface the packets are sent to */
+	struct net_if *iface;
+
+	/** Tx traffic class */
+	u8_t tc;
+};
+#endif /* CONFIG_NET_ETHERNET_TX_BATCH */
+
 /**
  * @brief Network Interface structure
  *
@@ -450,6 +470,11 @@ struct net_if {
 
 	/** Network interface instance configuration */
 	struct net_if_config config;
+
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	/** Packets queued for sending in batches, per Tx traffic class */
+	struct net_if_tx_batch tx_batch[NET_TC_TX_COUNT];
+#endif
 } __net_if_align;
 
 /**
@@ -1628,6 +1653,16 @@ bool net_if_need_calc_rx_checksum(struct net_if *iface);
  */
 bool net_if_need_calc_tx_checksum(struct net_if *iface);
 
+/**
+ * @brief Check if TCP segmentation needs to be done by the IP stack when
+ * sending a GSO packet, or if the device can split the packet itself.
+ *
+ * @param iface Network interface
+ *
+ * @return True if the stack needs to segment the packet, false otherwise.
+ */
+bool net_if_need_tcp_segmentation(struct net_if *iface);
+
 /**
  * @brief Get interface according to index
  *
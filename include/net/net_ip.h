@@ -262,6 +262,78 @@ struct sockaddr {
 	char data[NET_SOCKADDR_MAX_SIZE - sizeof(sa_family_t)];
 };
 
+/** IO vector array element */
+struct iovec {
+	void *iov_base;
+	size_t iov_len;
+};
+
+/** Message struct for sendmsg() and recvmsg() */
+struct msghdr {
+	void *msg_name;           /**< Optional socket address */
+	socklen_t msg_namelen;    /**< Size of the socket address */
+	struct iovec *msg_iov;    /**< Scatter/gather array */
+	size_t msg_iovlen;        /**< Number of elements in msg_iov */
+	void *msg_control;        /**< Ancillary data */
+	size_t msg_controllen;    /**< Ancillary data buffer length */
+	int msg_flags;            /**< Flags on received message */
+};
+
+/** Message struct for sendmmsg() and recvmmsg() */
+struct mmsghdr {
+	struct msghdr msg_hdr;    /**< Message header */
+	unsigned int msg_len;     /**< Number of bytes transmitted */
+};
+
+/** Control message ancillary data header */
+struct cmsghdr {
+	socklen_t cmsg_len;       /**< Data byte count, including header */
+	int cmsg_level;           /**< Originating protocol */
+	int cmsg_type;            /**< Protocol-specific type */
+};
+
+/** @cond INTERNAL_HIDDEN */
+#define NET_CMSG_ALIGN(len) \
+	(((len) + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1))
+/** @endcond */
+
+/** Pointer to the data of the control message */
+#define CMSG_DATA(cmsg) \
+	((u8_t *)(cmsg) + NET_CMSG_ALIGN(sizeof(struct cmsghdr)))
+
+/** Space needed in the control buffer for a message of len data bytes */
+#define CMSG_SPACE(len) \
+	(NET_CMSG_ALIGN(sizeof(struct cmsghdr)) + NET_CMSG_ALIGN(len))
+
+/** Value of cmsg_len for a message of len data bytes */
+#define CMSG_LEN(len) (NET_CMSG_ALIGN(sizeof(struct cmsghdr)) + (len))
+
+/** First control message in the msghdr, or NULL if there is none */
+#define CMSG_FIRSTHDR(msg) \
+	((msg)->msg_controllen >= sizeof(struct cmsghdr) ? \
+	 (struct cmsghdr *)(msg)->msg_control : NULL)
+
+/** Control message following cmsg, or NULL if there is no room for it */
+#define CMSG_NXTHDR(msg, cmsg) \
+	(((u8_t *)(cmsg) + NET_CMSG_ALIGN((cmsg)->cmsg_len) + \
+	  NET_CMSG_ALIGN(sizeof(struct cmsghdr)) > \
+	  (u8_t *)(msg)->msg_control + (msg)->msg_controllen) ? NULL : \
+	 (struct cmsghdr *)((u8_t *)(cmsg) + \
+			    NET_CMSG_ALIGN((cmsg)->cmsg_len)))
+
+/** Packet information of a received IPv4 packet (IP_PKTINFO) */
+struct in_pktinfo {
+	unsigned int ipi_ifindex;     /**< Interface index */
+	struct in_addr ipi_spec_dst;  /**< Local address */
+	struct in_addr ipi_addr;      /**< Header destination address */
+};
+
+/** Packet information of a received IPv6 packet (IPV6_PKTINFO) */
+struct in6_pktinfo {
+	struct in6_addr ipi6_addr;    /**< Destination address */
+	unsigned int ipi6_ifindex;    /**< Interface index */
+};
+
 /** @cond INTERNAL_HIDDEN */
 
 struct sockaddr_ptr {
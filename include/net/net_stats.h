@@ -187,6 +187,23 @@ struct net_stats_ipv6_nd {
 	net_stats_t sent;
 };
 
+/**
+ * @brief ARP cache statistics
+ */
+struct net_stats_arp {
+	/** Number of lookups that found a resolved entry */
+	net_stats_t hit;
+
+	/** Number of lookups that required an ARP request */
+	net_stats_t miss;
+
+	/** Number of packets queued waiting for an ARP reply */
+	net_stats_t queued;
+
+	/** Number of unicast ARP requests sent to refresh an entry */
+	net_stats_t refresh;
+};
+
 /**
  * @brief IPv6 multicast listener daemon statistics
  */
@@ -244,6 +261,11 @@ struct net_stats {
 	struct net_stats_ip ipv4;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+	/** ARP cache statistics */
+	struct net_stats_arp arp;
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 	/** ICMP statistics */
 	struct net_stats_icmp icmp;
@@ -384,6 +406,7 @@ enum net_request_stats_cmd {
 	NET_REQUEST_STATS_CMD_GET_UDP,
 	NET_REQUEST_STATS_CMD_GET_TCP,
 	NET_REQUEST_STATS_CMD_GET_ETHERNET,
+	NET_REQUEST_STATS_CMD_GET_ARP,
 };
 
 #define NET_REQUEST_STATS_GET_ALL				\
@@ -427,6 +450,13 @@ NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IPV6);
 NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IPV6_ND);
 #endif /* CONFIG_NET_STATISTICS_IPV6_ND */
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+#define NET_REQUEST_STATS_GET_ARP				\
+	(_NET_STATS_BASE | NET_REQUEST_STATS_CMD_GET_ARP)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_ARP);
+#endif /* CONFIG_NET_STATISTICS_ARP */
+
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 #define NET_REQUEST_STATS_GET_ICMP				\
 	(_NET_STATS_BASE | NET_REQUEST_STATS_CMD_GET_ICMP)
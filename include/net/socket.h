@@ -26,6 +26,7 @@
 #include <net/net_ip.h>
 #include <net/dns_resolve.h>
 #include <net/socket_select.h>
+#include <net/socket_epoll.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -38,6 +39,19 @@ struct zsock_pollfd {
 	short revents;
 };
 
+/** Data lent by zsock_recv_zerocopy() */
+struct zsock_zerocopy_rx {
+	/** Array to fill with the received data fragments */
+	struct iovec *iov;
+	/** Size of the iov array on input, fragments filled on output */
+	size_t iovcnt;
+
+	/** @cond INTERNAL_HIDDEN */
+	void *pkt;
+	size_t len;
+	/** @endcond */
+};
+
 /* ZSOCK_POLL* values are compatible with Linux */
 /** zsock_poll: Poll for readability */
 #define ZSOCK_POLLIN 1
@@ -54,8 +68,18 @@ struct zsock_pollfd {
 
 /** zsock_recv: Read data without removing it from socket input queue */
 #define ZSOCK_MSG_PEEK 0x02
+/** zsock_recvmsg: Control data was discarded, buffer too small
+ * (output value only)
+ */
+#define ZSOCK_MSG_CTRUNC 0x08
+/** zsock_recvmsg: Datagram was truncated (output value only) */
+#define ZSOCK_MSG_TRUNC 0x20
 /** zsock_recv/zsock_send: Override operation to non-blocking */
 #define ZSOCK_MSG_DONTWAIT 0x40
+/** zsock_send: More data will follow. TLS sockets keep the data to send it
+ *  in the same record as the next data, other sockets ignore the flag.
+ */
+#define ZSOCK_MSG_MORE 0x8000
 
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
@@ -119,6 +143,33 @@ struct zsock_pollfd {
  *    - 1 - server
  */
 #define TLS_DTLS_ROLE 6
+/** Socket option to enable the TLS session cache, so that the connections
+ *  can be resumed with an abbreviated handshake. This option accepts and
+ *  returns an integer:
+ *    - 0 - disabled
+ *    - 1 - enabled
+ *
+ *  Clients resume the session of their previous connection with the same
+ *  hostname (or peer address if no hostname is set) and secure tags. Set on
+ *  a listening socket, it enables the session cache and session tickets for
+ *  the accepted connections. By default, the session cache is disabled.
+ *  Requires CONFIG_NET_SOCKETS_TLS_SESSION_CACHE.
+ */
+#define TLS_SESSION_CACHE 7
+
+/** Values of the TLS_SESSION_CACHE socket option. */
+#define TLS_SESSION_CACHE_DISABLED 0
+#define TLS_SESSION_CACHE_ENABLED 1
+
+/** Read-only socket option to read whether a TLS client connection resumed
+ *  the cached session of its peer with an abbreviated handshake. This option
+ *  returns an integer:
+ *    - 0 - full handshake
+ *    - 1 - resumed session
+ *
+ *  Requires CONFIG_NET_SOCKETS_TLS_SESSION_CACHE.
+ */
+#define TLS_SESSION_RESUMED 8
 
 /** @} */
 
@@ -270,6 +321,45 @@ static inline ssize_t zsock_send(int sock, const void *buf, size_t len,
 	return zsock_sendto(sock, buf, len, flags, NULL, 0);
 }
 
+/**
+ * @brief Send data to an arbitrary network address
+ *
+ * @details
+ * @rststar
+ * See `POSIX.1-2017 article
+ * <http://pubs.opengroup.org/onlinepubs/9699919799/functions/sendmsg.html>`__
+ * for normative description.
+ * This function is also exposed as ``sendmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrststar
+ *
+ * The data in the iovec array is written directly into the network
+ * packet. If msg_name is not set, the data is sent to the connected
+ * peer. Ancillary data is ignored. On TLS sockets, the data of the iovec
+ * array is coalesced into as few records as possible.
+ */
+__syscall ssize_t zsock_sendmsg(int sock, const struct msghdr *msg, int flags);
+
+/**
+ * @brief Send multiple messages with a single call
+ *
+ * @details
+ * @rststar
+ * See `Linux man page
+ * <http://man7.org/linux/man-pages/man2/sendmmsg.2.html>`__
+ * for normative description.
+ * This function is also exposed as ``sendmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrststar
+ *
+ * The messages are sent as with zsock_sendmsg(), and the number of bytes
+ * sent for each is stored in its msg_len. The call stops at the first
+ * message that cannot be sent, and returns the number of messages sent,
+ * or -1 if the first message failed.
+ */
+__syscall int zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
 /**
  * @brief Receive data from an arbitrary network address
  *
@@ -304,6 +394,86 @@ static inline ssize_t zsock_recv(int sock, void *buf, size_t max_len,
 	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
 }
 
+/**
+ * @brief Receive data from an arbitrary network address
+ *
+ * @details
+ * @rststar
+ * See `POSIX.1-2017 article
+ * <http://pubs.opengroup.org/onlinepubs/9699919799/functions/recvmsg.html>`__
+ * for normative description.
+ * This function is also exposed as ``recvmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrststar
+ *
+ * The received data is copied from the network packet into the iovec
+ * array. For datagram sockets, packet information (IP_PKTINFO and
+ * IPV6_RECVPKTINFO options) and the receive timestamp (SO_TIMESTAMPING
+ * option) are returned as ancillary data if enabled for the socket.
+ */
+__syscall ssize_t zsock_recvmsg(int sock, struct msghdr *msg, int flags);
+
+/**
+ * @brief Receive multiple messages with a single call
+ *
+ * @details
+ * @rststar
+ * See `Linux man page
+ * <http://man7.org/linux/man-pages/man2/recvmmsg.2.html>`__
+ * for normative description.
+ * This function is also exposed as ``recvmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrststar
+ *
+ * The messages are received as with zsock_recvmsg(), and the length of
+ * each is stored in its msg_len. Only the first message is waited for,
+ * the call then returns as many of the already queued messages as fit
+ * into msgvec, like with MSG_WAITFORONE on Linux. The timeout argument of
+ * the Linux function is not supported. Returns the number of messages
+ * received, or -1 if no message could be received.
+ */
+__syscall int zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/**
+ * @brief Receive data without copying it
+ *
+ * @details
+ * Instead of copying the received data into an application buffer, the
+ * iov array in @a zc is set to point to the network buffers holding the
+ * data, which stay valid until zsock_recv_zerocopy_release() is called.
+ * The data must be treated as read-only.
+ *
+ * For stream sockets, data that does not fit into the iov array is
+ * returned by the next call, and the receive window is reopened only
+ * when the data is released. For datagram sockets, the part of the
+ * datagram that does not fit is discarded. ZSOCK_MSG_PEEK is not
+ * supported.
+ *
+ * The network buffers are not accessible to user mode threads, so this
+ * function is not a system call. All lent data must be released before
+ * the socket is closed.
+ *
+ * @param sock Socket descriptor
+ * @param zc Zero-copy receive descriptor
+ * @param flags ZSOCK_MSG_DONTWAIT or 0
+ *
+ * @return Number of bytes lent, 0 at end of stream, or -1 on error with
+ * errno set.
+ */
+ssize_t zsock_recv_zerocopy(int sock, struct zsock_zerocopy_rx *zc,
+			    int flags);
+
+/**
+ * @brief Release data received with zsock_recv_zerocopy()
+ *
+ * @param sock Socket descriptor the data was received from
+ * @param zc Zero-copy receive descriptor filled by zsock_recv_zerocopy()
+ *
+ * @return 0 on success, -1 on error with errno set.
+ */
+int zsock_recv_zerocopy_release(int sock, struct zsock_zerocopy_rx *zc);
+
 /**
  * @brief Control blocking/non-blocking mode of a socket
  *
@@ -568,6 +738,28 @@ static inline ssize_t recv(int sock, void *buf, size_t max_len, int flags)
 /* This conflicts with fcntl.h, so code must include fcntl.h before socket.h: */
 #define fcntl zsock_fcntl
 
+static inline ssize_t sendmsg(int sock, const struct msghdr *msg, int flags)
+{
+	return zsock_sendmsg(sock, msg, flags);
+}
+
+static inline ssize_t recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg(sock, msg, flags);
+}
+
+static inline int sendmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
+static inline int recvmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_recvmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline ssize_t sendto(int sock, const void *buf, size_t len, int flags,
 			     const struct sockaddr *dest_addr,
 			     socklen_t addrlen)
@@ -674,6 +866,9 @@ static inline int inet_pton(sa_family_t family, const char *src, void *dst)
 
 #define MSG_PEEK ZSOCK_MSG_PEEK
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
+#define MSG_CTRUNC ZSOCK_MSG_CTRUNC
+#define MSG_TRUNC ZSOCK_MSG_TRUNC
+#define MSG_MORE ZSOCK_MSG_MORE
 
 #define SHUT_RD ZSOCK_SHUT_RD
 #define SHUT_WR ZSOCK_SHUT_WR
@@ -703,14 +898,34 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 #define SO_REUSEADDR 2
 /** sockopt: Async error (ignored, for compatibility) */
 #define SO_ERROR 4
+/** sockopt: Size of the send buffer, bounds TCP data in flight */
+#define SO_SNDBUF 7
+/** sockopt: Size of the receive buffer, sets the TCP receive window */
+#define SO_RCVBUF 8
+/** sockopt: Allow several sockets to bind the same port, incoming
+ * datagrams and connections are spread among them by flow
+ */
+#define SO_REUSEPORT 15
+/** sockopt: Return the receive timestamp of datagrams in recvmsg()
+ * ancillary data, as struct net_ptp_time
+ */
+#define SO_TIMESTAMPING 37
 
 /* Socket options for IPPROTO_TCP level */
 /** sockopt: Disable TCP buffering (ignored, for compatibility) */
 #define TCP_NODELAY 1
 
+/* Socket options for IPPROTO_IP level */
+/** sockopt: Return struct in_pktinfo in recvmsg() ancillary data */
+#define IP_PKTINFO 8
+
 /* Socket options for IPPROTO_IPV6 level */
 /** sockopt: Don't support IPv4 access (ignored, for compatibility) */
 #define IPV6_V6ONLY 26
+/** sockopt: Return struct in6_pktinfo in recvmsg() ancillary data */
+#define IPV6_RECVPKTINFO 49
+/** Ancillary data type of struct in6_pktinfo */
+#define IPV6_PKTINFO 50
 
 #ifdef __cplusplus
 }
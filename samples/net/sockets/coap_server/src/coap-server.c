@@ -691,32 +691,31 @@ end:
 	return r;
 }
 
+static int large_read(size_t offset, u8_t *buf, size_t len, void *user_data)
+{
+	/* The body is generated as it is sent, one block at a time */
+	memset(buf, 'A', len);
+
+	return len;
+}
+
 static int large_get(struct coap_resource *resource,
 		     struct coap_packet *request,
 		     struct sockaddr *addr, socklen_t addr_len)
 
 {
-	static struct coap_block_context ctx;
+	struct coap_block_context ctx;
 	struct coap_packet response;
-	u8_t payload[64];
 	u8_t token[8];
 	u8_t *data;
-	u16_t size;
 	u16_t id;
 	u8_t code;
 	u8_t type;
 	u8_t tkl;
 	int r;
 
-	if (ctx.total_size == 0) {
-		coap_block_transfer_init(&ctx, COAP_BLOCK_64,
-					 BLOCK_WISE_TRANSFER_SIZE_GET);
-	}
-
-	r = coap_update_from_block(request, &ctx);
-	if (r < 0) {
-		return -EINVAL;
-	}
+	coap_block_transfer_init(&ctx, COAP_BLOCK_64,
+				 BLOCK_WISE_TRANSFER_SIZE_GET);
 
 	code = coap_header_get_code(request);
 	type = coap_header_get_type(request);
@@ -736,7 +735,7 @@ static int large_get(struct coap_resource *resource,
 			     1, COAP_TYPE_ACK, tkl, (u8_t *) token,
 			     COAP_RESPONSE_CODE_CONTENT, id);
 	if (r < 0) {
-		return -EINVAL;
+		goto end;
 	}
 
 	r = coap_packet_append_option(&response, COAP_OPTION_CONTENT_FORMAT,
@@ -746,32 +745,11 @@ static int large_get(struct coap_resource *resource,
 		goto end;
 	}
 
-	r = coap_append_block2_option(&response, &ctx);
+	r = coap_block2_response(&response, request, &ctx, large_read, NULL);
 	if (r < 0) {
 		goto end;
 	}
 
-	r = coap_packet_append_payload_marker(&response);
-	if (r < 0) {
-		goto end;
-	}
-
-	size = MIN(coap_block_size_to_bytes(ctx.block_size),
-		   ctx.total_size - ctx.current);
-
-	memset(payload, 'A', MIN(size, sizeof(payload)));
-
-	r = coap_packet_append_payload(&response, (u8_t *)payload, size);
-	if (r < 0) {
-		goto end;
-	}
-
-	r = coap_next_block(&response, &ctx);
-	if (!r) {
-		/* Will return 0 when it's the last block. */
-		memset(&ctx, 0, sizeof(ctx));
-	}
-
 	r = send_coap_reply(&response, addr, addr_len);
 
 end:
@@ -1295,6 +1273,10 @@ static struct coap_resource resources[] = {
 	{ },
 };
 
+/* The root and one node for each path segment of the resources */
+static struct coap_resource_node resource_nodes[16];
+static struct coap_resource_index resource_index;
+
 static struct coap_resource *find_resouce_by_observer(
 		struct coap_resource *resources, struct coap_observer *o)
 {
@@ -1370,8 +1352,8 @@ not_found:
 	}
 
 end:
-	r = coap_handle_request(&request, resources, options, opt_num,
-				client_addr, client_addr_len);
+	r = coap_handle_request_index(&request, &resource_index, options,
+				      opt_num, client_addr, client_addr_len);
 	if (r < 0) {
 		LOG_WRN("No handler for such request (%d)\n", r);
 	}
@@ -1415,6 +1397,13 @@ void main(void)
 	}
 #endif
 
+	r = coap_resource_index_init(&resource_index, resources,
+				     resource_nodes,
+				     ARRAY_SIZE(resource_nodes));
+	if (r < 0) {
+		goto quit;
+	}
+
 	r = start_coap_server();
 	if (r < 0) {
 		goto quit;
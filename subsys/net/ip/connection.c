@@ -19,6 +19,7 @@ LOG_MODULE_REGISTER(net_conn, CONFIG_NET_CONN_LOG_LEVEL);
 #include <net/udp.h>
 #include <net/ethernet.h>
 #include <net/socket_can.h>
+#include <net/hash.h>
 
 #include "net_private.h"
 #include "icmpv6.h"
@@ -326,6 +327,115 @@ static inline void cache_remove(struct net_conn *conn)
 #define cache_remove(...)
 #endif /* CONFIG_NET_CONN_CACHE */
 
+#if defined(CONFIG_NET_CONN_HASH)
+
+/* Connections that have the remote address, remote port and local port
+ * set (connected sockets) are hashed by these. Other connections that
+ * have a local port are hashed by the local port only. The rest, like
+ * packet sockets, are in a list that is checked for every packet.
+ * All the ports are in network byte order.
+ */
+#define NET_RANK_CONNECTED (NET_RANK_LOCAL_PORT | NET_RANK_REMOTE_PORT | \
+			    NET_RANK_REMOTE_SPEC_ADDR)
+
+static sys_slist_t conn_hash_connected[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_hash_port[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_wildcard;
+
+static inline u32_t hash_index(u32_t value)
+{
+	return net_hash_fib(value) % CONFIG_NET_CONN_HASH_SIZE;
+}
+
+static u32_t hash_addr(sa_family_t family, const void *addr)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV6) && family == AF_INET6) {
+		const struct in6_addr *addr6 = addr;
+
+		return UNALIGNED_GET(&addr6->s6_addr32[0]) ^
+			UNALIGNED_GET(&addr6->s6_addr32[1]) ^
+			UNALIGNED_GET(&addr6->s6_addr32[2]) ^
+			UNALIGNED_GET(&addr6->s6_addr32[3]);
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
+		const struct in_addr *addr4 = addr;
+
+		return UNALIGNED_GET(&addr4->s_addr);
+	}
+
+	return 0;
+}
+
+static sys_slist_t *hash_connected(u16_t proto, sa_family_t family,
+				   const void *remote_addr,
+				   u16_t remote_port, u16_t local_port)
+{
+	u32_t value = hash_addr(family, remote_addr) ^ proto ^
+		(((u32_t)remote_port << 16) | local_port);
+
+	return &conn_hash_connected[hash_index(value)];
+}
+
+static sys_slist_t *hash_port(u16_t proto, u16_t local_port)
+{
+	return &conn_hash_port[hash_index(((u32_t)proto << 16) |
+					  local_port)];
+}
+
+static sys_slist_t *conn_hash_list(struct net_conn *conn)
+{
+	u16_t local_port = net_sin(&conn->local_addr)->sin_port;
+	const void *remote_addr;
+
+	if ((conn->rank & NET_RANK_CONNECTED) == NET_RANK_CONNECTED) {
+		if (conn->remote_addr.sa_family == AF_INET6) {
+			remote_addr = &net_sin6(&conn->remote_addr)->sin6_addr;
+		} else {
+			remote_addr = &net_sin(&conn->remote_addr)->sin_addr;
+		}
+
+		return hash_connected(conn->proto,
+				      conn->remote_addr.sa_family,
+				      remote_addr,
+				      net_sin(&conn->remote_addr)->sin_port,
+				      local_port);
+	}
+
+	if (local_port) {
+		return hash_port(conn->proto, local_port);
+	}
+
+	return &conn_wildcard;
+}
+
+/* Handlers are registered and unregistered from application threads
+ * while the RX path walks the lists, so both sides keep interrupts
+ * locked while touching them. The walks are bounded by
+ * CONFIG_NET_MAX_CONN.
+ */
+static inline void conn_hash_add(struct net_conn *conn)
+{
+	unsigned int key = irq_lock();
+
+	sys_slist_append(conn_hash_list(conn), &conn->node);
+
+	irq_unlock(key);
+}
+
+static inline void conn_hash_remove(struct net_conn *conn)
+{
+	unsigned int key = irq_lock();
+
+	sys_slist_find_and_remove(conn_hash_list(conn), &conn->node);
+
+	irq_unlock(key);
+}
+#else
+#define conn_hash_add(...)
+#define conn_hash_remove(...)
+#endif /* CONFIG_NET_CONN_HASH */
+
 int net_conn_unregister(struct net_conn_handle *handle)
 {
 	struct net_conn *conn = (struct net_conn *)handle;
@@ -339,6 +449,7 @@ int net_conn_unregister(struct net_conn_handle *handle)
 	}
 
 	cache_remove(conn);
+	conn_hash_remove(conn);
 
 	NET_DBG("[%zu] connection handler %p removed",
 		conn - conns, conn);
@@ -540,6 +651,7 @@ int net_conn_register(u16_t proto, u8_t family,
 		      const struct sockaddr *local_addr,
 		      u16_t remote_port,
 		      u16_t local_port,
+		      struct net_context *context,
 		      net_conn_cb_t cb,
 		      void *user_data,
 		      struct net_conn_handle **handle)
@@ -549,7 +661,10 @@ int net_conn_register(u16_t proto, u8_t family,
 
 	i = find_conn_handler(proto, family, remote_addr, local_addr,
 			      remote_port, local_port);
-	if (i != -ENOENT) {
+	if (i != -ENOENT &&
+	    !(context && net_context_is_reuseport_set(context) &&
+	      conns[i].context &&
+	      net_context_is_reuseport_set(conns[i].context))) {
 		NET_ERR("Identical connection handler %p already found.",
 			&conns[i]);
 		return -EALREADY;
@@ -655,10 +770,13 @@ int net_conn_register(u16_t proto, u8_t family,
 		conns[i].flags |= NET_CONN_IN_USE;
 		conns[i].cb = cb;
 		conns[i].user_data = user_data;
+		conns[i].context = context;
 		conns[i].rank = rank;
 		conns[i].proto = proto;
 		conns[i].family = family;
 
+		conn_hash_add(&conns[i]);
+
 		/* Cache needs to be cleared if new entries are added. */
 		cache_clear();
 
@@ -796,14 +914,248 @@ static bool is_valid_packet(struct net_pkt *pkt,
 	return !(my_src_addr && (src_port == dst_port));
 }
 
+static bool conn_match(struct net_conn *conn,
+		       struct net_pkt *pkt,
+		       union net_ip_header *ip_hdr,
+		       u8_t proto,
+		       u16_t src_port,
+		       u16_t dst_port)
+{
+	if (!(conn->flags & NET_CONN_IN_USE)) {
+		return false;
+	}
+
+	if (conn->proto != proto) {
+		return false;
+	}
+
+	if (conn->family != AF_UNSPEC &&
+	    conn->family != net_pkt_family(pkt)) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_UDP) || IS_ENABLED(CONFIG_NET_TCP)) {
+		if (net_sin(&conn->remote_addr)->sin_port) {
+			if (net_sin(&conn->remote_addr)->sin_port !=
+			    src_port) {
+				return false;
+			}
+		}
+
+		if (net_sin(&conn->local_addr)->sin_port) {
+			if (net_sin(&conn->local_addr)->sin_port !=
+			    dst_port) {
+				return false;
+			}
+		}
+
+		if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
+			if (!check_addr(pkt, ip_hdr, &conn->remote_addr,
+					true)) {
+				return false;
+			}
+		}
+
+		if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
+			if (!check_addr(pkt, ip_hdr, &conn->local_addr,
+					false)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/* Check if matching conn should replace the current best match */
+static bool conn_is_better(struct net_conn *conn, int best_match,
+			   s16_t best_rank)
+{
+	if (!IS_ENABLED(CONFIG_NET_UDP) && !IS_ENABLED(CONFIG_NET_TCP)) {
+		return true;
+	}
+
+	/* If we have an existing best_match, and that one
+	 * specifies a remote port, then we've matched to a
+	 * LISTENING connection that should not override.
+	 */
+	if (best_match >= 0 &&
+	    net_sin(&conns[best_match].remote_addr)->sin_port) {
+		return false;
+	}
+
+	return best_rank < conn->rank;
+}
+
+#if defined(CONFIG_NET_CONN_HASH)
+static void conn_hash_match(sys_slist_t *list,
+			    struct net_pkt *pkt,
+			    union net_ip_header *ip_hdr,
+			    u8_t proto,
+			    u16_t src_port,
+			    u16_t dst_port,
+			    int *best_match,
+			    s16_t *best_rank)
+{
+	struct net_conn *conn;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(list, conn, node) {
+		if (!conn_match(conn, pkt, ip_hdr, proto,
+				src_port, dst_port)) {
+			continue;
+		}
+
+		if (conn_is_better(conn, *best_match, *best_rank)) {
+			*best_rank = conn->rank;
+			*best_match = conn - conns;
+		}
+	}
+}
+
+static int conn_hash_find(struct net_pkt *pkt,
+			  union net_ip_header *ip_hdr,
+			  u8_t proto,
+			  u16_t src_port,
+			  u16_t dst_port)
+{
+	const void *src_addr = NULL;
+	int best_match = -1;
+	s16_t best_rank = -1;
+	unsigned int key;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		src_addr = &ip_hdr->ipv4->src;
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		src_addr = &ip_hdr->ipv6->src;
+	}
+
+	key = irq_lock();
+
+	/* A connected socket is the most specific match there can be */
+	if (src_addr) {
+		conn_hash_match(hash_connected(proto, net_pkt_family(pkt),
+					       src_addr, src_port, dst_port),
+				pkt, ip_hdr, proto, src_port, dst_port,
+				&best_match, &best_rank);
+		if (best_match >= 0) {
+			goto out;
+		}
+	}
+
+	conn_hash_match(hash_port(proto, dst_port), pkt, ip_hdr, proto,
+			src_port, dst_port, &best_match, &best_rank);
+	conn_hash_match(&conn_wildcard, pkt, ip_hdr, proto,
+			src_port, dst_port, &best_match, &best_rank);
+
+out:
+	irq_unlock(key);
+
+	return best_match;
+}
+#endif /* CONFIG_NET_CONN_HASH */
+
+#if defined(CONFIG_NET_CONTEXT_REUSEPORT)
+static bool conn_is_reuseport(struct net_conn *conn)
+{
+	return conn->context && net_context_is_reuseport_set(conn->context);
+}
+
+static u32_t conn_flow_hash(struct net_pkt *pkt, union net_ip_header *ip_hdr,
+			    u16_t src_port)
+{
+	const u8_t *addr;
+	u32_t hash = src_port;
+	size_t len;
+	size_t i;
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(pkt) == AF_INET6) {
+		addr = ip_hdr->ipv6->src.s6_addr;
+		len = sizeof(struct in6_addr);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		   net_pkt_family(pkt) == AF_INET) {
+		addr = ip_hdr->ipv4->src.s4_addr;
+		len = sizeof(struct in_addr);
+	} else {
+		return hash;
+	}
+
+	/* The same flow must always end up at the same socket */
+	for (i = 0; i < len; i++) {
+		hash = hash * 31U + addr[i];
+	}
+
+	return net_hash_fib(hash);
+}
+
+static bool conn_is_reuseport_peer(struct net_conn *conn,
+				   struct net_conn *best,
+				   struct net_pkt *pkt,
+				   union net_ip_header *ip_hdr,
+				   u8_t proto,
+				   u16_t src_port,
+				   u16_t dst_port)
+{
+	return conn->rank == best->rank && conn_is_reuseport(conn) &&
+		conn_match(conn, pkt, ip_hdr, proto, src_port, dst_port);
+}
+
+/* If the best match is bound with the reuseport option, spread the flows
+ * among all the equally ranked handlers that share its port. This is only
+ * done for reuseport handlers, so the full table scan is not in the common
+ * path.
+ */
+static int conn_reuseport_select(int best_match, struct net_pkt *pkt,
+				 union net_ip_header *ip_hdr, u8_t proto,
+				 u16_t src_port, u16_t dst_port)
+{
+	struct net_conn *best = &conns[best_match];
+	u32_t count = 0U;
+	u32_t pick;
+	int i;
+
+	if (!conn_is_reuseport(best)) {
+		return best_match;
+	}
+
+	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
+		if (conn_is_reuseport_peer(&conns[i], best, pkt, ip_hdr,
+					   proto, src_port, dst_port)) {
+			count++;
+		}
+	}
+
+	if (count <= 1U) {
+		return best_match;
+	}
+
+	pick = conn_flow_hash(pkt, ip_hdr, src_port) % count;
+
+	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
+		if (conn_is_reuseport_peer(&conns[i], best, pkt, ip_hdr,
+					   proto, src_port, dst_port) &&
+		    pick-- == 0U) {
+			return i;
+		}
+	}
+
+	return best_match;
+}
+#else
+#define conn_reuseport_select(best_match, ...) (best_match)
+#endif /* CONFIG_NET_CONTEXT_REUSEPORT */
+
 enum net_verdict net_conn_input(struct net_pkt *pkt,
 				union net_ip_header *ip_hdr,
 				u8_t proto,
 				union net_proto_header *proto_hdr)
 {
 	struct net_if *pkt_iface = net_pkt_iface(pkt);
-	int i, best_match = -1;
+	int best_match = -1;
+#if !defined(CONFIG_NET_CONN_HASH)
 	s16_t best_rank = -1;
+	int i;
+#endif
 	u16_t src_port;
 	u16_t dst_port;
 #if defined(CONFIG_NET_CONN_CACHE)
@@ -858,75 +1210,26 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 		" family %d", net_proto2str(net_pkt_family(pkt), proto), pkt,
 		ntohs(src_port), ntohs(dst_port), net_pkt_family(pkt));
 
+#if defined(CONFIG_NET_CONN_HASH)
+	best_match = conn_hash_find(pkt, ip_hdr, proto, src_port, dst_port);
+#else
 	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (!(conns[i].flags & NET_CONN_IN_USE)) {
-			continue;
-		}
-
-		if (conns[i].proto != proto) {
-			continue;
-		}
-
-		if (conns[i].family != AF_UNSPEC &&
-		    conns[i].family != net_pkt_family(pkt)) {
+		if (!conn_match(&conns[i], pkt, ip_hdr, proto,
+				src_port, dst_port)) {
 			continue;
 		}
 
-		if (IS_ENABLED(CONFIG_NET_UDP) ||
-		    IS_ENABLED(CONFIG_NET_TCP)) {
-			if (net_sin(&conns[i].remote_addr)->sin_port) {
-				if (net_sin(&conns[i].remote_addr)->sin_port !=
-				    src_port) {
-					continue;
-				}
-			}
-
-			if (net_sin(&conns[i].local_addr)->sin_port) {
-				if (net_sin(&conns[i].local_addr)->sin_port !=
-				    dst_port) {
-					continue;
-				}
-			}
-
-			if (conns[i].flags & NET_CONN_REMOTE_ADDR_SET) {
-				if (!check_addr(pkt, ip_hdr,
-						&conns[i].remote_addr,
-						true)) {
-					continue;
-				}
-			}
-
-			if (conns[i].flags & NET_CONN_LOCAL_ADDR_SET) {
-				if (!check_addr(pkt, ip_hdr,
-						&conns[i].local_addr,
-						false)) {
-					continue;
-				}
-			}
-
-			/* If we have an existing best_match, and that one
-			 * specifies a remote port, then we've matched to a
-			 * LISTENING connection that should not override.
-			 */
-			if (best_match >= 0 &&
-			    net_sin(&conns[best_match].remote_addr)->sin_port) {
-				continue;
-			}
-
-			if (best_rank < conns[i].rank) {
-				best_rank = conns[i].rank;
-				best_match = i;
-			}
-		} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET)) {
-			best_rank = 0;
-			best_match = i;
-		} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN)) {
-			best_rank = 0;
+		if (conn_is_better(&conns[i], best_match, best_rank)) {
+			best_rank = conns[i].rank;
 			best_match = i;
 		}
 	}
+#endif /* CONFIG_NET_CONN_HASH */
 
 	if (best_match >= 0) {
+		best_match = conn_reuseport_select(best_match, pkt, ip_hdr,
+						   proto, src_port, dst_port);
+
 #if defined(CONFIG_NET_CONN_CACHE)
 		NET_DBG("[%d] match found cb %p ud %p rank 0x%02x cache 0x%x",
 			best_match,
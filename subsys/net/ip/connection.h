@@ -16,6 +16,7 @@
 #include <zephyr/types.h>
 
 #include <misc/util.h>
+#include <misc/slist.h>
 
 #include <net/net_core.h>
 #include <net/net_ip.h>
@@ -47,6 +48,11 @@ typedef enum net_verdict (*net_conn_cb_t)(struct net_conn *conn,
  *
  */
 struct net_conn {
+#if defined(CONFIG_NET_CONN_HASH)
+	/** Node in the hash bucket of the connection */
+	sys_snode_t node;
+#endif
+
 	/** Remote IP address */
 	struct sockaddr remote_addr;
 
@@ -59,6 +65,9 @@ struct net_conn {
 	/** Possible user to pass to the callback */
 	void *user_data;
 
+	/** Network context owning the connection, if any */
+	struct net_context *context;
+
 	/** Connection protocol */
 	u16_t proto;
 
@@ -91,6 +100,9 @@ struct net_conn {
  * @param local_addr Local address of the connection end point.
  * @param remote_port Remote port of the connection end point.
  * @param local_port Local port of the connection end point.
+ * @param context Network context owning the connection, or NULL. A
+ * context with the NET_OPT_REUSEPORT option set can share its end point
+ * with other such contexts.
  * @param cb Callback to be called
  * @param user_data User data supplied by caller.
  * @param handle Connection handle that can be used when unregistering
@@ -102,6 +114,7 @@ int net_conn_register(u16_t proto, u8_t family,
 		      const struct sockaddr *local_addr,
 		      u16_t remote_port,
 		      u16_t local_port,
+		      struct net_context *context,
 		      net_conn_cb_t cb,
 		      void *user_data,
 		      struct net_conn_handle **handle);
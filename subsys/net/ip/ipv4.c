@@ -77,6 +77,7 @@ int net_ipv4_finalize(struct net_pkt *pkt, u8_t next_header_proto)
 
 	ipv4_hdr->len   = htons(net_pkt_get_len(pkt));
 	ipv4_hdr->proto = next_header_proto;
+	ipv4_hdr->chksum = 0U;
 
 	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
 		ipv4_hdr->chksum = net_calc_chksum_ipv4(pkt);
@@ -190,6 +191,19 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 
 	net_pkt_set_family(pkt, PF_INET);
 
+	if (sys_get_be16(hdr->offset) &
+	    (NET_IPV4_MF | NET_IPV4_FRAGH_OFFSET_MASK)) {
+		/* The fragments are stored until the whole packet has been
+		 * received, which is then fed back to the IP stack.
+		 */
+		verdict = net_ipv4_handle_fragment_hdr(pkt, hdr);
+		if (verdict == NET_DROP) {
+			goto drop;
+		}
+
+		return verdict;
+	}
+
 	NET_DBG("IPv4 packet received from %s to %s",
 		log_strdup(net_sprint_ipv4_addr(&hdr->src)),
 		log_strdup(net_sprint_ipv4_addr(&hdr->dst)));
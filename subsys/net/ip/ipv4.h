@@ -20,8 +20,15 @@
 #include <net/net_if.h>
 #include <net/net_context.h>
 
+#include "reassembly.h"
+
 #define NET_IPV4_IHL_MASK 0x0F
 
+/* IPv4 flags and fragment offset in the offset field of the header */
+#define NET_IPV4_DF 0x4000
+#define NET_IPV4_MF 0x2000
+#define NET_IPV4_FRAGH_OFFSET_MASK 0x1fff
+
 /**
  * @brief Create IPv4 packet in provided net_pkt.
  *
@@ -48,4 +55,84 @@ int net_ipv4_create(struct net_pkt *pkt,
  */
 int net_ipv4_finalize(struct net_pkt *pkt, u8_t next_header_proto);
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+#define NET_IPV4_FRAGMENTS_MAX_PKT CONFIG_NET_IPV4_FRAGMENT_MAX_PKT
+#else
+#define NET_IPV4_FRAGMENTS_MAX_PKT 1
+#endif
+
+/** Store pending IPv4 fragment information that is needed for reassembly. */
+struct net_ipv4_reassembly {
+	/** Fragments and timer, common with IPv6 */
+	struct net_reassembly common;
+
+	/** IPv4 source address of the fragment */
+	struct in_addr src;
+
+	/** IPv4 destination address of the fragment */
+	struct in_addr dst;
+
+	/** IPv4 fragment identification */
+	u16_t id;
+
+	/** Protocol of the fragmented packet */
+	u8_t protocol;
+};
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+/**
+ * @brief Handles IPv4 fragmented packets.
+ *
+ * @param pkt Network packet containing one fragment
+ * @param hdr The IPv4 header of the current packet
+ *
+ * @return Return verdict about the packet
+ */
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr);
+
+/**
+ * @brief Fragment the packet if it does not fit into the MTU of the
+ * network interface. Called by net_if.c before the packet is passed
+ * to L2.
+ *
+ * @param pkt Network packet
+ *
+ * @return NET_OK if the packet can be sent as is, NET_CONTINUE if the
+ * packet was fragmented and the fragments were sent instead of it,
+ * and NET_DROP if the packet cannot be sent.
+ */
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt);
+
+/**
+ * @brief Send the packet in fragments that fit into the given MTU.
+ *
+ * @param iface Network interface
+ * @param pkt Network packet
+ * @param pkt_len Length of the packet
+ * @param mtu MTU of the network interface
+ *
+ * @return 0 on success, negative errno otherwise.
+ */
+int net_ipv4_send_fragmented_pkt(struct net_if *iface, struct net_pkt *pkt,
+				 u16_t pkt_len, u16_t mtu);
+#else
+static inline
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(hdr);
+
+	return NET_DROP;
+}
+
+static inline enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return NET_OK;
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #endif /* __IPV4_H */
@@ -0,0 +1,447 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_context.h>
+#include "net_private.h"
+#include "ipv4.h"
+
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+
+#define BUF_ALLOC_TIMEOUT K_MSEC(100)
+
+static struct net_ipv4_reassembly
+reassembly[CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT];
+
+static sys_slist_t reassembly_hash[CONFIG_NET_IPV4_FRAGMENT_HASH_SIZE];
+
+static struct net_reassembly_table reassembly_table =
+	NET_REASSEMBLY_TABLE_INITIALIZER(reassembly_table, reassembly_hash,
+					 CONFIG_NET_IPV4_FRAGMENT_MAX_MEM,
+					 IPV4_REASSEMBLY_TIMEOUT);
+
+static inline u16_t fragment_len(struct net_pkt *pkt)
+{
+	return net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt);
+}
+
+static u16_t reassembly_hash_bucket(u16_t id, u8_t protocol,
+				    struct in_addr *src, struct in_addr *dst)
+{
+	return net_reassembly_bucket(&reassembly_table,
+				     (id | (u32_t)protocol << 16) ^
+				     UNALIGNED_GET(&src->s_addr) ^
+				     UNALIGNED_GET(&dst->s_addr));
+}
+
+static void reassembly_init(void)
+{
+	int i;
+
+	net_reassembly_table_init(&reassembly_table);
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		net_reassembly_slot_init(&reassembly_table,
+					 &reassembly[i].common);
+	}
+}
+
+static struct net_ipv4_reassembly *reassembly_get(u16_t id, u8_t protocol,
+						  struct in_addr *src,
+						  struct in_addr *dst)
+{
+	u16_t bucket = reassembly_hash_bucket(id, protocol, src, dst);
+	struct net_ipv4_reassembly *reass;
+	struct net_reassembly *common;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&reassembly_hash[bucket], common, node) {
+		reass = CONTAINER_OF(common, struct net_ipv4_reassembly,
+				     common);
+
+		if (reass->id == id && reass->protocol == protocol &&
+		    net_ipv4_addr_cmp(src, &reass->src) &&
+		    net_ipv4_addr_cmp(dst, &reass->dst)) {
+			return reass;
+		}
+	}
+
+	common = net_reassembly_alloc(&reassembly_table, bucket);
+	if (!common) {
+		return NULL;
+	}
+
+	reass = CONTAINER_OF(common, struct net_ipv4_reassembly, common);
+
+	net_ipaddr_copy(&reass->src, src);
+	net_ipaddr_copy(&reass->dst, dst);
+
+	reass->id = id;
+	reass->protocol = protocol;
+
+	return reass;
+}
+
+static void reassembly_info(char *str, struct net_ipv4_reassembly *reass)
+{
+	NET_DBG("%s id 0x%x src %s dst %s remain %d ms len %u", str, reass->id,
+		log_strdup(net_sprint_ipv4_addr(&reass->src)),
+		log_strdup(net_sprint_ipv4_addr(&reass->dst)),
+		k_delayed_work_remaining_get(&reass->common.timer),
+		reass->common.len);
+}
+
+static void reassemble_packet(struct net_ipv4_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *ipv4_hdr;
+	struct net_pkt *pkt;
+
+	pkt = net_reassembly_take(&reass->common);
+
+	/* Fix the IPv4 header of the first fragment to describe the whole
+	 * packet.
+	 */
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!ipv4_hdr) {
+		goto error;
+	}
+
+	ipv4_hdr->len = htons(net_pkt_get_len(pkt));
+	ipv4_hdr->offset[0] = 0U;
+	ipv4_hdr->offset[1] = 0U;
+	ipv4_hdr->chksum = 0U;
+	ipv4_hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	NET_DBG("New pkt %p IPv4 len is %zd bytes", pkt, net_pkt_get_len(pkt));
+
+	net_pkt_set_ipv4_fragment_offset(pkt, 0U);
+	net_pkt_set_ipv4_fragment_more(pkt, false);
+	net_pkt_set_ipv4_reassembled(pkt, true);
+
+	/* We need to use the queue when feeding the packet back into the
+	 * IP stack as we might run out of stack if we call processing_data()
+	 * directly. As the packet does not contain link layer header, we
+	 * MUST NOT pass it to L2 so there will be a special check for that
+	 * in process_data() when handling the packet.
+	 */
+	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
+		return;
+	}
+error:
+	net_pkt_unref(pkt);
+}
+
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	struct net_ipv4_reassembly *reass;
+	u16_t offset;
+	u16_t flag;
+	u32_t end;
+	u16_t len;
+	bool more;
+	int ret;
+
+	flag = sys_get_be16(hdr->offset);
+	len = fragment_len(pkt);
+	offset = (flag & NET_IPV4_FRAGH_OFFSET_MASK) * 8U;
+	more = flag & NET_IPV4_MF;
+	end = offset + len;
+
+	net_pkt_set_ipv4_fragment_offset(pkt, offset);
+	net_pkt_set_ipv4_fragment_more(pkt, more);
+
+	/* Every fragment except the last one must carry a multiple of
+	 * 8 bytes, and the packet must not grow beyond the maximum
+	 * IPv4 packet size.
+	 */
+	if (!len || (more && len % 8) ||
+	    end + net_pkt_ip_hdr_len(pkt) > UINT16_MAX) {
+		NET_DBG("Invalid fragment offset %u len %u, dropping pkt %p",
+			offset, len, pkt);
+		return NET_DROP;
+	}
+
+	k_mutex_lock(&reassembly_table.lock, K_FOREVER);
+
+	if (!reassembly_table.init_done) {
+		/* Static initializing does not work here because of the array
+		 * so we must do it at runtime.
+		 */
+		reassembly_init();
+	}
+
+	reass = reassembly_get(sys_get_be16(hdr->id), hdr->proto,
+			       &hdr->src, &hdr->dst);
+	if (!reass) {
+		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
+		goto unlock;
+	}
+
+	if (reass->common.total_len &&
+	    (end > reass->common.total_len ||
+	     (!more && end != reass->common.total_len))) {
+		NET_DBG("Invalid end of fragment in 0x%x", reass->id);
+		goto cancel;
+	}
+
+	NET_DBG("Storing pkt %p offset 0x%x len %u", pkt, offset, len);
+
+	ret = net_reassembly_add(&reass->common, pkt, net_pkt_ip_hdr_len(pkt),
+				 offset, len, more);
+	if (ret == -EALREADY) {
+		NET_DBG("Duplicate fragment offset 0x%x, dropping pkt %p",
+			offset, pkt);
+		goto unlock;
+	}
+
+	if (ret < 0) {
+		/* Overlapping fragments, we must discard the whole packet
+		 * at this point.
+		 */
+		NET_DBG("Cannot store fragment of 0x%x, dropping it",
+			reass->id);
+		goto cancel;
+	}
+
+	if (!more) {
+		reass->common.total_len = end;
+	}
+
+	/* The packet is now owned by the reassembly */
+	if (!net_reassembly_limit_mem(&reass->common)) {
+		goto out;
+	}
+
+	if (!net_reassembly_is_complete(&reass->common)) {
+		reassembly_info("Reassembly nth pkt", reass);
+
+		NET_DBG("More fragments to be received");
+		goto out;
+	}
+
+	reassembly_info("Reassembly last pkt", reass);
+
+	/* All the fragments received, reassemble the packet */
+	reassemble_packet(reass);
+
+out:
+	k_mutex_unlock(&reassembly_table.lock);
+
+	return NET_OK;
+
+cancel:
+	net_reassembly_cancel(&reass->common);
+
+unlock:
+	k_mutex_unlock(&reassembly_table.lock);
+
+	return NET_DROP;
+}
+
+static int send_ipv4_fragment(struct net_pkt *pkt, u16_t id,
+			      u16_t fit_len, u16_t frag_offset, bool final)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *ipv4_hdr;
+	struct net_pkt *frag_pkt;
+	u16_t offset;
+	int ret = -ENOBUFS;
+
+	frag_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt), fit_len +
+					     net_pkt_ip_hdr_len(pkt),
+					     AF_INET, 0, BUF_ALLOC_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	/* We copy the original header, including the options, and then
+	 * the payload part of this fragment.
+	 */
+	if (net_pkt_copy(frag_pkt, pkt, net_pkt_ip_hdr_len(pkt)) ||
+	    net_pkt_skip(pkt, frag_offset) ||
+	    net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(frag_pkt);
+	net_pkt_set_overwrite(frag_pkt, true);
+
+	ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(frag_pkt,
+							   &ipv4_access);
+	if (!ipv4_hdr) {
+		goto fail;
+	}
+
+	offset = frag_offset / 8U;
+	if (!final) {
+		offset |= NET_IPV4_MF;
+	}
+
+	ipv4_hdr->len = htons(net_pkt_get_len(frag_pkt));
+	sys_put_be16(id, ipv4_hdr->id);
+	sys_put_be16(offset, ipv4_hdr->offset);
+	ipv4_hdr->chksum = 0U;
+
+	net_pkt_set_ip_hdr_len(frag_pkt, net_pkt_ip_hdr_len(pkt));
+	net_pkt_set_ipv4_ttl(frag_pkt, net_pkt_ipv4_ttl(pkt));
+	net_pkt_set_priority(frag_pkt, net_pkt_priority(pkt));
+
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(frag_pkt))) {
+		ipv4_hdr->chksum = net_calc_chksum_ipv4(frag_pkt);
+	}
+
+	if (net_pkt_set_data(frag_pkt, &ipv4_access)) {
+		goto fail;
+	}
+
+	/* If everything has been ok so far, we can send the packet. */
+	ret = net_send_data(frag_pkt);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment (%d)", ret);
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+int net_ipv4_send_fragmented_pkt(struct net_if *iface, struct net_pkt *pkt,
+				 u16_t pkt_len, u16_t mtu)
+{
+	u16_t frag_offset;
+	size_t length;
+	int fit_len;
+	u16_t id;
+	int ret;
+
+	/* The maximum payload that fits into each packet after the IPv4
+	 * header. All but the last fragment must carry a multiple of
+	 * 8 bytes.
+	 */
+	fit_len = (mtu - net_pkt_ip_hdr_len(pkt)) & ~7;
+	if (fit_len <= 0) {
+		NET_DBG("No room for IPv4 payload MTU %d hdr_len %d",
+			mtu, net_pkt_ip_hdr_len(pkt));
+		return -EINVAL;
+	}
+
+	id = sys_rand32_get();
+
+	frag_offset = 0U;
+
+	length = pkt_len - net_pkt_ip_hdr_len(pkt);
+	while (length) {
+		bool final = false;
+
+		if (fit_len >= length) {
+			final = true;
+			fit_len = length;
+		}
+
+		ret = send_ipv4_fragment(pkt, id, fit_len, frag_offset, final);
+		if (ret < 0) {
+			return ret;
+		}
+
+		length -= fit_len;
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *ipv4_hdr;
+	size_t pkt_len;
+	u16_t mtu;
+	int ret;
+
+	/* GSO packets are segmented by the device */
+	if (net_pkt_gso_size(pkt)) {
+		return NET_OK;
+	}
+
+	mtu = MAX(NET_IPV4_MTU, net_if_get_mtu(net_pkt_iface(pkt)));
+	pkt_len = net_pkt_get_len(pkt);
+	if (pkt_len <= mtu) {
+		return NET_OK;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!ipv4_hdr) {
+		return NET_DROP;
+	}
+
+	if (sys_get_be16(ipv4_hdr->offset) & NET_IPV4_DF) {
+		NET_DBG("Cannot fragment IPv4 pkt %p len %zd with DF set",
+			pkt, pkt_len);
+		return NET_DROP;
+	}
+
+	ret = net_ipv4_send_fragmented_pkt(net_pkt_iface(pkt), pkt, pkt_len,
+					   mtu);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+
+		if (ret == -ENOMEM) {
+			/* Try to send the packet if we could not allocate
+			 * enough network packets and hope the original large
+			 * packet can be sent ok.
+			 */
+			return NET_OK;
+		}
+
+		return NET_DROP;
+	}
+
+	/* We "fake" the sending of the packet here so that
+	 * tcp.c:tcp_retry_expired() will increase the ref count when
+	 * re-sending the packet.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP)) {
+		net_pkt_set_sent(pkt, true);
+	}
+
+	/* We need to unref here because we simulate the packet sending.
+	 * The packet is now split and its fragments are sent separately
+	 * to network.
+	 */
+	net_pkt_unref(pkt);
+
+	return NET_CONTINUE;
+}
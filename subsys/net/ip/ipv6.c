@@ -354,6 +354,7 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
 	enum net_verdict verdict = NET_DROP;
 	int real_len = net_pkt_get_len(pkt);
+	u16_t prev_hdr_off = offsetof(struct net_ipv6_hdr, nexthdr);
 	u8_t ext_bitmap = 0U;
 	u16_t ext_len = 0U;
 	u8_t nexthdr, next_nexthdr;
@@ -439,6 +440,7 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 	nexthdr = hdr->nexthdr;
 	while (!net_ipv6_is_nexthdr_upper_layer(nexthdr)) {
+		u16_t hdr_off = net_pkt_get_current_offset(pkt);
 		int exthdr_len;
 
 		NET_DBG("IPv6 next header %d", nexthdr);
@@ -479,8 +481,12 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 		case NET_IPV6_NEXTHDR_FRAG:
 			if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT)) {
-				net_pkt_set_ipv6_fragment_start(
-					pkt, net_pkt_get_current_offset(pkt));
+				/* The reassembly removes the fragment header
+				 * and updates the next header field of the
+				 * header before it.
+				 */
+				net_pkt_set_ipv6_hdr_prev(pkt, prev_hdr_off);
+				net_pkt_set_ipv6_fragment_start(pkt, hdr_off);
 				return net_ipv6_handle_fragment_hdr(pkt, hdr,
 								    nexthdr);
 			}
@@ -506,6 +512,7 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 		ext_len += exthdr_len;
 		nexthdr = next_nexthdr;
+		prev_hdr_off = hdr_off;
 	}
 
 	net_pkt_set_ipv6_ext_len(pkt, ext_len);
@@ -39,12 +39,16 @@ LOG_MODULE_DECLARE(net_ipv6, CONFIG_NET_IPV6_LOG_LEVEL);
 
 #define FRAG_BUF_WAIT K_MSEC(10) /* how long to max wait for a buffer */
 
-static void reassembly_timeout(struct k_work *work);
-static bool reassembly_init_done;
-
 static struct net_ipv6_reassembly
 reassembly[CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT];
 
+static sys_slist_t reassembly_hash[CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE];
+
+static struct net_reassembly_table reassembly_table =
+	NET_REASSEMBLY_TABLE_INITIALIZER(reassembly_table, reassembly_hash,
+					 CONFIG_NET_IPV6_FRAGMENT_MAX_MEM,
+					 IPV6_REASSEMBLY_TIMEOUT);
+
 int net_ipv6_find_last_ext_hdr(struct net_pkt *pkt, u16_t *next_hdr_off,
 			       u16_t *last_hdr_off)
 {
@@ -119,115 +123,73 @@ fail:
 	return -EINVAL;
 }
 
-static struct net_ipv6_reassembly *reassembly_get(u32_t id,
-						  struct in6_addr *src,
-						  struct in6_addr *dst)
+static u16_t reassembly_hash_bucket(u32_t id, struct in6_addr *src,
+				    struct in6_addr *dst)
 {
-	int i, avail = -1;
-
-	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-
-		if (k_delayed_work_remaining_get(&reassembly[i].timer) &&
-		    reassembly[i].id == id &&
-		    net_ipv6_addr_cmp(src, &reassembly[i].src) &&
-		    net_ipv6_addr_cmp(dst, &reassembly[i].dst)) {
-			return &reassembly[i];
-		}
-
-		if (k_delayed_work_remaining_get(&reassembly[i].timer)) {
-			continue;
-		}
-
-		if (avail < 0) {
-			avail = i;
-		}
-	}
+	u32_t hash = id;
+	int i;
 
-	if (avail < 0) {
-		return NULL;
+	for (i = 0; i < 4; i++) {
+		hash ^= UNALIGNED_GET(&src->s6_addr32[i]) ^
+			UNALIGNED_GET(&dst->s6_addr32[i]);
 	}
 
-	k_delayed_work_submit(&reassembly[avail].timer,
-			      IPV6_REASSEMBLY_TIMEOUT);
-
-	net_ipaddr_copy(&reassembly[avail].src, src);
-	net_ipaddr_copy(&reassembly[avail].dst, dst);
-
-	reassembly[avail].id = id;
-
-	return &reassembly[avail];
+	return net_reassembly_bucket(&reassembly_table, hash);
 }
 
-static bool reassembly_cancel(u32_t id,
-			      struct in6_addr *src,
-			      struct in6_addr *dst)
+static void reassembly_init(void)
 {
-	int i, j;
+	int i;
 
-	NET_DBG("Cancel 0x%x", id);
+	net_reassembly_table_init(&reassembly_table);
 
 	for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		s32_t remaining;
-
-		if (reassembly[i].id != id ||
-		    !net_ipv6_addr_cmp(src, &reassembly[i].src) ||
-		    !net_ipv6_addr_cmp(dst, &reassembly[i].dst)) {
-			continue;
-		}
+		net_reassembly_slot_init(&reassembly_table,
+					 &reassembly[i].common);
+	}
+}
 
-		remaining = k_delayed_work_remaining_get(&reassembly[i].timer);
-		if (remaining) {
-			k_delayed_work_cancel(&reassembly[i].timer);
+static struct net_ipv6_reassembly *reassembly_get(u32_t id,
+						  struct in6_addr *src,
+						  struct in6_addr *dst)
+{
+	u16_t bucket = reassembly_hash_bucket(id, src, dst);
+	struct net_ipv6_reassembly *reass;
+	struct net_reassembly *common;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&reassembly_hash[bucket], common, node) {
+		reass = CONTAINER_OF(common, struct net_ipv6_reassembly,
+				     common);
+
+		if (reass->id == id &&
+		    net_ipv6_addr_cmp(src, &reass->src) &&
+		    net_ipv6_addr_cmp(dst, &reass->dst)) {
+			return reass;
 		}
+	}
 
-		NET_DBG("IPv6 reassembly id 0x%x remaining %d ms",
-			reassembly[i].id, remaining);
-
-		reassembly[i].id = 0U;
-
-		for (j = 0; j < NET_IPV6_FRAGMENTS_MAX_PKT; j++) {
-			if (!reassembly[i].pkt[j]) {
-				continue;
-			}
+	common = net_reassembly_alloc(&reassembly_table, bucket);
+	if (!common) {
+		return NULL;
+	}
 
-			NET_DBG("[%d] IPv6 reassembly pkt %p %zd bytes data",
-				j, reassembly[i].pkt[j],
-				net_pkt_get_len(reassembly[i].pkt[j]));
+	reass = CONTAINER_OF(common, struct net_ipv6_reassembly, common);
 
-			net_pkt_unref(reassembly[i].pkt[j]);
-			reassembly[i].pkt[j] = NULL;
-		}
+	net_ipaddr_copy(&reass->src, src);
+	net_ipaddr_copy(&reass->dst, dst);
 
-		return true;
-	}
+	reass->id = id;
 
-	return false;
+	return reass;
 }
 
 static void reassembly_info(char *str, struct net_ipv6_reassembly *reass)
 {
-	int i, len;
-
-	for (i = 0, len = 0; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (reass->pkt[i]) {
-			len += net_pkt_get_len(reass->pkt[i]);
-		}
-	}
-
-	NET_DBG("%s id 0x%x src %s dst %s remain %d ms len %d", str, reass->id,
+	NET_DBG("%s id 0x%x src %s dst %s remain %d ms len %u", str, reass->id,
 		log_strdup(net_sprint_ipv6_addr(&reass->src)),
 		log_strdup(net_sprint_ipv6_addr(&reass->dst)),
-		k_delayed_work_remaining_get(&reass->timer), len);
-}
-
-static void reassembly_timeout(struct k_work *work)
-{
-	struct net_ipv6_reassembly *reass =
-		CONTAINER_OF(work, struct net_ipv6_reassembly, timer);
-
-	reassembly_info("Reassembly cancelled", reass);
-
-	reassembly_cancel(reass->id, &reass->src, &reass->dst);
+		k_delayed_work_remaining_get(&reass->common.timer),
+		reass->common.len);
 }
 
 static void reassemble_packet(struct net_ipv6_reassembly *reass)
@@ -240,51 +202,10 @@ static void reassemble_packet(struct net_ipv6_reassembly *reass)
 	} ipv6;
 
 	struct net_pkt *pkt;
-	struct net_buf *last;
 	u8_t next_hdr;
-	int i, len;
-
-	k_delayed_work_cancel(&reass->timer);
-
-	NET_ASSERT(reass->pkt[0]);
-
-	last = net_buf_frag_last(reass->pkt[0]->buffer);
+	int len;
 
-	/* We start from 2nd packet which is then appended to
-	 * the first one.
-	 */
-	for (i = 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		int removed_len;
-
-		pkt = reass->pkt[i];
-
-		/* Get rid of IPv6 and fragment header which are at
-		 * the beginning of the fragment.
-		 */
-		removed_len = net_pkt_ipv6_fragment_start(pkt) +
-			      sizeof(struct net_ipv6_frag_hdr);
-
-		NET_DBG("Removing %d bytes from start of pkt %p",
-			removed_len, pkt->buffer);
-
-		if (net_pkt_pull(pkt, removed_len)) {
-			NET_ERR("Failed to pull headers");
-			reassembly_cancel(reass->id, &reass->src, &reass->dst);
-			return;
-		}
-
-		/* Attach the data to previous pkt */
-		last->frags = pkt->buffer;
-		last = net_buf_frag_last(pkt->buffer);
-
-		pkt->buffer = NULL;
-		reass->pkt[i] = NULL;
-
-		net_pkt_unref(pkt);
-	}
-
-	pkt = reass->pkt[0];
-	reass->pkt[0] = NULL;
+	pkt = net_reassembly_take(&reass->common);
 
 	/* Next we need to strip away the fragment header from the first packet
 	 * and set the various pointers and values in packet.
@@ -357,78 +278,21 @@ error:
 
 void net_ipv6_frag_foreach(net_ipv6_frag_cb_t cb, void *user_data)
 {
+	struct net_reassembly *common;
 	int i;
 
-	for (i = 0; reassembly_init_done &&
-		     i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-		if (!k_delayed_work_remaining_get(&reassembly[i].timer)) {
-			continue;
-		}
-
-		cb(&reassembly[i], user_data);
-	}
-}
-
-/* Verify that we have all the fragments received and in correct order.
- */
-static bool fragment_verify(struct net_ipv6_reassembly *reass)
-{
-	u16_t offset;
-	int i, prev_len;
-
-	prev_len = net_pkt_get_len(reass->pkt[0]);
-	offset = net_pkt_ipv6_fragment_offset(reass->pkt[0]);
-
-	NET_DBG("pkt %p offset %u", reass->pkt[0], offset);
-
-	if (offset != 0U) {
-		return false;
-	}
-
-	for (i = 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		offset = net_pkt_ipv6_fragment_offset(reass->pkt[i]);
-
-		NET_DBG("pkt %p offset %u prev_len %d", reass->pkt[i],
-			offset, prev_len);
-
-		if (prev_len < offset) {
-			/* Something wrong with the offset value */
-			return false;
-		}
-
-		prev_len = net_pkt_get_len(reass->pkt[i]);
-	}
-
-	return true;
-}
-
-static int shift_packets(struct net_ipv6_reassembly *reass, int pos)
-{
-	int i;
-
-	for (i = pos + 1; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (!reass->pkt[i]) {
-			NET_DBG("Moving [%d] %p (offset 0x%x) to [%d]",
-				pos, reass->pkt[pos],
-				net_pkt_ipv6_fragment_offset(reass->pkt[pos]),
-				i);
-
-			/* Do we have enough space in packet array to make
-			 * the move?
-			 */
-			if (((i - pos) + 1) >
-			    (NET_IPV6_FRAGMENTS_MAX_PKT - i)) {
-				return -ENOMEM;
-			}
-
-			memmove(&reass->pkt[i], &reass->pkt[pos],
-				sizeof(void *) * (i - pos));
+	k_mutex_lock(&reassembly_table.lock, K_FOREVER);
 
-			return 0;
+	for (i = 0; reassembly_table.init_done &&
+		     i < CONFIG_NET_IPV6_FRAGMENT_HASH_SIZE; i++) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&reassembly_hash[i], common,
+					     node) {
+			cb(CONTAINER_OF(common, struct net_ipv6_reassembly,
+					common), user_data);
 		}
 	}
 
-	return -EINVAL;
+	k_mutex_unlock(&reassembly_table.lock);
 }
 
 enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
@@ -436,23 +300,13 @@ enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
 					      u8_t nexthdr)
 {
 	struct net_ipv6_reassembly *reass = NULL;
+	u16_t hdr_len;
+	u16_t offset;
 	u16_t flag;
-	bool found;
+	u32_t end;
+	u16_t len;
 	u8_t more;
 	u32_t id;
-	int i;
-
-	if (!reassembly_init_done) {
-		/* Static initializing does not work here because of the array
-		 * so we must do it at runtime.
-		 */
-		for (i = 0; i < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; i++) {
-			k_delayed_work_init(&reassembly[i].timer,
-					    reassembly_timeout);
-		}
-
-		reassembly_init_done = true;
-	}
 
 	/* Each fragment has a fragment header, however since we already
 	 * read the nexthdr part of it, we are not going to use
@@ -465,105 +319,109 @@ enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
 		goto drop;
 	}
 
-	reass = reassembly_get(id, &hdr->src, &hdr->dst);
-	if (!reass) {
-		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
+	more = flag & 0x01;
+	offset = flag & 0xfff8;
+	net_pkt_set_ipv6_fragment_offset(pkt, offset);
+
+	hdr_len = net_pkt_ipv6_fragment_start(pkt) +
+		  sizeof(struct net_ipv6_frag_hdr);
+	len = net_pkt_get_len(pkt) - hdr_len;
+	end = offset + len;
+
+	if (more && len % 8) {
+		/* Fragment length is not multiple of 8, discard
+		 * the packet and send parameter problem error.
+		 */
+		net_icmpv6_send_error(pkt, NET_ICMPV6_PARAM_PROBLEM,
+				      NET_ICMPV6_PARAM_PROB_OPTION, 0);
 		goto drop;
 	}
 
-	more = flag & 0x01;
-	net_pkt_set_ipv6_fragment_offset(pkt, flag & 0xfff8);
+	if (end > UINT16_MAX) {
+		/* The reassembled packet would be too long (RFC 8200
+		 * ch 4.5), point to the fragment offset field.
+		 */
+		net_icmpv6_send_error(pkt, NET_ICMPV6_PARAM_PROBLEM,
+				      NET_ICMPV6_PARAM_PROB_HEADER,
+				      net_pkt_ipv6_fragment_start(pkt) + 2);
+		goto drop;
+	}
 
-	if (!reass->pkt[0]) {
-		NET_DBG("Storing pkt %p to slot %d offset 0x%x",
-			pkt, 0, net_pkt_ipv6_fragment_offset(pkt));
-		reass->pkt[0] = pkt;
+	if (!len) {
+		NET_DBG("Empty fragment, dropping pkt %p", pkt);
+		goto drop;
+	}
 
-		reassembly_info("Reassembly 1st pkt", reass);
+	k_mutex_lock(&reassembly_table.lock, K_FOREVER);
 
-		/* Wait for more fragments to receive. */
-		goto accept;
+	if (!reassembly_table.init_done) {
+		/* Static initializing does not work here because of the array
+		 * so we must do it at runtime.
+		 */
+		reassembly_init();
 	}
 
-	/* The fragments might come in wrong order so place them
-	 * in reassembly chain in correct order.
-	 */
-	for (i = 0, found = false; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (reass->pkt[i]) {
-			if (net_pkt_ipv6_fragment_offset(reass->pkt[i]) <
-			    net_pkt_ipv6_fragment_offset(pkt)) {
-				continue;
-			}
+	reass = reassembly_get(id, &hdr->src, &hdr->dst);
+	if (!reass) {
+		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
+		goto unlock;
+	}
 
-			/* Make room for this fragment. If there is no room,
-			 * then it will discard the whole reassembly.
-			 */
-			if (shift_packets(reass, i)) {
-				break;
-			}
-		}
+	if (reass->common.total_len && end > reass->common.total_len) {
+		NET_DBG("Fragment beyond the end of 0x%x", reass->id);
+		goto cancel;
+	}
 
-		NET_DBG("Storing pkt %p to slot %d offset 0x%x",
-			pkt, i, net_pkt_ipv6_fragment_offset(pkt));
-		reass->pkt[i] = pkt;
-		found = true;
+	if (!more) {
+		if (reass->common.total_len &&
+		    end != reass->common.total_len) {
+			NET_DBG("Invalid last fragment of 0x%x", reass->id);
+			goto cancel;
+		}
 
-		break;
+		reass->common.total_len = end;
 	}
 
-	if (!found) {
-		/* We could not add this fragment into our saved fragment
-		 * list. We must discard the whole packet at this point.
-		 */
-		NET_DBG("No slots available for 0x%x", reass->id);
-		net_pkt_unref(pkt);
-		goto drop;
+	NET_DBG("Storing pkt %p offset 0x%x len %u", pkt, offset, len);
+
+	/* Overlapping fragments, exact duplicates included, fail the whole
+	 * reassembly as RFC 8200 ch 4.5 requires.
+	 */
+	if (net_reassembly_add(&reass->common, pkt, hdr_len, offset, len,
+			       more)) {
+		NET_DBG("Overlapping fragment in 0x%x", reass->id);
+		goto cancel;
 	}
 
-	if (more) {
-		if (net_pkt_get_len(pkt) % 8) {
-			/* Fragment length is not multiple of 8, discard
-			 * the packet and send parameter problem error.
-			 */
-			net_icmpv6_send_error(pkt, NET_ICMPV6_PARAM_PROBLEM,
-					      NET_ICMPV6_PARAM_PROB_OPTION, 0);
-			goto drop;
-		}
+	/* The packet is now owned by the reassembly */
+	if (!net_reassembly_limit_mem(&reass->common)) {
+		goto out;
+	}
 
+	if (!net_reassembly_is_complete(&reass->common)) {
 		reassembly_info("Reassembly nth pkt", reass);
 
 		NET_DBG("More fragments to be received");
-		goto accept;
+		goto out;
 	}
 
 	reassembly_info("Reassembly last pkt", reass);
 
-	if (!fragment_verify(reass)) {
-		NET_DBG("Reassembled IPv6 verify failed, dropping id %u",
-			reass->id);
+	/* All the fragments received, reassemble the packet */
+	reassemble_packet(reass);
 
-		/* Let the caller release the already inserted pkt */
-		if (i < NET_IPV6_FRAGMENTS_MAX_PKT) {
-			reass->pkt[i] = NULL;
-		}
+out:
+	k_mutex_unlock(&reassembly_table.lock);
 
-		net_pkt_unref(pkt);
-		goto drop;
-	}
+	return NET_OK;
 
-	/* The last fragment received, reassemble the packet */
-	reassemble_packet(reass);
+cancel:
+	net_reassembly_cancel(&reass->common);
 
-accept:
-	return NET_OK;
+unlock:
+	k_mutex_unlock(&reassembly_table.lock);
 
 drop:
-	if (reass) {
-		if (reassembly_cancel(reass->id, &reass->src, &reass->dst)) {
-			return NET_OK;
-		}
-	}
-
 	return NET_DROP;
 }
 
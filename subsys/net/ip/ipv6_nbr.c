@@ -23,6 +23,7 @@ LOG_MODULE_DECLARE(net_ipv6, CONFIG_NET_IPV6_LOG_LEVEL);
 #include <net/net_stats.h>
 #include <net/net_context.h>
 #include <net/net_mgmt.h>
+#include <net/hash.h>
 #include "net_private.h"
 #include "connection.h"
 #include "icmpv6.h"
@@ -86,6 +87,9 @@ extern void net_neighbor_table_clear(struct net_nbr_table *table);
 /** Neighbor Solicitation reply timer */
 static struct k_delayed_work ipv6_ns_reply_timer;
 
+/* The neighbors in use, hashed by IPv6 address */
+static sys_slist_t nbr_hash[CONFIG_NET_IPV6_NBR_HASH_SIZE];
+
 NET_NBR_POOL_INIT(net_neighbor_pool,
 		  CONFIG_NET_IPV6_MAX_NEIGHBORS,
 		  sizeof(struct net_ipv6_nbr_data),
@@ -255,14 +259,30 @@ void nbr_print(void)
 #define nbr_print(...)
 #endif
 
+static sys_slist_t *nbr_hash_bucket(const struct in6_addr *addr)
+{
+	u32_t hash;
+
+	hash = UNALIGNED_GET(&addr->s6_addr32[0]) ^
+		UNALIGNED_GET(&addr->s6_addr32[1]) ^
+		UNALIGNED_GET(&addr->s6_addr32[2]) ^
+		UNALIGNED_GET(&addr->s6_addr32[3]);
+
+	return &nbr_hash[net_hash_fib(hash) % CONFIG_NET_IPV6_NBR_HASH_SIZE];
+}
+
 static struct net_nbr *nbr_lookup(struct net_nbr_table *table,
 				  struct net_if *iface,
 				  struct in6_addr *addr)
 {
-	int i;
+	struct net_ipv6_nbr_data *data;
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	ARG_UNUSED(table);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(nbr_hash_bucket(addr), data, hash_node) {
+		/* The data is stored right after the generic part */
+		struct net_nbr *nbr = CONTAINER_OF((u8_t *)data,
+						   struct net_nbr, __nbr);
 
 		if (!nbr->ref) {
 			continue;
@@ -272,7 +292,7 @@ static struct net_nbr *nbr_lookup(struct net_nbr_table *table,
 			continue;
 		}
 
-		if (net_ipv6_addr_cmp(&net_ipv6_nbr_data(nbr)->addr, addr)) {
+		if (net_ipv6_addr_cmp(&data->addr, addr)) {
 			return nbr;
 		}
 	}
@@ -408,6 +428,9 @@ static void nbr_init(struct net_nbr *nbr, struct net_if *iface,
 	nbr->iface = iface;
 
 	net_ipaddr_copy(&net_ipv6_nbr_data(nbr)->addr, addr);
+	sys_slist_prepend(nbr_hash_bucket(addr),
+			  &net_ipv6_nbr_data(nbr)->hash_node);
+
 	ipv6_nbr_set_state(nbr, state);
 	net_ipv6_nbr_data(nbr)->is_router = is_router;
 	net_ipv6_nbr_data(nbr)->pending = NULL;
@@ -604,8 +627,8 @@ struct net_nbr *net_ipv6_nbr_add(struct net_if *iface,
 		if (memcmp(cached_lladdr->addr, lladdr->addr, lladdr->len)) {
 			dbg_update_neighbor_lladdr(lladdr, cached_lladdr, addr);
 
-			net_linkaddr_set(cached_lladdr, lladdr->addr,
-					 lladdr->len);
+			net_nbr_set_lladdr(nbr->idx, lladdr->addr,
+					   lladdr->len);
 
 			ipv6_nbr_set_state(nbr, NET_IPV6_NBR_STATE_STALE);
 		} else if (net_ipv6_nbr_data(nbr)->state ==
@@ -647,7 +670,9 @@ void net_neighbor_data_remove(struct net_nbr *nbr)
 {
 	NET_DBG("Neighbor %p removed", nbr);
 
-	return;
+	sys_slist_find_and_remove(
+		nbr_hash_bucket(&net_ipv6_nbr_data(nbr)->addr),
+		&net_ipv6_nbr_data(nbr)->hash_node);
 }
 
 void net_neighbor_table_clear(struct net_nbr_table *table)
@@ -658,29 +683,18 @@ void net_neighbor_table_clear(struct net_nbr_table *table)
 struct in6_addr *net_ipv6_nbr_lookup_by_index(struct net_if *iface,
 					      u8_t idx)
 {
-	int i;
+	struct net_nbr *nbr;
 
 	if (idx == NET_NBR_LLADDR_UNKNOWN) {
 		return NULL;
 	}
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
-
-		if (!nbr->ref) {
-			continue;
-		}
-
-		if (iface && nbr->iface != iface) {
-			continue;
-		}
-
-		if (nbr->idx == idx) {
-			return &net_ipv6_nbr_data(nbr)->addr;
-		}
+	nbr = net_nbr_lookup_by_index(&net_neighbor.table, iface, idx);
+	if (!nbr) {
+		return NULL;
 	}
 
-	return NULL;
+	return &net_ipv6_nbr_data(nbr)->addr;
 }
 #else
 const char *net_ipv6_nbr_state2str(enum net_ipv6_nbr_state state)
@@ -781,7 +795,8 @@ enum net_verdict net_ipv6_prepare_for_send(struct net_pkt *pkt)
 	/* If we have already fragmented the packet, the fragment id will
 	 * contain a proper value and we can skip other checks.
 	 */
-	if (net_pkt_ipv6_fragment_id(pkt) == 0U) {
+	if (net_pkt_ipv6_fragment_id(pkt) == 0U &&
+	    !net_pkt_gso_size(pkt)) {
 		u16_t mtu = net_if_get_mtu(net_pkt_iface(pkt));
 		size_t pkt_len = net_pkt_get_len(pkt);
 
@@ -947,27 +962,11 @@ struct net_nbr *net_ipv6_nbr_lookup(struct net_if *iface,
 
 struct net_nbr *net_ipv6_get_nbr(struct net_if *iface, u8_t idx)
 {
-	int i;
-
 	if (idx == NET_NBR_LLADDR_UNKNOWN) {
 		return NULL;
 	}
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
-
-		if (nbr->ref) {
-			if (iface && nbr->iface != iface) {
-				continue;
-			}
-
-			if (nbr->idx == idx) {
-				return nbr;
-			}
-		}
-	}
-
-	return NULL;
+	return net_nbr_lookup_by_index(&net_neighbor.table, iface, idx);
 }
 
 static inline u8_t get_llao_len(struct net_if *iface)
@@ -1586,8 +1585,8 @@ static inline bool handle_na_neighbor(struct net_pkt *pkt,
 						       cached_lladdr,
 						       &na_hdr->tgt);
 
-			net_linkaddr_set(cached_lladdr, lladdr.addr,
-					 cached_lladdr->len);
+			net_nbr_set_lladdr(nbr->idx, lladdr.addr,
+					   cached_lladdr->len);
 		}
 
 		if (na_hdr->flags & NET_ICMPV6_NA_FLAG_SOLICITED) {
@@ -1630,8 +1629,8 @@ static inline bool handle_na_neighbor(struct net_pkt *pkt,
 			dbg_update_neighbor_lladdr_raw(
 				lladdr.addr, cached_lladdr, &na_hdr->tgt);
 
-			net_linkaddr_set(cached_lladdr, lladdr.addr,
-					 cached_lladdr->len);
+			net_nbr_set_lladdr(nbr->idx, lladdr.addr,
+					   cached_lladdr->len);
 		}
 
 		if (na_hdr->flags & NET_ICMPV6_NA_FLAG_SOLICITED) {
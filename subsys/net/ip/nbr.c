@@ -12,6 +12,7 @@ LOG_MODULE_REGISTER(net_nbr, CONFIG_NET_IPV6_NBR_CACHE_LOG_LEVEL);
 #include <errno.h>
 
 #include <net/net_core.h>
+#include <net/hash.h>
 
 #include "net_private.h"
 
@@ -19,6 +20,36 @@ LOG_MODULE_REGISTER(net_nbr, CONFIG_NET_IPV6_NBR_CACHE_LOG_LEVEL);
 
 NET_NBR_LLADDR_INIT(net_neighbor_lladdr, CONFIG_NET_IPV6_MAX_NEIGHBORS);
 
+/* The link layer addresses in use, hashed by address */
+static sys_slist_t lladdr_hash[CONFIG_NET_IPV6_NBR_HASH_SIZE];
+
+static sys_slist_t *lladdr_hash_bucket(const u8_t *addr, u8_t len)
+{
+	u32_t hash = 0U;
+	int i;
+
+	for (i = 0; i < len; i++) {
+		hash = hash * 31U + addr[i];
+	}
+
+	return &lladdr_hash[net_hash_fib(hash) % CONFIG_NET_IPV6_NBR_HASH_SIZE];
+}
+
+static int lladdr_find(const u8_t *addr, u8_t len)
+{
+	struct net_nbr_lladdr *entry;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(lladdr_hash_bucket(addr, len),
+				     entry, node) {
+		if (entry->lladdr.len == len &&
+		    !memcmp(entry->lladdr.addr, addr, len)) {
+			return entry - net_neighbor_lladdr;
+		}
+	}
+
+	return -ENOENT;
+}
+
 #if defined(CONFIG_NET_IPV6_NBR_CACHE_LOG_LEVEL_DBG)
 void net_nbr_unref_debug(struct net_nbr *nbr, const char *caller, int line)
 #define net_nbr_unref(nbr) net_nbr_unref_debug(nbr, __func__, __LINE__)
@@ -66,6 +97,16 @@ static inline struct net_nbr *get_nbr(struct net_nbr *start, int idx)
 			  start->size + start->extra_data_size) * idx));
 }
 
+static inline bool nbr_in_table(struct net_nbr_table *table,
+				struct net_nbr *nbr)
+{
+	size_t size = sizeof(struct net_nbr) + table->nbr->size +
+		table->nbr->extra_data_size;
+
+	return (u8_t *)nbr >= (u8_t *)table->nbr &&
+		(u8_t *)nbr < (u8_t *)table->nbr + size * table->nbr_count;
+}
+
 struct net_nbr *net_nbr_get(struct net_nbr_table *table)
 {
 	int i;
@@ -86,54 +127,57 @@ struct net_nbr *net_nbr_get(struct net_nbr_table *table)
 int net_nbr_link(struct net_nbr *nbr, struct net_if *iface,
 		 struct net_linkaddr *lladdr)
 {
-	int i, avail = -1;
+	int i;
 
 	if (nbr->idx != NET_NBR_LLADDR_UNKNOWN) {
 		return -EALREADY;
 	}
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		if (avail < 0 && !net_neighbor_lladdr[i].ref) {
-			avail = i;
-		}
-
-		if (net_neighbor_lladdr[i].ref &&
-		    !memcmp(lladdr->addr,
-			    net_neighbor_lladdr[i].lladdr.addr,
-			    lladdr->len)) {
-			/* We found same lladdr in nbr cache so just
-			 * increase the ref count.
-			 */
-			net_neighbor_lladdr[i].ref++;
+	i = lladdr_find(lladdr->addr, lladdr->len);
+	if (i >= 0) {
+		/* We found same lladdr in nbr cache so just
+		 * increase the ref count.
+		 */
+		net_neighbor_lladdr[i].ref++;
 
-			nbr->idx = i;
-			nbr->iface = iface;
+		goto link;
+	}
 
-			return 0;
+	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
+		if (!net_neighbor_lladdr[i].ref) {
+			break;
 		}
 	}
 
-	if (avail < 0) {
+	if (i == CONFIG_NET_IPV6_MAX_NEIGHBORS) {
 		return -ENOENT;
 	}
 
 	/* There was no existing entry in the lladdr cache,
 	 * so allocate one for this lladdr.
 	 */
-	net_neighbor_lladdr[avail].ref++;
-	nbr->idx = avail;
+	net_neighbor_lladdr[i].ref++;
 
-	net_linkaddr_set(&net_neighbor_lladdr[avail].lladdr, lladdr->addr,
+	net_linkaddr_set(&net_neighbor_lladdr[i].lladdr, lladdr->addr,
 			 lladdr->len);
-	net_neighbor_lladdr[avail].lladdr.len = lladdr->len;
+	net_neighbor_lladdr[i].lladdr.len = lladdr->len;
 
+	sys_slist_prepend(lladdr_hash_bucket(lladdr->addr, lladdr->len),
+			  &net_neighbor_lladdr[i].node);
+
+link:
+	nbr->idx = i;
 	nbr->iface = iface;
 
+	sys_slist_append(&net_neighbor_lladdr[i].nbrs, &nbr->lladdr_node);
+
 	return 0;
 }
 
 int net_nbr_unlink(struct net_nbr *nbr, struct net_linkaddr *lladdr)
 {
+	struct net_nbr_lladdr *entry;
+
 	ARG_UNUSED(lladdr);
 
 	if (nbr->idx == NET_NBR_LLADDR_UNKNOWN) {
@@ -143,11 +187,20 @@ int net_nbr_unlink(struct net_nbr *nbr, struct net_linkaddr *lladdr)
 	NET_ASSERT(nbr->idx < CONFIG_NET_IPV6_MAX_NEIGHBORS);
 	NET_ASSERT(net_neighbor_lladdr[nbr->idx].ref > 0);
 
-	net_neighbor_lladdr[nbr->idx].ref--;
+	entry = &net_neighbor_lladdr[nbr->idx];
+
+	sys_slist_find_and_remove(&entry->nbrs, &nbr->lladdr_node);
+
+	entry->ref--;
 
-	if (!net_neighbor_lladdr[nbr->idx].ref) {
-		(void)memset(net_neighbor_lladdr[nbr->idx].lladdr.addr, 0,
-			     sizeof(net_neighbor_lladdr[nbr->idx].lladdr.addr));
+	if (!entry->ref) {
+		sys_slist_find_and_remove(
+			lladdr_hash_bucket(entry->lladdr.addr,
+					   entry->lladdr.len),
+			&entry->node);
+
+		(void)memset(entry->lladdr.addr, 0,
+			     sizeof(entry->lladdr.addr));
 	}
 
 	nbr->idx = NET_NBR_LLADDR_UNKNOWN;
@@ -156,19 +209,23 @@ int net_nbr_unlink(struct net_nbr *nbr, struct net_linkaddr *lladdr)
 	return 0;
 }
 
-struct net_nbr *net_nbr_lookup(struct net_nbr_table *table,
-			       struct net_if *iface,
-			       struct net_linkaddr *lladdr)
+struct net_nbr *net_nbr_lookup_by_index(struct net_nbr_table *table,
+					struct net_if *iface,
+					u8_t idx)
 {
-	int i;
+	struct net_nbr *nbr;
 
-	for (i = 0; i < table->nbr_count; i++) {
-		struct net_nbr *nbr = get_nbr(table->nbr, i);
+	if (idx >= CONFIG_NET_IPV6_MAX_NEIGHBORS) {
+		return NULL;
+	}
 
-		if (nbr->ref && nbr->iface == iface &&
-		    net_neighbor_lladdr[nbr->idx].ref &&
-		    !memcmp(net_neighbor_lladdr[nbr->idx].lladdr.addr,
-			    lladdr->addr, lladdr->len)) {
+	/* Only the neighbors linked to the lladdr need to be checked,
+	 * they can be in any table.
+	 */
+	SYS_SLIST_FOR_EACH_CONTAINER(&net_neighbor_lladdr[idx].nbrs,
+				     nbr, lladdr_node) {
+		if (nbr->ref && (!iface || nbr->iface == iface) &&
+		    nbr_in_table(table, nbr)) {
 			return nbr;
 		}
 	}
@@ -176,6 +233,20 @@ struct net_nbr *net_nbr_lookup(struct net_nbr_table *table,
 	return NULL;
 }
 
+struct net_nbr *net_nbr_lookup(struct net_nbr_table *table,
+			       struct net_if *iface,
+			       struct net_linkaddr *lladdr)
+{
+	int idx;
+
+	idx = lladdr_find(lladdr->addr, lladdr->len);
+	if (idx < 0) {
+		return NULL;
+	}
+
+	return net_nbr_lookup_by_index(table, iface, idx);
+}
+
 struct net_linkaddr_storage *net_nbr_get_lladdr(u8_t idx)
 {
 	NET_ASSERT_INFO(idx < CONFIG_NET_IPV6_MAX_NEIGHBORS,
@@ -185,6 +256,28 @@ struct net_linkaddr_storage *net_nbr_get_lladdr(u8_t idx)
 	return &net_neighbor_lladdr[idx].lladdr;
 }
 
+void net_nbr_set_lladdr(u8_t idx, u8_t *addr, u8_t len)
+{
+	struct net_nbr_lladdr *entry;
+
+	NET_ASSERT_INFO(idx < CONFIG_NET_IPV6_MAX_NEIGHBORS,
+			"idx %d >= max %d", idx,
+			CONFIG_NET_IPV6_MAX_NEIGHBORS);
+
+	entry = &net_neighbor_lladdr[idx];
+
+	/* The address is the hash key, so the entry changes bucket */
+	sys_slist_find_and_remove(lladdr_hash_bucket(entry->lladdr.addr,
+						     entry->lladdr.len),
+				  &entry->node);
+
+	net_linkaddr_set(&entry->lladdr, addr, len);
+
+	sys_slist_prepend(lladdr_hash_bucket(entry->lladdr.addr,
+					     entry->lladdr.len),
+			  &entry->node);
+}
+
 void net_nbr_clear_table(struct net_nbr_table *table)
 {
 	int i;
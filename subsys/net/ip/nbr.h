@@ -27,6 +27,12 @@ extern "C" {
  * neighboring tables.
  */
 struct net_nbr_lladdr {
+	/** Node in the hash bucket of the link layer address */
+	sys_snode_t node;
+
+	/** Neighbors linked to this link layer address */
+	sys_slist_t nbrs;
+
 	/** Link layer address */
 	struct net_linkaddr_storage lladdr;
 
@@ -62,6 +68,9 @@ struct net_nbr {
 	/** Interface this neighbor is found */
 	struct net_if *iface;
 
+	/** Node in the list of neighbors linked to the same lladdr */
+	sys_snode_t lladdr_node;
+
 	/** Pointer to the start of data in the neighbor table. */
 	u8_t *data;
 
@@ -170,6 +179,17 @@ struct net_nbr *net_nbr_lookup(struct net_nbr_table *table,
 			       struct net_if *iface,
 			       struct net_linkaddr *lladdr);
 
+/**
+ * @brief Find a neighbor linked to a specific lladdr table index.
+ * @param table Neighbor table
+ * @param iface Network interface to use, NULL to match any interface
+ * @param idx Link layer address index in ll table.
+ * @return Pointer to neighbor, NULL if not found
+ */
+struct net_nbr *net_nbr_lookup_by_index(struct net_nbr_table *table,
+					struct net_if *iface,
+					u8_t idx);
+
 /**
  * @brief Link a neighbor to specific link layer address.
  * @param table Neighbor table
@@ -195,6 +215,15 @@ int net_nbr_unlink(struct net_nbr *nbr, struct net_linkaddr *lladdr);
  */
 struct net_linkaddr_storage *net_nbr_get_lladdr(u8_t idx);
 
+/**
+ * @brief Change the link layer address of a specific lladdr table index.
+ * The change is seen by all the neighbors linked to this index.
+ * @param idx Link layer address index in ll table.
+ * @param addr New link layer address
+ * @param len Length of the new link layer address
+ */
+void net_nbr_set_lladdr(u8_t idx, u8_t *addr, u8_t len);
+
 /**
  * @brief Clear table from all neighbors. After this the linking between
  * lladdr and neighbor is removed.
@@ -55,7 +55,8 @@ static struct k_sem contexts_lock;
 #if defined(CONFIG_NET_UDP) || defined(CONFIG_NET_TCP)
 static int check_used_port(enum net_ip_protocol ip_proto,
 			   u16_t local_port,
-			   const struct sockaddr *local_addr)
+			   const struct sockaddr *local_addr,
+			   bool reuseport)
 
 {
 	int i;
@@ -65,6 +66,11 @@ static int check_used_port(enum net_ip_protocol ip_proto,
 			continue;
 		}
 
+		/* The port can be shared if all its users agree */
+		if (reuseport && net_context_is_reuseport_set(&contexts[i])) {
+			continue;
+		}
+
 		if (!(net_context_get_ip_proto(&contexts[i]) == ip_proto &&
 		      net_sin((struct sockaddr *)&
 			      contexts[i].local)->sin_port == local_port)) {
@@ -106,7 +112,7 @@ static u16_t find_available_port(struct net_context *context,
 		}
 	} while (check_used_port(
 				net_context_get_ip_proto(context),
-				htons(local_port), addr) == -EEXIST);
+				htons(local_port), addr, false) == -EEXIST);
 
 	return htons(local_port);
 }
@@ -243,6 +249,10 @@ int net_context_get(sa_family_t family,
 
 		contexts[i].iface = -1;
 		contexts[i].flags = 0U;
+#if defined(CONFIG_NET_CONTEXT_REUSEPORT)
+		/* The new user must not share the port of the previous one */
+		contexts[i].options.reuseport = false;
+#endif
 		atomic_set(&contexts[i].refcount, 1);
 
 		net_context_set_family(&contexts[i], family);
@@ -564,7 +574,9 @@ int net_context_bind(struct net_context *context, const struct sockaddr *addr,
 		net_sin6_ptr(&context->local)->sin6_addr = ptr;
 		if (addr6->sin6_port) {
 			ret = check_used_port(AF_INET6, addr6->sin6_port,
-					      addr);
+					      addr,
+					      net_context_is_reuseport_set(
+						      context));
 			if (!ret) {
 				net_sin6_ptr(&context->local)->sin6_port =
 					addr6->sin6_port;
@@ -656,7 +668,9 @@ int net_context_bind(struct net_context *context, const struct sockaddr *addr,
 		net_sin_ptr(&context->local)->sin_addr = ptr;
 		if (addr4->sin_port) {
 			ret = check_used_port(AF_INET, addr4->sin_port,
-					      addr);
+					      addr,
+					      net_context_is_reuseport_set(
+						      context));
 			if (!ret) {
 				net_sin_ptr(&context->local)->sin_port =
 					addr4->sin_port;
@@ -1154,10 +1168,100 @@ static int get_context_timepstamp(struct net_context *context,
 #endif
 }
 
+static int get_context_reuseport(struct net_context *context,
+				 void *value, size_t *len)
+{
+#if defined(CONFIG_NET_CONTEXT_REUSEPORT)
+	*((bool *)value) = context->options.reuseport;
+
+	if (len) {
+		*len = sizeof(bool);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int get_context_rcvbuf(struct net_context *context,
+			      void *value, size_t *len)
+{
+	int ret;
+
+	if (net_context_get_ip_proto(context) != IPPROTO_TCP) {
+		return -ENOTSUP;
+	}
+
+	ret = net_tcp_get_recv_buf(context);
+	if (ret < 0) {
+		return ret;
+	}
+
+	*((int *)value) = ret;
+
+	if (len) {
+		*len = sizeof(int);
+	}
+
+	return 0;
+}
+
+static int get_context_sndbuf(struct net_context *context,
+			      void *value, size_t *len)
+{
+	int ret;
+
+	if (net_context_get_ip_proto(context) != IPPROTO_TCP) {
+		return -ENOTSUP;
+	}
+
+	ret = net_tcp_get_send_buf(context);
+	if (ret < 0) {
+		return ret;
+	}
+
+	*((int *)value) = ret;
+
+	if (len) {
+		*len = sizeof(int);
+	}
+
+	return 0;
+}
+
+/* Write the data to the packet either from the buffer or from the
+ * iovec array of the msghdr, at most len bytes.
+ */
+static int context_write_data(struct net_pkt *pkt, const void *buf,
+			      size_t len, const struct msghdr *msghdr)
+{
+	size_t i, iov_len;
+	int ret;
+
+	if (!msghdr) {
+		return net_pkt_write(pkt, buf, len);
+	}
+
+	for (i = 0; i < msghdr->msg_iovlen && len; i++) {
+		iov_len = MIN(msghdr->msg_iov[i].iov_len, len);
+
+		ret = net_pkt_write(pkt, msghdr->msg_iov[i].iov_base, iov_len);
+		if (ret < 0) {
+			return ret;
+		}
+
+		len -= iov_len;
+	}
+
+	return 0;
+}
+
 static int context_setup_udp_packet(struct net_context *context,
 				    struct net_pkt *pkt,
 				    const void *buf,
 				    size_t len,
+				    const struct msghdr *msghdr,
 				    const struct sockaddr *dst_addr,
 				    socklen_t addrlen)
 {
@@ -1199,7 +1303,7 @@ static int context_setup_udp_packet(struct net_context *context,
 		return ret;
 	}
 
-	ret = net_pkt_write(pkt, buf, len);
+	ret = context_write_data(pkt, buf, len, msghdr);
 	if (ret) {
 		return ret;
 	}
@@ -1262,10 +1366,56 @@ static struct net_pkt *context_alloc_pkt(struct net_context *context,
 	return pkt;
 }
 
+#if defined(CONFIG_NET_TCP_GSO)
+/* Allocate a packet that carries more than one segment of data, it is
+ * split into segments before it is passed to L2. Returns NULL if the
+ * data should be sent in the usual way, for example because there are
+ * not enough free buffers right now.
+ */
+static struct net_pkt *context_alloc_gso_pkt(struct net_context *context,
+					     size_t len)
+{
+	struct net_pkt *pkt;
+	u16_t gso_size;
+
+#if defined(CONFIG_NET_CONTEXT_NET_PKT_POOL)
+	if (context->tx_slab) {
+		return NULL;
+	}
+#endif
+
+	if (net_if_is_ip_offloaded(net_context_get_iface(context))) {
+		return NULL;
+	}
+
+	gso_size = net_tcp_gso_size(context, &len);
+	if (!gso_size) {
+		return NULL;
+	}
+
+	pkt = net_pkt_alloc_on_iface(net_context_get_iface(context),
+				     K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	net_pkt_set_family(pkt, net_context_get_family(context));
+	net_pkt_set_context(pkt, context);
+	net_pkt_set_gso_size(pkt, gso_size);
+
+	if (net_pkt_alloc_buffer(pkt, len, IPPROTO_TCP, K_NO_WAIT)) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	return pkt;
+}
+#endif /* CONFIG_NET_TCP_GSO */
 
 static int context_sendto(struct net_context *context,
 			  const void *buf,
 			  size_t len,
+			  const struct msghdr *msghdr,
 			  const struct sockaddr *dst_addr,
 			  socklen_t addrlen,
 			  net_context_send_cb_t cb,
@@ -1361,7 +1511,19 @@ static int context_sendto(struct net_context *context,
 		return -EINVAL;
 	}
 
+#if defined(CONFIG_NET_TCP_GSO)
+	if (net_context_get_ip_proto(context) == IPPROTO_TCP) {
+		pkt = context_alloc_gso_pkt(context, len);
+	} else {
+		pkt = NULL;
+	}
+
+	if (!pkt) {
+		pkt = context_alloc_pkt(context, len, PKT_WAIT_TIME);
+	}
+#else
 	pkt = context_alloc_pkt(context, len, PKT_WAIT_TIME);
+#endif
 	if (!pkt) {
 		return -ENOMEM;
 	}
@@ -1397,7 +1559,7 @@ static int context_sendto(struct net_context *context,
 
 	if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
 	    net_if_is_ip_offloaded(net_context_get_iface(context))) {
-		ret = net_pkt_write(pkt, buf, len);
+		ret = context_write_data(pkt, buf, len, msghdr);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1414,7 +1576,7 @@ static int context_sendto(struct net_context *context,
 		}
 	} else if (IS_ENABLED(CONFIG_NET_UDP) &&
 	    net_context_get_ip_proto(context) == IPPROTO_UDP) {
-		ret = context_setup_udp_packet(context, pkt, buf, len,
+		ret = context_setup_udp_packet(context, pkt, buf, len, msghdr,
 					       dst_addr, addrlen);
 		if (ret < 0) {
 			goto fail;
@@ -1425,7 +1587,7 @@ static int context_sendto(struct net_context *context,
 		ret = net_send_data(pkt);
 	} else if (IS_ENABLED(CONFIG_NET_TCP) &&
 		   net_context_get_ip_proto(context) == IPPROTO_TCP) {
-		ret = net_pkt_write(pkt, buf, len);
+		ret = context_write_data(pkt, buf, len, msghdr);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1439,7 +1601,7 @@ static int context_sendto(struct net_context *context,
 		ret = net_tcp_send_data(context, cb, user_data);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
 		   net_context_get_family(context) == AF_PACKET) {
-		ret = net_pkt_write(pkt, buf, len);
+		ret = context_write_data(pkt, buf, len, msghdr);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1450,7 +1612,7 @@ static int context_sendto(struct net_context *context,
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
 		   net_context_get_family(context) == AF_CAN &&
 		   net_context_get_ip_proto(context) == CAN_RAW) {
-		ret = net_pkt_write(pkt, buf, len);
+		ret = context_write_data(pkt, buf, len, msghdr);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1475,42 +1637,52 @@ fail:
 	return ret;
 }
 
-int net_context_send(struct net_context *context,
-		     const void *buf,
-		     size_t len,
-		     net_context_send_cb_t cb,
-		     s32_t timeout,
-		     void *user_data)
+/* Return the length of the address the context is connected to */
+static int context_remote_addrlen(struct net_context *context,
+				  socklen_t *addrlen)
 {
-	socklen_t addrlen;
-	int ret = 0;
-
-	k_mutex_lock(&context->lock, K_FOREVER);
-
 	if (!(context->flags & NET_CONTEXT_REMOTE_ADDR_SET) ||
 	    !net_sin(&context->remote)->sin_port) {
-		ret = -EDESTADDRREQ;
-		goto unlock;
+		return -EDESTADDRREQ;
 	}
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) &&
 	    net_context_get_family(context) == AF_INET) {
-		addrlen = sizeof(struct sockaddr_in);
+		*addrlen = sizeof(struct sockaddr_in);
 	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
 		   net_context_get_family(context) == AF_INET6) {
-		addrlen = sizeof(struct sockaddr_in6);
+		*addrlen = sizeof(struct sockaddr_in6);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
 		   net_context_get_family(context) == AF_PACKET) {
-		ret = -EOPNOTSUPP;
-		goto unlock;
+		return -EOPNOTSUPP;
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
 		   net_context_get_family(context) == AF_CAN) {
-		addrlen = sizeof(struct sockaddr_can);
+		*addrlen = sizeof(struct sockaddr_can);
 	} else {
-		addrlen = 0;
+		*addrlen = 0;
 	}
 
-	ret = context_sendto(context, buf, len, &context->remote,
+	return 0;
+}
+
+int net_context_send(struct net_context *context,
+		     const void *buf,
+		     size_t len,
+		     net_context_send_cb_t cb,
+		     s32_t timeout,
+		     void *user_data)
+{
+	socklen_t addrlen;
+	int ret = 0;
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	ret = context_remote_addrlen(context, &addrlen);
+	if (ret < 0) {
+		goto unlock;
+	}
+
+	ret = context_sendto(context, buf, len, NULL, &context->remote,
 			     addrlen, cb, timeout, user_data, false);
 unlock:
 	k_mutex_unlock(&context->lock);
@@ -1518,7 +1690,6 @@ unlock:
 	return ret;
 }
 
-
 int net_context_sendto(struct net_context *context,
 		       const void *buf,
 		       size_t len,
@@ -1532,7 +1703,7 @@ int net_context_sendto(struct net_context *context,
 
 	k_mutex_lock(&context->lock, K_FOREVER);
 
-	ret = context_sendto(context, buf, len, dst_addr, addrlen,
+	ret = context_sendto(context, buf, len, NULL, dst_addr, addrlen,
 			     cb, timeout, user_data, true);
 
 	k_mutex_unlock(&context->lock);
@@ -1540,6 +1711,44 @@ int net_context_sendto(struct net_context *context,
 	return ret;
 }
 
+int net_context_sendmsg(struct net_context *context,
+			const struct msghdr *msghdr,
+			int flags,
+			net_context_send_cb_t cb,
+			s32_t timeout,
+			void *user_data)
+{
+	const struct sockaddr *dst_addr = msghdr->msg_name;
+	socklen_t addrlen = msghdr->msg_namelen;
+	size_t len = 0;
+	size_t i;
+	int ret;
+
+	ARG_UNUSED(flags);
+
+	for (i = 0; i < msghdr->msg_iovlen; i++) {
+		len += msghdr->msg_iov[i].iov_len;
+	}
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	if (!dst_addr) {
+		ret = context_remote_addrlen(context, &addrlen);
+		if (ret < 0) {
+			goto unlock;
+		}
+
+		dst_addr = &context->remote;
+	}
+
+	ret = context_sendto(context, NULL, len, msghdr, dst_addr, addrlen,
+			     cb, timeout, user_data, msghdr->msg_name != NULL);
+unlock:
+	k_mutex_unlock(&context->lock);
+
+	return ret;
+}
+
 enum net_verdict net_context_packet_received(struct net_conn *conn,
 					     struct net_pkt *pkt,
 					     union net_ip_header *ip_hdr,
@@ -1645,6 +1854,7 @@ static int recv_udp(struct net_context *context,
 				laddr,
 				ntohs(net_sin(&context->remote)->sin_port),
 				ntohs(lport),
+				context,
 				net_context_packet_received,
 				user_data,
 				&context->conn_handler);
@@ -1708,7 +1918,7 @@ static int recv_raw(struct net_context *context,
 
 	ret = net_conn_register(net_context_get_ip_proto(context),
 				net_context_get_family(context),
-				NULL, NULL, 0, 0,
+				NULL, NULL, 0, 0, context,
 				net_context_raw_packet_received,
 				user_data,
 				&context->conn_handler);
@@ -1846,6 +2056,50 @@ static int set_context_timestamp(struct net_context *context,
 #endif
 }
 
+static int set_context_reuseport(struct net_context *context,
+				 const void *value, size_t len)
+{
+#if defined(CONFIG_NET_CONTEXT_REUSEPORT)
+	if (len > sizeof(bool)) {
+		return -EINVAL;
+	}
+
+	context->options.reuseport = *((bool *)value);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int set_context_rcvbuf(struct net_context *context,
+			      const void *value, size_t len)
+{
+	if (net_context_get_ip_proto(context) != IPPROTO_TCP) {
+		return -ENOTSUP;
+	}
+
+	if (len != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	return net_tcp_set_recv_buf(context, *((int *)value));
+}
+
+static int set_context_sndbuf(struct net_context *context,
+			      const void *value, size_t len)
+{
+	if (net_context_get_ip_proto(context) != IPPROTO_TCP) {
+		return -ENOTSUP;
+	}
+
+	if (len != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	return net_tcp_set_send_buf(context, *((int *)value));
+}
+
 int net_context_set_option(struct net_context *context,
 			   enum net_context_option option,
 			   const void *value, size_t len)
@@ -1867,6 +2121,15 @@ int net_context_set_option(struct net_context *context,
 	case NET_OPT_TIMESTAMP:
 		ret = set_context_timestamp(context, value, len);
 		break;
+	case NET_OPT_RCVBUF:
+		ret = set_context_rcvbuf(context, value, len);
+		break;
+	case NET_OPT_SNDBUF:
+		ret = set_context_sndbuf(context, value, len);
+		break;
+	case NET_OPT_REUSEPORT:
+		ret = set_context_reuseport(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -1895,6 +2158,15 @@ int net_context_get_option(struct net_context *context,
 	case NET_OPT_TIMESTAMP:
 		ret = get_context_timepstamp(context, value, len);
 		break;
+	case NET_OPT_RCVBUF:
+		ret = get_context_rcvbuf(context, value, len);
+		break;
+	case NET_OPT_SNDBUF:
+		ret = get_context_sndbuf(context, value, len);
+		break;
+	case NET_OPT_REUSEPORT:
+		ret = get_context_reuseport(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -89,6 +89,13 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 	}
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	/* Same for a reassembled IPv4 packet */
+	if (net_pkt_ipv4_reassembled(pkt)) {
+		locally_routed = true;
+	}
+#endif
+
 	/* If there is no data, then drop the packet. */
 	if (!pkt->frags) {
 		NET_DBG("Corrupted packet (frags %p)", pkt->frags);
@@ -360,7 +367,13 @@ static void process_rx_packet(struct k_work *work)
 static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
 {
 	u8_t prio = net_pkt_priority(pkt);
-	u8_t tc = net_rx_priority2tc(prio);
+	u8_t tc;
+
+	if (IS_ENABLED(CONFIG_NET_TC_RX_FLOW_HASH)) {
+		tc = net_rx_flow2tc(pkt);
+	} else {
+		tc = net_rx_priority2tc(prio);
+	}
 
 	k_work_init(net_pkt_work(pkt), process_rx_packet);
 
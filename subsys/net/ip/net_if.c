@@ -19,7 +19,9 @@ LOG_MODULE_REGISTER(net_if, CONFIG_NET_IF_LOG_LEVEL);
 #include <net/ethernet.h>
 
 #include "net_private.h"
+#include "ipv4.h"
 #include "ipv6.h"
+#include "tcp_internal.h"
 #include "ipv4_autoconf_internal.h"
 
 #include "net_stats.h"
@@ -187,12 +189,61 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 static void process_tx_packet(struct k_work *work)
 {
 	struct net_pkt *pkt;
+	u8_t tc;
 
 	pkt = CONTAINER_OF(work, struct net_pkt, work);
+	tc = net_tx_priority2tc(net_pkt_priority(pkt));
 
+	net_tc_tx_begin(tc);
 	net_if_tx(net_pkt_iface(pkt), pkt);
+	net_tc_tx_end(tc, 1);
 }
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+/* Hand the packets queued for the interface over to the driver in one
+ * go. If another traffic class is already collecting a batch for the
+ * interface, they are sent one by one.
+ */
+static void process_tx_batch(struct k_work *work)
+{
+	struct net_if_tx_batch *batch =
+		CONTAINER_OF(work, struct net_if_tx_batch, work);
+	struct net_if *iface = batch->iface;
+	struct net_pkt *pkt;
+	bool started;
+	int count = 0;
+
+	net_tc_tx_begin(batch->tc);
+
+	started = net_eth_tx_batch_start(iface);
+
+	while ((pkt = k_fifo_get(&batch->fifo, K_NO_WAIT))) {
+		net_if_tx(iface, pkt);
+		count++;
+	}
+
+	if (started) {
+		net_eth_tx_batch_flush(iface);
+	}
+
+	net_tc_tx_end(batch->tc, count);
+}
+
+static void init_tx_batch(struct net_if *iface)
+{
+	int i;
+
+	for (i = 0; i < NET_TC_TX_COUNT; i++) {
+		struct net_if_tx_batch *batch = &iface->tx_batch[i];
+
+		k_work_init(&batch->work, process_tx_batch);
+		k_fifo_init(&batch->fifo);
+		batch->iface = iface;
+		batch->tc = i;
+	}
+}
+#endif /* CONFIG_NET_ETHERNET_TX_BATCH */
+
 void net_if_queue_tx(struct net_if *iface, struct net_pkt *pkt)
 {
 	u8_t prio = net_pkt_priority(pkt);
@@ -210,7 +261,21 @@ void net_if_queue_tx(struct net_if *iface, struct net_pkt *pkt)
 	NET_DBG("TC %d with prio %d pkt %p", tc, prio, pkt);
 #endif
 
-	net_tc_submit_to_tx_queue(tc, pkt);
+	if (net_tc_tx_direct_begin(tc)) {
+		net_if_tx(iface, pkt);
+		net_tc_tx_end(tc, 1);
+		return;
+	}
+
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		k_fifo_put(&iface->tx_batch[tc].fifo, pkt);
+		net_tc_submit_to_tx_queue(tc, &iface->tx_batch[tc].work);
+		return;
+	}
+#endif
+
+	net_tc_submit_to_tx_queue(tc, net_pkt_work(pkt));
 }
 
 static inline void init_iface(struct net_if *iface)
@@ -221,6 +286,10 @@ static inline void init_iface(struct net_if *iface)
 
 	NET_DBG("On iface %p", iface);
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	init_tx_batch(iface);
+#endif
+
 	api->init(iface);
 }
 
@@ -250,6 +319,23 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 		net_pkt_lladdr_src(pkt)->len = net_pkt_lladdr_if(pkt)->len;
 	}
 
+#if defined(CONFIG_NET_TCP_GSO)
+	/* Split GSO packets into MTU sized TCP segments unless the device
+	 * can do it. The segments are sent separately, so the original
+	 * packet does not proceed any further. Loopback gets the segments
+	 * too, so that it behaves like a device without offloading.
+	 */
+	if (net_pkt_gso_size(pkt) && net_if_need_tcp_segmentation(iface)) {
+		if (net_tcp_gso_segment(pkt) < 0) {
+			verdict = NET_DROP;
+			status = -ENOMEM;
+			goto done;
+		}
+
+		return NET_CONTINUE;
+	}
+#endif
+
 #if defined(CONFIG_NET_LOOPBACK)
 	/* If the packet is destined back to us, then there is no need to do
 	 * additional checks, so let the packet through.
@@ -259,6 +345,13 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 	}
 #endif
 
+#if defined(CONFIG_NET_IPV4)
+	/* Fragment the packet if it does not fit into the MTU */
+	if (net_pkt_family(pkt) == AF_INET) {
+		verdict = net_ipv4_prepare_for_send(pkt);
+	}
+#endif
+
 #if defined(CONFIG_NET_IPV6)
 	/* If the ll dst address is not set check if it is present in the nbr
 	 * cache.
@@ -2801,6 +2894,11 @@ bool net_if_need_calc_rx_checksum(struct net_if *iface)
 	return need_calc_checksum(iface, ETHERNET_HW_RX_CHKSUM_OFFLOAD);
 }
 
+bool net_if_need_tcp_segmentation(struct net_if *iface)
+{
+	return need_calc_checksum(iface, ETHERNET_HW_TX_TSO);
+}
+
 struct net_if *net_if_get_by_index(int index)
 {
 	if (index <= 0) {
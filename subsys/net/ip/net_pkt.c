@@ -39,6 +39,7 @@ LOG_MODULE_REGISTER(net_pkt, CONFIG_NET_PKT_LOG_LEVEL);
 #include <net/udp.h>
 
 #include "net_private.h"
+#include "ipv4.h"
 #include "tcp_internal.h"
 
 /* Find max header size of IP protocol (IPv4 or IPv6) */
@@ -946,6 +947,13 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 	sa_family_t family = net_pkt_family(pkt);
 	size_t max_len;
 
+	/* GSO packets are segmented before L2, so the MTU does not
+	 * limit them.
+	 */
+	if (net_pkt_gso_size(pkt)) {
+		return size;
+	}
+
 	if (net_pkt_iface(pkt)) {
 		max_len = net_if_get_mtu(net_pkt_iface(pkt));
 	} else {
@@ -957,6 +965,17 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 		max_len = MAX(max_len, NET_IPV6_MTU);
 	} else if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
 		max_len = MAX(max_len, NET_IPV4_MTU);
+
+		/* UDP packets larger than the MTU are fragmented, up to
+		 * the number of fragments we could reassemble ourselves.
+		 */
+		if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) &&
+		    proto == IPPROTO_UDP) {
+			max_len = sizeof(struct net_ipv4_hdr) +
+				NET_IPV4_FRAGMENTS_MAX_PKT *
+				((max_len - sizeof(struct net_ipv4_hdr)) & ~7);
+			max_len = MIN(max_len, UINT16_MAX);
+		}
 	} else { /* family == AF_UNSPEC */
 #if defined (CONFIG_NET_L2_ETHERNET)
 		if (net_if_l2(net_pkt_iface(pkt)) ==
@@ -1688,6 +1707,7 @@ struct net_pkt *net_pkt_clone(struct net_pkt *pkt, s32_t timeout)
 	net_pkt_set_vlan_tag(clone_pkt, net_pkt_vlan_tag(pkt));
 	net_pkt_set_timestamp(clone_pkt, net_pkt_timestamp(pkt));
 	net_pkt_set_priority(clone_pkt, net_pkt_priority(pkt));
+	net_pkt_set_gso_size(clone_pkt, net_pkt_gso_size(pkt));
 	net_pkt_set_orig_iface(clone_pkt, net_pkt_orig_iface(pkt));
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
@@ -1757,7 +1777,7 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 	net_pkt_cursor_backup(pkt, &backup);
 
 	while (length) {
-		u8_t left, rem;
+		size_t left, rem;
 
 		pkt_cursor_advance(pkt, false);
 
@@ -1774,7 +1794,7 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 		c_op->buf->len -= rem;
 		left -= rem;
 		if (left) {
-			memmove(c_op->pos, c_op->pos+rem, rem);
+			memmove(c_op->pos, c_op->pos+rem, left);
 		}
 
 		/* For now, empty buffer are not freed, and there is no
@@ -47,10 +47,36 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt);
 enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback);
 extern void net_tc_tx_init(void);
 extern void net_tc_rx_init(void);
-extern void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt);
+extern void net_tc_submit_to_tx_queue(u8_t tc, struct k_work *work);
 extern void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt);
+extern int net_rx_flow2tc(struct net_pkt *pkt);
 extern enum net_verdict net_promisc_mode_input(struct net_pkt *pkt);
 
+#if defined(CONFIG_NET_TC_TX_DIRECT)
+extern bool net_tc_tx_direct_begin(u8_t tc);
+extern void net_tc_tx_begin(u8_t tc);
+extern void net_tc_tx_end(u8_t tc, int count);
+#else
+/* Only the Tx queue thread of the traffic class sends its packets */
+static inline bool net_tc_tx_direct_begin(u8_t tc)
+{
+	ARG_UNUSED(tc);
+
+	return false;
+}
+
+static inline void net_tc_tx_begin(u8_t tc)
+{
+	ARG_UNUSED(tc);
+}
+
+static inline void net_tc_tx_end(u8_t tc, int count)
+{
+	ARG_UNUSED(tc);
+	ARG_UNUSED(count);
+}
+#endif
+
 char *net_sprint_addr(sa_family_t af, const void *addr);
 
 #define net_sprint_ipv4_addr(_addr) net_sprint_addr(AF_INET, _addr)
@@ -219,6 +219,7 @@ static struct ethernet_capabilities eth_hw_caps[] = {
 	EC(ETHERNET_PROMISC_MODE,         "Promiscuous mode"),
 	EC(ETHERNET_PRIORITY_QUEUES,      "Priority queues"),
 	EC(ETHERNET_HW_FILTERING,         "MAC address filtering"),
+	EC(ETHERNET_HW_TX_TSO,            "TCP segmentation offload"),
 };
 
 static void print_supported_ethernet_capabilities(
@@ -719,6 +720,14 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	   GET_STAT(iface, ipv4.forwarded));
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+	PR("ARP hit        %d\tmiss\t%d\tqueued\t%d\trefresh\t%d\n",
+	   GET_STAT(iface, arp.hit),
+	   GET_STAT(iface, arp.miss),
+	   GET_STAT(iface, arp.queued),
+	   GET_STAT(iface, arp.refresh));
+#endif /* CONFIG_NET_STATISTICS_ARP */
+
 	PR("IP vhlerr      %d\thblener\t%d\tlblener\t%d\n",
 	   GET_STAT(iface, ip_errors.vhlerr),
 	   GET_STAT(iface, ip_errors.hblenerr),
@@ -959,11 +968,12 @@ static void tcp_cb(struct net_tcp *tcp, void *user_data)
 	int *count = data->user_data;
 	u16_t recv_mss = net_tcp_get_recv_mss(tcp);
 
-	PR("%p %p   %5u    %5u %10u %10u %5u   %s\n",
+	PR("%p %p   %5u    %5u %10u %10u %5u %10u %10u   %s\n",
 	   tcp, tcp->context,
 	   ntohs(net_sin6_ptr(&tcp->context->local)->sin6_port),
 	   ntohs(net_sin6(&tcp->context->remote)->sin6_port),
 	   tcp->send_seq, tcp->send_ack, recv_mss,
+	   tcp->acks_sent, tcp->segs_received,
 	   net_tcp_state_str(net_tcp_get_state(tcp)));
 
 	(*count)++;
@@ -1026,6 +1036,21 @@ static void tcp_sent_list_cb(struct net_tcp *tcp, void *user_data)
 #endif
 
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
+static void ipv6_frag_print_bufs(const struct shell *shell,
+				 struct net_buf *frag)
+{
+	while (frag) {
+		PR("%p", frag);
+
+		frag = frag->frags;
+		if (frag) {
+			PR("->");
+		}
+	}
+
+	PR("\n");
+}
+
 static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 			 void *user_data)
 {
@@ -1033,7 +1058,6 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 	const struct shell *shell = data->shell;
 	int *count = data->user_data;
 	char src[ADDR_LEN];
-	int i;
 
 	if (!*count) {
 		PR("\nIPv6 reassembly Id         Remain "
@@ -1044,26 +1068,17 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 
 	PR("%p      0x%08x  %5d %16s\t%16s\n",
 	   reass, reass->id,
-	   k_delayed_work_remaining_get(&reass->timer),
+	   k_delayed_work_remaining_get(&reass->common.timer),
 	   src, net_sprint_ipv6_addr(&reass->dst));
 
-	for (i = 0; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (reass->pkt[i]) {
-			struct net_buf *frag = reass->pkt[i]->frags;
-
-			PR("[%d] pkt %p->", i, reass->pkt[i]);
-
-			while (frag) {
-				PR("%p", frag);
-
-				frag = frag->frags;
-				if (frag) {
-					PR("->");
-				}
-			}
+	if (reass->common.pkt) {
+		PR("pkt %p->", reass->common.pkt);
+		ipv6_frag_print_bufs(shell, reass->common.pkt->frags);
+	}
 
-			PR("\n");
-		}
+	if (reass->common.frags) {
+		PR("frags ");
+		ipv6_frag_print_bufs(shell, reass->common.frags);
 	}
 
 	(*count)++;
@@ -1260,7 +1275,7 @@ static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 
 #if defined(CONFIG_NET_TCP)
 	PR("\nTCP        Context   Src port Dst port   "
-	   "Send-Seq   Send-Ack  MSS    State\n");
+	   "Send-Seq   Send-Ack  MSS  ACKs-Sent  Segs-Recv    State\n");
 
 	count = 0;
 
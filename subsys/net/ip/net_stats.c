@@ -106,6 +106,14 @@ static inline void stats(struct net_if *iface)
 			 GET_STAT(iface, ipv4.forwarded));
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+		NET_INFO("ARP hit        %d\tmiss\t%d\tqueued\t%d\trefresh\t%d",
+			 GET_STAT(iface, arp.hit),
+			 GET_STAT(iface, arp.miss),
+			 GET_STAT(iface, arp.queued),
+			 GET_STAT(iface, arp.refresh));
+#endif /* CONFIG_NET_STATISTICS_ARP */
+
 		NET_INFO("IP vhlerr      %d\thblener\t%d\tlblener\t%d",
 			 GET_STAT(iface, ip_errors.vhlerr),
 			 GET_STAT(iface, ip_errors.hblenerr),
@@ -266,6 +274,12 @@ static int net_stats_get(u32_t mgmt_request, struct net_if *iface,
 		src = GET_STAT_ADDR(iface, ipv6_nd);
 		break;
 #endif
+#if defined(CONFIG_NET_STATISTICS_ARP)
+	case NET_REQUEST_STATS_CMD_GET_ARP:
+		len_chk = sizeof(struct net_stats_arp);
+		src = GET_STAT_ADDR(iface, arp);
+		break;
+#endif
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 	case NET_REQUEST_STATS_CMD_GET_ICMP:
 		len_chk = sizeof(struct net_stats_icmp);
@@ -322,6 +336,11 @@ NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_IPV6_ND,
 				  net_stats_get);
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_ARP,
+				  net_stats_get);
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_ICMP,
 				  net_stats_get);
@@ -111,6 +111,35 @@ static inline void net_stats_update_ipv6_nd_drop(struct net_if *iface)
 #define net_stats_update_ipv6_nd_drop(iface)
 #endif /* CONFIG_NET_STATISTICS_IPV6_ND */
 
+#if defined(CONFIG_NET_STATISTICS_ARP)
+/* ARP cache stats */
+
+static inline void net_stats_update_arp_hit(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.hit++);
+}
+
+static inline void net_stats_update_arp_miss(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.miss++);
+}
+
+static inline void net_stats_update_arp_queued(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.queued++);
+}
+
+static inline void net_stats_update_arp_refresh(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.arp.refresh++);
+}
+#else
+#define net_stats_update_arp_hit(iface)
+#define net_stats_update_arp_miss(iface)
+#define net_stats_update_arp_queued(iface)
+#define net_stats_update_arp_refresh(iface)
+#endif /* CONFIG_NET_STATISTICS_ARP */
+
 #if defined(CONFIG_NET_STATISTICS_IPV4)
 /* IPv4 stats */
 
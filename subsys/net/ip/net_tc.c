@@ -13,10 +13,13 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include <net/net_core.h>
 #include <net/net_pkt.h>
 #include <net/net_stats.h>
+#include <net/ethernet.h>
+#include <net/hash.h>
 
 #include "net_private.h"
 #include "net_stats.h"
 #include "net_tc_mapping.h"
+#include "ipv4.h"
 
 /* Stacks for TX work queue */
 NET_STACK_ARRAY_DEFINE(TX, tx_stack,
@@ -33,9 +36,56 @@ NET_STACK_ARRAY_DEFINE(RX, rx_stack,
 static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
 static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
 
-void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt)
+#if defined(CONFIG_NET_TC_TX_DIRECT)
+/* Number of packets queued or being sent in each Tx traffic class */
+static atomic_t tx_pending[NET_TC_TX_COUNT];
+
+/* Held while a packet of the Tx traffic class is given to L2, so that
+ * the sending thread and the Tx queue thread never do it at the same
+ * time.
+ */
+static struct k_mutex tx_lock[NET_TC_TX_COUNT];
+
+bool net_tc_tx_direct_begin(u8_t tc)
 {
-	k_work_submit_to_queue(&tx_classes[tc].work_q, net_pkt_work(pkt));
+	if (k_is_in_isr()) {
+		return false;
+	}
+
+	/* Packets sent while the queue is busy must wait for their turn */
+	if (atomic_inc(&tx_pending[tc]) != 0) {
+		atomic_dec(&tx_pending[tc]);
+		return false;
+	}
+
+	k_mutex_lock(&tx_lock[tc], K_FOREVER);
+
+	return true;
+}
+
+void net_tc_tx_begin(u8_t tc)
+{
+	k_mutex_lock(&tx_lock[tc], K_FOREVER);
+}
+
+void net_tc_tx_end(u8_t tc, int count)
+{
+	k_mutex_unlock(&tx_lock[tc]);
+
+	atomic_sub(&tx_pending[tc], count);
+}
+#endif /* CONFIG_NET_TC_TX_DIRECT */
+
+/* The work item is either the one of a packet, or the one of a batch
+ * to which one packet was added.
+ */
+void net_tc_submit_to_tx_queue(u8_t tc, struct k_work *work)
+{
+#if defined(CONFIG_NET_TC_TX_DIRECT)
+	atomic_inc(&tx_pending[tc]);
+#endif
+
+	k_work_submit_to_queue(&tx_classes[tc].work_q, work);
 }
 
 void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt)
@@ -63,6 +113,132 @@ int net_rx_priority2tc(enum net_priority prio)
 	return rx_prio2tc_map[prio];
 }
 
+#if defined(CONFIG_NET_TC_RX_FLOW_HASH)
+static u32_t flow_hash_add(u32_t hash, const u8_t *data, size_t len)
+{
+	while (len--) {
+		hash = hash * 31U + *data++;
+	}
+
+	return hash;
+}
+
+/* Return the start of the IP header, or NULL if the packet is not
+ * an IP packet in an interface we know the link layer header of.
+ */
+static const u8_t *rx_flow_ip_hdr(struct net_pkt *pkt, size_t *len)
+{
+	const struct net_l2 *l2 = net_if_l2(net_pkt_iface(pkt));
+	const u8_t *data = pkt->frags->data;
+
+	*len = pkt->frags->len;
+
+#if defined(CONFIG_NET_L2_DUMMY)
+	if (l2 == &NET_L2_GET_NAME(DUMMY)) {
+		return data;
+	}
+#endif
+
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (l2 == &NET_L2_GET_NAME(ETHERNET)) {
+		size_t hdr_len = sizeof(struct net_eth_hdr);
+		u16_t type;
+
+		if (*len < sizeof(struct net_eth_vlan_hdr)) {
+			return NULL;
+		}
+
+		type = ntohs(((struct net_eth_hdr *)data)->type);
+		if (type == NET_ETH_PTYPE_VLAN) {
+			hdr_len = sizeof(struct net_eth_vlan_hdr);
+			type = ntohs(((struct net_eth_vlan_hdr *)data)->type);
+		}
+
+		if (type != NET_ETH_PTYPE_IP && type != NET_ETH_PTYPE_IPV6) {
+			return NULL;
+		}
+
+		*len -= hdr_len;
+
+		return data + hdr_len;
+	}
+#endif
+
+	ARG_UNUSED(l2);
+	ARG_UNUSED(data);
+
+	return NULL;
+}
+
+/* Hash the addresses, protocol and ports of the packet. The ports are
+ * left out of IP fragments so that all the fragments of a datagram
+ * end up in the same queue.
+ */
+static u32_t rx_flow_hash(struct net_pkt *pkt)
+{
+	const u8_t *ports = NULL;
+	const u8_t *hdr;
+	u32_t hash = 0U;
+	size_t len;
+	u8_t proto;
+
+	hdr = rx_flow_ip_hdr(pkt, &len);
+	if (!hdr || len < 1) {
+		return 0U;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && (hdr[0] & 0xf0) == 0x40) {
+		const struct net_ipv4_hdr *ipv4 = (const void *)hdr;
+		size_t hdr_len = (hdr[0] & 0x0f) * 4U;
+
+		if (len < NET_IPV4H_LEN) {
+			return 0U;
+		}
+
+		proto = ipv4->proto;
+		hash = flow_hash_add(hash, (const u8_t *)&ipv4->src,
+				     2 * sizeof(struct in_addr));
+
+		if (!(sys_get_be16(ipv4->offset) &
+		      (NET_IPV4_MF | NET_IPV4_FRAGH_OFFSET_MASK)) &&
+		    len >= hdr_len + 4) {
+			ports = hdr + hdr_len;
+		}
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   (hdr[0] & 0xf0) == 0x60) {
+		const struct net_ipv6_hdr *ipv6 = (const void *)hdr;
+
+		if (len < NET_IPV6H_LEN) {
+			return 0U;
+		}
+
+		/* Extension headers, fragments included, are not walked */
+		proto = ipv6->nexthdr;
+		hash = flow_hash_add(hash, (const u8_t *)&ipv6->src,
+				     2 * sizeof(struct in6_addr));
+
+		if (len >= NET_IPV6H_LEN + 4) {
+			ports = hdr + NET_IPV6H_LEN;
+		}
+	} else {
+		return 0U;
+	}
+
+	hash = flow_hash_add(hash, &proto, sizeof(proto));
+
+	if (ports && (proto == IPPROTO_TCP || proto == IPPROTO_UDP)) {
+		hash = flow_hash_add(hash, ports, 4);
+	}
+
+	return net_hash_fib(hash);
+}
+
+int net_rx_flow2tc(struct net_pkt *pkt)
+{
+	return rx_flow_hash(pkt) % NET_TC_RX_COUNT;
+}
+#endif /* CONFIG_NET_TC_RX_FLOW_HASH */
+
 /* Convert traffic class to thread priority */
 static u8_t tx_tc2thread(u8_t tc)
 {
@@ -166,6 +342,13 @@ static u8_t rx_tc2thread(u8_t tc)
 
 	NET_ASSERT(tc < ARRAY_SIZE(thread_priorities));
 
+	/* The queues are peers when they are selected by flow, so they all
+	 * get the priority of the lowest traffic class.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TC_RX_FLOW_HASH)) {
+		return thread_priorities[0];
+	}
+
 	return thread_priorities[tc];
 }
 
@@ -195,6 +378,10 @@ static void tc_rx_stats_priority_setup(struct net_if *iface)
 {
 	int i;
 
+	if (IS_ENABLED(CONFIG_NET_TC_RX_FLOW_HASH)) {
+		return;
+	}
+
 	for (i = 0; i < 8; i++) {
 		net_stats_update_tc_recv_priority(iface, net_rx_priority2tc(i),
 						  i);
@@ -235,6 +422,10 @@ void net_tc_tx_init(void)
 	for (i = 0; i < NET_TC_TX_COUNT; i++) {
 		u8_t thread_priority;
 
+#if defined(CONFIG_NET_TC_TX_DIRECT)
+		k_mutex_init(&tx_lock[i]);
+#endif
+
 		thread_priority = tx_tc2thread(i);
 		tx_classes[i].tc = thread_priority;
 
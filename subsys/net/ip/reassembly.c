@@ -0,0 +1,351 @@
+/** @file
+ * @brief IP fragment reassembly shared by IPv4 and IPv6
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_reassembly, CONFIG_NET_CORE_LOG_LEVEL);
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/hash.h>
+#include "net_private.h"
+#include "reassembly.h"
+
+/* Position of a fragment in the reassembled payload, stored in the user
+ * data of its first buffer.
+ */
+struct fragment_info {
+	u16_t offset;
+	u16_t len;
+};
+
+BUILD_ASSERT(sizeof(struct fragment_info) <= CONFIG_NET_BUF_USER_DATA_SIZE);
+
+static void reassembly_timeout(struct k_work *work);
+
+void net_reassembly_table_init(struct net_reassembly_table *table)
+{
+	int i;
+
+	for (i = 0; i < table->hash_size; i++) {
+		sys_slist_init(&table->hash[i]);
+	}
+
+	sys_slist_init(&table->free);
+
+	table->init_done = true;
+}
+
+void net_reassembly_slot_init(struct net_reassembly_table *table,
+			      struct net_reassembly *reass)
+{
+	k_delayed_work_init(&reass->timer, reassembly_timeout);
+
+	reass->table = table;
+
+	sys_slist_append(&table->free, &reass->node);
+}
+
+u16_t net_reassembly_bucket(struct net_reassembly_table *table, u32_t hash)
+{
+	return net_hash_fib(hash) % table->hash_size;
+}
+
+struct net_reassembly *net_reassembly_alloc(struct net_reassembly_table *table,
+					    u16_t bucket)
+{
+	struct net_reassembly *reass;
+	sys_snode_t *node;
+
+	node = sys_slist_get(&table->free);
+	if (!node) {
+		return NULL;
+	}
+
+	reass = CONTAINER_OF(node, struct net_reassembly, node);
+
+	k_delayed_work_submit(&reass->timer, table->timeout);
+
+	reass->len = 0U;
+	reass->total_len = 0U;
+	reass->first_len = 0U;
+	reass->bucket = bucket;
+
+	sys_slist_prepend(&table->hash[bucket], &reass->node);
+
+	return reass;
+}
+
+void net_reassembly_cancel(struct net_reassembly *reass)
+{
+	struct net_reassembly_table *table = reass->table;
+
+	k_delayed_work_cancel(&reass->timer);
+
+	if (reass->pkt) {
+		NET_DBG("Reassembly pkt %p %zd bytes data", reass->pkt,
+			net_pkt_get_len(reass->pkt));
+
+		net_pkt_unref(reass->pkt);
+		reass->pkt = NULL;
+	}
+
+	if (reass->frags) {
+		net_buf_unref(reass->frags);
+		reass->frags = NULL;
+	}
+
+	table->mem -= reass->mem;
+	reass->mem = 0U;
+
+	sys_slist_find_and_remove(&table->hash[reass->bucket], &reass->node);
+	sys_slist_append(&table->free, &reass->node);
+}
+
+/* A timeout handler that was already running when the reassembly was
+ * completed or cancelled finds it freed, or in use again with a new
+ * timer.
+ */
+static bool reassembly_expired(struct net_reassembly *reass)
+{
+	struct net_reassembly *tmp;
+
+	if (k_delayed_work_remaining_get(&reass->timer)) {
+		return false;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&reass->table->hash[reass->bucket],
+				     tmp, node) {
+		if (tmp == reass) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void reassembly_timeout(struct k_work *work)
+{
+	struct net_reassembly *reass =
+		CONTAINER_OF(work, struct net_reassembly, timer);
+	struct net_reassembly_table *table = reass->table;
+
+	k_mutex_lock(&table->lock, K_FOREVER);
+
+	if (reassembly_expired(reass)) {
+		NET_DBG("Reassembly %p timed out, len %u", reass, reass->len);
+
+		net_reassembly_cancel(reass);
+	}
+
+	k_mutex_unlock(&table->lock);
+}
+
+bool net_reassembly_limit_mem(struct net_reassembly *current)
+{
+	struct net_reassembly_table *table = current->table;
+
+	while (table->mem > table->max_mem) {
+		struct net_reassembly *oldest = NULL;
+		struct net_reassembly *reass;
+		s32_t remaining, oldest_remaining = 0;
+		int i;
+
+		for (i = 0; i < table->hash_size; i++) {
+			SYS_SLIST_FOR_EACH_CONTAINER(&table->hash[i],
+						     reass, node) {
+				if (reass == current) {
+					continue;
+				}
+
+				remaining = k_delayed_work_remaining_get(
+								&reass->timer);
+				if (!oldest || remaining < oldest_remaining) {
+					oldest = reass;
+					oldest_remaining = remaining;
+				}
+			}
+		}
+
+		if (!oldest) {
+			NET_DBG("Reassembly %p too large, len %u", current,
+				current->len);
+			net_reassembly_cancel(current);
+			return false;
+		}
+
+		NET_DBG("Reassembly %p evicted, len %u", oldest, oldest->len);
+		net_reassembly_cancel(oldest);
+	}
+
+	return true;
+}
+
+/* Size of the buffers in a chain, which is what a fragment really costs */
+static u32_t buf_chain_mem(struct net_buf *buf)
+{
+	u32_t mem = 0U;
+
+	while (buf) {
+		mem += buf->size;
+		buf = buf->frags;
+	}
+
+	return mem;
+}
+
+static struct fragment_info *fragment_info(struct net_buf *buf)
+{
+	return (struct fragment_info *)net_buf_user_data(buf);
+}
+
+/* Last buffer of the fragment that starts from the given buffer */
+static struct net_buf *fragment_last(struct net_buf *buf)
+{
+	u16_t len = fragment_info(buf)->len;
+
+	while (len > buf->len) {
+		len -= buf->len;
+		buf = buf->frags;
+	}
+
+	return buf;
+}
+
+/* Take the payload buffers of a fragment out of its packet. The IP
+ * headers are removed from the start of the data, and empty buffers are
+ * freed so that the fragment can be walked by its length.
+ */
+static struct net_buf *fragment_detach(struct net_pkt *pkt, u16_t hdr_len)
+{
+	struct net_buf *buf = pkt->buffer;
+	struct net_buf *prev;
+
+	pkt->buffer = NULL;
+
+	while (buf && hdr_len >= buf->len) {
+		hdr_len -= buf->len;
+		buf = net_buf_frag_del(NULL, buf);
+	}
+
+	if (!buf) {
+		return NULL;
+	}
+
+	net_buf_pull(buf, hdr_len);
+
+	for (prev = buf; prev->frags; ) {
+		if (!prev->frags->len) {
+			net_buf_frag_del(prev, prev->frags);
+		} else {
+			prev = prev->frags;
+		}
+	}
+
+	return buf;
+}
+
+static void reassembly_add_mem(struct net_reassembly *reass, u32_t mem)
+{
+	reass->mem += mem;
+	reass->table->mem += mem;
+}
+
+int net_reassembly_add(struct net_reassembly *reass, struct net_pkt *pkt,
+		       u16_t hdr_len, u16_t offset, u16_t len, bool more)
+{
+	struct net_buf *prev = NULL;
+	struct net_buf *next;
+	struct net_buf *buf;
+
+	next = reass->frags;
+
+	if (offset == 0U) {
+		if (reass->pkt) {
+			return reass->first_len == len ? -EALREADY : -EINVAL;
+		}
+
+		if (next && (!more || fragment_info(next)->offset < len)) {
+			return -EINVAL;
+		}
+
+		reass->pkt = pkt;
+		reass->first_len = len;
+		reass->len += len;
+		reassembly_add_mem(reass, buf_chain_mem(pkt->buffer));
+
+		return 0;
+	}
+
+	if (reass->pkt && offset < reass->first_len) {
+		return -EINVAL;
+	}
+
+	while (next && fragment_info(next)->offset < offset) {
+		if (fragment_info(next)->offset +
+		    fragment_info(next)->len > offset) {
+			return -EINVAL;
+		}
+
+		prev = fragment_last(next);
+		next = prev->frags;
+	}
+
+	if (next && fragment_info(next)->offset == offset &&
+	    fragment_info(next)->len == len) {
+		return -EALREADY;
+	}
+
+	if (next && (!more || offset + len > fragment_info(next)->offset)) {
+		return -EINVAL;
+	}
+
+	buf = fragment_detach(pkt, hdr_len);
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	fragment_info(buf)->offset = offset;
+	fragment_info(buf)->len = len;
+
+	reass->len += len;
+	reassembly_add_mem(reass, buf_chain_mem(buf));
+
+	net_buf_frag_last(buf)->frags = next;
+
+	if (prev) {
+		prev->frags = buf;
+	} else {
+		reass->frags = buf;
+	}
+
+	net_pkt_unref(pkt);
+
+	return 0;
+}
+
+struct net_pkt *net_reassembly_take(struct net_reassembly *reass)
+{
+	struct net_pkt *pkt = reass->pkt;
+
+	NET_ASSERT(pkt);
+
+	/* The payload of the other fragments is already in order and
+	 * without headers, so it is attached as such to the first one.
+	 */
+	net_buf_frag_last(pkt->buffer)->frags = reass->frags;
+
+	reass->pkt = NULL;
+	reass->frags = NULL;
+
+	net_reassembly_cancel(reass);
+
+	return pkt;
+}
@@ -0,0 +1,197 @@
+/** @file
+ * @brief IP fragment reassembly shared by IPv4 and IPv6
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __NET_REASSEMBLY_H
+#define __NET_REASSEMBLY_H
+
+#include <zephyr/types.h>
+#include <kernel.h>
+#include <misc/slist.h>
+#include <net/net_pkt.h>
+
+struct net_reassembly_table;
+
+/** Pending reassembly of one packet, embedded in the IPv4 and IPv6
+ * specific structs that add the fragment identification.
+ */
+struct net_reassembly {
+	/** Node in the hash table, or in the free list if not used */
+	sys_snode_t node;
+
+	/** Timeout for cancelling the reassembly */
+	struct k_delayed_work timer;
+
+	/** Table the reassembly belongs to */
+	struct net_reassembly_table *table;
+
+	/** First fragment with the IP headers, NULL until it is received */
+	struct net_pkt *pkt;
+
+	/**
+	 * Payload of the other fragments, sorted by fragment offset. The
+	 * first buffer of each fragment stores the offset and the length
+	 * of the fragment in its user data.
+	 */
+	struct net_buf *frags;
+
+	/** Size of the network buffers held by the reassembly */
+	u32_t mem;
+
+	/** Payload length received so far */
+	u32_t len;
+
+	/** Payload length of the packet, 0 until the last fragment is seen */
+	u32_t total_len;
+
+	/** Payload length of the first fragment */
+	u16_t first_len;
+
+	/** Hash table bucket of the reassembly */
+	u16_t bucket;
+};
+
+/** Pending reassemblies of one IP version */
+struct net_reassembly_table {
+	/** Protects the table, which is used both from the RX path and
+	 * from the timeout handler.
+	 */
+	struct k_mutex lock;
+
+	/** Pending reassemblies, hashed by fragment id and addresses */
+	sys_slist_t *hash;
+
+	/** Unused reassemblies */
+	sys_slist_t free;
+
+	/** Size of the network buffers held by all the reassemblies */
+	u32_t mem;
+
+	/** Limit for mem */
+	u32_t max_mem;
+
+	/** How long to wait for the rest of the fragments */
+	s32_t timeout;
+
+	/** Number of buckets in hash */
+	u16_t hash_size;
+
+	/** Whether net_reassembly_table_init() has been called */
+	bool init_done;
+};
+
+#define NET_REASSEMBLY_TABLE_INITIALIZER(obj, _hash, _max_mem, _timeout) \
+	{								\
+		.lock = _K_MUTEX_INITIALIZER(obj.lock),			\
+		.hash = _hash,						\
+		.max_mem = _max_mem,					\
+		.timeout = _timeout,					\
+		.hash_size = ARRAY_SIZE(_hash),				\
+	}
+
+/**
+ * @brief Initialize the hash table and the free list. Must be called
+ * with the table lock held, before the reassemblies are added with
+ * net_reassembly_slot_init().
+ *
+ * @param table Reassembly table
+ */
+void net_reassembly_table_init(struct net_reassembly_table *table);
+
+/**
+ * @brief Add an unused reassembly to the table.
+ *
+ * @param table Reassembly table
+ * @param reass Reassembly
+ */
+void net_reassembly_slot_init(struct net_reassembly_table *table,
+			      struct net_reassembly *reass);
+
+/**
+ * @brief Hash table bucket for the given hash of the fragment id and
+ * addresses.
+ *
+ * @param table Reassembly table
+ * @param hash Hash of the fields identifying the packet
+ *
+ * @return Bucket index
+ */
+u16_t net_reassembly_bucket(struct net_reassembly_table *table, u32_t hash);
+
+/**
+ * @brief Take an unused reassembly into use and start its timer. The
+ * caller sets the fields that identify the packet.
+ *
+ * @param table Reassembly table
+ * @param bucket Hash table bucket, from net_reassembly_bucket()
+ *
+ * @return Reassembly, or NULL if all of them are in use
+ */
+struct net_reassembly *net_reassembly_alloc(struct net_reassembly_table *table,
+					    u16_t bucket);
+
+/**
+ * @brief Free the fragments of a reassembly and return it to the free
+ * list.
+ *
+ * @param reass Reassembly
+ */
+void net_reassembly_cancel(struct net_reassembly *reass);
+
+/**
+ * @brief Store a fragment. The fragment at offset 0 is kept as is, the
+ * headers of the others are removed. A fragment that overlaps an already
+ * received one is refused, so is data after the last fragment.
+ *
+ * @param reass Reassembly
+ * @param pkt Fragment, owned by the reassembly on success
+ * @param hdr_len Length of the IP headers of the fragment
+ * @param offset Fragment offset
+ * @param len Payload length of the fragment
+ * @param more Whether more fragments follow this one
+ *
+ * @return 0 if stored, -EALREADY if the same fragment has already been
+ * received, other negative errno if the reassembly should be cancelled.
+ */
+int net_reassembly_add(struct net_reassembly *reass, struct net_pkt *pkt,
+		       u16_t hdr_len, u16_t offset, u16_t len, bool more);
+
+/**
+ * @brief Discard the oldest reassemblies until the buffers held by all
+ * of them fit in the memory limit of the table.
+ *
+ * @param current Reassembly that got the latest fragment
+ *
+ * @return False if the current reassembly had to be discarded too.
+ */
+bool net_reassembly_limit_mem(struct net_reassembly *current);
+
+/**
+ * @brief Check if all the fragments have been received.
+ *
+ * @param reass Reassembly
+ *
+ * @return True if the packet can be reassembled.
+ */
+static inline bool net_reassembly_is_complete(struct net_reassembly *reass)
+{
+	return reass->pkt && reass->len == reass->total_len;
+}
+
+/**
+ * @brief Attach the payload of the other fragments to the first one and
+ * free the reassembly. The caller fixes the IP headers.
+ *
+ * @param reass Complete reassembly
+ *
+ * @return First fragment, now carrying all of the payload
+ */
+struct net_pkt *net_reassembly_take(struct net_reassembly *reass);
+
+#endif /* __NET_REASSEMBLY_H */
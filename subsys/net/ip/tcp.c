@@ -52,6 +52,8 @@ static struct tcp_backlog_entry {
 	struct k_delayed_work ack_timer;
 	struct sockaddr remote;
 	u16_t send_mss;
+	u8_t send_wnd_scale;
+	u8_t recv_wnd_scale;
 } tcp_backlog[CONFIG_NET_TCP_BACKLOG_SIZE];
 
 #if defined(CONFIG_NET_TCP_ACK_TIMEOUT)
@@ -62,6 +64,21 @@ static struct tcp_backlog_entry {
 
 #define FIN_TIMEOUT K_SECONDS(1)
 
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+#define DELAYED_ACK_TIMEOUT K_MSEC(CONFIG_NET_TCP_DELAYED_ACK_TIMEOUT)
+#endif
+
+/* Memory available for received data. The autotuned receive window of
+ * a single connection is limited to half of it.
+ */
+#if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
+#define RX_BUF_BUDGET (CONFIG_NET_BUF_RX_COUNT * CONFIG_NET_BUF_DATA_SIZE)
+#else
+#define RX_BUF_BUDGET CONFIG_NET_BUF_DATA_POOL_SIZE
+#endif
+
+#define AUTOTUNE_MAX_WND (RX_BUF_BUDGET / 2)
+
 /* Declares a wrapper function for a net_conn callback that refs the
  * context around the invocation (to protect it from premature
  * deletion).  Long term would be nice to see this feature be part of
@@ -282,8 +299,19 @@ struct net_tcp *net_tcp_alloc(struct net_context *context)
 	tcp_context[i].context = context;
 
 	tcp_context[i].send_seq = tcp_init_isn();
-	tcp_context[i].recv_wnd = MIN(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
+	tcp_context[i].recv_wnd_max = CONFIG_NET_TCP_RECV_WINDOW_SIZE;
+	if (!IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE)) {
+		tcp_context[i].recv_wnd_max =
+			MIN(tcp_context[i].recv_wnd_max, UINT16_MAX);
+	}
+
+	tcp_context[i].recv_wnd = tcp_context[i].recv_wnd_max;
+	tcp_context[i].send_wnd = UINT16_MAX;
+	tcp_context[i].send_buf_max = CONFIG_NET_TCP_SEND_WINDOW_SIZE;
 	tcp_context[i].send_mss = NET_TCP_DEFAULT_MSS;
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	tcp_context[i].quickack = CONFIG_NET_TCP_QUICKACK_SEGMENTS;
+#endif
 
 	tcp_context[i].accept_cb = NULL;
 
@@ -313,6 +341,38 @@ static void timewait_timer_cancel(struct net_tcp *tcp)
 	k_delayed_work_cancel(&tcp->timewait_timer);
 }
 
+static void delayed_ack_timer_cancel(struct net_tcp *tcp)
+{
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	k_delayed_work_cancel(&tcp->delayed_ack_timer);
+#endif
+}
+
+#if defined(CONFIG_NET_TCP_GRO)
+/* Must be called before tcp->context is cleared, the timer may already
+ * be running and it checks the context before flushing.
+ */
+static void tcp_gro_drop(struct net_tcp *tcp)
+{
+	k_delayed_work_cancel(&tcp->gro_timer);
+
+	if (tcp->gro_pkt) {
+		net_pkt_unref(tcp->gro_pkt);
+		tcp->gro_pkt = NULL;
+		tcp->gro_len = 0U;
+	}
+}
+
+/* Data held back for merging is not yet accounted for in recv_wnd */
+static inline u32_t gro_held_len(const struct net_tcp *tcp)
+{
+	return tcp->gro_len;
+}
+#else
+#define tcp_gro_drop(...)
+#define gro_held_len(...) 0
+#endif /* CONFIG_NET_TCP_GRO */
+
 int net_tcp_release(struct net_tcp *tcp)
 {
 	struct net_pkt *pkt;
@@ -335,6 +395,8 @@ int net_tcp_release(struct net_tcp *tcp)
 	ack_timer_cancel(tcp);
 	fin_timer_cancel(tcp);
 	timewait_timer_cancel(tcp);
+	delayed_ack_timer_cancel(tcp);
+	tcp_gro_drop(tcp);
 
 	net_tcp_change_state(tcp, NET_TCP_CLOSED);
 	tcp->context = NULL;
@@ -509,6 +571,64 @@ u32_t net_tcp_get_recv_wnd(const struct net_tcp *tcp)
 	return tcp->recv_wnd;
 }
 
+static inline u8_t recv_wnd_scale(const struct net_tcp *tcp)
+{
+	return (tcp->flags & NET_TCP_WND_SCALE) ? tcp->recv_wnd_scale : 0;
+}
+
+/* Largest receive window that can be advertised on this connection */
+static u32_t max_recv_wnd(const struct net_tcp *tcp)
+{
+	if (!IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE)) {
+		return UINT16_MAX;
+	}
+
+	/* The scale is not fixed until the SYN has been sent */
+	if (net_tcp_get_state(tcp) == NET_TCP_CLOSED ||
+	    net_tcp_get_state(tcp) == NET_TCP_LISTEN) {
+		return (u32_t)UINT16_MAX << NET_TCP_MAX_WND_SCALE;
+	}
+
+	return (u32_t)UINT16_MAX << recv_wnd_scale(tcp);
+}
+
+/* Shift count needed to advertise the largest window this connection
+ * may use, including the autotuned one.
+ */
+static u8_t calc_recv_wnd_scale(const struct net_tcp *tcp)
+{
+	u32_t wnd = tcp->recv_wnd_max;
+	u8_t scale = 0U;
+
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_AUTOTUNE) &&
+	    !(tcp->flags & NET_TCP_RECV_BUF_LOCKED)) {
+		wnd = MAX(wnd, AUTOTUNE_MAX_WND);
+	}
+
+	while (scale < NET_TCP_MAX_WND_SCALE && (wnd >> scale) > UINT16_MAX) {
+		scale++;
+	}
+
+	return scale;
+}
+
+/* Window scaling is in use only if both ends sent the option */
+static void set_wnd_scale(struct net_tcp *tcp, u8_t peer_scale)
+{
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+	    peer_scale != NET_TCP_NO_WND_SCALE) {
+		tcp->flags |= NET_TCP_WND_SCALE;
+		tcp->send_wnd_scale = peer_scale;
+		return;
+	}
+
+	tcp->flags &= ~NET_TCP_WND_SCALE;
+	tcp->send_wnd_scale = 0U;
+	tcp->recv_wnd_scale = 0U;
+	tcp->recv_wnd_max = MIN(tcp->recv_wnd_max, UINT16_MAX);
+	tcp->recv_wnd = MIN(tcp->recv_wnd, tcp->recv_wnd_max);
+}
+
 int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
 			    void *options, size_t optlen,
 			    const struct sockaddr_ptr *local,
@@ -562,7 +682,13 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
 		}
 	}
 
-	wnd = net_tcp_get_recv_wnd(tcp);
+	/* The window in a SYN segment is never scaled (RFC 7323) */
+	if (flags & NET_TCP_SYN) {
+		wnd = MIN(net_tcp_get_recv_wnd(tcp), UINT16_MAX);
+	} else {
+		wnd = MIN((net_tcp_get_recv_wnd(tcp) - gro_held_len(tcp)) >>
+			  recv_wnd_scale(tcp), UINT16_MAX);
+	}
 
 	segment.src_addr = (struct sockaddr_ptr *)local;
 	segment.dst_addr = remote;
@@ -676,6 +802,16 @@ static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 	*optionlen += NET_TCP_MSS_SIZE;
 }
 
+static void net_tcp_set_wnd_scale_opt(struct net_tcp *tcp, u8_t *options,
+				      u8_t *optionlen)
+{
+	/* Prefix with NOP so that the options stay 4-byte aligned */
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_OPT;
+	options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_SIZE;
+	options[(*optionlen)++] = tcp->recv_wnd_scale;
+}
+
 int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 			struct net_pkt **pkt)
 {
@@ -918,6 +1054,9 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 
 	ctx->tcp->sent_ack = ctx->tcp->send_ack;
 
+	/* Any pending delayed ACK is carried by this segment */
+	delayed_ack_timer_cancel(ctx->tcp);
+
 	/* We must have special handling for some network technologies that
 	 * tweak the IP protocol headers during packet sending. This happens
 	 * with Bluetooth and IEEE 802.15.4 which use IPv6 header compression
@@ -990,22 +1129,241 @@ static void restart_timer(struct net_tcp *tcp)
 	}
 }
 
+/* Data queued by net_tcp_queue_data() never carries TCP options */
+static inline size_t sent_pkt_data_len(struct net_pkt *pkt)
+{
+	return net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		net_pkt_ipv6_ext_len(pkt) - NET_TCPH_LEN;
+}
+
+/* Amount of unacknowledged data allowed in flight */
+static inline u32_t send_wnd(const struct net_tcp *tcp)
+{
+	if (tcp->send_buf_max) {
+		return MIN(tcp->send_wnd, tcp->send_buf_max);
+	}
+
+	return tcp->send_wnd;
+}
+
+#if defined(CONFIG_NET_TCP_GSO)
+/* Largest segment that fits into the interface MTU and the peer MSS */
+static u16_t gso_mss(struct net_context *context)
+{
+	u16_t mtu = net_if_get_mtu(net_context_get_iface(context));
+	u16_t hdr_len;
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) &&
+	    net_context_get_family(context) == AF_INET6) {
+		mtu = MAX(mtu, NET_IPV6_MTU);
+		hdr_len = NET_IPV6TCPH_LEN;
+	} else {
+		mtu = MAX(mtu, NET_IPV4_MTU);
+		hdr_len = NET_IPV4TCPH_LEN;
+	}
+
+	return MIN(context->tcp->send_mss, mtu - hdr_len);
+}
+
+u16_t net_tcp_gso_size(struct net_context *context, size_t *len)
+{
+	struct net_tcp *tcp = context->tcp;
+	u32_t in_flight = 0U;
+	struct net_pkt *pkt;
+	size_t max_len;
+	u16_t mss;
+	u32_t wnd;
+
+	mss = gso_mss(context);
+	if (*len <= mss) {
+		return 0;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		in_flight += sent_pkt_data_len(pkt);
+	}
+
+	/* A GSO packet must fit into the send window as a whole,
+	 * otherwise send the data in the usual way.
+	 */
+	wnd = send_wnd(tcp);
+	if (in_flight >= wnd) {
+		return 0;
+	}
+
+	max_len = MIN(wnd - in_flight, CONFIG_NET_TCP_GSO_MAX_SIZE);
+	if (max_len <= mss) {
+		return 0;
+	}
+
+	*len = MIN(*len, max_len);
+
+	return mss;
+}
+
+static struct net_pkt *gso_build_segment(struct net_pkt *pkt, size_t hdr_len,
+					 size_t offset, size_t len, bool last)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_tcp_hdr *tcp_hdr;
+	struct net_pkt *seg;
+
+	seg = net_pkt_alloc_with_buffer(net_pkt_iface(pkt), hdr_len + len,
+					AF_UNSPEC, 0, ALLOC_TIMEOUT);
+	if (!seg) {
+		return NULL;
+	}
+
+	net_pkt_set_family(seg, net_pkt_family(pkt));
+	net_pkt_set_context(seg, net_pkt_context(pkt));
+	net_pkt_set_ip_hdr_len(seg, net_pkt_ip_hdr_len(pkt));
+	net_pkt_set_priority(seg, net_pkt_priority(pkt));
+	net_pkt_set_vlan_tag(seg, net_pkt_vlan_tag(pkt));
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(pkt) == AF_INET6) {
+		net_pkt_set_ipv6_ext_len(seg, net_pkt_ipv6_ext_len(pkt));
+		net_pkt_set_ipv6_next_hdr(seg, net_pkt_ipv6_next_hdr(pkt));
+	}
+
+	/* Same headers, then this segment's part of the data */
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_copy(seg, pkt, hdr_len) ||
+	    net_pkt_skip(pkt, offset) ||
+	    net_pkt_copy(seg, pkt, len)) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(seg);
+	net_pkt_set_overwrite(seg, true);
+
+	if (net_pkt_skip(seg, net_pkt_ip_hdr_len(seg) +
+			 net_pkt_ipv6_ext_len(seg))) {
+		goto fail;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(seg, &tcp_access);
+	if (!tcp_hdr) {
+		goto fail;
+	}
+
+	sys_put_be32(sys_get_be32(tcp_hdr->seq) + offset, tcp_hdr->seq);
+
+	/* Like a device doing TSO, only the last segment keeps PSH */
+	if (!last) {
+		tcp_hdr->flags &= ~NET_TCP_PSH;
+	}
+
+	if (net_pkt_set_data(seg, &tcp_access) ||
+	    finalize_segment(seg) < 0) {
+		goto fail;
+	}
+
+	return seg;
+
+fail:
+	net_pkt_unref(seg);
+
+	return NULL;
+}
+
+int net_tcp_gso_segment(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	u16_t mss = net_pkt_gso_size(pkt);
+	struct net_tcp_hdr *tcp_hdr;
+	size_t data_len;
+	size_t hdr_len;
+	size_t offset;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ipv6_ext_len(pkt);
+	if (net_pkt_skip(pkt, hdr_len)) {
+		return -ENOBUFS;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(pkt, &tcp_access);
+	if (!tcp_hdr) {
+		return -ENOBUFS;
+	}
+
+	hdr_len += NET_TCP_HDR_LEN(tcp_hdr);
+	data_len = net_pkt_get_len(pkt) - hdr_len;
+
+	for (offset = 0; offset < data_len; offset += mss) {
+		size_t len = MIN(mss, data_len - offset);
+		struct net_pkt *seg;
+
+		seg = gso_build_segment(pkt, hdr_len, offset, len,
+					offset + len == data_len);
+		if (!seg) {
+			if (!offset) {
+				return -ENOMEM;
+			}
+
+			/* The rest is sent when the packet is resent */
+			break;
+		}
+
+		NET_DBG("pkt %p segment %p offset %zu len %zu", pkt, seg,
+			offset, len);
+
+		if (net_send_data(seg) < 0) {
+			net_pkt_unref(seg);
+			break;
+		}
+
+		/* Let the segment go out so its buffers can be reused
+		 * for the next one.
+		 */
+		k_yield();
+	}
+
+	/* As with IPv6 fragmentation, "fake" the sending of the packet
+	 * so that tcp_retry_expired() takes a new reference when the
+	 * packet is resent.
+	 */
+	net_pkt_set_sent(pkt, true);
+	net_pkt_unref(pkt);
+
+	return 0;
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
 		      void *user_data)
 {
+	u32_t wnd = send_wnd(context->tcp);
+	u32_t in_flight = 0U;
 	struct net_pkt *pkt;
 
-	/* For now, just send all queued data synchronously.  Need to
-	 * add window handling and retry/ACK logic.
+	/* Send the queued data that fits into the send window. The rest
+	 * stays queued and is sent when ACKs open the window again.
 	 */
 	SYS_SLIST_FOR_EACH_CONTAINER(&context->tcp->sent_list, pkt, sent_list) {
+		size_t data_len = sent_pkt_data_len(pkt);
+
 		/* Do not resend packets that were sent by expire timer */
 		if (net_pkt_queued(pkt)) {
 			NET_DBG("[%p] Skipping pkt %p because it was already "
 				"sent.", context->tcp, pkt);
+			in_flight += data_len;
 			continue;
 		}
 
+		/* Always allow one segment so that a window smaller than
+		 * the segment cannot stall the connection.
+		 */
+		if (in_flight && in_flight + data_len > wnd) {
+			NET_DBG("[%p] Window full (%u/%u), holding pkt %p",
+				context->tcp, in_flight, wnd, pkt);
+			break;
+		}
+
+		in_flight += data_len;
+
 		if (!net_pkt_sent(pkt)) {
 			int ret;
 
@@ -1336,6 +1694,21 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 				goto error;
 			}
 
+			break;
+		case NET_TCP_WINDOW_SCALE_OPT:
+			if (optlen != 1U) {
+				goto error;
+			}
+
+			if (net_pkt_read_u8(pkt, &opts->wnd_scale)) {
+				goto error;
+			}
+
+			/* RFC 7323 ch 2.3: use 14 if a larger shift is sent */
+			if (opts->wnd_scale > NET_TCP_MAX_WND_SCALE) {
+				opts->wnd_scale = NET_TCP_MAX_WND_SCALE;
+			}
+
 			break;
 		default:
 			if (net_pkt_skip(pkt, optlen)) {
@@ -1418,25 +1791,138 @@ int net_tcp_listen(struct net_context *context)
 	return -EOPNOTSUPP;
 }
 
+static int send_ack(struct net_context *context,
+		    struct sockaddr *remote, bool force);
+
+/* Double the receive window if the peer was limited by it and the
+ * application has now read all the queued data.
+ */
+static void autotune_recv_wnd(struct net_tcp *tcp)
+{
+	u32_t new_max;
+
+	if (!IS_ENABLED(CONFIG_NET_TCP_WINDOW_AUTOTUNE) ||
+	    (tcp->flags & NET_TCP_RECV_BUF_LOCKED)) {
+		return;
+	}
+
+	new_max = MIN(tcp->recv_wnd_max * 2U,
+		      MIN((u32_t)AUTOTUNE_MAX_WND, max_recv_wnd(tcp)));
+	if (new_max <= tcp->recv_wnd_max) {
+		return;
+	}
+
+	NET_DBG("[%p] recv window %u => %u", tcp, tcp->recv_wnd_max, new_max);
+
+	tcp->recv_wnd += new_max - tcp->recv_wnd_max;
+	tcp->recv_wnd_max = new_max;
+}
+
 int net_tcp_update_recv_wnd(struct net_context *context, s32_t delta)
 {
-	s32_t new_win;
+	struct net_tcp *tcp = context->tcp;
+	s64_t new_win;
+	u32_t old_win;
 
-	if (!context->tcp) {
+	if (!tcp) {
 		NET_ERR("context->tcp == NULL");
 		return -EPROTOTYPE;
 	}
 
-	new_win = context->tcp->recv_wnd + delta;
-	if (new_win < 0 || new_win > UINT16_MAX) {
+	old_win = tcp->recv_wnd;
+
+	new_win = (s64_t)old_win + delta;
+	if (new_win < 0 || new_win > tcp->recv_wnd_max) {
+		return -EINVAL;
+	}
+
+	tcp->recv_wnd = new_win;
+
+	if (delta < 0) {
+		if (tcp->recv_wnd < tcp->send_mss) {
+			tcp->flags |= NET_TCP_RECV_WND_LIMITED;
+		}
+
+		return 0;
+	}
+
+	if ((tcp->flags & NET_TCP_RECV_WND_LIMITED) &&
+	    tcp->recv_wnd == tcp->recv_wnd_max) {
+		tcp->flags &= ~NET_TCP_RECV_WND_LIMITED;
+		autotune_recv_wnd(tcp);
+	}
+
+	/* Let the peer know that the window has opened again, otherwise
+	 * it would only find out by probing.
+	 */
+	if (old_win < tcp->send_mss && tcp->recv_wnd >= tcp->send_mss &&
+	    net_tcp_get_state(tcp) == NET_TCP_ESTABLISHED) {
+		send_ack(context, &context->remote, true);
+	}
+
+	return 0;
+}
+
+int net_tcp_set_recv_buf(struct net_context *context, int size)
+{
+	struct net_tcp *tcp = context->tcp;
+	u32_t new_max, queued;
+
+	if (!tcp) {
+		return -EPROTOTYPE;
+	}
+
+	if (size <= 0) {
+		return -EINVAL;
+	}
+
+	new_max = MAX((u32_t)size, NET_TCP_DEFAULT_MSS);
+	new_max = MIN(new_max, max_recv_wnd(tcp));
+
+	/* Data already queued for the application cannot be given back */
+	queued = tcp->recv_wnd_max - tcp->recv_wnd;
+	new_max = MAX(new_max, queued);
+
+	tcp->recv_wnd = new_max - queued;
+	tcp->recv_wnd_max = new_max;
+	tcp->flags |= NET_TCP_RECV_BUF_LOCKED;
+
+	return 0;
+}
+
+int net_tcp_get_recv_buf(struct net_context *context)
+{
+	if (!context->tcp) {
+		return -EPROTOTYPE;
+	}
+
+	return context->tcp->recv_wnd_max;
+}
+
+int net_tcp_set_send_buf(struct net_context *context, int size)
+{
+	if (!context->tcp) {
+		return -EPROTOTYPE;
+	}
+
+	if (size < 0) {
 		return -EINVAL;
 	}
 
-	context->tcp->recv_wnd = new_win;
+	context->tcp->send_buf_max = size;
 
 	return 0;
 }
 
+int net_tcp_get_send_buf(struct net_context *context)
+{
+	if (!context->tcp) {
+		return -EPROTOTYPE;
+	}
+
+	return context->tcp->send_buf_max;
+}
+
 static int send_reset(struct net_context *context, struct sockaddr *local,
 		      struct sockaddr *remote);
 
@@ -1555,7 +2041,7 @@ static int tcp_backlog_syn(struct net_pkt *pkt,
 			   union net_ip_header *ip_hdr,
 			   struct net_tcp_hdr *tcp_hdr,
 			   struct net_context *context,
-			   u16_t send_mss)
+			   u16_t send_mss, u8_t send_wnd_scale)
 {
 	int empty_slot = -1;
 
@@ -1575,6 +2061,8 @@ static int tcp_backlog_syn(struct net_pkt *pkt,
 	tcp_backlog[empty_slot].send_seq = context->tcp->send_seq;
 	tcp_backlog[empty_slot].send_ack = context->tcp->send_ack;
 	tcp_backlog[empty_slot].send_mss = send_mss;
+	tcp_backlog[empty_slot].send_wnd_scale = send_wnd_scale;
+	tcp_backlog[empty_slot].recv_wnd_scale = context->tcp->recv_wnd_scale;
 
 	k_delayed_work_init(&tcp_backlog[empty_slot].ack_timer,
 			    backlog_ack_timeout);
@@ -1606,6 +2094,11 @@ static int tcp_backlog_ack(struct net_pkt *pkt,
 	context->tcp->send_ack = tcp_backlog[r].send_ack;
 	context->tcp->send_mss = tcp_backlog[r].send_mss;
 
+	context->tcp->recv_wnd_scale = tcp_backlog[r].recv_wnd_scale;
+	set_wnd_scale(context->tcp, tcp_backlog[r].send_wnd_scale);
+	context->tcp->send_wnd = (u32_t)sys_get_be16(tcp_hdr->wnd) <<
+				 context->tcp->send_wnd_scale;
+
 	k_delayed_work_cancel(&tcp_backlog[r].ack_timer);
 	(void)memset(&tcp_backlog[r], 0, sizeof(struct tcp_backlog_entry));
 
@@ -1644,6 +2137,27 @@ static void handle_fin_timeout(struct k_work *work)
 	net_context_unref(tcp->context);
 }
 
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+static void handle_delayed_ack_timeout(struct k_work *work)
+{
+	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp,
+					   delayed_ack_timer);
+	struct net_context *context = tcp->context;
+
+	if (!context) {
+		return;
+	}
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	if (context->tcp == tcp) {
+		send_ack(context, &context->remote, false);
+	}
+
+	k_mutex_unlock(&context->lock);
+}
+#endif
+
 static void handle_ack_timeout(struct k_work *work)
 {
 	/* This means that we did not receive ACK response in time. */
@@ -1688,6 +2202,142 @@ static void handle_timewait_timeout(struct k_work *work)
 	}
 }
 
+#if defined(CONFIG_NET_TCP_GRO)
+/* Detach the data of a received segment from its headers */
+static struct net_buf *gro_take_data(struct net_pkt *pkt)
+{
+	struct net_buf *buf = pkt->buffer;
+	struct net_buf *data = pkt->cursor.buf;
+
+	while (buf != data) {
+		buf = net_buf_frag_del(NULL, buf);
+	}
+
+	net_buf_pull(data, pkt->cursor.pos - data->data);
+	if (!data->len) {
+		data = net_buf_frag_del(NULL, data);
+	}
+
+	pkt->buffer = NULL;
+	net_pkt_cursor_init(pkt);
+
+	return data;
+}
+
+/* Pass the merged segments to the application */
+static void tcp_gro_flush(struct net_context *context)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_tcp *tcp = context->tcp;
+	struct net_pkt *pkt = tcp->gro_pkt;
+	union net_proto_header proto_hdr;
+	struct net_pkt_cursor backup;
+	union net_ip_header ip_hdr;
+
+	if (!pkt) {
+		return;
+	}
+
+	k_delayed_work_cancel(&tcp->gro_timer);
+
+	tcp->gro_pkt = NULL;
+	tcp->gro_len = 0U;
+
+	/* The first segment still has its headers, the receive callback
+	 * gets those.
+	 */
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(pkt) == AF_INET6) {
+		ip_hdr.ipv6 = NET_IPV6_HDR(pkt);
+	} else {
+		ip_hdr.ipv4 = NET_IPV4_HDR(pkt);
+	}
+
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) + net_pkt_ipv6_ext_len(pkt));
+	proto_hdr.tcp = (struct net_tcp_hdr *)net_pkt_get_data(pkt,
+							       &tcp_access);
+	net_pkt_cursor_restore(pkt, &backup);
+
+	if (!proto_hdr.tcp ||
+	    net_context_packet_received(
+		    (struct net_conn *)context->conn_handler, pkt, &ip_hdr,
+		    &proto_hdr, tcp->recv_user_data) == NET_DROP) {
+		net_pkt_unref(pkt);
+	}
+}
+
+static void tcp_gro_timeout(struct k_work *work)
+{
+	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, gro_timer);
+	struct net_context *context = tcp->context;
+
+	if (!context) {
+		return;
+	}
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	if (context->tcp == tcp) {
+		tcp_gro_flush(context);
+	}
+
+	k_mutex_unlock(&context->lock);
+}
+
+/* Hold back in-order segments and merge them, so that the application
+ * gets one packet instead of many small ones.
+ */
+static enum net_verdict tcp_gro_receive(struct net_context *context,
+					struct net_conn *conn,
+					struct net_pkt *pkt,
+					union net_ip_header *ip_hdr,
+					union net_proto_header *proto_hdr,
+					u16_t data_len, u8_t tcp_flags)
+{
+	struct net_tcp *tcp = context->tcp;
+	bool flush = tcp_flags & (NET_TCP_PSH | NET_TCP_FIN | NET_TCP_URG);
+
+	if (tcp->gro_pkt &&
+	    tcp->gro_len + data_len > CONFIG_NET_TCP_GRO_MAX_SIZE) {
+		tcp_gro_flush(context);
+	}
+
+	if (!tcp->gro_pkt) {
+		if (flush) {
+			return net_context_packet_received(conn, pkt, ip_hdr,
+							   proto_hdr,
+							   tcp->recv_user_data);
+		}
+
+		tcp->gro_pkt = pkt;
+		tcp->gro_len = data_len;
+
+		k_delayed_work_submit(&tcp->gro_timer,
+				      K_MSEC(CONFIG_NET_TCP_GRO_TIMEOUT));
+
+		return NET_OK;
+	}
+
+	net_pkt_append_buffer(tcp->gro_pkt, gro_take_data(pkt));
+	tcp->gro_len += data_len;
+	net_pkt_unref(pkt);
+
+	NET_DBG("[%p] Merged %u bytes, %u bytes held", tcp, data_len,
+		tcp->gro_len);
+
+	if (flush || tcp->gro_len >= CONFIG_NET_TCP_GRO_MAX_SIZE) {
+		tcp_gro_flush(context);
+	}
+
+	return NET_OK;
+}
+#else
+#define tcp_gro_flush(...)
+#endif /* CONFIG_NET_TCP_GRO */
+
 int net_tcp_get(struct net_context *context)
 {
 	context->tcp = net_tcp_alloc(context);
@@ -1700,6 +2350,13 @@ int net_tcp_get(struct net_context *context)
 	k_delayed_work_init(&context->tcp->fin_timer, handle_fin_timeout);
 	k_delayed_work_init(&context->tcp->timewait_timer,
 			    handle_timewait_timeout);
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	k_delayed_work_init(&context->tcp->delayed_ack_timer,
+			    handle_delayed_ack_timeout);
+#endif
+#if defined(CONFIG_NET_TCP_GRO)
+	k_delayed_work_init(&context->tcp->gro_timer, tcp_gro_timeout);
+#endif
 
 	return 0;
 }
@@ -1796,6 +2453,17 @@ static inline int send_syn_segment(struct net_context *context,
 
 	if (flags == NET_TCP_SYN) {
 		net_tcp_set_syn_opt(context->tcp, options, &optionlen);
+		context->tcp->recv_wnd_scale =
+			calc_recv_wnd_scale(context->tcp);
+	}
+
+	/* Window scale is offered in SYN, but in SYN-ACK only if the peer
+	 * offered it too.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+	    (flags == NET_TCP_SYN ||
+	     (context->tcp->flags & NET_TCP_WND_SCALE))) {
+		net_tcp_set_wnd_scale_opt(context->tcp, options, &optionlen);
 	}
 
 	ret = net_tcp_prepare_segment(context->tcp, flags, options, optionlen,
@@ -1857,11 +2525,54 @@ static int send_ack(struct net_context *context,
 	ret = net_tcp_send_pkt(pkt);
 	if (ret < 0) {
 		net_pkt_unref(pkt);
+		return ret;
 	}
 
+	context->tcp->acks_sent++;
+
 	return ret;
 }
 
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+/* Acknowledge received data as described in RFC 1122 ch. 4.2.3.2: at
+ * least every second full-sized segment is acked, and the ACK is never
+ * delayed longer than CONFIG_NET_TCP_DELAYED_ACK_TIMEOUT.
+ */
+static void ack_received_data(struct net_context *context,
+			      struct sockaddr *remote, u8_t tcp_flags)
+{
+	struct net_tcp *tcp = context->tcp;
+
+	if (tcp->send_ack == tcp->sent_ack) {
+		return;
+	}
+
+	if (tcp->quickack > 0) {
+		tcp->quickack--;
+		goto send;
+	}
+
+	if ((tcp_flags & (NET_TCP_PSH | NET_TCP_FIN)) ||
+	    tcp->send_ack - tcp->sent_ack >=
+	    2U * net_tcp_get_recv_mss(tcp)) {
+		goto send;
+	}
+
+	if (!k_delayed_work_remaining_get(&tcp->delayed_ack_timer)) {
+		k_delayed_work_submit(&tcp->delayed_ack_timer,
+				      DELAYED_ACK_TIMEOUT);
+	}
+
+	return;
+
+send:
+	send_ack(context, remote, false);
+}
+#else
+#define ack_received_data(context, remote, tcp_flags)	\
+	send_ack(context, remote, false)
+#endif /* CONFIG_NET_TCP_DELAYED_ACK */
+
 static int send_reset(struct net_context *context,
 		      struct sockaddr *local,
 		      struct sockaddr *remote)
@@ -1938,6 +2649,14 @@ resend_ack:
 		 * match the next segment exactly, drop and wait for
 		 * retransmit
 		 */
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+		/* Tell the peer about the hole right away with a duplicate
+		 * ACK, and do not delay the ACKs until the data has been
+		 * recovered.
+		 */
+		context->tcp->quickack = CONFIG_NET_TCP_QUICKACK_SEGMENTS;
+		send_ack(context, &conn->remote_addr, true);
+#endif
 		ret = NET_DROP;
 		goto unlock;
 	}
@@ -1958,6 +2677,8 @@ resend_ack:
 
 		net_tcp_print_recv_info("RST", pkt, tcp_hdr->src_port);
 
+		tcp_gro_drop(context->tcp);
+
 		if (context->recv_cb) {
 			context->recv_cb(context, NULL, NULL, NULL, -ECONNRESET,
 					 context->tcp->recv_user_data);
@@ -1977,6 +2698,12 @@ resend_ack:
 			goto unlock;
 		}
 
+		context->tcp->send_wnd = (u32_t)sys_get_be16(tcp_hdr->wnd) <<
+					 context->tcp->send_wnd_scale;
+
+		/* The ACK may have opened the window for held back data */
+		net_tcp_send_data(context, NULL, NULL);
+
 		/* TCP state might be changed after maintaining the sent pkt
 		 * list, e.g., an ack of FIN is received.
 		 */
@@ -2019,7 +2746,8 @@ resend_ack:
 	}
 
 	data_len = net_pkt_remaining_data(pkt);
-	if (data_len > net_tcp_get_recv_wnd(context->tcp)) {
+	if (data_len + gro_held_len(context->tcp) >
+	    net_tcp_get_recv_wnd(context->tcp)) {
 		/* In case we have zero window, we should still accept
 		 * Zero Window Probes from peer, which per convention
 		 * come with len=1. Note that normally we need to check
@@ -2043,10 +2771,22 @@ resend_ack:
 	 * release the pkt. Otherwise, release the pkt immediately.
 	 */
 	if (data_len > 0) {
+		context->tcp->segs_received++;
+
+#if defined(CONFIG_NET_TCP_GRO)
+		ret = tcp_gro_receive(context, conn, pkt, ip_hdr, proto_hdr,
+				      data_len, tcp_flags);
+#else
 		ret = net_context_packet_received(conn, pkt, ip_hdr, proto_hdr,
 						  context->tcp->recv_user_data);
+#endif
 	} else if (data_len == 0U) {
 		net_pkt_unref(pkt);
+
+		/* Held back data must be delivered before the EOF */
+		if (tcp_flags & NET_TCP_FIN) {
+			tcp_gro_flush(context);
+		}
 	}
 
 	/* Increment the ack */
@@ -2055,7 +2795,7 @@ resend_ack:
 		context->tcp->send_ack += 1U;
 	}
 
-	send_ack(context, &conn->remote_addr, false);
+	ack_received_data(context, &conn->remote_addr, tcp_flags);
 
 clean_up:
 	if (net_tcp_get_state(context->tcp) == NET_TCP_TIME_WAIT) {
@@ -2138,8 +2878,23 @@ NET_CONN_CB(tcp_synack_received)
 		/* Remove the temporary connection handler and register
 		 * a proper now as we have an established connection.
 		 */
+		struct net_tcp_options tcp_opts = {
+			.mss = NET_TCP_DEFAULT_MSS,
+			.wnd_scale = NET_TCP_NO_WND_SCALE,
+		};
 		struct sockaddr local_addr;
 		struct sockaddr remote_addr;
+		int opt_totlen;
+
+		opt_totlen = NET_TCP_HDR_LEN(tcp_hdr)
+			     - sizeof(struct net_tcp_hdr);
+		if (net_tcp_parse_opts(pkt, opt_totlen, &tcp_opts) < 0) {
+			return NET_DROP;
+		}
+
+		set_wnd_scale(context->tcp, tcp_opts.wnd_scale);
+		context->tcp->send_wnd = sys_get_be16(tcp_hdr->wnd);
+		context->tcp->send_mss = tcp_opts.mss;
 
 		tcp_copy_ip_addr_from_hdr(net_pkt_family(pkt), ip_hdr, tcp_hdr,
 					  &remote_addr, true);
@@ -2153,6 +2908,7 @@ NET_CONN_CB(tcp_synack_received)
 				       &local_addr,
 				       ntohs(tcp_hdr->src_port),
 				       ntohs(tcp_hdr->dst_port),
+				       NULL,
 				       tcp_established,
 				       context,
 				       &context->conn_handler);
@@ -2267,6 +3023,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 	if (NET_TCP_FLAGS(tcp_hdr) == NET_TCP_SYN) {
 		struct net_tcp_options tcp_opts = {
 			.mss = NET_TCP_DEFAULT_MSS,
+			.wnd_scale = NET_TCP_NO_WND_SCALE,
 		};
 		int opt_totlen;
 		int r;
@@ -2289,10 +3046,24 @@ NET_CONN_CB(tcp_syn_rcvd)
 		context->tcp->send_ack =
 			sys_get_be32(tcp_hdr->seq) + 1;
 
+		/* The SYN-ACK carries our window scale only if the peer
+		 * offered one. This is per handshake state like the seq
+		 * and ack numbers, the accepted context takes it over from
+		 * the backlog.
+		 */
+		if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+		    tcp_opts.wnd_scale != NET_TCP_NO_WND_SCALE) {
+			tcp->flags |= NET_TCP_WND_SCALE;
+			tcp->recv_wnd_scale = calc_recv_wnd_scale(tcp);
+		} else {
+			tcp->flags &= ~NET_TCP_WND_SCALE;
+			tcp->recv_wnd_scale = 0U;
+		}
+
 		/* Get MSS from TCP options here*/
 
 		r = tcp_backlog_syn(pkt, ip_hdr, tcp_hdr,
-				    context, tcp_opts.mss);
+				    context, tcp_opts.mss, tcp_opts.wnd_scale);
 		if (r < 0) {
 			if (r == -EADDRINUSE) {
 				NET_DBG("TCP connection already exists");
@@ -2355,6 +3126,16 @@ NET_CONN_CB(tcp_syn_rcvd)
 			goto conndrop;
 		}
 
+		/* Accepted connections inherit the buffer sizes of the
+		 * listening one, the window scale sent in SYN-ACK was
+		 * calculated from them.
+		 */
+		new_context->tcp->recv_wnd_max = tcp->recv_wnd_max;
+		new_context->tcp->recv_wnd = tcp->recv_wnd_max;
+		new_context->tcp->send_buf_max = tcp->send_buf_max;
+		new_context->tcp->flags |= tcp->flags &
+					   NET_TCP_RECV_BUF_LOCKED;
+
 		ret = tcp_backlog_ack(pkt, ip_hdr, tcp_hdr, new_context);
 		if (ret < 0) {
 			NET_DBG("Cannot find context from TCP backlog");
@@ -2383,6 +3164,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 			       &local_addr,
 			       ntohs(net_sin(&new_context->remote)->sin_port),
 			       ntohs(net_sin(&local_addr)->sin_port),
+			       NULL,
 			       tcp_established,
 			       new_context,
 			       &new_context->conn_handler);
@@ -2494,12 +3276,14 @@ int net_tcp_accept(struct net_context *context,
 	}
 #endif /* CONFIG_NET_IPV4 */
 
+	/* The context is passed so that listeners can share the port */
 	ret = net_tcp_register(net_context_get_family(context),
 			       context->flags & NET_CONTEXT_REMOTE_ADDR_SET ?
 			       &context->remote : NULL,
 			       laddr,
 			       ntohs(net_sin(&context->remote)->sin_port),
 			       ntohs(lport),
+			       context,
 			       tcp_syn_rcvd,
 			       context,
 			       &context->conn_handler);
@@ -2542,6 +3326,7 @@ int net_tcp_connect(struct net_context *context,
 			       laddr,
 			       ntohs(rport),
 			       ntohs(lport),
+			       NULL,
 			       tcp_synack_received,
 			       context,
 			       &context->conn_handler);
@@ -29,7 +29,11 @@ extern "C" {
 /** Is this TCP context/socket used or not */
 #define NET_TCP_IN_USE BIT(0)
 
-/* BIT(1), BIT(2) are unused and available */
+/** Window scaling (RFC 7323) is in use on this connection */
+#define NET_TCP_WND_SCALE BIT(1)
+
+/** Receive buffer size was set by the user, do not autotune it */
+#define NET_TCP_RECV_BUF_LOCKED BIT(2)
 
 /** Is the socket shutdown for read/write */
 #define NET_TCP_IS_SHUTDOWN BIT(3)
@@ -40,6 +44,9 @@ extern "C" {
 /** MSS option has been set already */
 #define NET_TCP_RECV_MSS_SET BIT(5)
 
+/** Peer has been limited by our receive window */
+#define NET_TCP_RECV_WND_LIMITED BIT(6)
+
 /*
  * TCP connection states
  */
@@ -80,6 +87,12 @@ enum net_tcp_state {
 /* TCP max window size */
 #define NET_TCP_MAX_WIN   (4 * 1024)
 
+/* Largest window scale shift count allowed by RFC 7323 */
+#define NET_TCP_MAX_WND_SCALE 14
+
+/* Window scale value telling that the option was not present */
+#define NET_TCP_NO_WND_SCALE 0xff
+
 /* Maximal value of the sequence number */
 #define NET_TCP_MAX_SEQ   0xffffffff
 
@@ -100,6 +113,7 @@ enum net_tcp_state {
 /** Parsed TCP option values for net_tcp_parse_opts()  */
 struct net_tcp_options {
 	u16_t mss;
+	u8_t wnd_scale;
 };
 
 /* Max received bytes to buffer internally */
@@ -129,6 +143,22 @@ struct net_tcp {
 	/** TIME_WAIT timer */
 	struct k_delayed_work timewait_timer;
 
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	/** Timer to send a delayed ACK */
+	struct k_delayed_work delayed_ack_timer;
+#endif
+
+#if defined(CONFIG_NET_TCP_GRO)
+	/** Timer to deliver held back received segments */
+	struct k_delayed_work gro_timer;
+
+	/** Received segments merged but not yet delivered */
+	struct net_pkt *gro_pkt;
+
+	/** Amount of data in gro_pkt */
+	u32_t gro_len;
+#endif
+
 	/** List pointer used for TCP retransmit buffering */
 	sys_slist_t sent_list;
 
@@ -154,13 +184,56 @@ struct net_tcp {
 	/**
 	 * Current TCP receive window for our side
 	 */
-	u16_t recv_wnd;
+	u32_t recv_wnd;
+
+	/**
+	 * Upper limit of the receive window (SO_RCVBUF)
+	 */
+	u32_t recv_wnd_max;
+
+	/**
+	 * Send window advertised by the peer, already scaled
+	 */
+	u32_t send_wnd;
+
+	/**
+	 * Upper limit of unacknowledged data in flight (SO_SNDBUF),
+	 * 0 if only the peer window applies
+	 */
+	u32_t send_buf_max;
+
+	/**
+	 * Number of pure ACK segments sent
+	 */
+	u32_t acks_sent;
+
+	/**
+	 * Number of data segments received
+	 */
+	u32_t segs_received;
 
 	/**
 	 * Send MSS for the peer
 	 */
 	u16_t send_mss;
 
+	/**
+	 * Window scale shift count for the window we advertise
+	 */
+	u8_t recv_wnd_scale;
+
+	/**
+	 * Window scale shift count for the window the peer advertises
+	 */
+	u8_t send_wnd_scale;
+
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	/**
+	 * Data segments still to be acknowledged without delay
+	 */
+	u8_t quickack;
+#endif
+
 	/** Current retransmit period */
 	u32_t retry_timeout_shift : 5;
 	/** Flags for the TCP */
@@ -193,6 +266,8 @@ static inline bool net_tcp_is_used(struct net_tcp *tcp)
  * @param local_addr Local address of the connection end point.
  * @param remote_port Remote port of the connection end point.
  * @param local_port Local port of the connection end point.
+ * @param context Listening context that can share its port with other
+ * listeners, or NULL.
  * @param cb Callback to be called
  * @param user_data User data supplied by caller.
  * @param handle TCP handle that can be used when unregistering
@@ -204,13 +279,14 @@ static inline int net_tcp_register(u8_t family,
 				   const struct sockaddr *local_addr,
 				   u16_t remote_port,
 				   u16_t local_port,
+				   struct net_context *context,
 				   net_conn_cb_t cb,
 				   void *user_data,
 				   struct net_conn_handle **handle)
 {
 	return net_conn_register(IPPROTO_TCP, family, remote_addr, local_addr,
-				 remote_port, local_port, cb, user_data,
-				 handle);
+				 remote_port, local_port, context, cb,
+				 user_data, handle);
 }
 
 /**
@@ -660,6 +736,133 @@ static inline int net_tcp_update_recv_wnd(struct net_context *context,
 }
 #endif
 
+/**
+ * @brief Set the TCP receive buffer size (SO_RCVBUF)
+ *
+ * The value bounds the receive window advertised to the peer. Setting it
+ * disables receive window autotuning for this connection.
+ *
+ * @param context Network context
+ * @param size Receive buffer size in bytes
+ *
+ * @return 0 on success, -EINVAL if the size is invalid, -EPROTOTYPE if
+ *         there is no TCP context, -EPROTONOSUPPORT if TCP is not supported
+ */
+#if defined(CONFIG_NET_TCP)
+int net_tcp_set_recv_buf(struct net_context *context, int size);
+#else
+static inline int net_tcp_set_recv_buf(struct net_context *context, int size)
+{
+	ARG_UNUSED(context);
+	ARG_UNUSED(size);
+
+	return -EPROTONOSUPPORT;
+}
+#endif
+
+/**
+ * @brief Get the TCP receive buffer size (SO_RCVBUF)
+ *
+ * @param context Network context
+ *
+ * @return Receive buffer size in bytes, < 0 on error
+ */
+#if defined(CONFIG_NET_TCP)
+int net_tcp_get_recv_buf(struct net_context *context);
+#else
+static inline int net_tcp_get_recv_buf(struct net_context *context)
+{
+	ARG_UNUSED(context);
+
+	return -EPROTONOSUPPORT;
+}
+#endif
+
+/**
+ * @brief Set the TCP send buffer size (SO_SNDBUF)
+ *
+ * The value bounds the amount of unacknowledged data in flight, in
+ * addition to the send window advertised by the peer.
+ *
+ * @param context Network context
+ * @param size Send buffer size in bytes, 0 to only honor the peer window
+ *
+ * @return 0 on success, -EINVAL if the size is invalid, -EPROTOTYPE if
+ *         there is no TCP context, -EPROTONOSUPPORT if TCP is not supported
+ */
+#if defined(CONFIG_NET_TCP)
+int net_tcp_set_send_buf(struct net_context *context, int size);
+#else
+static inline int net_tcp_set_send_buf(struct net_context *context, int size)
+{
+	ARG_UNUSED(context);
+	ARG_UNUSED(size);
+
+	return -EPROTONOSUPPORT;
+}
+#endif
+
+/**
+ * @brief Get the TCP send buffer size (SO_SNDBUF)
+ *
+ * @param context Network context
+ *
+ * @return Send buffer size in bytes, < 0 on error
+ */
+#if defined(CONFIG_NET_TCP)
+int net_tcp_get_send_buf(struct net_context *context);
+#else
+static inline int net_tcp_get_send_buf(struct net_context *context)
+{
+	ARG_UNUSED(context);
+
+	return -EPROTONOSUPPORT;
+}
+#endif
+
+/**
+ * @brief Find out if data should be sent as one GSO packet
+ *
+ * @param context Network context
+ * @param len Length of the data to send, on return the amount of data
+ * that fits into the GSO packet
+ *
+ * @return Segment size to split the GSO packet into, 0 if the data
+ * is to be sent as a normal segment
+ */
+#if defined(CONFIG_NET_TCP_GSO)
+u16_t net_tcp_gso_size(struct net_context *context, size_t *len);
+#else
+static inline u16_t net_tcp_gso_size(struct net_context *context,
+				     size_t *len)
+{
+	ARG_UNUSED(context);
+	ARG_UNUSED(len);
+
+	return 0;
+}
+#endif
+
+/**
+ * @brief Split a GSO packet into segments and send them
+ *
+ * The packet is consumed if this function succeeds.
+ *
+ * @param pkt GSO packet, with IP and TCP headers
+ *
+ * @return 0 if successful, < 0 on error
+ */
+#if defined(CONFIG_NET_TCP_GSO)
+int net_tcp_gso_segment(struct net_pkt *pkt);
+#else
+static inline int net_tcp_gso_segment(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return -ENOTSUP;
+}
+#endif
+
 /**
  * @brief Initialize TCP parts of a context
  *
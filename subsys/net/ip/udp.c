@@ -134,7 +134,7 @@ int net_udp_register(u8_t family,
 		     struct net_conn_handle **handle)
 {
 	return net_conn_register(IPPROTO_UDP, family, remote_addr, local_addr,
-				 remote_port, local_port, cb, user_data,
+				 remote_port, local_port, NULL, cb, user_data,
 				 handle);
 }
 
@@ -16,12 +16,22 @@ LOG_MODULE_REGISTER(net_arp, CONFIG_NET_ARP_LOG_LEVEL);
 #include <net/net_pkt.h>
 #include <net/net_if.h>
 #include <net/net_stats.h>
+#include <net/hash.h>
 
 #include "arp.h"
 #include "net_private.h"
+#include "net_stats.h"
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
 #define ARP_REQUEST_TIMEOUT K_SECONDS(2)
+#define ARP_REACHABLE_TIME K_SECONDS(CONFIG_NET_ARP_REACHABLE_TIME)
+#define ARP_PROBE_TIME (CONFIG_NET_ARP_MAX_PROBES * ARP_REQUEST_TIMEOUT)
+
+/* Refreshing an entry in use starts early enough for all the probes to
+ * be sent before the entry would go stale.
+ */
+#define ARP_REFRESH_TIME (ARP_REACHABLE_TIME - \
+			  MIN(ARP_PROBE_TIME, ARP_REACHABLE_TIME / 2))
 
 static bool arp_cache_initialized;
 static struct arp_entry arp_entries[CONFIG_NET_ARP_TABLE_SIZE];
@@ -30,7 +40,11 @@ static sys_slist_t arp_free_entries;
 static sys_slist_t arp_pending_entries;
 static sys_slist_t arp_table;
 
+/* Resolved entries, also found in arp_table, hashed by IPv4 address */
+static sys_slist_t arp_hash[CONFIG_NET_ARP_HASH_SIZE];
+
 struct k_delayed_work arp_request_timer;
+static struct k_delayed_work arp_refresh_timer;
 
 static void arp_entry_cleanup(struct arp_entry *entry, bool pending)
 {
@@ -74,28 +88,41 @@ static struct arp_entry *arp_entry_find(sys_slist_t *list,
 	return NULL;
 }
 
-static inline struct arp_entry *arp_entry_find_move_first(struct net_if *iface,
-							  struct in_addr *dst)
+static inline sys_slist_t *arp_hash_bucket(struct in_addr *addr)
+{
+	u32_t hash = net_hash_fib(UNALIGNED_GET(&addr->s_addr));
+
+	return &arp_hash[hash % CONFIG_NET_ARP_HASH_SIZE];
+}
+
+static struct arp_entry *arp_table_find(struct net_if *iface,
+					struct in_addr *dst)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
 
-	entry = arp_entry_find(&arp_table, iface, dst, &prev);
-	if (entry) {
-		/* Let's assume the target is going to be accessed
-		 * more than once here in a short time frame. So we
-		 * place the entry first in position into the table
-		 * in order to reduce subsequent find.
-		 */
-		if (&entry->node != sys_slist_peek_head(&arp_table)) {
-			sys_slist_remove(&arp_table, prev, &entry->node);
-			sys_slist_prepend(&arp_table, &entry->node);
+	SYS_SLIST_FOR_EACH_CONTAINER(arp_hash_bucket(dst), entry, hash_node) {
+		if (entry->iface == iface &&
+		    net_ipv4_addr_cmp(&entry->ip, dst)) {
+			return entry;
 		}
 	}
 
-	return entry;
+	return NULL;
+}
+
+static void arp_table_add(struct arp_entry *entry)
+{
+	sys_slist_prepend(&arp_table, &entry->node);
+	sys_slist_prepend(arp_hash_bucket(&entry->ip), &entry->hash_node);
+}
+
+static void arp_table_remove(struct arp_entry *entry)
+{
+	sys_slist_find_and_remove(&arp_table, &entry->node);
+	sys_slist_find_and_remove(arp_hash_bucket(&entry->ip),
+				  &entry->hash_node);
 }
 
 static inline
@@ -143,22 +170,24 @@ static struct arp_entry *arp_entry_get_free(void)
 	return CONTAINER_OF(node, struct arp_entry, node);
 }
 
-static struct arp_entry *arp_entry_get_last_from_table(void)
+static struct arp_entry *arp_entry_get_oldest_from_table(void)
 {
-	sys_snode_t *node;
+	struct arp_entry *entry, *oldest = NULL;
 
-	/* We assume last entry is the oldest one,
-	 * so is the preferred one to be taken out.
+	/* The least recently used entry is the preferred one
+	 * to be taken out.
 	 */
-
-	node = sys_slist_peek_tail(&arp_table);
-	if (!node) {
-		return NULL;
+	SYS_SLIST_FOR_EACH_CONTAINER(&arp_table, entry, node) {
+		if (!oldest || entry->used < oldest->used) {
+			oldest = entry;
+		}
 	}
 
-	sys_slist_find_and_remove(&arp_table, node);
+	if (oldest) {
+		arp_table_remove(oldest);
+	}
 
-	return CONTAINER_OF(node, struct arp_entry, node);
+	return oldest;
 }
 
 
@@ -169,6 +198,7 @@ static void arp_entry_register_pending(struct arp_entry *entry)
 	sys_slist_append(&arp_pending_entries, &entry->node);
 
 	entry->req_start = k_uptime_get();
+	entry->used = entry->req_start;
 
 	/* Let's start the timer if necessary */
 	if (!k_delayed_work_remaining_get(&arp_request_timer)) {
@@ -229,6 +259,156 @@ static inline struct in_addr *if_get_addr(struct net_if *iface,
 	return NULL;
 }
 
+static struct net_pkt *arp_prepare_refresh(struct arp_entry *entry)
+{
+	struct net_arp_hdr *hdr;
+	struct in_addr *my_addr;
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(entry->iface,
+					sizeof(struct net_arp_hdr),
+					AF_UNSPEC, 0, K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	net_pkt_set_vlan_tag(pkt, net_eth_get_vlan_tag(entry->iface));
+
+	net_buf_add(pkt->buffer, sizeof(struct net_arp_hdr));
+
+	hdr = NET_ARP_HDR(pkt);
+
+	hdr->hwtype = htons(NET_ARP_HTYPE_ETH);
+	hdr->protocol = htons(NET_ETH_PTYPE_IP);
+	hdr->hwlen = sizeof(struct net_eth_addr);
+	hdr->protolen = sizeof(struct in_addr);
+	hdr->opcode = htons(NET_ARP_REQUEST);
+
+	/* The request is sent directly to the cached address */
+	memcpy(&hdr->dst_hwaddr.addr, &entry->eth,
+	       sizeof(struct net_eth_addr));
+	memcpy(&hdr->src_hwaddr.addr, net_if_get_link_addr(entry->iface)->addr,
+	       sizeof(struct net_eth_addr));
+
+	net_ipaddr_copy(&hdr->dst_ipaddr, &entry->ip);
+
+	my_addr = if_get_addr(entry->iface, NULL);
+	if (my_addr) {
+		net_ipaddr_copy(&hdr->src_ipaddr, my_addr);
+	} else {
+		(void)memset(&hdr->src_ipaddr, 0, sizeof(struct in_addr));
+	}
+
+	net_pkt_lladdr_src(pkt)->addr = net_if_get_link_addr(entry->iface)->addr;
+	net_pkt_lladdr_src(pkt)->len = sizeof(struct net_eth_addr);
+
+	net_pkt_lladdr_dst(pkt)->addr = (u8_t *)&hdr->dst_hwaddr.addr;
+	net_pkt_lladdr_dst(pkt)->len = sizeof(struct net_eth_addr);
+
+	return pkt;
+}
+
+static void arp_entry_probe(struct arp_entry *entry, s64_t now)
+{
+	struct net_pkt *pkt;
+
+	NET_DBG("Refreshing %s (probe %d)",
+		log_strdup(net_sprint_ipv4_addr(&entry->ip)),
+		entry->probes + 1);
+
+	entry->state = ARP_STATE_PROBE;
+	entry->req_start = now;
+	entry->probes++;
+
+	pkt = arp_prepare_refresh(entry);
+	if (!pkt) {
+		/* Tried again after the request timeout */
+		return;
+	}
+
+	net_stats_update_arp_refresh(entry->iface);
+
+	net_if_queue_tx(entry->iface, pkt);
+}
+
+static void arp_entry_confirm(struct arp_entry *entry)
+{
+	entry->state = ARP_STATE_REACHABLE;
+	entry->confirmed = k_uptime_get();
+	entry->probes = 0U;
+
+	/* Entries confirmed later are refreshed later, so a running timer
+	 * already expires early enough for this entry.
+	 */
+	if (!k_delayed_work_remaining_get(&arp_refresh_timer)) {
+		k_delayed_work_submit(&arp_refresh_timer, ARP_REFRESH_TIME);
+	}
+}
+
+static void arp_refresh_timeout(struct k_work *work)
+{
+	s64_t current = k_uptime_get();
+	struct arp_entry *entry, *next;
+	s64_t expiry = 0;
+
+	ARG_UNUSED(work);
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_table, entry, next, node) {
+		s64_t deadline;
+
+		switch (entry->state) {
+		case ARP_STATE_REACHABLE:
+			deadline = entry->confirmed + ARP_REFRESH_TIME;
+			if (deadline > current) {
+				break;
+			}
+
+			if (entry->used <= entry->confirmed) {
+				/* Idle entries are refreshed on their next use */
+				entry->state = ARP_STATE_STALE;
+				continue;
+			}
+
+			arp_entry_probe(entry, current);
+			deadline = current + ARP_REQUEST_TIMEOUT;
+			break;
+
+		case ARP_STATE_PROBE:
+			deadline = entry->req_start + ARP_REQUEST_TIMEOUT;
+			if (entry->probes && deadline > current) {
+				break;
+			}
+
+			if (entry->probes >= CONFIG_NET_ARP_MAX_PROBES) {
+				NET_DBG("No reply from %s, removing entry",
+					log_strdup(net_sprint_ipv4_addr(
+							   &entry->ip)));
+
+				arp_table_remove(entry);
+				arp_entry_cleanup(entry, false);
+				sys_slist_prepend(&arp_free_entries,
+						  &entry->node);
+				continue;
+			}
+
+			arp_entry_probe(entry, current);
+			deadline = current + ARP_REQUEST_TIMEOUT;
+			break;
+
+		default:
+			continue;
+		}
+
+		if (!expiry || deadline < expiry) {
+			expiry = deadline;
+		}
+	}
+
+	if (expiry) {
+		k_delayed_work_submit(&arp_refresh_timer, expiry - current);
+	}
+}
+
 static inline struct net_pkt *arp_prepare(struct net_if *iface,
 					  struct in_addr *next_addr,
 					  struct arp_entry *entry,
@@ -348,17 +528,19 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 	/* If the destination address is already known, we do not need
 	 * to send any ARP packet.
 	 */
-	entry = arp_entry_find_move_first(net_pkt_iface(pkt), addr);
+	entry = arp_table_find(net_pkt_iface(pkt), addr);
 	if (!entry) {
 		struct net_pkt *req;
 
+		net_stats_update_arp_miss(net_pkt_iface(pkt));
+
 		entry = arp_entry_find_pending(net_pkt_iface(pkt), addr);
 		if (!entry) {
 			/* No pending, let's try to get a new entry */
 			entry = arp_entry_get_free();
 			if (!entry) {
 				/* Then let's take one from table? */
-				entry = arp_entry_get_last_from_table();
+				entry = arp_entry_get_oldest_from_table();
 			}
 		} else {
 			/* There is a pending already */
@@ -374,11 +556,24 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 			 * address, so this packet must be discarded.
 			 */
 			NET_DBG("Resending ARP %p", req);
+		} else if (req) {
+			net_stats_update_arp_queued(net_pkt_iface(pkt));
 		}
 
 		return req;
 	}
 
+	net_stats_update_arp_hit(net_pkt_iface(pkt));
+
+	entry->used = k_uptime_get();
+
+	if (entry->state == ARP_STATE_STALE) {
+		/* Keep using the entry while it is being refreshed */
+		entry->state = ARP_STATE_PROBE;
+		entry->probes = 0U;
+		k_delayed_work_submit(&arp_refresh_timer, K_NO_WAIT);
+	}
+
 	net_pkt_lladdr_src(pkt)->addr =
 		(u8_t *)net_if_get_link_addr(entry->iface)->addr;
 	net_pkt_lladdr_src(pkt)->len = sizeof(struct net_eth_addr);
@@ -398,10 +593,9 @@ static void arp_gratuitous(struct net_if *iface,
 			   struct in_addr *src,
 			   struct net_eth_addr *hwaddr)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
-	entry = arp_entry_find(&arp_table, iface, src, &prev);
+	entry = arp_table_find(iface, src);
 	if (entry) {
 		NET_DBG("Gratuitous ARP hwaddr %s -> %s",
 			log_strdup(net_sprint_ll_addr(
@@ -433,13 +627,18 @@ static void arp_update(struct net_if *iface,
 		}
 
 		if (force) {
-			sys_snode_t *prev = NULL;
-			struct arp_entry *entry;
-
-			entry = arp_entry_find(&arp_table, iface, src, &prev);
+			entry = arp_table_find(iface, src);
+			if (entry) {
+				memcpy(&entry->eth, hwaddr,
+				       sizeof(struct net_eth_addr));
+			}
+		} else if (!gratuitous) {
+			/* A reply to a refresh request */
+			entry = arp_table_find(iface, src);
 			if (entry) {
 				memcpy(&entry->eth, hwaddr,
 				       sizeof(struct net_eth_addr));
+				arp_entry_confirm(entry);
 			}
 		}
 
@@ -461,7 +660,8 @@ static void arp_update(struct net_if *iface,
 	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
 
 	/* Inserting entry into the table */
-	sys_slist_prepend(&arp_table, &entry->node);
+	arp_table_add(entry);
+	arp_entry_confirm(entry);
 
 	net_if_queue_tx(iface, pkt);
 }
@@ -648,12 +848,18 @@ void net_arp_clear_cache(struct net_if *iface)
 			continue;
 		}
 
+		sys_slist_find_and_remove(arp_hash_bucket(&entry->ip),
+					  &entry->hash_node);
 		arp_entry_cleanup(entry, false);
 
 		sys_slist_remove(&arp_table, prev, &entry->node);
 		sys_slist_prepend(&arp_free_entries, &entry->node);
 	}
 
+	if (sys_slist_is_empty(&arp_table)) {
+		k_delayed_work_cancel(&arp_refresh_timer);
+	}
+
 	prev = NULL;
 
 	NET_DBG("Flushing ARP pending requests");
@@ -701,12 +907,17 @@ void net_arp_init(void)
 	sys_slist_init(&arp_pending_entries);
 	sys_slist_init(&arp_table);
 
+	for (i = 0; i < CONFIG_NET_ARP_HASH_SIZE; i++) {
+		sys_slist_init(&arp_hash[i]);
+	}
+
 	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
 		/* Inserting entry as free */
 		sys_slist_prepend(&arp_free_entries, &arp_entries[i].node);
 	}
 
 	k_delayed_work_init(&arp_request_timer, arp_request_timeout);
+	k_delayed_work_init(&arp_refresh_timer, arp_refresh_timeout);
 
 	arp_cache_initialized = true;
 }
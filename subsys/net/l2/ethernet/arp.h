@@ -49,15 +49,29 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 enum net_verdict net_arp_input(struct net_pkt *pkt,
 			       struct net_eth_hdr *eth_hdr);
 
+enum arp_state {
+	/** Recently confirmed by an ARP reply */
+	ARP_STATE_REACHABLE,
+	/** Not confirmed for a while, still used for sending */
+	ARP_STATE_STALE,
+	/** Being refreshed with unicast ARP requests */
+	ARP_STATE_PROBE,
+};
+
 struct arp_entry {
 	sys_snode_t node;
+	sys_snode_t hash_node;
 	s64_t req_start;
+	s64_t confirmed;
+	s64_t used;
 	struct net_if *iface;
 	struct in_addr ip;
 	union {
 		struct net_pkt *pending;
 		struct net_eth_addr eth;
 	};
+	u8_t state;
+	u8_t probes;
 };
 
 typedef void (*net_arp_cb_t)(struct arp_entry *entry,
@@ -508,6 +508,85 @@ static void ethernet_remove_l2_header(struct net_pkt *pkt)
 	net_pkt_frag_unref(buf);
 }
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+static void ethernet_tx_batch_send(struct net_if *iface,
+				   struct ethernet_context *ctx)
+{
+	const struct ethernet_api *api = net_if_get_device(iface)->driver_api;
+	int sent;
+	int i;
+
+	if (!ctx->tx_batch_count) {
+		return;
+	}
+
+	sent = api->send_batch(net_if_get_device(iface), ctx->tx_batch,
+			       ctx->tx_batch_count);
+
+	/* The packets were already reported as sent to the upper layers
+	 * when they were added to the batch.
+	 */
+	for (i = 0; i < ctx->tx_batch_count; i++) {
+		struct net_pkt *pkt = ctx->tx_batch[i];
+
+		if (i < sent) {
+#if defined(CONFIG_NET_STATISTICS_ETHERNET)
+			ethernet_update_tx_stats(net_pkt_iface(pkt), pkt);
+#endif
+		} else {
+			eth_stats_update_errors_tx(net_pkt_iface(pkt));
+		}
+
+		ethernet_remove_l2_header(pkt);
+		net_pkt_unref(pkt);
+	}
+
+	ctx->tx_batch_count = 0U;
+}
+
+static bool ethernet_tx_batch_has(struct ethernet_context *ctx,
+				  struct net_pkt *pkt)
+{
+	int i;
+
+	for (i = 0; i < ctx->tx_batch_count; i++) {
+		if (ctx->tx_batch[i] == pkt) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool net_eth_tx_batch_start(struct net_if *iface)
+{
+	const struct ethernet_api *api = net_if_get_device(iface)->driver_api;
+	struct ethernet_context *ctx = net_if_l2_data(iface);
+
+	if (!api->send_batch) {
+		return false;
+	}
+
+	if (k_sem_take(&ctx->tx_batch_lock, K_NO_WAIT)) {
+		return false;
+	}
+
+	ctx->tx_batch_owner = k_current_get();
+
+	return true;
+}
+
+void net_eth_tx_batch_flush(struct net_if *iface)
+{
+	struct ethernet_context *ctx = net_if_l2_data(iface);
+
+	ethernet_tx_batch_send(iface, ctx);
+
+	ctx->tx_batch_owner = NULL;
+	k_sem_give(&ctx->tx_batch_lock);
+}
+#endif /* CONFIG_NET_ETHERNET_TX_BATCH */
+
 static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 {
 	const struct ethernet_api *api = net_if_get_device(iface)->driver_api;
@@ -515,6 +594,21 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 	u16_t ptype;
 	int ret;
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	/* A TCP retransmission can hand over a packet that is still
+	 * waiting in the batch, and already has its L2 header. It is sent
+	 * once, with the batch. Other threads cannot have it in their
+	 * batch, as the Tx of a traffic class is serialized.
+	 */
+	if (ctx->tx_batch_owner == k_current_get() &&
+	    ethernet_tx_batch_has(ctx, pkt)) {
+		ret = net_pkt_get_len(pkt);
+		net_pkt_unref(pkt);
+
+		return ret;
+	}
+#endif
+
 	if (IS_ENABLED(CONFIG_NET_IPV4) &&
 	    net_pkt_family(pkt) == AF_INET) {
 		struct net_pkt *tmp;
@@ -582,6 +676,19 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 	net_pkt_cursor_init(pkt);
 
 send:
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	if (ctx->tx_batch_owner == k_current_get()) {
+		ret = net_pkt_get_len(pkt);
+
+		ctx->tx_batch[ctx->tx_batch_count++] = pkt;
+		if (ctx->tx_batch_count == ARRAY_SIZE(ctx->tx_batch)) {
+			ethernet_tx_batch_send(iface, ctx);
+		}
+
+		return ret;
+	}
+#endif
+
 	ret = api->send(net_if_get_device(iface), pkt);
 	if (ret != 0) {
 		eth_stats_update_errors_tx(iface);
@@ -971,6 +1078,12 @@ void ethernet_init(struct net_if *iface)
 
 	ctx->ethernet_l2_flags = NET_L2_MULTICAST;
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	if (!ctx->is_init) {
+		k_sem_init(&ctx->tx_batch_lock, 1, 1);
+	}
+#endif
+
 	if (net_eth_get_hw_capabilities(iface) & ETHERNET_PROMISC_MODE) {
 		ctx->ethernet_l2_flags |= NET_L2_PROMISC_MODE;
 	}
@@ -800,6 +800,22 @@ static bool is_request(const struct coap_packet *cpkt)
 	return !(code & ~COAP_REQUEST_MASK);
 }
 
+static int call_method(struct coap_resource *resource,
+		       struct coap_packet *cpkt,
+		       struct sockaddr *addr, socklen_t addr_len)
+{
+	coap_method_t method;
+	u8_t code;
+
+	code = coap_header_get_code(cpkt);
+	method = method_from_code(resource, code);
+	if (!method) {
+		return -EPERM;
+	}
+
+	return method(resource, cpkt, addr, addr_len);
+}
+
 int coap_handle_request(struct coap_packet *cpkt,
 			struct coap_resource *resources,
 			struct coap_option *options,
@@ -812,28 +828,147 @@ int coap_handle_request(struct coap_packet *cpkt,
 		return 0;
 	}
 
-	/* FIXME: deal with hierarchical resources */
+	/* See coap_handle_request_index() for large resource arrays */
 	for (resource = resources; resource && resource->path; resource++) {
-		coap_method_t method;
-		u8_t code;
-
 		if (!uri_path_eq(cpkt, resource->path, options, opt_num)) {
 			continue;
 		}
 
-		code = coap_header_get_code(cpkt);
-		method = method_from_code(resource, code);
-		if (!method) {
-			return -EPERM;
-		}
-
-		return method(resource, cpkt, addr, addr_len);
+		return call_method(resource, cpkt, addr, addr_len);
 	}
 
 	NET_DBG("%d", __LINE__);
 	return -ENOENT;
 }
 
+static struct coap_resource_node *find_child(
+	const struct coap_resource_node *node, const u8_t *segment, u16_t len)
+{
+	struct coap_resource_node *child;
+
+	for (child = node->child; child; child = child->sibling) {
+		if (child->len == len &&
+		    !memcmp(child->segment, segment, len)) {
+			return child;
+		}
+	}
+
+	return NULL;
+}
+
+static struct coap_resource_node *add_child(struct coap_resource_index *index,
+					    struct coap_resource_node *node,
+					    const char *segment)
+{
+	struct coap_resource_node *child;
+	struct coap_resource_node **last;
+	u16_t len = strlen(segment);
+
+	child = find_child(node, (const u8_t *)segment, len);
+	if (child) {
+		return child;
+	}
+
+	if (index->used == index->node_count) {
+		return NULL;
+	}
+
+	child = &index->nodes[index->used++];
+	child->segment = segment;
+	child->len = len;
+	child->resource = NULL;
+	child->child = NULL;
+	child->sibling = NULL;
+
+	/* Keep the order of the resource array among siblings */
+	last = &node->child;
+	while (*last) {
+		last = &(*last)->sibling;
+	}
+
+	*last = child;
+
+	return child;
+}
+
+int coap_resource_index_init(struct coap_resource_index *index,
+			     struct coap_resource *resources,
+			     struct coap_resource_node *nodes,
+			     size_t node_count)
+{
+	struct coap_resource *resource;
+
+	if (!index || !nodes || !node_count) {
+		return -EINVAL;
+	}
+
+	memset(&nodes[0], 0, sizeof(nodes[0]));
+	index->nodes = nodes;
+	index->node_count = node_count;
+	index->used = 1;
+
+	for (resource = resources; resource && resource->path; resource++) {
+		struct coap_resource_node *node = &nodes[0];
+		const char * const *p;
+
+		for (p = resource->path; *p; p++) {
+			node = add_child(index, node, *p);
+			if (!node) {
+				NET_ERR("Not enough nodes to index resources");
+				return -ENOMEM;
+			}
+		}
+
+		if (!node->resource) {
+			node->resource = resource;
+		}
+	}
+
+	return 0;
+}
+
+struct coap_resource *coap_resource_index_find(
+	const struct coap_resource_index *index,
+	const struct coap_option *options, u8_t opt_num)
+{
+	const struct coap_resource_node *node = &index->nodes[0];
+	u8_t i;
+
+	for (i = 0U; i < opt_num; i++) {
+		if (options[i].delta != COAP_OPTION_URI_PATH) {
+			continue;
+		}
+
+		node = find_child(node, options[i].value, options[i].len);
+		if (!node) {
+			return NULL;
+		}
+	}
+
+	return node->resource;
+}
+
+int coap_handle_request_index(struct coap_packet *cpkt,
+			      const struct coap_resource_index *index,
+			      struct coap_option *options,
+			      u8_t opt_num,
+			      struct sockaddr *addr, socklen_t addr_len)
+{
+	struct coap_resource *resource;
+
+	if (!is_request(cpkt)) {
+		return 0;
+	}
+
+	resource = coap_resource_index_find(index, options, opt_num);
+	if (!resource) {
+		NET_DBG("%d", __LINE__);
+		return -ENOENT;
+	}
+
+	return call_method(resource, cpkt, addr, addr_len);
+}
+
 int coap_block_transfer_init(struct coap_block_context *ctx,
 			      enum coap_block_size block_size,
 			      size_t total_size)
@@ -1048,6 +1183,149 @@ size_t coap_next_block(const struct coap_packet *cpkt,
 	return ctx->current;
 }
 
+int coap_block2_response(struct coap_packet *response,
+			 const struct coap_packet *request,
+			 struct coap_block_context *ctx,
+			 coap_block_read_t read, void *user_data)
+{
+	unsigned int val = 0U;
+	size_t offset = 0;
+	u16_t more_pos;
+	size_t len;
+	u16_t bytes;
+	bool more;
+	int block;
+	int r;
+
+	block = get_block_option(request, COAP_OPTION_BLOCK2);
+	if (block != -ENOENT) {
+		if (GET_MORE(block)) {
+			return -EINVAL;
+		}
+
+		offset = GET_NUM(block) << (GET_BLOCK_SIZE(block) + 4);
+		ctx->block_size = MIN(GET_BLOCK_SIZE(block), ctx->block_size);
+	}
+
+	if (ctx->total_size && offset && offset >= ctx->total_size) {
+		return -EINVAL;
+	}
+
+	ctx->current = offset;
+	bytes = coap_block_size_to_bytes(ctx->block_size);
+	len = bytes;
+	if (ctx->total_size) {
+		len = MIN(len, ctx->total_size - offset);
+	}
+
+	/* Whether more blocks follow is only known once the block is read,
+	 * so the More flag is set here and cleared in place if needed.
+	 */
+	SET_BLOCK_SIZE(val, ctx->block_size);
+	SET_MORE(val, true);
+	SET_NUM(val, offset / bytes);
+
+	r = coap_append_option_int(response, COAP_OPTION_BLOCK2, val);
+	if (r < 0) {
+		return r;
+	}
+
+	more_pos = response->offset - 1;
+
+	if (!offset && ctx->total_size) {
+		r = coap_append_size2_option(response, ctx);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	if (response->max_len - response->offset < len + 1) {
+		return -ENOMEM;
+	}
+
+	r = coap_packet_append_payload_marker(response);
+	if (r < 0) {
+		return r;
+	}
+
+	r = read(offset, response->data + response->offset, len, user_data);
+	if (r < 0) {
+		return r;
+	}
+
+	if ((size_t)r > len) {
+		return -EINVAL;
+	}
+
+	more = r == bytes &&
+		(!ctx->total_size || offset + r < ctx->total_size);
+	if (!more) {
+		response->data[more_pos] &= ~0x08;
+	}
+
+	if (r) {
+		response->offset += r;
+	} else {
+		/* A payload marker must not be followed by an empty payload */
+		response->offset--;
+	}
+
+	return more;
+}
+
+int coap_block1_receive(const struct coap_packet *request,
+			struct coap_block_context *ctx,
+			coap_block_write_t write, void *user_data)
+{
+	const u8_t *payload;
+	size_t offset;
+	u16_t len;
+	bool more;
+	int block;
+	int size;
+	int r;
+
+	payload = coap_packet_get_payload(request, &len);
+
+	block = get_block_option(request, COAP_OPTION_BLOCK1);
+	if (block == -ENOENT) {
+		ctx->total_size = len;
+		ctx->current = 0;
+
+		r = write(0, payload, len, true, user_data);
+
+		return r < 0 ? r : 0;
+	}
+
+	offset = GET_NUM(block) << (GET_BLOCK_SIZE(block) + 4);
+	more = GET_MORE(block);
+
+	if (more && len != coap_block_size_to_bytes(GET_BLOCK_SIZE(block))) {
+		return -EINVAL;
+	}
+
+	if (offset == 0) {
+		size = get_block_option(request, COAP_OPTION_SIZE1);
+		ctx->total_size = size == -ENOENT ? 0 : size;
+	} else if (offset == ctx->current) {
+		/* Retransmission of the block acknowledged last */
+		return more;
+	} else if (offset != ctx->current +
+		   coap_block_size_to_bytes(ctx->block_size)) {
+		return -EINVAL;
+	}
+
+	r = write(offset, payload, len, !more, user_data);
+	if (r < 0) {
+		return r;
+	}
+
+	ctx->current = offset;
+	ctx->block_size = GET_BLOCK_SIZE(block);
+
+	return more;
+}
+
 int coap_pending_init(struct coap_pending *pending,
 		      const struct coap_packet *request,
 		      const struct sockaddr *addr)
@@ -0,0 +1,323 @@
+/** @file
+ * @brief DNS answer cache
+ *
+ * Cache of the answers received by the DNS resolver.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+#include <misc/slist.h>
+#include <net/net_core.h>
+#include <net/net_ip.h>
+#include <net/dns_resolve.h>
+
+#include "dns_cache.h"
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE_SERVE_STALE)
+#define STALE_TTL CONFIG_DNS_RESOLVER_CACHE_STALE_TTL
+#else
+#define STALE_TTL 0
+#endif
+
+struct dns_cache_entry {
+	sys_snode_t node;
+
+	/** Uptime in ms when the answer expires */
+	s64_t expiry;
+
+	/** Cached addresses, none if the name does not exist */
+	union {
+		struct in_addr in;
+		struct in6_addr in6;
+	} addr[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS];
+
+	/** Number of cached addresses */
+	u8_t count;
+
+	/** Query type */
+	u8_t type;
+
+	char name[CONFIG_DNS_RESOLVER_CACHE_NAME_LEN + 1];
+};
+
+static struct dns_cache_entry entries[CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES];
+
+/* The most recently used entries are first */
+static sys_slist_t cache_list;
+static sys_slist_t cache_free;
+
+static bool cache_initialized;
+
+static struct dns_resolve_cache_stats cache_stats;
+
+static K_MUTEX_DEFINE(cache_lock);
+
+static void cache_init(void)
+{
+	int i;
+
+	if (cache_initialized) {
+		return;
+	}
+
+	sys_slist_init(&cache_list);
+	sys_slist_init(&cache_free);
+
+	for (i = 0; i < ARRAY_SIZE(entries); i++) {
+		sys_slist_append(&cache_free, &entries[i].node);
+	}
+
+	cache_initialized = true;
+}
+
+static inline size_t addr_len(enum dns_query_type type)
+{
+	if (type == DNS_QUERY_TYPE_AAAA) {
+		return sizeof(struct in6_addr);
+	}
+
+	return sizeof(struct in_addr);
+}
+
+static struct dns_cache_entry *cache_lookup(const char *name,
+					    enum dns_query_type type)
+{
+	struct dns_cache_entry *entry, *prev = NULL;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&cache_list, entry, node) {
+		if (entry->type == type &&
+		    !strncasecmp(entry->name, name, sizeof(entry->name))) {
+			sys_slist_remove(&cache_list,
+					 prev ? &prev->node : NULL,
+					 &entry->node);
+			sys_slist_prepend(&cache_list, &entry->node);
+
+			return entry;
+		}
+
+		prev = entry;
+	}
+
+	return NULL;
+}
+
+static struct dns_cache_entry *cache_alloc(const char *name,
+					   enum dns_query_type type)
+{
+	sys_snode_t *node;
+	struct dns_cache_entry *entry;
+
+	node = sys_slist_get(&cache_free);
+	if (!node) {
+		/* Drop the least recently used entry */
+		node = sys_slist_peek_tail(&cache_list);
+		sys_slist_find_and_remove(&cache_list, node);
+
+		cache_stats.evictions++;
+	}
+
+	entry = CONTAINER_OF(node, struct dns_cache_entry, node);
+
+	strncpy(entry->name, name, sizeof(entry->name) - 1);
+	entry->name[sizeof(entry->name) - 1] = '\0';
+	entry->type = type;
+	entry->count = 0U;
+
+	sys_slist_prepend(&cache_list, &entry->node);
+
+	return entry;
+}
+
+static void cache_release(struct dns_cache_entry *entry)
+{
+	sys_slist_find_and_remove(&cache_list, &entry->node);
+	sys_slist_prepend(&cache_free, &entry->node);
+}
+
+static bool name_cacheable(const char *name)
+{
+	return strlen(name) <= CONFIG_DNS_RESOLVER_CACHE_NAME_LEN;
+}
+
+int dns_cache_find(const char *name, enum dns_query_type type, bool stale,
+		   dns_resolve_cb_t cb, void *user_data)
+{
+	struct dns_cache_entry *entry;
+	struct dns_cache_entry answer;
+	struct dns_addrinfo info = { 0 };
+	s64_t now = k_uptime_get();
+	int i;
+
+	if (!name_cacheable(name) ||
+	    (type == DNS_QUERY_TYPE_AAAA && !IS_ENABLED(CONFIG_NET_IPV6))) {
+		return -ENOENT;
+	}
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	cache_init();
+
+	entry = cache_lookup(name, type);
+	if (entry && entry->expiry <= now) {
+		if (entry->count == 0U ||
+		    entry->expiry + STALE_TTL * MSEC_PER_SEC <= now) {
+			cache_release(entry);
+			entry = NULL;
+		} else if (!stale) {
+			/* Kept in case the refresh fails */
+			entry = NULL;
+		}
+	}
+
+	if (!entry) {
+		if (!stale) {
+			cache_stats.misses++;
+		}
+
+		k_mutex_unlock(&cache_lock);
+		return -ENOENT;
+	}
+
+	if (entry->count == 0U) {
+		cache_stats.negative_hits++;
+	} else if (entry->expiry <= now) {
+		cache_stats.stale_hits++;
+	} else {
+		cache_stats.hits++;
+	}
+
+	/* The callback is not called with the cache locked */
+	memcpy(&answer, entry, sizeof(answer));
+
+	k_mutex_unlock(&cache_lock);
+
+	NET_DBG("Cached answer for %s type %u, %u addresses",
+		log_strdup(name), type, answer.count);
+
+	if (answer.count == 0U) {
+		cb(DNS_EAI_NODATA, NULL, user_data);
+		return 0;
+	}
+
+	if (type == DNS_QUERY_TYPE_AAAA) {
+		info.ai_family = AF_INET6;
+		info.ai_addrlen = sizeof(struct sockaddr_in6);
+	} else {
+		info.ai_family = AF_INET;
+		info.ai_addrlen = sizeof(struct sockaddr_in);
+	}
+
+	info.ai_addr.sa_family = info.ai_family;
+
+	for (i = 0; i < answer.count; i++) {
+		if (type == DNS_QUERY_TYPE_AAAA) {
+			memcpy(&net_sin6(&info.ai_addr)->sin6_addr,
+			       &answer.addr[i].in6, sizeof(struct in6_addr));
+		} else {
+			memcpy(&net_sin(&info.ai_addr)->sin_addr,
+			       &answer.addr[i].in, sizeof(struct in_addr));
+		}
+
+		cb(DNS_EAI_INPROGRESS, &info, user_data);
+	}
+
+	cb(DNS_EAI_ALLDONE, NULL, user_data);
+
+	return 0;
+}
+
+void dns_cache_add(const char *name, enum dns_query_type type, int idx,
+		   const u8_t *addr, u32_t ttl)
+{
+	struct dns_cache_entry *entry;
+	s64_t expiry;
+
+	if (!name_cacheable(name) || ttl == 0U ||
+	    idx >= CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS) {
+		return;
+	}
+
+	ttl = MIN(ttl, CONFIG_DNS_RESOLVER_CACHE_MAX_TTL);
+	expiry = k_uptime_get() + (s64_t)ttl * MSEC_PER_SEC;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	cache_init();
+
+	entry = cache_lookup(name, type);
+
+	if (idx == 0) {
+		if (!entry) {
+			entry = cache_alloc(name, type);
+		}
+
+		entry->expiry = expiry;
+	} else {
+		/* The previous addresses of the answer were not cached */
+		if (!entry || entry->count != idx) {
+			goto out;
+		}
+
+		entry->expiry = MIN(entry->expiry, expiry);
+	}
+
+	memcpy(&entry->addr[idx], addr, addr_len(type));
+	entry->count = idx + 1;
+
+out:
+	k_mutex_unlock(&cache_lock);
+}
+
+void dns_cache_add_negative(const char *name, enum dns_query_type type)
+{
+	struct dns_cache_entry *entry;
+
+	if (!name_cacheable(name) ||
+	    CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL == 0) {
+		return;
+	}
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	cache_init();
+
+	entry = cache_lookup(name, type);
+	if (!entry) {
+		entry = cache_alloc(name, type);
+	}
+
+	entry->expiry = k_uptime_get() +
+		(s64_t)CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL * MSEC_PER_SEC;
+	entry->count = 0U;
+
+	k_mutex_unlock(&cache_lock);
+}
+
+void dns_resolve_cache_stats_get(struct dns_resolve_cache_stats *stats)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	memcpy(stats, &cache_stats, sizeof(*stats));
+	k_mutex_unlock(&cache_lock);
+}
+
+void dns_resolve_cache_flush(void)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	cache_initialized = false;
+	cache_init();
+
+	k_mutex_unlock(&cache_lock);
+}
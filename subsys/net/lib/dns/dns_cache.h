@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _DNS_CACHE_H_
+#define _DNS_CACHE_H_
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include <net/dns_resolve.h>
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+
+/**
+ * @brief Answer a query from the cache.
+ *
+ * @details The callback is called for each cached address, then with
+ * DNS_EAI_ALLDONE, or only with DNS_EAI_NODATA if the name does not exist.
+ * The cache is not locked while the callback is called.
+ *
+ * @param name Name to resolve
+ * @param type Query type
+ * @param stale Also use the expired answers that can still be served, as
+ *        the DNS servers are not responding.
+ * @param cb Result callback
+ * @param user_data User data given to the callback
+ *
+ * @return 0 if the query was answered, -ENOENT otherwise.
+ */
+int dns_cache_find(const char *name, enum dns_query_type type, bool stale,
+		   dns_resolve_cb_t cb, void *user_data);
+
+/**
+ * @brief Cache an address of an answer.
+ *
+ * @details The address at index 0 replaces the previously cached answer,
+ * the next ones are added to it, in order.
+ *
+ * @param name Name that was resolved
+ * @param type Query type
+ * @param idx Index of the address in the answer
+ * @param addr Address, 4 or 16 bytes depending on the query type
+ * @param ttl TTL of the answer in seconds
+ */
+void dns_cache_add(const char *name, enum dns_query_type type, int idx,
+		   const u8_t *addr, u32_t ttl);
+
+/**
+ * @brief Cache a non-existent name.
+ *
+ * @param name Name that was resolved
+ * @param type Query type
+ */
+void dns_cache_add_negative(const char *name, enum dns_query_type type);
+
+#else
+
+static inline int dns_cache_find(const char *name, enum dns_query_type type,
+				 bool stale, dns_resolve_cb_t cb,
+				 void *user_data)
+{
+	return -ENOENT;
+}
+
+static inline void dns_cache_add(const char *name, enum dns_query_type type,
+				 int idx, const u8_t *addr, u32_t ttl)
+{
+}
+
+static inline void dns_cache_add_negative(const char *name,
+					  enum dns_query_type type)
+{
+}
+
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
+#endif /* _DNS_CACHE_H_ */
@@ -22,6 +22,7 @@ LOG_MODULE_REGISTER(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
 #include <net/net_pkt.h>
 #include <net/dns_resolve.h>
 #include "dns_pack.h"
+#include "dns_cache.h"
 
 #define DNS_SERVER_COUNT CONFIG_DNS_RESOLVER_MAX_SERVERS
 #define SERVER_COUNT     (DNS_SERVER_COUNT + DNS_MAX_MCAST_SERVERS)
@@ -72,6 +73,9 @@ NET_BUF_POOL_DEFINE(dns_qname_pool, DNS_RESOLVER_BUF_CTR, DNS_MAX_NAME_LEN,
 
 static struct dns_resolve_context dns_default_ctx;
 
+/* The servers a query was sent to are tracked in a bit mask */
+BUILD_ASSERT_MSG(SERVER_COUNT <= 32, "Too many DNS servers");
+
 static int dns_write(struct dns_resolve_context *ctx,
 		     int server_idx,
 		     int query_idx,
@@ -320,7 +324,180 @@ static inline int get_slot_by_id(struct dns_resolve_context *ctx,
 	return -ENOENT;
 }
 
+static bool server_is_source(struct sockaddr *server, struct net_pkt *pkt,
+			     union net_ip_header *ip_hdr,
+			     union net_proto_header *proto_hdr)
+{
+	if (server->sa_family != net_pkt_family(pkt)) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && server->sa_family == AF_INET) {
+		return net_ipv4_addr_cmp(&net_sin(server)->sin_addr,
+					 &ip_hdr->ipv4->src) &&
+			net_sin(server)->sin_port == proto_hdr->udp->src_port;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && server->sa_family == AF_INET6) {
+		return net_ipv6_addr_cmp(&net_sin6(server)->sin6_addr,
+					 &ip_hdr->ipv6->src) &&
+			net_sin6(server)->sin6_port ==
+						proto_hdr->udp->src_port;
+	}
+
+	return false;
+}
+
+/* Find the server which sent a response, by its address, or by the
+ * connection for the multicast ones.
+ */
+static int get_server_by_source(struct dns_resolve_context *ctx,
+				struct net_context *net_ctx,
+				struct net_pkt *pkt,
+				union net_ip_header *ip_hdr,
+				union net_proto_header *proto_hdr)
+{
+	int i;
+
+	for (i = 0; i < SERVER_COUNT; i++) {
+		if (ctx->servers[i].net_ctx &&
+		    server_is_source(&ctx->servers[i].dns_server, pkt,
+				     ip_hdr, proto_hdr)) {
+			return i;
+		}
+	}
+
+	for (i = 0; i < SERVER_COUNT; i++) {
+		if (ctx->servers[i].net_ctx == net_ctx &&
+		    (ctx->servers[i].is_mdns || ctx->servers[i].is_llmnr)) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static inline bool server_backed_off(struct dns_resolve_context *ctx,
+				     int server_idx, u32_t now)
+{
+	return ctx->servers[server_idx].failures &&
+		(s32_t)(ctx->servers[server_idx].backoff_until - now) > 0;
+}
+
+static bool server_preferred(struct dns_resolve_context *ctx, int a, int b,
+			     u32_t now)
+{
+	bool a_off = server_backed_off(ctx, a, now);
+	bool b_off = server_backed_off(ctx, b, now);
+
+	if (a_off != b_off) {
+		return b_off;
+	}
+
+	if (a_off) {
+		return (s32_t)(ctx->servers[a].backoff_until -
+			       ctx->servers[b].backoff_until) < 0;
+	}
+
+	return ctx->servers[a].rtt < ctx->servers[b].rtt;
+}
+
+/* Order the servers from the most to the least preferred one */
+static void sort_servers(struct dns_resolve_context *ctx, u8_t *order)
+{
+	u32_t now = k_uptime_get_32();
+	int i, j;
+	u8_t idx;
+
+	for (i = 0; i < SERVER_COUNT; i++) {
+		idx = i;
+
+		for (j = i; j > 0 && server_preferred(ctx, idx, order[j - 1],
+						      now); j--) {
+			order[j] = order[j - 1];
+		}
+
+		order[j] = idx;
+	}
+}
+
+/* Update the round trip time of a server that answered a query, even if
+ * the query was already answered by another server.
+ */
+static void server_answered(struct dns_resolve_context *ctx, int server_idx,
+			    u16_t dns_id)
+{
+	struct dns_pending_query *query;
+	u32_t rtt;
+	int i;
+
+	if (server_idx < 0) {
+		return;
+	}
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		query = &ctx->queries[i];
+
+		if (query->id != dns_id ||
+		    !(query->pending_servers & BIT(server_idx))) {
+			continue;
+		}
+
+		query->pending_servers &= ~BIT(server_idx);
+
+		rtt = MAX(k_uptime_get_32() - query->sent, 1);
+
+		if (ctx->servers[server_idx].rtt) {
+			rtt = (7 * ctx->servers[server_idx].rtt + rtt) / 8U;
+		}
+
+		ctx->servers[server_idx].rtt = rtt;
+		ctx->servers[server_idx].failures = 0U;
+
+		NET_DBG("Server idx %d rtt %u ms", server_idx, rtt);
+
+		break;
+	}
+}
+
+/* Avoid a server that did not answer for an exponentially increasing time */
+static void server_failed(struct dns_resolve_context *ctx, int server_idx)
+{
+	u32_t backoff = CONFIG_DNS_RESOLVER_BACKOFF_BASE;
+	u8_t failures;
+
+	failures = ctx->servers[server_idx].failures;
+	if (failures < UINT8_MAX) {
+		ctx->servers[server_idx].failures = ++failures;
+	}
+
+	while (--failures > 0 && backoff < CONFIG_DNS_RESOLVER_BACKOFF_MAX) {
+		backoff *= 2U;
+	}
+
+	backoff = MIN(backoff, CONFIG_DNS_RESOLVER_BACKOFF_MAX);
+
+	ctx->servers[server_idx].backoff_until = k_uptime_get_32() + backoff;
+
+	NET_DBG("Server idx %d failed %u times, backoff %u ms", server_idx,
+		ctx->servers[server_idx].failures, backoff);
+}
+
+static void servers_failed(struct dns_resolve_context *ctx, int query_idx)
+{
+	int i;
+
+	for (i = 0; i < SERVER_COUNT; i++) {
+		if (ctx->queries[query_idx].pending_servers & BIT(i)) {
+			server_failed(ctx, i);
+		}
+	}
+
+	ctx->queries[query_idx].pending_servers = 0U;
+}
+
 static int dns_read(struct dns_resolve_context *ctx,
+		    int server,
 		    struct net_pkt *pkt,
 		    struct net_buf *dns_data,
 		    u16_t *dns_id,
@@ -330,6 +507,7 @@ static int dns_read(struct dns_resolve_context *ctx,
 	/* Helper struct to track the dns msg received from the server */
 	struct dns_msg_t dns_msg;
 	u32_t ttl; /* RR ttl, so far it is not passed to caller */
+	u32_t min_ttl = UINT32_MAX; /* answer ttl, used for caching */
 	u8_t *src, *addr;
 	int address_size;
 	/* index that points to the current answer being analyzed */
@@ -360,13 +538,16 @@ static int dns_read(struct dns_resolve_context *ctx,
 	 */
 	*dns_id = dns_unpack_header_id(dns_msg.msg);
 
+	server_answered(ctx, server, *dns_id);
+
 	query_idx = get_slot_by_id(ctx, *dns_id);
 	if (query_idx < 0) {
 		ret = DNS_EAI_SYSTEM;
 		goto quit;
 	}
 
-	if (dns_header_rcode(dns_msg.msg) == DNS_HEADER_REFUSED) {
+	if (dns_header_rcode(dns_msg.msg) == DNS_HEADER_REFUSED ||
+	    dns_header_rcode(dns_msg.msg) == DNS_HEADER_SERVERFAILURE) {
 		ret = DNS_EAI_FAIL;
 		goto quit;
 	}
@@ -425,6 +606,8 @@ static int dns_read(struct dns_resolve_context *ctx,
 			goto quit;
 		}
 
+		min_ttl = MIN(min_ttl, ttl);
+
 		switch (dns_msg.response_type) {
 		case DNS_RESPONSE_IP:
 			if (dns_msg.response_length < address_size) {
@@ -437,6 +620,10 @@ static int dns_read(struct dns_resolve_context *ctx,
 
 			memcpy(addr, src, address_size);
 
+			dns_cache_add(ctx->queries[query_idx].query,
+				      ctx->queries[query_idx].query_type,
+				      items, addr, min_ttl);
+
 			ctx->queries[query_idx].cb(DNS_EAI_INPROGRESS, &info,
 					ctx->queries[query_idx].user_data);
 			items++;
@@ -482,6 +669,11 @@ static int dns_read(struct dns_resolve_context *ctx,
 
 	if (items == 0) {
 		ret = DNS_EAI_NODATA;
+
+		if (dns_header_rcode(dns_msg.msg) == DNS_HEADER_NAMEERROR) {
+			dns_cache_add_negative(ctx->queries[query_idx].query,
+					       ctx->queries[query_idx].query_type);
+		}
 	} else {
 		ret = DNS_EAI_ALLDONE;
 	}
@@ -519,10 +711,9 @@ static void cb_recv(struct net_context *net_ctx,
 	struct net_buf *dns_cname = NULL;
 	struct net_buf *dns_data = NULL;
 	u16_t dns_id = 0U;
+	int server_idx;
 	int ret, i;
 
-	ARG_UNUSED(net_ctx);
-
 	if (status) {
 		ret = DNS_EAI_SYSTEM;
 		goto quit;
@@ -540,7 +731,9 @@ static void cb_recv(struct net_context *net_ctx,
 		goto quit;
 	}
 
-	ret = dns_read(ctx, pkt, dns_data, &dns_id, dns_cname);
+	server_idx = get_server_by_source(ctx, net_ctx, pkt, ip_hdr, proto_hdr);
+
+	ret = dns_read(ctx, server_idx, pkt, dns_data, &dns_id, dns_cname);
 	if (!ret) {
 		/* We called the callback already in dns_read() if there
 		 * was no errors.
@@ -587,6 +780,11 @@ quit:
 		goto free_buf;
 	}
 
+	/* Wait for a valid answer from the other servers */
+	if (ret == DNS_EAI_FAIL && ctx->queries[i].pending_servers) {
+		goto free_buf;
+	}
+
 	if (k_delayed_work_remaining_get(&ctx->queries[i].timer) > 0) {
 		k_delayed_work_cancel(&ctx->queries[i].timer);
 	}
@@ -659,6 +857,9 @@ static int dns_write(struct dns_resolve_context *ctx,
 		return ret;
 	}
 
+	ctx->queries[query_idx].sent = k_uptime_get_32();
+	ctx->queries[query_idx].pending_servers |= BIT(server_idx);
+
 	ret = k_delayed_work_submit(&ctx->queries[query_idx].timer,
 				    ctx->queries[query_idx].timeout);
 	if (ret < 0) {
@@ -695,10 +896,31 @@ int dns_resolve_cancel(struct dns_resolve_context *ctx, u16_t dns_id)
 
 	ctx->queries[i].cb(DNS_EAI_CANCELED, NULL, ctx->queries[i].user_data);
 	ctx->queries[i].cb = NULL;
+	ctx->queries[i].pending_servers = 0U;
 
 	return 0;
 }
 
+/* Answer the query with an expired cached answer, if allowed to */
+static bool serve_stale(struct dns_pending_query *pending_query)
+{
+	if (!IS_ENABLED(CONFIG_DNS_RESOLVER_CACHE_SERVE_STALE)) {
+		return false;
+	}
+
+	if (dns_cache_find(pending_query->query, pending_query->query_type,
+			   true, pending_query->cb,
+			   pending_query->user_data) < 0) {
+		return false;
+	}
+
+	NET_DBG("Served stale answer to DNS req %u", pending_query->id);
+
+	pending_query->cb = NULL;
+
+	return true;
+}
+
 static void query_timeout(struct k_work *work)
 {
 	struct dns_pending_query *pending_query =
@@ -706,6 +928,13 @@ static void query_timeout(struct k_work *work)
 
 	NET_DBG("Query timeout DNS req %u", pending_query->id);
 
+	servers_failed(pending_query->ctx,
+		       pending_query - pending_query->ctx->queries);
+
+	if (serve_stale(pending_query)) {
+		return;
+	}
+
 	dns_resolve_cancel(pending_query->ctx, pending_query->id);
 }
 
@@ -720,8 +949,10 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 	struct net_buf *dns_data = NULL;
 	struct net_buf *dns_qname = NULL;
 	struct sockaddr addr;
-	int ret, i = -1, j = 0;
+	u8_t order[SERVER_COUNT];
+	int ret, i = -1, j = 0, n;
 	int failure = 0;
+	int queried = 0;
 	bool mdns_query = false;
 	u8_t hop_limit;
 
@@ -770,6 +1001,14 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 	}
 
 try_resolve:
+	if (dns_cache_find(query, type, false, cb, user_data) == 0) {
+		if (dns_id) {
+			*dns_id = 0U;
+		}
+
+		return 0;
+	}
+
 	i = get_cb_slot(ctx);
 	if (i < 0) {
 		return -EAGAIN;
@@ -781,6 +1020,7 @@ try_resolve:
 	ctx->queries[i].query_type = type;
 	ctx->queries[i].user_data = user_data;
 	ctx->queries[i].ctx = ctx;
+	ctx->queries[i].pending_servers = 0U;
 
 	k_delayed_work_init(&ctx->queries[i].timer, query_timeout);
 
@@ -827,7 +1067,10 @@ try_resolve:
 		}
 	}
 
-	for (j = 0; j < SERVER_COUNT; j++) {
+	sort_servers(ctx, order);
+
+	for (n = 0; n < SERVER_COUNT; n++) {
+		j = order[n];
 		hop_limit = 0U;
 
 		if (!ctx->servers[j].net_ctx) {
@@ -859,18 +1102,17 @@ try_resolve:
 			continue;
 		}
 
-		/* Do one concurrent query only for each name resolve.
-		 * TODO: Change the i (query index) to do multiple concurrent
-		 *       to each server.
-		 */
-		break;
+		/* The first valid answer of the servers is used */
+		if (++queried == CONFIG_DNS_RESOLVER_FANOUT) {
+			break;
+		}
 	}
 
 	if (failure) {
 		NET_DBG("DNS query failed %d times", failure);
 
-		if (failure == j) {
-			ret = -ENOENT;
+		if (queried == 0) {
+			ret = serve_stale(&ctx->queries[i]) ? 0 : -ENOENT;
 			goto quit;
 		}
 	}
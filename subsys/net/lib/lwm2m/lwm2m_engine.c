@@ -35,6 +35,7 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #include <net/net_ip.h>
 #include <net/http_parser_url.h>
 #include <net/socket.h>
+#include <net/hash.h>
 #if defined(CONFIG_LWM2M_DTLS_SUPPORT)
 #include <net/tls_credentials.h>
 #endif
@@ -49,6 +50,12 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #ifdef CONFIG_LWM2M_RW_JSON_SUPPORT
 #include "lwm2m_rw_json.h"
 #endif
+#ifdef CONFIG_LWM2M_RW_CBOR_SUPPORT
+#include "lwm2m_rw_cbor.h"
+#endif
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+#include "lwm2m_rw_senml_cbor.h"
+#endif
 #ifdef CONFIG_LWM2M_RD_CLIENT_SUPPORT
 #include "lwm2m_rd_client.h"
 #endif
@@ -91,16 +98,18 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 
 struct observe_node {
 	sys_snode_t node;
+	sys_dnode_t due_node;
 	struct lwm2m_ctx *ctx;
 	struct lwm2m_obj_path path;
 	u8_t  token[MAX_TOKEN_LEN];
-	s64_t event_timestamp;
 	s64_t last_timestamp;
+	s64_t due_timestamp;
 	u32_t min_period_sec;
 	u32_t max_period_sec;
 	u32_t counter;
 	u16_t format;
 	u8_t  tkl;
+	bool  event_pending;
 };
 
 struct notification_attrs {
@@ -128,7 +137,17 @@ static struct service_node service_node_data[MAX_PERIODIC_SERVICE];
 
 static sys_slist_t engine_obj_list;
 static sys_slist_t engine_obj_inst_list;
+static sys_slist_t engine_obj_hash[CONFIG_LWM2M_ENGINE_HASH_SIZE];
+static sys_slist_t engine_obj_inst_hash[CONFIG_LWM2M_ENGINE_HASH_SIZE];
+/* Changed when objects or object instances are added or removed, so that
+ * resource handles resolved before are resolved again.
+ */
+static u32_t engine_generation;
 static sys_slist_t engine_observer_list;
+/* The observers, sorted by the time of their next notification */
+static sys_dlist_t engine_observer_queue =
+	SYS_DLIST_STATIC_INIT(&engine_observer_queue);
+static K_MUTEX_DEFINE(observer_lock);
 static sys_slist_t engine_service_list;
 
 static K_THREAD_STACK_DEFINE(engine_thread_stack,
@@ -378,6 +397,65 @@ static void clear_attrs(void *ref)
 	}
 }
 
+static int observer_due_after(sys_dnode_t *node, void *data)
+{
+	struct observe_node *obs = CONTAINER_OF(node, struct observe_node,
+						due_node);
+
+	return obs->due_timestamp > *(s64_t *)data;
+}
+
+/* Queue the observer by the time of its next notification: a pending
+ * event is notified once pmin has elapsed, otherwise the value is notified
+ * again after pmax.
+ */
+static void observer_schedule(struct observe_node *obs)
+{
+	s64_t delay;
+
+	k_mutex_lock(&observer_lock, K_FOREVER);
+
+	if (sys_dnode_is_linked(&obs->due_node)) {
+		sys_dlist_remove(&obs->due_node);
+	}
+
+	if (obs->event_pending) {
+		obs->due_timestamp = obs->last_timestamp +
+				     K_SECONDS(obs->min_period_sec);
+	} else if (obs->max_period_sec > 0) {
+		obs->due_timestamp = obs->last_timestamp +
+				     K_SECONDS(obs->max_period_sec);
+	} else {
+		/* nothing to notify until the next event */
+		goto unlock;
+	}
+
+	sys_dlist_insert_at(&engine_observer_queue, &obs->due_node,
+			    observer_due_after, &obs->due_timestamp);
+
+	/* wake up the service earlier for the first notification due */
+	if (sys_dlist_peek_head(&engine_observer_queue) == &obs->due_node) {
+		delay = MAX(obs->due_timestamp - k_uptime_get(), 0);
+		if (delay < k_delayed_work_remaining_get(&periodic_work)) {
+			k_delayed_work_submit(&periodic_work, delay);
+		}
+	}
+
+unlock:
+	k_mutex_unlock(&observer_lock);
+}
+
+static void observer_unschedule(struct observe_node *obs)
+{
+	k_mutex_lock(&observer_lock, K_FOREVER);
+
+	if (sys_dnode_is_linked(&obs->due_node)) {
+		sys_dlist_remove(&obs->due_node);
+	}
+
+	k_mutex_unlock(&observer_lock);
+}
+
 int lwm2m_notify_observer(u16_t obj_id, u16_t obj_inst_id, u16_t res_id)
 {
 	struct observe_node *obs;
@@ -389,8 +467,9 @@ int lwm2m_notify_observer(u16_t obj_id, u16_t obj_inst_id, u16_t res_id)
 		    obs->path.obj_inst_id == obj_inst_id &&
 		    (obs->path.level < 3 ||
 		     obs->path.res_id == res_id)) {
-			/* update the event time for this observer */
-			obs->event_timestamp = k_uptime_get();
+			/* the event is notified once pmin has elapsed */
+			obs->event_pending = true;
+			observer_schedule(obs);
 
 			LOG_DBG("NOTIFY EVENT %u/%u/%u",
 				obj_id, obj_inst_id, res_id);
@@ -538,14 +617,13 @@ static int engine_add_observer(struct lwm2m_message *msg,
 	memcpy(observe_node_data[i].token, token, tkl);
 	observe_node_data[i].tkl = tkl;
 	observe_node_data[i].last_timestamp = k_uptime_get();
-	observe_node_data[i].event_timestamp =
-			observe_node_data[i].last_timestamp;
 	observe_node_data[i].min_period_sec = attrs.pmin;
 	observe_node_data[i].max_period_sec = MAX(attrs.pmax, attrs.pmin);
 	observe_node_data[i].format = format;
 	observe_node_data[i].counter = 1U;
 	sys_slist_append(&engine_observer_list,
 			 &observe_node_data[i].node);
+	observer_schedule(&observe_node_data[i]);
 
 	LOG_DBG("OBSERVER ADDED %u/%u/%u(%u) token:'%s' addr:%s",
 		msg->path.obj_id, msg->path.obj_inst_id,
@@ -582,6 +660,7 @@ static int engine_remove_observer(const u8_t *token, u8_t tkl)
 	}
 
 	sys_slist_remove(&engine_observer_list, prev_node, &found_obj->node);
+	observer_unschedule(found_obj);
 	(void)memset(found_obj, 0, sizeof(*found_obj));
 
 	LOG_DBG("observer '%s' removed", sprint_token(token, tkl));
@@ -604,28 +683,42 @@ static void engine_remove_observer_by_id(u16_t obj_id, s32_t obj_inst_id)
 		}
 
 		sys_slist_remove(&engine_observer_list, prev_node, &obs->node);
+		observer_unschedule(obs);
 		(void)memset(obs, 0, sizeof(*obs));
 	}
 }
 
 /* engine object */
 
+static sys_slist_t *engine_obj_hash_bucket(u16_t obj_id)
+{
+	return &engine_obj_hash[net_hash_fib(obj_id) %
+				CONFIG_LWM2M_ENGINE_HASH_SIZE];
+}
+
 void lwm2m_register_obj(struct lwm2m_engine_obj *obj)
 {
 	sys_slist_append(&engine_obj_list, &obj->node);
+	sys_slist_prepend(engine_obj_hash_bucket(obj->obj_id),
+			  &obj->hash_node);
+	engine_generation++;
 }
 
 void lwm2m_unregister_obj(struct lwm2m_engine_obj *obj)
 {
 	engine_remove_observer_by_id(obj->obj_id, -1);
 	sys_slist_find_and_remove(&engine_obj_list, &obj->node);
+	sys_slist_find_and_remove(engine_obj_hash_bucket(obj->obj_id),
+				  &obj->hash_node);
+	engine_generation++;
 }
 
 static struct lwm2m_engine_obj *get_engine_obj(int obj_id)
 {
 	struct lwm2m_engine_obj *obj;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_list, obj, node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(engine_obj_hash_bucket(obj_id), obj,
+				     hash_node) {
 		if (obj->obj_id == obj_id) {
 			return obj;
 		}
@@ -652,9 +745,21 @@ lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 
 /* engine object instance */
 
+static sys_slist_t *engine_obj_inst_hash_bucket(u16_t obj_id,
+						u16_t obj_inst_id)
+{
+	u32_t hash = net_hash_fib((obj_id << 16) | obj_inst_id);
+
+	return &engine_obj_inst_hash[hash % CONFIG_LWM2M_ENGINE_HASH_SIZE];
+}
+
 static void engine_register_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 {
 	sys_slist_append(&engine_obj_inst_list, &obj_inst->node);
+	sys_slist_prepend(engine_obj_inst_hash_bucket(obj_inst->obj->obj_id,
+						      obj_inst->obj_inst_id),
+			  &obj_inst->hash_node);
+	engine_generation++;
 }
 
 static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
@@ -662,6 +767,11 @@ static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 	engine_remove_observer_by_id(
 			obj_inst->obj->obj_id, obj_inst->obj_inst_id);
 	sys_slist_find_and_remove(&engine_obj_inst_list, &obj_inst->node);
+	sys_slist_find_and_remove(
+		engine_obj_inst_hash_bucket(obj_inst->obj->obj_id,
+					    obj_inst->obj_inst_id),
+		&obj_inst->hash_node);
+	engine_generation++;
 }
 
 static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
@@ -669,8 +779,9 @@ static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
 {
 	struct lwm2m_engine_obj_inst *obj_inst;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
-				     node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(engine_obj_inst_hash_bucket(obj_id,
+								 obj_inst_id),
+				     obj_inst, hash_node) {
 		if (obj_inst->obj->obj_id == obj_id &&
 		    obj_inst->obj_inst_id == obj_inst_id) {
 			return obj_inst;
@@ -1144,6 +1255,18 @@ static int select_writer(struct lwm2m_output_context *out, u16_t accept)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_CBOR:
+		out->writer = &cbor_writer;
+		break;
+#endif
+
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		out->writer = &senml_cbor_writer;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", accept);
 		return -ENOMSG;
@@ -1175,6 +1298,15 @@ static int select_reader(struct lwm2m_input_context *in, u16_t format)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_CBOR:
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+#endif
+		in->reader = &cbor_reader;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", format);
 		return -ENOMSG;
@@ -1363,41 +1495,17 @@ int lwm2m_engine_set_res_data(char *pathstr, void *data_ptr, u16_t data_len,
 	return ret;
 }
 
-static int lwm2m_engine_set(char *pathstr, void *value, u16_t len)
+static int engine_set_res(struct lwm2m_obj_path *path,
+			  struct lwm2m_engine_obj_inst *obj_inst,
+			  struct lwm2m_engine_obj_field *obj_field,
+			  struct lwm2m_engine_res_inst *res,
+			  void *value, u16_t len)
 {
-	struct lwm2m_obj_path path;
-	struct lwm2m_engine_obj_inst *obj_inst;
-	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_engine_res_inst *res = NULL;
 	void *data_ptr = NULL;
 	size_t data_len = 0;
 	int ret = 0;
 	bool changed = false;
 
-	LOG_DBG("path:%s, value:%p, len:%d", pathstr, value, len);
-
-	/* translate path -> path_obj */
-	ret = string_to_path(pathstr, &path, '/');
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (path.level < 3) {
-		LOG_ERR("path must have 3 parts");
-		return -EINVAL;
-	}
-
-	/* look up resource obj */
-	ret = path_to_objs(&path, &obj_inst, &obj_field, &res);
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (!res) {
-		LOG_ERR("res instance %d not found", path.res_id);
-		return -ENOENT;
-	}
-
 	if (LWM2M_HAS_RES_FLAG(res, LWM2M_RES_DATA_FLAG_RO)) {
 		LOG_ERR("res data pointer is read-only");
 		return -EACCES;
@@ -1421,7 +1529,7 @@ static int lwm2m_engine_set(char *pathstr, void *value, u16_t len)
 	if (len > res->data_len -
 		(obj_field->data_type == LWM2M_RES_TYPE_STRING ? 1 : 0)) {
 		LOG_ERR("length %u is too long for resource %d data",
-			len, path.res_id);
+			len, path->res_id);
 		return -ENOMEM;
 	}
 
@@ -1503,12 +1611,42 @@ static int lwm2m_engine_set(char *pathstr, void *value, u16_t len)
 	}
 
 	if (changed) {
-		NOTIFY_OBSERVER_PATH(&path);
+		NOTIFY_OBSERVER_PATH(path);
 	}
 
 	return ret;
 }
 
+static int lwm2m_engine_set(char *pathstr, void *value, u16_t len)
+{
+	struct lwm2m_obj_path path;
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res_inst *res = NULL;
+	int ret = 0;
+
+	LOG_DBG("path:%s, value:%p, len:%d", pathstr, value, len);
+
+	/* translate path -> path_obj */
+	ret = string_to_path(pathstr, &path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (path.level < 3) {
+		LOG_ERR("path must have 3 parts");
+		return -EINVAL;
+	}
+
+	/* look up resource obj */
+	ret = path_to_objs(&path, &obj_inst, &obj_field, &res);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_set_res(&path, obj_inst, obj_field, res, value, len);
+}
+
 int lwm2m_engine_set_opaque(char *pathstr, char *data_ptr, u16_t data_len)
 {
 	return lwm2m_engine_set(pathstr, data_ptr, data_len);
@@ -1609,40 +1747,14 @@ int lwm2m_engine_get_res_data(char *pathstr, void **data_ptr, u16_t *data_len,
 	return 0;
 }
 
-static int lwm2m_engine_get(char *pathstr, void *buf, u16_t buflen)
+static int engine_get_res(struct lwm2m_engine_obj_inst *obj_inst,
+			  struct lwm2m_engine_obj_field *obj_field,
+			  struct lwm2m_engine_res_inst *res,
+			  void *buf, u16_t buflen)
 {
-	int ret = 0;
-	struct lwm2m_obj_path path;
-	struct lwm2m_engine_obj_inst *obj_inst;
-	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_engine_res_inst *res = NULL;
 	void *data_ptr = NULL;
 	size_t data_len = 0;
 
-	LOG_DBG("path:%s, buf:%p, buflen:%d", pathstr, buf, buflen);
-
-	/* translate path -> path_obj */
-	ret = string_to_path(pathstr, &path, '/');
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (path.level < 3) {
-		LOG_ERR("path must have 3 parts");
-		return -EINVAL;
-	}
-
-	/* look up resource obj */
-	ret = path_to_objs(&path, &obj_inst, &obj_field, &res);
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (!res) {
-		LOG_ERR("res instance %d not found", path.res_id);
-		return -ENOENT;
-	}
-
 	/* setup initial data elements */
 	data_ptr = res->data_ptr;
 	data_len = res->data_len;
@@ -1731,6 +1843,36 @@ static int lwm2m_engine_get(char *pathstr, void *buf, u16_t buflen)
 	return 0;
 }
 
+static int lwm2m_engine_get(char *pathstr, void *buf, u16_t buflen)
+{
+	int ret = 0;
+	struct lwm2m_obj_path path;
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res_inst *res = NULL;
+
+	LOG_DBG("path:%s, buf:%p, buflen:%d", pathstr, buf, buflen);
+
+	/* translate path -> path_obj */
+	ret = string_to_path(pathstr, &path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (path.level < 3) {
+		LOG_ERR("path must have 3 parts");
+		return -EINVAL;
+	}
+
+	/* look up resource obj */
+	ret = path_to_objs(&path, &obj_inst, &obj_field, &res);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_get_res(obj_inst, obj_field, res, buf, buflen);
+}
+
 int lwm2m_engine_get_opaque(char *pathstr, void *buf, u16_t buflen)
 {
 	return lwm2m_engine_get(pathstr, buf, buflen);
@@ -1822,6 +1964,240 @@ int lwm2m_engine_get_resource(char *pathstr, struct lwm2m_engine_res_inst **res)
 	return path_to_objs(&path, NULL, NULL, res);
 }
 
+/* resource handle functions */
+
+/* Resolve the handle again if objects or object instances were added or
+ * removed since it was last resolved.
+ */
+static int handle_to_objs(struct lwm2m_res_handle *handle,
+			  struct lwm2m_obj_path *path)
+{
+	int ret;
+
+	path->obj_id = handle->obj_id;
+	path->obj_inst_id = handle->obj_inst_id;
+	path->res_id = handle->res_id;
+	path->res_inst_id = 0U;
+	path->level = 3U;
+
+	if (handle->res && handle->generation == engine_generation) {
+		return 0;
+	}
+
+	handle->res = NULL;
+
+	ret = path_to_objs(path, &handle->obj_inst, &handle->obj_field,
+			   &handle->res);
+	if (ret < 0) {
+		return ret;
+	}
+
+	handle->generation = engine_generation;
+
+	return 0;
+}
+
+int lwm2m_engine_get_res_handle(char *pathstr, struct lwm2m_res_handle *handle)
+{
+	struct lwm2m_obj_path path;
+	int ret;
+
+	ret = string_to_path(pathstr, &path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (path.level < 3) {
+		LOG_ERR("path must have 3 parts");
+		return -EINVAL;
+	}
+
+	(void)memset(handle, 0, sizeof(*handle));
+	handle->obj_id = path.obj_id;
+	handle->obj_inst_id = path.obj_inst_id;
+	handle->res_id = path.res_id;
+
+	return handle_to_objs(handle, &path);
+}
+
+static int lwm2m_engine_handle_set(struct lwm2m_res_handle *handle,
+				   void *value, u16_t len)
+{
+	struct lwm2m_obj_path path;
+	int ret;
+
+	ret = handle_to_objs(handle, &path);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_set_res(&path, handle->obj_inst, handle->obj_field,
+			      handle->res, value, len);
+}
+
+int lwm2m_engine_handle_set_opaque(struct lwm2m_res_handle *handle,
+				   char *data_ptr, u16_t data_len)
+{
+	return lwm2m_engine_handle_set(handle, data_ptr, data_len);
+}
+
+int lwm2m_engine_handle_set_string(struct lwm2m_res_handle *handle,
+				   char *data_ptr)
+{
+	return lwm2m_engine_handle_set(handle, data_ptr, strlen(data_ptr));
+}
+
+int lwm2m_engine_handle_set_u8(struct lwm2m_res_handle *handle, u8_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 1);
+}
+
+int lwm2m_engine_handle_set_u16(struct lwm2m_res_handle *handle, u16_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 2);
+}
+
+int lwm2m_engine_handle_set_u32(struct lwm2m_res_handle *handle, u32_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 4);
+}
+
+int lwm2m_engine_handle_set_u64(struct lwm2m_res_handle *handle, u64_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 8);
+}
+
+int lwm2m_engine_handle_set_s8(struct lwm2m_res_handle *handle, s8_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 1);
+}
+
+int lwm2m_engine_handle_set_s16(struct lwm2m_res_handle *handle, s16_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 2);
+}
+
+int lwm2m_engine_handle_set_s32(struct lwm2m_res_handle *handle, s32_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 4);
+}
+
+int lwm2m_engine_handle_set_s64(struct lwm2m_res_handle *handle, s64_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 8);
+}
+
+int lwm2m_engine_handle_set_bool(struct lwm2m_res_handle *handle, bool value)
+{
+	u8_t temp = (value != 0 ? 1 : 0);
+
+	return lwm2m_engine_handle_set(handle, &temp, 1);
+}
+
+int lwm2m_engine_handle_set_float32(struct lwm2m_res_handle *handle,
+				    float32_value_t *value)
+{
+	return lwm2m_engine_handle_set(handle, value, sizeof(float32_value_t));
+}
+
+int lwm2m_engine_handle_set_float64(struct lwm2m_res_handle *handle,
+				    float64_value_t *value)
+{
+	return lwm2m_engine_handle_set(handle, value, sizeof(float64_value_t));
+}
+
+static int lwm2m_engine_handle_get(struct lwm2m_res_handle *handle,
+				   void *buf, u16_t buflen)
+{
+	struct lwm2m_obj_path path;
+	int ret;
+
+	ret = handle_to_objs(handle, &path);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_get_res(handle->obj_inst, handle->obj_field, handle->res,
+			      buf, buflen);
+}
+
+int lwm2m_engine_handle_get_opaque(struct lwm2m_res_handle *handle,
+				   void *buf, u16_t buflen)
+{
+	return lwm2m_engine_handle_get(handle, buf, buflen);
+}
+
+int lwm2m_engine_handle_get_string(struct lwm2m_res_handle *handle,
+				   void *buf, u16_t buflen)
+{
+	return lwm2m_engine_handle_get(handle, buf, buflen);
+}
+
+int lwm2m_engine_handle_get_u8(struct lwm2m_res_handle *handle, u8_t *value)
+{
+	return lwm2m_engine_handle_get(handle, value, 1);
+}
+
+int lwm2m_engine_handle_get_u16(struct lwm2m_res_handle *handle, u16_t *value)
+{
+	return lwm2m_engine_handle_get(handle, value, 2);
+}
+
+int lwm2m_engine_handle_get_u32(struct lwm2m_res_handle *handle, u32_t *value)
+{
+	return lwm2m_engine_handle_get(handle, value, 4);
+}
+
+int lwm2m_engine_handle_get_u64(struct lwm2m_res_handle *handle, u64_t *value)
+{
+	return lwm2m_engine_handle_get(handle, value, 8);
+}
+
+int lwm2m_engine_handle_get_s8(struct lwm2m_res_handle *handle, s8_t *value)
+{
+	return lwm2m_engine_handle_get(handle, value, 1);
+}
+
+int lwm2m_engine_handle_get_s16(struct lwm2m_res_handle *handle, s16_t *value)
+{
+	return lwm2m_engine_handle_get(handle, value, 2);
+}
+
+int lwm2m_engine_handle_get_s32(struct lwm2m_res_handle *handle, s32_t *value)
+{
+	return lwm2m_engine_handle_get(handle, value, 4);
+}
+
+int lwm2m_engine_handle_get_s64(struct lwm2m_res_handle *handle, s64_t *value)
+{
+	return lwm2m_engine_handle_get(handle, value, 8);
+}
+
+int lwm2m_engine_handle_get_bool(struct lwm2m_res_handle *handle, bool *value)
+{
+	int ret = 0;
+	s8_t temp = 0;
+
+	ret = lwm2m_engine_handle_get_s8(handle, &temp);
+	if (!ret) {
+		*value = temp != 0;
+	}
+
+	return ret;
+}
+
+int lwm2m_engine_handle_get_float32(struct lwm2m_res_handle *handle,
+				    float32_value_t *buf)
+{
+	return lwm2m_engine_handle_get(handle, buf, sizeof(float32_value_t));
+}
+
+int lwm2m_engine_handle_get_float64(struct lwm2m_res_handle *handle,
+				    float64_value_t *buf)
+{
+	return lwm2m_engine_handle_get(handle, buf, sizeof(float64_value_t));
+}
+
 int lwm2m_engine_register_read_callback(char *pathstr,
 					lwm2m_engine_get_data_cb_t cb)
 {
@@ -2595,6 +2971,7 @@ static int lwm2m_write_attr_handler(struct lwm2m_engine_obj *obj,
 			nattrs.pmin, MAX(nattrs.pmin, nattrs.pmax));
 		obs->min_period_sec = (u32_t)nattrs.pmin;
 		obs->max_period_sec = (u32_t)MAX(nattrs.pmin, nattrs.pmax);
+		observer_schedule(obs);
 		(void)memset(&nattrs, 0, sizeof(nattrs));
 	}
 
@@ -2652,6 +3029,10 @@ static int do_read_op(struct lwm2m_engine_obj *obj,
 	case LWM2M_FORMAT_APP_OCTET_STREAM:
 	case LWM2M_FORMAT_PLAIN_TEXT:
 	case LWM2M_FORMAT_OMA_PLAIN_TEXT:
+#ifdef CONFIG_LWM2M_RW_CBOR_SUPPORT
+	/* CBOR carries a single resource value as plain text does */
+	case LWM2M_FORMAT_APP_CBOR:
+#endif
 		return do_read_op_plain_text(obj, msg, content_format);
 
 	case LWM2M_FORMAT_OMA_TLV:
@@ -2664,6 +3045,11 @@ static int do_read_op(struct lwm2m_engine_obj *obj,
 		return do_read_op_json(obj, msg, content_format);
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_read_op_senml_cbor(obj, msg, content_format);
+#endif
+
 	default:
 		LOG_ERR("Unsupported content-format: %u", content_format);
 		return -ENOMSG;
@@ -3057,6 +3443,9 @@ static int do_write_op(struct lwm2m_engine_obj *obj,
 	case LWM2M_FORMAT_APP_OCTET_STREAM:
 	case LWM2M_FORMAT_PLAIN_TEXT:
 	case LWM2M_FORMAT_OMA_PLAIN_TEXT:
+#ifdef CONFIG_LWM2M_RW_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_CBOR:
+#endif
 		return do_write_op_plain_text(obj, msg);
 
 	case LWM2M_FORMAT_OMA_TLV:
@@ -3069,6 +3458,11 @@ static int do_write_op(struct lwm2m_engine_obj *obj,
 		return do_write_op_json(obj, msg);
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_write_op_senml_cbor(obj, msg);
+#endif
+
 	default:
 		LOG_ERR("Unsupported format: %u", format);
 		return -ENOMSG;
@@ -3716,10 +4110,24 @@ cleanup:
 
 s32_t engine_next_service_timeout_ms(u32_t max_timeout)
 {
+	struct observe_node *obs;
 	struct service_node *srv;
 	u64_t time_left_ms, timestamp = k_uptime_get();
 	u32_t timeout = max_timeout;
 
+	/* the first notification due */
+	obs = SYS_DLIST_PEEK_HEAD_CONTAINER(&engine_observer_queue, obs,
+					    due_node);
+	if (obs) {
+		if (obs->due_timestamp <= timestamp) {
+			return 0;
+		}
+
+		if (obs->due_timestamp - timestamp < timeout) {
+			timeout = obs->due_timestamp - timestamp;
+		}
+	}
+
 	SYS_SLIST_FOR_EACH_CONTAINER(&engine_service_list, srv, node) {
 		time_left_ms = srv->last_timestamp +
 				  K_MSEC(srv->min_call_period);
@@ -3764,44 +4172,105 @@ int lwm2m_engine_add_service(k_work_handler_t service, u32_t period_ms)
 	return 0;
 }
 
-static void lwm2m_engine_service(struct k_work *work)
+#if CONFIG_LWM2M_ENGINE_NOTIFY_BATCH_WINDOW > 0
+static bool observer_ctx_due(sys_dlist_t *due_list, struct lwm2m_ctx *ctx)
+{
+	struct observe_node *obs;
+
+	SYS_DLIST_FOR_EACH_CONTAINER(due_list, obs, due_node) {
+		if (obs->ctx == ctx) {
+			return true;
+		}
+	}
+
+	return false;
+}
+#endif
+
+static void notify_due_observers(s64_t timestamp)
 {
 	struct observe_node *obs;
+	sys_dlist_t due_list;
+	bool manual_trigger;
+#if CONFIG_LWM2M_ENGINE_NOTIFY_BATCH_WINDOW > 0
+	struct observe_node *next;
+#endif
+
+	sys_dlist_init(&due_list);
+
+	k_mutex_lock(&observer_lock, K_FOREVER);
+
+	/* the queue is sorted, only the observers due are looked at */
+	while ((obs = SYS_DLIST_PEEK_HEAD_CONTAINER(&engine_observer_queue,
+						    obs, due_node)) &&
+	       obs->due_timestamp <= timestamp) {
+		sys_dlist_remove(&obs->due_node);
+		sys_dlist_append(&due_list, &obs->due_node);
+	}
+
+#if CONFIG_LWM2M_ENGINE_NOTIFY_BATCH_WINDOW > 0
+	/* the servers notified now also get the notifications due soon */
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&engine_observer_queue, obs, next,
+					  due_node) {
+		if (obs->due_timestamp > timestamp +
+		    CONFIG_LWM2M_ENGINE_NOTIFY_BATCH_WINDOW) {
+			break;
+		}
+
+		if (timestamp < obs->last_timestamp +
+				K_SECONDS(obs->min_period_sec) ||
+		    !observer_ctx_due(&due_list, obs->ctx)) {
+			continue;
+		}
+
+		sys_dlist_remove(&obs->due_node);
+		sys_dlist_append(&due_list, &obs->due_node);
+	}
+#endif
+
+	k_mutex_unlock(&observer_lock);
+
+	while (true) {
+		k_mutex_lock(&observer_lock, K_FOREVER);
+		obs = SYS_DLIST_PEEK_HEAD_CONTAINER(&due_list, obs, due_node);
+		if (obs) {
+			sys_dlist_remove(&obs->due_node);
+		}
+
+		k_mutex_unlock(&observer_lock);
+
+		if (!obs) {
+			break;
+		}
+
+		/*
+		 * manual notify: an event happened since the last
+		 * notification, otherwise automatic time-based notify
+		 */
+		manual_trigger = obs->event_pending;
+		obs->event_pending = false;
+		obs->last_timestamp = k_uptime_get();
+		generate_notify_message(obs, manual_trigger);
+
+		/* unless removed while notifying */
+		if (obs->ctx) {
+			observer_schedule(obs);
+		}
+	}
+}
+
+static void lwm2m_engine_service(struct k_work *work)
+{
 	struct service_node *srv;
 	s64_t timestamp, service_due_timestamp;
 	s32_t sleep_ms;
 	int ret;
 
 	/*
-	 * 1. scan the observer list
-	 * 2. For each notify event found, scan the observer list
-	 * 3. For each observer match, generate a NOTIFY message,
-	 *    attaching the notify response handler
+	 * Generate a NOTIFY message for each observer due, attaching the
+	 * notify response handler
 	 */
-	timestamp = k_uptime_get();
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
-		/*
-		 * manual notify requirements:
-		 * - event_timestamp > last_timestamp
-		 * - current timestamp > last_timestamp + min_period_sec
-		 */
-		if (obs->event_timestamp > obs->last_timestamp &&
-		    timestamp > obs->last_timestamp +
-				K_SECONDS(obs->min_period_sec)) {
-			obs->last_timestamp = k_uptime_get();
-			generate_notify_message(obs, true);
-
-		/*
-		 * automatic time-based notify requirements:
-		 * - current timestamp > last_timestamp + max_period_sec
-		 */
-		} else if (timestamp > obs->last_timestamp +
-				K_SECONDS(obs->min_period_sec)) {
-			obs->last_timestamp = k_uptime_get();
-			generate_notify_message(obs, false);
-		}
-
-	}
+	notify_due_observers(k_uptime_get());
 
 	timestamp = k_uptime_get();
 	SYS_SLIST_FOR_EACH_CONTAINER(&engine_service_list, srv, node) {
@@ -3815,8 +4284,10 @@ static void lwm2m_engine_service(struct k_work *work)
 	}
 
 	/* calculate how long to sleep till the next service */
+	k_mutex_lock(&observer_lock, K_FOREVER);
 	sleep_ms = engine_next_service_timeout_ms(ENGINE_UPDATE_INTERVAL);
 	ret = k_delayed_work_submit(&periodic_work, sleep_ms);
+	k_mutex_unlock(&observer_lock);
 	if (ret < 0) {
 		LOG_ERR("Work submit error:%d", ret);
 	}
@@ -3834,6 +4305,7 @@ int lwm2m_engine_context_close(struct lwm2m_ctx *client_ctx)
 		if (obs->ctx == client_ctx) {
 			sys_slist_remove(&engine_observer_list, prev_node,
 					 &obs->node);
+			observer_unschedule(obs);
 			(void)memset(obs, 0, sizeof(*obs));
 		} else {
 			prev_node = &obs->node;
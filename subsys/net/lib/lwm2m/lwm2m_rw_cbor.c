@@ -0,0 +1,565 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * CBOR (RFC 7049) content format, application/cbor
+ *
+ * A CBOR payload carries the value of a single resource, as plain text
+ * does. The data items are encoded and decoded with tinycbor, directly in
+ * the CoAP packets. The writer and reader of the packets, and the encoding
+ * of the values, are shared with the SenML-CBOR content format.
+ */
+
+#define LOG_MODULE_NAME net_lwm2m_cbor
+#define LOG_LEVEL CONFIG_LWM2M_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <string.h>
+#include <stdint.h>
+#include <misc/byteorder.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_rw_cbor.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_util.h"
+
+/* parser of the data item at the offset of the input */
+struct cbor_in_value {
+	struct cbor_in_reader reader;
+	CborParser parser;
+	CborValue value;
+};
+
+static int cbor_out_write(struct cbor_encoder_writer *writer,
+			  const char *data, int len)
+{
+	struct cbor_out_writer *cow = (struct cbor_out_writer *)writer;
+
+	if (buf_append(CPKT_BUF_WRITE(cow->cpkt), (u8_t *)data, len) < 0) {
+		return CborErrorOutOfMemory;
+	}
+
+	cow->enc.bytes_written += len;
+
+	return CborNoError;
+}
+
+void cbor_out_writer_init(struct cbor_out_writer *cow,
+			  struct lwm2m_output_context *out)
+{
+	cow->cpkt = out->out_cpkt;
+	cow->enc.bytes_written = 0;
+	cow->enc.write = &cbor_out_write;
+}
+
+/* Return the input data at the offset of the reader, or NULL if the input
+ * is shorter.
+ */
+static u8_t *cbor_in_data(struct cbor_decoder_reader *d, int offset,
+			  size_t len)
+{
+	struct cbor_in_reader *cir = (struct cbor_in_reader *)d;
+
+	if (offset < 0 || len > d->message_size ||
+	    (size_t)offset > d->message_size - len) {
+		return NULL;
+	}
+
+	return cir->cpkt->data + cir->base + offset;
+}
+
+static uint8_t cbor_in_get8(struct cbor_decoder_reader *d, int offset)
+{
+	u8_t *data = cbor_in_data(d, offset, sizeof(u8_t));
+
+	return data ? *data : UINT8_MAX;
+}
+
+static uint16_t cbor_in_get16(struct cbor_decoder_reader *d, int offset)
+{
+	u8_t *data = cbor_in_data(d, offset, sizeof(u16_t));
+
+	return data ? sys_get_be16(data) : UINT16_MAX;
+}
+
+static uint32_t cbor_in_get32(struct cbor_decoder_reader *d, int offset)
+{
+	u8_t *data = cbor_in_data(d, offset, sizeof(u32_t));
+
+	return data ? sys_get_be32(data) : UINT32_MAX;
+}
+
+static uint64_t cbor_in_get64(struct cbor_decoder_reader *d, int offset)
+{
+	u8_t *data = cbor_in_data(d, offset, sizeof(u64_t));
+
+	if (!data) {
+		return UINT64_MAX;
+	}
+
+	return ((u64_t)sys_get_be32(data) << 32) | sys_get_be32(data + 4);
+}
+
+static uintptr_t cbor_in_cmp(struct cbor_decoder_reader *d, char *buf,
+			     int offset, size_t len)
+{
+	u8_t *data = cbor_in_data(d, offset, len);
+
+	if (!data) {
+		return -1;
+	}
+
+	return memcmp(data, buf, len);
+}
+
+static uintptr_t cbor_in_cpy(struct cbor_decoder_reader *d, char *dst,
+			     int offset, size_t len)
+{
+	u8_t *data = cbor_in_data(d, offset, len);
+
+	if (!data) {
+		return -1;
+	}
+
+	return (uintptr_t)memcpy(dst, data, len);
+}
+
+static uintptr_t cbor_in_get_string_chunk(struct cbor_decoder_reader *d,
+					  int offset, size_t *len)
+{
+	return (uintptr_t)cbor_in_data(d, offset, *len);
+}
+
+void cbor_in_reader_init(struct cbor_in_reader *cir,
+			 struct lwm2m_input_context *in)
+{
+	cir->r.get8 = &cbor_in_get8;
+	cir->r.get16 = &cbor_in_get16;
+	cir->r.get32 = &cbor_in_get32;
+	cir->r.get64 = &cbor_in_get64;
+	cir->r.cmp = &cbor_in_cmp;
+	cir->r.cpy = &cbor_in_cpy;
+	cir->r.get_string_chunk = &cbor_in_get_string_chunk;
+
+	cir->cpkt = in->in_cpkt;
+	cir->base = in->offset;
+	cir->r.message_size = (in->offset < in->in_cpkt->max_len) ?
+			      in->in_cpkt->max_len - in->offset : 0;
+}
+
+CborError cbor_put_float32fix(CborEncoder *encoder, float32_value_t *value)
+{
+	u8_t b32[4];
+	u32_t bits;
+	int ret;
+
+	ret = lwm2m_f32_to_b32(value, b32, sizeof(b32));
+	if (ret < 0) {
+		LOG_ERR("float32 conversion error: %d", ret);
+		return CborErrorIllegalNumber;
+	}
+
+	bits = sys_get_be32(b32);
+	return cbor_encode_floating_point(encoder, CborFloatType, &bits);
+}
+
+CborError cbor_put_float64fix(CborEncoder *encoder, float64_value_t *value)
+{
+	u8_t b64[8];
+	u64_t bits;
+	int ret;
+
+	ret = lwm2m_f64_to_b64(value, b64, sizeof(b64));
+	if (ret < 0) {
+		LOG_ERR("float64 conversion error: %d", ret);
+		return CborErrorIllegalNumber;
+	}
+
+	bits = ((u64_t)sys_get_be32(b64) << 32) | sys_get_be32(b64 + 4);
+	return cbor_encode_floating_point(encoder, CborDoubleType, &bits);
+}
+
+/* Return the length of the data item written, a data item that could not
+ * be written whole is removed from the packet.
+ */
+static size_t put_end(struct cbor_out_writer *writer, CborError err)
+{
+	if (err != CborNoError) {
+		writer->cpkt->offset -= writer->enc.bytes_written;
+		return 0;
+	}
+
+	return writer->enc.bytes_written;
+}
+
+static size_t put_s64(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s64_t value)
+{
+	struct cbor_out_writer writer;
+	CborEncoder encoder;
+
+	cbor_out_writer_init(&writer, out);
+	cbor_encoder_cust_writer_init(&encoder, &writer.enc, 0);
+
+	return put_end(&writer, cbor_encode_int(&encoder, value));
+}
+
+static size_t put_s32(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s32_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_s16(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s16_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_s8(struct lwm2m_output_context *out,
+		     struct lwm2m_obj_path *path, s8_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_string(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	struct cbor_out_writer writer;
+	CborEncoder encoder;
+
+	cbor_out_writer_init(&writer, out);
+	cbor_encoder_cust_writer_init(&encoder, &writer.enc, 0);
+
+	return put_end(&writer,
+		       cbor_encode_text_string(&encoder, buf, buflen));
+}
+
+static size_t put_float32fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float32_value_t *value)
+{
+	struct cbor_out_writer writer;
+	CborEncoder encoder;
+
+	cbor_out_writer_init(&writer, out);
+	cbor_encoder_cust_writer_init(&encoder, &writer.enc, 0);
+
+	return put_end(&writer, cbor_put_float32fix(&encoder, value));
+}
+
+static size_t put_float64fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float64_value_t *value)
+{
+	struct cbor_out_writer writer;
+	CborEncoder encoder;
+
+	cbor_out_writer_init(&writer, out);
+	cbor_encoder_cust_writer_init(&encoder, &writer.enc, 0);
+
+	return put_end(&writer, cbor_put_float64fix(&encoder, value));
+}
+
+static size_t put_bool(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path, bool value)
+{
+	struct cbor_out_writer writer;
+	CborEncoder encoder;
+
+	cbor_out_writer_init(&writer, out);
+	cbor_encoder_cust_writer_init(&encoder, &writer.enc, 0);
+
+	return put_end(&writer, cbor_encode_boolean(&encoder, value));
+}
+
+static size_t put_opaque(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	struct cbor_out_writer writer;
+	CborEncoder encoder;
+
+	cbor_out_writer_init(&writer, out);
+	cbor_encoder_cust_writer_init(&encoder, &writer.enc, 0);
+
+	return put_end(&writer,
+		       cbor_encode_byte_string(&encoder, (u8_t *)buf, buflen));
+}
+
+static int get_begin(struct lwm2m_input_context *in,
+		     struct cbor_in_value *civ)
+{
+	cbor_in_reader_init(&civ->reader, in);
+
+	if (cbor_parser_cust_reader_init(&civ->reader.r, 0, &civ->parser,
+					 &civ->value) != CborNoError) {
+		LOG_ERR("Invalid CBOR data item");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Move the input past the data item, and return its length */
+static size_t get_end(struct lwm2m_input_context *in,
+		      struct cbor_in_value *civ)
+{
+	if (cbor_value_advance(&civ->value) != CborNoError) {
+		LOG_ERR("Invalid CBOR data item");
+		return 0;
+	}
+
+	in->offset += civ->value.offset;
+	return civ->value.offset;
+}
+
+/* convert a binary16 to a binary32 */
+static u32_t half_to_b32(u16_t half)
+{
+	u32_t sign = (u32_t)(half & 0x8000) << 16;
+	s32_t e = (half >> 10) & 0x1f;
+	u32_t f = half & 0x3ff;
+
+	if (e == 0) {
+		if (f == 0U) {
+			return sign;
+		}
+
+		/* normalize the subnormal value */
+		e = 1;
+		while (!(f & 0x400)) {
+			f <<= 1;
+			e--;
+		}
+
+		f &= 0x3ff;
+	}
+
+	return sign | ((u32_t)(e - 15 + 127) << 23) | (f << 13);
+}
+
+/* The values are read as binary floating point data, only their bits are
+ * converted to the fixed point values.
+ */
+static int get_float(CborValue *value, float64_value_t *f64)
+{
+	float32_value_t f32;
+	u8_t b[8];
+	u16_t half;
+	u32_t bits;
+	u64_t bits64;
+	float f;
+	double d;
+	int ret;
+
+	switch (cbor_value_get_type(value)) {
+
+	case CborIntegerType:
+		f64->val2 = 0;
+		return (cbor_value_get_int64_checked(value, &f64->val1) ==
+			CborNoError) ? 0 : -EINVAL;
+
+	case CborHalfFloatType:
+	case CborFloatType:
+		if (cbor_value_is_half_float(value)) {
+			cbor_value_get_half_float(value, &half);
+			bits = half_to_b32(half);
+		} else {
+			cbor_value_get_float(value, &f);
+			memcpy(&bits, &f, sizeof(bits));
+		}
+
+		sys_put_be32(bits, b);
+		ret = lwm2m_b32_to_f32(b, 4, &f32);
+		f64->val1 = f32.val1;
+		f64->val2 = (s64_t)f32.val2 *
+			(LWM2M_FLOAT64_DEC_MAX / LWM2M_FLOAT32_DEC_MAX);
+		break;
+
+	case CborDoubleType:
+		cbor_value_get_double(value, &d);
+		memcpy(&bits64, &d, sizeof(bits64));
+
+		sys_put_be32(bits64 >> 32, b);
+		sys_put_be32(bits64, b + 4);
+		ret = lwm2m_b64_to_f64(b, 8, f64);
+		break;
+
+	default:
+		LOG_ERR("Not a number");
+		return -EINVAL;
+
+	}
+
+	if (ret < 0) {
+		LOG_ERR("float conversion error: %d", ret);
+		return ret;
+	}
+
+	return 0;
+}
+
+static size_t get_float64fix(struct lwm2m_input_context *in,
+			     float64_value_t *value)
+{
+	struct cbor_in_value civ;
+
+	if (get_begin(in, &civ) < 0 || get_float(&civ.value, value) < 0) {
+		return 0;
+	}
+
+	return get_end(in, &civ);
+}
+
+static size_t get_float32fix(struct lwm2m_input_context *in,
+			     float32_value_t *value)
+{
+	float64_value_t f64;
+	size_t len;
+
+	len = get_float64fix(in, &f64);
+	if (len > 0) {
+		value->val1 = (s32_t)f64.val1;
+		value->val2 = (s32_t)(f64.val2 /
+			(LWM2M_FLOAT64_DEC_MAX / LWM2M_FLOAT32_DEC_MAX));
+	}
+
+	return len;
+}
+
+static size_t get_s64(struct lwm2m_input_context *in, s64_t *value)
+{
+	struct cbor_in_value civ;
+
+	if (get_begin(in, &civ) < 0) {
+		return 0;
+	}
+
+	if (!cbor_value_is_integer(&civ.value) ||
+	    cbor_value_get_int64_checked(&civ.value, value) != CborNoError) {
+		LOG_ERR("Not an integer");
+		return 0;
+	}
+
+	return get_end(in, &civ);
+}
+
+static size_t get_s32(struct lwm2m_input_context *in, s32_t *value)
+{
+	s64_t tmp;
+	size_t len;
+
+	len = get_s64(in, &tmp);
+	if (len > 0) {
+		*value = (s32_t)tmp;
+	}
+
+	return len;
+}
+
+static size_t get_string(struct lwm2m_input_context *in,
+			 u8_t *buf, size_t buflen)
+{
+	struct cbor_in_value civ;
+	CborError err;
+	size_t len;
+
+	if (buflen == 0 || get_begin(in, &civ) < 0) {
+		return 0;
+	}
+
+	/* keep room for the terminating null character */
+	len = buflen - 1;
+
+	if (cbor_value_is_text_string(&civ.value)) {
+		err = cbor_value_copy_text_string(&civ.value, (char *)buf,
+						  &len, NULL);
+	} else if (cbor_value_is_byte_string(&civ.value)) {
+		err = cbor_value_copy_byte_string(&civ.value, buf, &len, NULL);
+	} else {
+		err = CborErrorIllegalType;
+	}
+
+	if (err != CborNoError) {
+		LOG_ERR("Invalid string: %d", err);
+		return 0;
+	}
+
+	buf[len] = '\0';
+	return get_end(in, &civ);
+}
+
+static size_t get_bool(struct lwm2m_input_context *in, bool *value)
+{
+	struct cbor_in_value civ;
+
+	if (get_begin(in, &civ) < 0) {
+		return 0;
+	}
+
+	if (!cbor_value_is_boolean(&civ.value)) {
+		LOG_ERR("Not a boolean");
+		return 0;
+	}
+
+	cbor_value_get_boolean(&civ.value, value);
+	return get_end(in, &civ);
+}
+
+static size_t get_opaque(struct lwm2m_input_context *in,
+			 u8_t *buf, size_t buflen, bool *last_block)
+{
+	struct cbor_in_value civ;
+	size_t len;
+
+	if (get_begin(in, &civ) < 0) {
+		return 0;
+	}
+
+	/* the data of the string is read directly from the packet */
+	if ((!cbor_value_is_byte_string(&civ.value) &&
+	     !cbor_value_is_text_string(&civ.value)) ||
+	    !cbor_value_is_length_known(&civ.value) ||
+	    cbor_value_get_string_length(&civ.value, &len) != CborNoError ||
+	    len > UINT16_MAX) {
+		LOG_ERR("Not a byte string");
+		return 0;
+	}
+
+	if (get_end(in, &civ) == 0) {
+		return 0;
+	}
+
+	in->offset -= len;
+	in->opaque_len = len;
+	return lwm2m_engine_get_opaque_more(in, buf, buflen, last_block);
+}
+
+const struct lwm2m_writer cbor_writer = {
+	.put_s8 = put_s8,
+	.put_s16 = put_s16,
+	.put_s32 = put_s32,
+	.put_s64 = put_s64,
+	.put_string = put_string,
+	.put_float32fix = put_float32fix,
+	.put_float64fix = put_float64fix,
+	.put_bool = put_bool,
+	.put_opaque = put_opaque,
+};
+
+const struct lwm2m_reader cbor_reader = {
+	.get_s32 = get_s32,
+	.get_s64 = get_s64,
+	.get_string = get_string,
+	.get_float32fix = get_float32fix,
+	.get_float64fix = get_float64fix,
+	.get_bool = get_bool,
+	.get_opaque = get_opaque,
+};
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LWM2M_RW_CBOR_H_
+#define LWM2M_RW_CBOR_H_
+
+#include "cbor.h"
+#include "cbor_encoder_writer.h"
+#include "cbor_decoder_reader.h"
+
+#include "lwm2m_object.h"
+
+/* tinycbor writer appending the encoded data to the output packet */
+struct cbor_out_writer {
+	struct cbor_encoder_writer enc;
+	struct coap_packet *cpkt;
+};
+
+/* tinycbor reader of the input packet, the offsets of the reader are
+ * relative to the offset of the input at its initialization.
+ */
+struct cbor_in_reader {
+	struct cbor_decoder_reader r;
+	struct coap_packet *cpkt;
+	u16_t base;
+};
+
+extern const struct lwm2m_writer cbor_writer;
+extern const struct lwm2m_reader cbor_reader;
+
+void cbor_out_writer_init(struct cbor_out_writer *cow,
+			  struct lwm2m_output_context *out);
+void cbor_in_reader_init(struct cbor_in_reader *cir,
+			 struct lwm2m_input_context *in);
+
+/* encoding of the values, shared with the SenML-CBOR writer */
+CborError cbor_put_float32fix(CborEncoder *encoder, float32_value_t *value);
+CborError cbor_put_float64fix(CborEncoder *encoder, float64_value_t *value);
+
+#endif /* LWM2M_RW_CBOR_H_ */
@@ -0,0 +1,659 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * SenML-CBOR (RFC 8428) content format, application/senml+cbor
+ *
+ * A pack is an array of records, each record is a map of a name and a
+ * value. The base name of the request path is given in the first record
+ * only, the names are relative to it as in the JSON content format:
+ *
+ * [{-2: "/3303/0/", 0: "5700", 2: 21.5}, {0: "5701", 3: "Cel"}]
+ *
+ * The packs are encoded and parsed with tinycbor, the values of the
+ * records are read with the CBOR reader.
+ */
+
+#define LOG_MODULE_NAME net_lwm2m_senml_cbor
+#define LOG_LEVEL CONFIG_LWM2M_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cbor_buf_writer.h"
+
+#include "lwm2m_object.h"
+#include "lwm2m_rw_cbor.h"
+#include "lwm2m_rw_senml_cbor.h"
+#include "lwm2m_engine.h"
+
+/* SenML labels */
+#define SENML_BN	-2
+#define SENML_N		0
+#define SENML_V		2
+#define SENML_VS	3
+#define SENML_VB	4
+#define SENML_VD	8
+
+/* any label not handled */
+#define SENML_UNKNOWN	INT16_MIN
+
+/* "/65535/65535/65535/65535" */
+#define NAME_BUF_LEN	25
+
+/* head of a pack of up to UINT16_MAX records */
+#define PACK_HEAD_LEN	3
+
+struct senml_out_formatter_data {
+	/* tinycbor writer and encoders of the pack */
+	struct cbor_out_writer writer;
+	CborEncoder encoder;
+	CborEncoder pack;
+
+	/* offset of the head of the pack */
+	u16_t mark_pos;
+
+	/* offset of the record being written */
+	u16_t record_pos;
+
+	/* number of records in the pack */
+	u16_t record_count;
+
+	/* the head of the pack could not be written */
+	bool failed;
+
+	/* flags */
+	u8_t writer_flags;
+
+	/* path storage */
+	u8_t path_level;
+};
+
+/* some temporary buffer space for format conversions */
+static char senml_buffer[NAME_BUF_LEN];
+
+static size_t put_begin(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path)
+{
+	struct senml_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->mark_pos = out->out_cpkt->offset;
+	fd->record_count = 0U;
+	fd->failed = false;
+
+	cbor_out_writer_init(&fd->writer, out);
+	cbor_encoder_cust_writer_init(&fd->encoder, &fd->writer.enc, 0);
+
+	/* the record count is written at the end of the pack, reserve the
+	 * largest head it needs.
+	 */
+	if (cbor_encoder_create_array(&fd->encoder, &fd->pack,
+				      UINT16_MAX) != CborNoError) {
+		/* no record is written, and the head is not rewritten */
+		out->out_cpkt->offset = fd->mark_pos;
+		fd->failed = true;
+		return 0;
+	}
+
+	return out->out_cpkt->offset - fd->mark_pos;
+}
+
+static size_t put_end(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path)
+{
+	struct senml_out_formatter_data *fd;
+	struct cbor_buf_writer writer;
+	CborEncoder encoder, pack;
+	u8_t head[PACK_HEAD_LEN];
+	u8_t *data;
+	size_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd || fd->failed) {
+		return 0;
+	}
+
+	(void)cbor_encoder_close_container(&fd->encoder, &fd->pack);
+
+	/* use the shortest head for the record count */
+	cbor_buf_writer_init(&writer, head, sizeof(head));
+	cbor_encoder_cust_writer_init(&encoder, &writer.enc, 0);
+	(void)cbor_encoder_create_array(&encoder, &pack, fd->record_count);
+	len = writer.enc.bytes_written;
+
+	data = out->out_cpkt->data + fd->mark_pos;
+	if (len < sizeof(head)) {
+		memmove(data + len, data + sizeof(head),
+			out->out_cpkt->offset - fd->mark_pos - sizeof(head));
+		out->out_cpkt->offset -= sizeof(head) - len;
+	}
+
+	memcpy(data, head, len);
+	return 0;
+}
+
+static size_t put_begin_ri(struct lwm2m_output_context *out,
+			   struct lwm2m_obj_path *path)
+{
+	struct senml_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags |= WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_end_ri(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path)
+{
+	struct senml_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags &= ~WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+/* Append the decimal id to a name, snprintk() would take most of the
+ * encoding time.
+ */
+static char *put_id(char *name, u16_t id)
+{
+	char digits[5];
+	int i = 0;
+
+	do {
+		digits[i++] = '0' + id % 10U;
+		id /= 10U;
+	} while (id > 0U);
+
+	while (i > 0) {
+		*name++ = digits[--i];
+	}
+
+	return name;
+}
+
+/* Start a record with the names of the value and its label */
+static CborError put_record_begin(struct lwm2m_output_context *out,
+				  struct lwm2m_obj_path *path, int label,
+				  CborEncoder *record)
+{
+	struct senml_out_formatter_data *fd;
+	CborError err;
+	char *name;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd || fd->failed) {
+		return CborUnknownError;
+	}
+
+	fd->record_pos = out->out_cpkt->offset;
+
+	/* the base name is given with the first record */
+	err = cbor_encoder_create_map(&fd->pack, record,
+				      (fd->record_count == 0U) ? 3 : 2);
+
+	if (fd->record_count == 0U) {
+		name = senml_buffer;
+		*name++ = '/';
+		name = put_id(name, path->obj_id);
+		*name++ = '/';
+
+		if (fd->path_level >= 2U) {
+			name = put_id(name, path->obj_inst_id);
+			*name++ = '/';
+		}
+
+		err |= cbor_encode_int(record, SENML_BN);
+		err |= cbor_encode_text_string(record, senml_buffer,
+					       name - senml_buffer);
+	}
+
+	name = senml_buffer;
+	if (fd->path_level < 2U) {
+		name = put_id(name, path->obj_inst_id);
+		*name++ = '/';
+	}
+
+	name = put_id(name, path->res_id);
+
+	if (fd->writer_flags & WRITER_RESOURCE_INSTANCE) {
+		*name++ = '/';
+		name = put_id(name, path->res_inst_id);
+	}
+
+	err |= cbor_encode_int(record, SENML_N);
+	err |= cbor_encode_text_string(record, senml_buffer,
+				       name - senml_buffer);
+	err |= cbor_encode_int(record, label);
+
+	return err;
+}
+
+/* Count the record once its value is written, or else drop it from the
+ * pack.
+ */
+static size_t put_record_end(struct lwm2m_output_context *out,
+			     CborEncoder *record, CborError err)
+{
+	struct senml_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd || fd->failed) {
+		return 0;
+	}
+
+	if (err == CborNoError) {
+		err = cbor_encoder_close_container(&fd->pack, record);
+	}
+
+	if (err != CborNoError) {
+		out->out_cpkt->offset = fd->record_pos;
+		return 0;
+	}
+
+	fd->record_count++;
+	return out->out_cpkt->offset - fd->record_pos;
+}
+
+static size_t put_s64(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s64_t value)
+{
+	CborEncoder record;
+	CborError err;
+
+	err = put_record_begin(out, path, SENML_V, &record);
+	if (err == CborNoError) {
+		err = cbor_encode_int(&record, value);
+	}
+
+	return put_record_end(out, &record, err);
+}
+
+static size_t put_s32(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s32_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_s16(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s16_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_s8(struct lwm2m_output_context *out,
+		     struct lwm2m_obj_path *path, s8_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_string(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	CborEncoder record;
+	CborError err;
+
+	err = put_record_begin(out, path, SENML_VS, &record);
+	if (err == CborNoError) {
+		err = cbor_encode_text_string(&record, buf, buflen);
+	}
+
+	return put_record_end(out, &record, err);
+}
+
+static size_t put_float32fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float32_value_t *value)
+{
+	CborEncoder record;
+	CborError err;
+
+	err = put_record_begin(out, path, SENML_V, &record);
+	if (err == CborNoError) {
+		err = cbor_put_float32fix(&record, value);
+	}
+
+	return put_record_end(out, &record, err);
+}
+
+static size_t put_float64fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float64_value_t *value)
+{
+	CborEncoder record;
+	CborError err;
+
+	err = put_record_begin(out, path, SENML_V, &record);
+	if (err == CborNoError) {
+		err = cbor_put_float64fix(&record, value);
+	}
+
+	return put_record_end(out, &record, err);
+}
+
+static size_t put_bool(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path, bool value)
+{
+	CborEncoder record;
+	CborError err;
+
+	err = put_record_begin(out, path, SENML_VB, &record);
+	if (err == CborNoError) {
+		err = cbor_encode_boolean(&record, value);
+	}
+
+	return put_record_end(out, &record, err);
+}
+
+static size_t put_opaque(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	CborEncoder record;
+	CborError err;
+
+	err = put_record_begin(out, path, SENML_VD, &record);
+	if (err == CborNoError) {
+		err = cbor_encode_byte_string(&record, (u8_t *)buf, buflen);
+	}
+
+	return put_record_end(out, &record, err);
+}
+
+const struct lwm2m_writer senml_cbor_writer = {
+	.put_begin = put_begin,
+	.put_end = put_end,
+	.put_begin_ri = put_begin_ri,
+	.put_end_ri = put_end_ri,
+	.put_s8 = put_s8,
+	.put_s16 = put_s16,
+	.put_s32 = put_s32,
+	.put_s64 = put_s64,
+	.put_string = put_string,
+	.put_float32fix = put_float32fix,
+	.put_float64fix = put_float64fix,
+	.put_bool = put_bool,
+	.put_opaque = put_opaque,
+};
+
+int do_read_op_senml_cbor(struct lwm2m_engine_obj *obj,
+			  struct lwm2m_message *msg, int content_format)
+{
+	struct senml_out_formatter_data fd;
+	int ret;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	/* save the level for output processing */
+	fd.path_level = msg->path.level;
+	ret = lwm2m_perform_read_op(obj, msg, content_format);
+	engine_clear_out_user_data(&msg->out);
+
+	return ret;
+}
+
+static int parse_path(const char *name, struct lwm2m_obj_path *path)
+{
+	unsigned long id;
+	char *end;
+
+	(void)memset(path, 0, sizeof(*path));
+
+	/* skip the leading slash */
+	if (*name == '/') {
+		name++;
+	}
+
+	while (*name) {
+		id = strtoul(name, &end, 10);
+		if (end == name || id > UINT16_MAX || path->level > 3U) {
+			return -EINVAL;
+		}
+
+		if (path->level == 0U) {
+			path->obj_id = id;
+		} else if (path->level == 1U) {
+			path->obj_inst_id = id;
+		} else if (path->level == 2U) {
+			path->res_id = id;
+		} else {
+			path->res_inst_id = id;
+		}
+
+		path->level++;
+
+		if (*end == '/') {
+			end++;
+		} else if (*end) {
+			return -EINVAL;
+		}
+
+		name = end;
+	}
+
+	return 0;
+}
+
+/* Read the label of a record and move to its value, the labels of
+ * extensions are strings.
+ */
+static CborError get_label(CborValue *item, int *label)
+{
+	s64_t value;
+
+	if (cbor_value_is_integer(item) &&
+	    cbor_value_get_int64_checked(item, &value) == CborNoError &&
+	    value > SENML_UNKNOWN && value <= INT16_MAX) {
+		*label = value;
+	} else {
+		/* ignored with its value */
+		*label = SENML_UNKNOWN;
+	}
+
+	return cbor_value_advance(item);
+}
+
+static CborError get_name(CborValue *item, char *buf, size_t buflen)
+{
+	size_t len = buflen - 1;
+	CborError err;
+
+	if (!cbor_value_is_text_string(item)) {
+		return CborErrorIllegalType;
+	}
+
+	err = cbor_value_copy_text_string(item, buf, &len, NULL);
+	if (err != CborNoError) {
+		return err;
+	}
+
+	buf[len] = '\0';
+	return cbor_value_advance(item);
+}
+
+static int write_record(struct lwm2m_message *msg)
+{
+	struct lwm2m_engine_obj_inst *obj_inst = NULL;
+	struct lwm2m_engine_res_inst *res = NULL;
+	struct lwm2m_engine_obj_field *obj_field;
+	u8_t created = 0U;
+	int ret, i;
+
+	ret = lwm2m_get_or_create_engine_obj(msg, &obj_inst, &created);
+	if (ret < 0) {
+		return ret;
+	}
+
+	obj_field = lwm2m_get_engine_obj_field(obj_inst->obj,
+					       msg->path.res_id);
+	if (!obj_field) {
+		return -ENOENT;
+	}
+
+	if (!LWM2M_HAS_PERM(obj_field, LWM2M_PERM_W)) {
+		return -EPERM;
+	}
+
+	if (!obj_inst->resources || obj_inst->resource_count == 0U) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < obj_inst->resource_count; i++) {
+		if (obj_inst->resources[i].res_id == msg->path.res_id) {
+			res = &obj_inst->resources[i];
+			break;
+		}
+	}
+
+	if (!res) {
+		/* if OPTIONAL and BOOTSTRAP-WRITE or CREATE use ENOTSUP */
+		if ((msg->ctx->bootstrap_mode ||
+		     msg->operation == LWM2M_OP_CREATE) &&
+		    LWM2M_HAS_PERM(obj_field, BIT(LWM2M_FLAG_OPTIONAL))) {
+			return -ENOTSUP;
+		}
+
+		return -ENOENT;
+	}
+
+	return lwm2m_write_handler(obj_inst, res, obj_field, msg);
+}
+
+int do_write_op_senml_cbor(struct lwm2m_engine_obj *obj,
+			   struct lwm2m_message *msg)
+{
+	struct lwm2m_input_context *in = &msg->in;
+	struct lwm2m_obj_path orig_path;
+	struct cbor_in_reader reader;
+	CborParser parser;
+	CborValue pack, record, item;
+	char base_name[NAME_BUF_LEN];
+	char name[NAME_BUF_LEN];
+	u16_t pack_offset, value_offset;
+	CborError err;
+	int label;
+	int ret = 0;
+
+	/* store a copy of the original path */
+	memcpy(&orig_path, &msg->path, sizeof(msg->path));
+	base_name[0] = '\0';
+
+	/* the offsets of the parser are relative to the pack */
+	pack_offset = in->offset;
+	cbor_in_reader_init(&reader, in);
+
+	if (cbor_parser_cust_reader_init(&reader.r, 0, &parser,
+					 &pack) != CborNoError ||
+	    !cbor_value_is_array(&pack) ||
+	    cbor_value_enter_container(&pack, &record) != CborNoError) {
+		LOG_ERR("Invalid SenML pack");
+		return -EINVAL;
+	}
+
+	while (!cbor_value_at_end(&record)) {
+		if (!cbor_value_is_map(&record) ||
+		    cbor_value_enter_container(&record, &item) !=
+		    CborNoError) {
+			LOG_ERR("Invalid SenML record");
+			return -EINVAL;
+		}
+
+		name[0] = '\0';
+		value_offset = 0U;
+
+		while (!cbor_value_at_end(&item)) {
+			if (get_label(&item, &label) != CborNoError) {
+				LOG_ERR("Invalid SenML label");
+				return -EINVAL;
+			}
+
+			if (label == SENML_BN) {
+				err = get_name(&item, base_name,
+					       sizeof(base_name));
+			} else if (label == SENML_N) {
+				err = get_name(&item, name, sizeof(name));
+			} else {
+				/* the value is read once the path is known */
+				if (label == SENML_V || label == SENML_VS ||
+				    label == SENML_VB || label == SENML_VD) {
+					value_offset = pack_offset +
+						       item.offset;
+				}
+
+				err = cbor_value_advance(&item);
+			}
+
+			if (err != CborNoError) {
+				LOG_ERR("Invalid SenML value of label %d",
+					label);
+				return -EINVAL;
+			}
+		}
+
+		if (cbor_value_leave_container(&record, &item) !=
+		    CborNoError) {
+			LOG_ERR("Invalid SenML record");
+			return -EINVAL;
+		}
+
+		/* a record without value only sets the base name */
+		if (value_offset == 0U) {
+			continue;
+		}
+
+		snprintk(senml_buffer, sizeof(senml_buffer), "%s%s",
+			 base_name, name);
+		if (parse_path(senml_buffer, &msg->path) < 0 ||
+		    msg->path.level < 3U ||
+		    msg->path.obj_id != orig_path.obj_id) {
+			LOG_ERR("Invalid SenML name %s", senml_buffer);
+			ret = -EINVAL;
+			break;
+		}
+
+		msg->path.level = 3U;
+
+		/* the value is read with the CBOR reader */
+		in->offset = value_offset;
+		ret = write_record(msg);
+		in->offset = pack_offset + record.offset;
+
+		/*
+		 * ignore errors for CREATE op
+		 * for OP_CREATE and BOOTSTRAP WRITE: errors on optional
+		 * resources are ignored (ENOTSUP)
+		 */
+		if (ret < 0 &&
+		    !((ret == -ENOTSUP) &&
+		      (msg->ctx->bootstrap_mode ||
+		       msg->operation == LWM2M_OP_CREATE))) {
+			break;
+		}
+
+		ret = 0;
+	}
+
+	memcpy(&msg->path, &orig_path, sizeof(msg->path));
+	return ret;
+}
@@ -30,11 +30,195 @@ static void client_reset(struct mqtt_client *client)
 /** @brief Initialize tx buffer. */
 static void tx_buf_init(struct mqtt_client *client, struct buf_ctx *buf)
 {
-	memset(client->tx_buf, 0, client->tx_buf_size);
+	/* The encoders write every byte of the packets, so the buffer is
+	 * not cleared.
+	 */
 	buf->cur = client->tx_buf;
 	buf->end = client->tx_buf + client->tx_buf_size;
 }
 
+#if CONFIG_MQTT_INFLIGHT_MAX > 0
+/** @brief Find the in-flight entry of a message, or a free one with id 0. */
+static struct mqtt_inflight *inflight_find(struct mqtt_client *client,
+					   u16_t message_id)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		if (client->internal.inflight[i].message_id == message_id) {
+			return &client->internal.inflight[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int inflight_add(struct mqtt_client *client,
+			const struct mqtt_publish_param *param)
+{
+	struct mqtt_inflight *entry;
+
+	/* Message id zero of QoS 1 and QoS 2 messages is rejected by the
+	 * encoder.
+	 */
+	if (param->message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) {
+		return 0;
+	}
+
+	/* A retransmitted message reuses its entry. */
+	entry = inflight_find(client, param->message_id);
+	if (entry == NULL) {
+		entry = inflight_find(client, 0U);
+		if (entry == NULL) {
+			return -EAGAIN;
+		}
+	}
+
+	entry->message_id = param->message_id;
+	entry->ack_type = param->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE ?
+			  MQTT_PKT_TYPE_PUBACK : MQTT_PKT_TYPE_PUBREC;
+	entry->sent = mqtt_sys_tick_in_ms_get();
+
+	return 0;
+}
+
+static void inflight_remove(struct mqtt_client *client,
+			    const struct mqtt_publish_param *param)
+{
+	struct mqtt_inflight *entry;
+
+	if (param->message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE ||
+	    param->message_id == 0U) {
+		return;
+	}
+
+	entry = inflight_find(client, param->message_id);
+	if (entry != NULL) {
+		entry->message_id = 0U;
+	}
+}
+
+static void inflight_release(struct mqtt_client *client, u16_t message_id)
+{
+	struct mqtt_inflight *entry;
+
+	if (message_id == 0U) {
+		return;
+	}
+
+	entry = inflight_find(client, message_id);
+	if (entry != NULL && entry->ack_type == MQTT_PKT_TYPE_PUBCOMP) {
+		entry->sent = mqtt_sys_tick_in_ms_get();
+	}
+}
+
+static void inflight_clear(struct mqtt_client *client)
+{
+	memset(client->internal.inflight, 0,
+	       sizeof(client->internal.inflight));
+}
+
+/** @brief Report the messages which were not acknowledged in time. */
+static void inflight_timeout_notify(struct mqtt_client *client)
+{
+	struct mqtt_inflight *entry;
+	struct mqtt_evt evt;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->message_id == 0U ||
+		    mqtt_elapsed_time_in_ms_get(entry->sent) <
+					CONFIG_MQTT_INFLIGHT_TIMEOUT * 1000) {
+			continue;
+		}
+
+		/* Report it again after another timeout, unless it is
+		 * retransmitted before.
+		 */
+		entry->sent = mqtt_sys_tick_in_ms_get();
+
+		evt.result = -ETIMEDOUT;
+
+		switch (entry->ack_type) {
+		case MQTT_PKT_TYPE_PUBACK:
+			evt.type = MQTT_EVT_PUBACK;
+			evt.param.puback.message_id = entry->message_id;
+			break;
+
+		case MQTT_PKT_TYPE_PUBREC:
+			evt.type = MQTT_EVT_PUBREC;
+			evt.param.pubrec.message_id = entry->message_id;
+			break;
+
+		default:
+			evt.type = MQTT_EVT_PUBCOMP;
+			evt.param.pubcomp.message_id = entry->message_id;
+			break;
+		}
+
+		event_notify(client, &evt);
+
+		if (!MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+			break;
+		}
+	}
+}
+
+void mqtt_inflight_ack(struct mqtt_client *client, u8_t ack_type,
+		       u16_t message_id)
+{
+	struct mqtt_inflight *entry;
+
+	if (message_id == 0U) {
+		return;
+	}
+
+	entry = inflight_find(client, message_id);
+	if (entry == NULL || entry->ack_type != ack_type) {
+		return;
+	}
+
+	if (ack_type == MQTT_PKT_TYPE_PUBREC) {
+		/* Now waiting for the completion of the release. */
+		entry->ack_type = MQTT_PKT_TYPE_PUBCOMP;
+		entry->sent = mqtt_sys_tick_in_ms_get();
+	} else {
+		entry->message_id = 0U;
+	}
+}
+#else
+static inline int inflight_add(struct mqtt_client *client,
+			       const struct mqtt_publish_param *param)
+{
+	return 0;
+}
+
+static inline void inflight_remove(struct mqtt_client *client,
+				   const struct mqtt_publish_param *param)
+{
+}
+
+static inline void inflight_release(struct mqtt_client *client,
+				    u16_t message_id)
+{
+}
+
+static inline void inflight_clear(struct mqtt_client *client)
+{
+}
+
+static inline void inflight_timeout_notify(struct mqtt_client *client)
+{
+}
+
+void mqtt_inflight_ack(struct mqtt_client *client, u8_t ack_type,
+		       u16_t message_id)
+{
+}
+#endif /* CONFIG_MQTT_INFLIGHT_MAX > 0 */
+
 /**@brief Notifies disconnection event to the application.
  *
  * @param[in] client Identifies the client for which the procedure is requested.
@@ -124,7 +308,8 @@ static int client_read(struct mqtt_client *client)
 {
 	int err_code;
 
-	if (client->internal.remaining_payload > 0) {
+	if (!IS_ENABLED(CONFIG_MQTT_PAYLOAD_STREAM) &&
+	    client->internal.remaining_payload > 0) {
 		return -EBUSY;
 	}
 
@@ -157,6 +342,27 @@ static int client_write(struct mqtt_client *client, const u8_t *data,
 	return 0;
 }
 
+static int client_write_msg(struct mqtt_client *client,
+			    struct msghdr *message)
+{
+	int err_code;
+
+	MQTT_TRC("[%p]: Transport writing message.", client);
+
+	err_code = mqtt_transport_write_msg(client, message);
+	if (err_code < 0) {
+		MQTT_TRC("TCP write failed, errno = %d, "
+			 "closing connection", errno);
+		client_disconnect(client, err_code);
+		return err_code;
+	}
+
+	MQTT_TRC("[%p]: Transport write complete.", client);
+	client->internal.last_activity = mqtt_sys_tick_in_ms_get();
+
+	return 0;
+}
+
 void mqtt_client_init(struct mqtt_client *client)
 {
 	NULL_PARAM_CHECK_VOID(client);
@@ -184,6 +390,11 @@ int mqtt_connect(struct mqtt_client *client)
 		goto error;
 	}
 
+	/* Messages of a previous session are only kept for a resumed one. */
+	if (client->clean_session) {
+		inflight_clear(client);
+	}
+
 	err_code = client_connect(client);
 
 error:
@@ -210,6 +421,8 @@ int mqtt_publish(struct mqtt_client *client,
 {
 	int err_code;
 	struct buf_ctx packet;
+	struct iovec io_vector[2];
+	struct msghdr msg;
 
 	NULL_PARAM_CHECK(client);
 	NULL_PARAM_CHECK(param);
@@ -233,13 +446,25 @@ int mqtt_publish(struct mqtt_client *client,
 		goto error;
 	}
 
-	err_code = client_write(client, packet.cur, packet.end - packet.cur);
+	err_code = inflight_add(client, param);
 	if (err_code < 0) {
 		goto error;
 	}
 
-	err_code = client_write(client, param->message.payload.data,
-				param->message.payload.len);
+	io_vector[0].iov_base = packet.cur;
+	io_vector[0].iov_len = packet.end - packet.cur;
+	io_vector[1].iov_base = param->message.payload.data;
+	io_vector[1].iov_len = param->message.payload.len;
+
+	memset(&msg, 0, sizeof(msg));
+
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+
+	err_code = client_write_msg(client, &msg);
+	if (err_code < 0) {
+		inflight_remove(client, param);
+	}
 
 error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
@@ -250,6 +475,118 @@ error:
 	return err_code;
 }
 
+int mqtt_publish_batch(struct mqtt_client *client,
+		       const struct mqtt_publish_param *params, size_t count)
+{
+	struct iovec io_vector[2 * CONFIG_MQTT_PUBLISH_BATCH_MAX];
+	struct buf_ctx packet;
+	struct buf_ctx frame;
+	struct msghdr msg;
+	size_t published = 0;
+	size_t packed;
+	size_t i;
+	int err_code;
+	int ret;
+
+	NULL_PARAM_CHECK(client);
+	NULL_PARAM_CHECK(params);
+
+	MQTT_TRC("[CID %p]:[State 0x%02x]: >> Message count %zu",
+		 client, client->internal.state, count);
+
+	mqtt_mutex_lock(client);
+
+	err_code = verify_tx_state(client);
+	if (err_code < 0) {
+		goto error;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = io_vector;
+
+	while (published < count) {
+		tx_buf_init(client, &packet);
+		packed = 0;
+
+		/* Headers are encoded one after the other in the tx buffer,
+		 * each followed by its payload in the io vector array.
+		 */
+		while (published + packed < count &&
+		       packed < CONFIG_MQTT_PUBLISH_BATCH_MAX) {
+			const struct mqtt_publish_param *param =
+						&params[published + packed];
+
+			frame = packet;
+
+			err_code = publish_encode(param, &frame);
+			if (err_code == -ENOMEM && packed > 0) {
+				/* No room left, send what is packed. */
+				err_code = 0;
+				break;
+			}
+
+			if (err_code < 0) {
+				break;
+			}
+
+			err_code = inflight_add(client, param);
+			if (err_code < 0) {
+				break;
+			}
+
+			io_vector[2 * packed].iov_base = frame.cur;
+			io_vector[2 * packed].iov_len = frame.end - frame.cur;
+			io_vector[2 * packed + 1].iov_base =
+						param->message.payload.data;
+			io_vector[2 * packed + 1].iov_len =
+						param->message.payload.len;
+
+			packet.cur = frame.end;
+			packed++;
+		}
+
+		if (packed > 0) {
+			msg.msg_iovlen = 2 * packed;
+
+			ret = client_write_msg(client, &msg);
+			if (ret < 0) {
+				for (i = 0; i < packed; i++) {
+					inflight_remove(client,
+							&params[published + i]);
+				}
+
+				err_code = ret;
+				goto error;
+			}
+
+			published += packed;
+		}
+
+		/* Stop at the first message that cannot be sent, e.g. when
+		 * the in-flight window is full.
+		 */
+		if (err_code < 0) {
+			break;
+		}
+	}
+
+error:
+	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x, published %zu",
+		 client, client->internal.state, err_code, published);
+
+	mqtt_mutex_unlock(client);
+
+	/* The error of a message that could not be sent after others were
+	 * is not lost: a failed write disconnects the client, and anything
+	 * else happens again when the remaining messages are published.
+	 */
+	if (published == 0) {
+		return err_code;
+	}
+
+	return published;
+}
+
 int mqtt_publish_qos1_ack(struct mqtt_client *client,
 			  const struct mqtt_puback_param *param)
 {
@@ -351,6 +688,11 @@ int mqtt_publish_qos2_release(struct mqtt_client *client,
 	}
 
 	err_code = client_write(client, packet.cur, packet.end - packet.cur);
+	if (err_code < 0) {
+		goto error;
+	}
+
+	inflight_release(client, param->message_id);
 
 error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
@@ -566,6 +908,10 @@ int mqtt_live(struct mqtt_client *client)
 		    (elapsed_time >= (MQTT_KEEPALIVE * 1000))) {
 			(void)mqtt_ping(client);
 		}
+
+		if (MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+			inflight_timeout_notify(client);
+		}
 	}
 
 	mqtt_mutex_unlock(client);
@@ -153,6 +153,16 @@ enum mqtt_state {
  */
 void event_notify(struct mqtt_client *client, const struct mqtt_evt *evt);
 
+/**@brief Updates the window of unacknowledged messages on reception of
+ *        a PUBACK, PUBREC or PUBCOMP packet.
+ *
+ * @param[in] client Identifies the client for which the packet was received.
+ * @param[in] ack_type Type of the received packet.
+ * @param[in] message_id Message id carried by the packet.
+ */
+void mqtt_inflight_ack(struct mqtt_client *client, u8_t ack_type,
+		       u16_t message_id);
+
 /**@brief Handles MQTT messages received from the peer.
  *
  * @param[in] client Identifies the client for which the data was received.
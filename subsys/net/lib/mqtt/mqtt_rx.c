@@ -74,6 +74,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 
 		evt.type = MQTT_EVT_PUBACK;
 		err_code = publish_ack_decode(buf, &evt.param.puback);
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBACK,
+					  evt.param.puback.message_id);
+		}
+
 		evt.result = err_code;
 		break;
 
@@ -82,6 +87,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 
 		evt.type = MQTT_EVT_PUBREC;
 		err_code = publish_receive_decode(buf, &evt.param.pubrec);
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBREC,
+					  evt.param.pubrec.message_id);
+		}
+
 		evt.result = err_code;
 		break;
 
@@ -98,6 +108,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 
 		evt.type = MQTT_EVT_PUBCOMP;
 		err_code = publish_complete_decode(buf, &evt.param.pubcomp);
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBCOMP,
+					  evt.param.pubcomp.message_id);
+		}
+
 		evt.result = err_code;
 		break;
 
@@ -240,6 +255,51 @@ static int mqtt_read_and_parse_fixed_header(struct mqtt_client *client,
 	return err_code;
 }
 
+/* Deliver the payload data available on the transport, in chunks of at
+ * most the size of the receive buffer.
+ */
+static int mqtt_read_publish_payload_chunks(struct mqtt_client *client)
+{
+	struct mqtt_evt evt;
+	u32_t chunk_size;
+	int len;
+
+	evt.type = MQTT_EVT_PUBLISH_PAYLOAD;
+	evt.result = 0;
+
+	while (client->internal.remaining_payload > 0) {
+		chunk_size = MIN(client->internal.remaining_payload,
+				 client->rx_buf_size);
+
+		len = mqtt_transport_read(client, client->rx_buf, chunk_size);
+		if (len == -EAGAIN) {
+			break;
+		}
+
+		if (len < 0) {
+			MQTT_TRC("[CID %p]: Transport read error: %d", client,
+				 len);
+			return len;
+		}
+
+		if (len == 0) {
+			MQTT_TRC("[CID %p]: Connection closed.", client);
+			return -ENOTCONN;
+		}
+
+		client->internal.remaining_payload -= len;
+
+		evt.param.publish_payload.data.data = client->rx_buf;
+		evt.param.publish_payload.data.len = len;
+		evt.param.publish_payload.remaining =
+					client->internal.remaining_payload;
+
+		event_notify(client, &evt);
+	}
+
+	return 0;
+}
+
 int mqtt_handle_rx(struct mqtt_client *client)
 {
 	int err_code;
@@ -247,6 +307,11 @@ int mqtt_handle_rx(struct mqtt_client *client)
 	u32_t var_length;
 	struct buf_ctx buf;
 
+	if (IS_ENABLED(CONFIG_MQTT_PAYLOAD_STREAM) &&
+	    client->internal.remaining_payload > 0) {
+		return mqtt_read_publish_payload_chunks(client);
+	}
+
 	buf.cur = client->rx_buf;
 	buf.end = client->rx_buf + client->internal.rx_buf_datalen;
 
@@ -275,5 +340,11 @@ int mqtt_handle_rx(struct mqtt_client *client)
 
 	client->internal.rx_buf_datalen = 0U;
 
+	/* Deliver the payload which came along with the header. */
+	if (IS_ENABLED(CONFIG_MQTT_PAYLOAD_STREAM) &&
+	    client->internal.remaining_payload > 0) {
+		return mqtt_read_publish_payload_chunks(client);
+	}
+
 	return 0;
 }
@@ -13,6 +13,7 @@
 #define MQTT_TRANSPORT_H_
 
 #include <net/mqtt.h>
+#include <net/net_ip.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,6 +26,10 @@ typedef int (*transport_connect_handler_t)(struct mqtt_client *client);
 typedef int (*transport_write_handler_t)(struct mqtt_client *client,
 					 const u8_t *data, u32_t datalen);
 
+/**@brief Transport write message handler, similar to POSIX sendmsg(). */
+typedef int (*transport_write_msg_handler_t)(struct mqtt_client *client,
+					     struct msghdr *message);
+
 /**@brief Transport read handler. */
 typedef int (*transport_read_handler_t)(struct mqtt_client *client, u8_t *data,
 					u32_t buflen);
@@ -44,6 +49,12 @@ struct transport_procedure {
 	 */
 	transport_write_handler_t write;
 
+	/** Transport write message handler. Writes all the buffers of
+	 *  a scatter/gather array, in as few transport writes as the
+	 *  type of transport allows.
+	 */
+	transport_write_msg_handler_t write_msg;
+
 	/** Transport read handler. Handles transport read based on type of
 	 *  transport.
 	 */
@@ -74,6 +85,30 @@ int mqtt_transport_connect(struct mqtt_client *client);
 int mqtt_transport_write(struct mqtt_client *client, const u8_t *data,
 			 u32_t datalen);
 
+/**@brief Handles write requests of a scatter/gather array on configured
+ *        transport.
+ *
+ * @param[in] client Identifies the client on which the procedure is requested.
+ * @param[inout] message Message with the buffers to be written on the
+ *                       transport. The io vectors are modified in case of a
+ *                       partial write.
+ *
+ * @retval 0 or an error code indicating reason for failure.
+ */
+int mqtt_transport_write_msg(struct mqtt_client *client,
+			     struct msghdr *message);
+
+/**@brief Writes all the buffers of a scatter/gather array on a socket,
+ *        calling sendmsg() again after a partial write.
+ *
+ * @param[in] sock Socket to write on.
+ * @param[inout] message Message with the buffers to be written. The io
+ *                       vectors are modified in case of a partial write.
+ *
+ * @retval 0 or an error code indicating reason for failure.
+ */
+int mqtt_transport_sendmsg(int sock, struct msghdr *message);
+
 /**@brief Handles read requests on configured transport.
  *
  * @param[in] client Identifies the client on which the procedure is requested.
@@ -17,6 +17,7 @@ LOG_MODULE_REGISTER(net_mqtt_sock_tcp, CONFIG_MQTT_LOG_LEVEL);
 #include <net/mqtt.h>
 
 #include "mqtt_os.h"
+#include "mqtt_transport.h"
 
 /**@brief Handles connect request for TCP socket transport.
  *
@@ -81,6 +82,21 @@ int mqtt_client_tcp_write(struct mqtt_client *client, const u8_t *data,
 	return 0;
 }
 
+/**@brief Handles write requests of a scatter/gather array on TCP socket
+ *        transport.
+ *
+ * @param[in] client Identifies the client on which the procedure is requested.
+ * @param[inout] message Message with the buffers to be written on the
+ *                       transport.
+ *
+ * @retval 0 or an error code indicating reason for failure.
+ */
+int mqtt_client_tcp_write_msg(struct mqtt_client *client,
+			      struct msghdr *message)
+{
+	return mqtt_transport_sendmsg(client->transport.tcp.sock, message);
+}
+
 /**@brief Handles read requests on TCP socket transport.
  *
  * @param[in] client Identifies the client on which the procedure is requested.
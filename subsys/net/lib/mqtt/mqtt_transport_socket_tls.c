@@ -17,6 +17,7 @@ LOG_MODULE_REGISTER(net_mqtt_sock_tls, CONFIG_MQTT_LOG_LEVEL);
 #include <net/mqtt.h>
 
 #include "mqtt_os.h"
+#include "mqtt_transport.h"
 
 /**@brief Handles connect request for TLS socket transport.
  *
@@ -120,6 +121,21 @@ int mqtt_client_tls_write(struct mqtt_client *client, const u8_t *data,
 	return 0;
 }
 
+/**@brief Handles write requests of a scatter/gather array on TLS socket
+ *        transport.
+ *
+ * @param[in] client Identifies the client on which the procedure is requested.
+ * @param[inout] message Message with the buffers to be written on the
+ *                       transport.
+ *
+ * @retval 0 or an error code indicating reason for failure.
+ */
+int mqtt_client_tls_write_msg(struct mqtt_client *client,
+			      struct msghdr *message)
+{
+	return mqtt_transport_sendmsg(client->transport.tls.sock, message);
+}
+
 /**@brief Handles read requests on TLS socket transport.
  *
  * @param[in] client Identifies the client on which the procedure is requested.
@@ -101,6 +101,7 @@ int zsock_socket_internal(int family, int type, int proto)
 
 	/* recv_q and accept_q are in union */
 	k_fifo_init(&ctx->recv_q);
+	zsock_epoll_init_ctx(ctx);
 
 #ifdef CONFIG_USERSPACE
 	/* Set net context object as initialized and grant access to the
@@ -177,6 +178,7 @@ int zsock_close_ctx(struct net_context *ctx)
 		(void)net_context_recv(ctx, NULL, K_NO_WAIT, NULL);
 	}
 
+	zsock_epoll_close_ctx(ctx);
 	zsock_flush_queue(ctx);
 
 	SET_ERRNO(net_context_put(ctx));
@@ -236,12 +238,21 @@ static void zsock_accepted_cb(struct net_context *new_ctx,
 	NET_DBG("parent=%p, ctx=%p, st=%d", parent, new_ctx, status);
 
 	if (status == 0) {
+		/* The socket flags of a previous user of the context must
+		 * not show up on the new socket. Set up everything the
+		 * receive callback uses before installing it, an early FIN
+		 * or RST may be reported right away.
+		 */
+		new_ctx->user_data = NULL;
+		k_fifo_init(&new_ctx->recv_q);
+		zsock_epoll_init_ctx(new_ctx);
+
 		/* This just installs a callback, so cannot fail. */
 		(void)net_context_recv(new_ctx, zsock_received_cb, K_NO_WAIT,
 				       NULL);
-		k_fifo_init(&new_ctx->recv_q);
 
 		k_fifo_put(&parent->accept_q, new_ctx);
+		zsock_epoll_notify(parent);
 	}
 }
 
@@ -259,6 +270,15 @@ static void zsock_received_cb(struct net_context *ctx,
 	if (!pkt) {
 		struct net_pkt *last_pkt = k_fifo_peek_tail(&ctx->recv_q);
 
+		/* Unlike EOF, these are known before the queued data has
+		 * been read.
+		 */
+		sock_set_hup(ctx);
+		if (status < 0) {
+			sock_set_reset(ctx);
+			NET_DBG("Marked socket %p as reset", ctx);
+		}
+
 		if (!last_pkt) {
 			/* If there're no packets in the queue, recv() may
 			 * be blocked waiting on it to become non-empty,
@@ -271,6 +291,8 @@ static void zsock_received_cb(struct net_context *ctx,
 			net_pkt_set_eof(last_pkt, true);
 			NET_DBG("Set EOF flag on pkt %p", last_pkt);
 		}
+
+		zsock_epoll_notify(ctx);
 		return;
 	}
 
@@ -282,6 +304,7 @@ static void zsock_received_cb(struct net_context *ctx,
 	}
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	zsock_epoll_notify(ctx);
 }
 
 int zsock_bind_ctx(struct net_context *ctx, const struct sockaddr *addr,
@@ -511,6 +534,275 @@ Z_SYSCALL_HANDLER(zsock_sendto, sock, buf, len, flags, dest_addr, addrlen)
 }
 #endif /* CONFIG_USERSPACE */
 
+ssize_t zsock_sendmsg_ctx(struct net_context *ctx, const struct msghdr *msg,
+			  int flags)
+{
+	s32_t timeout = K_FOREVER;
+	int status;
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	/* Register the callback before sending in order to receive the response
+	 * from the peer.
+	 */
+	status = net_context_recv(ctx, zsock_received_cb,
+				  K_NO_WAIT, ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	status = net_context_sendmsg(ctx, msg, flags, NULL, timeout,
+				     ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	return status;
+}
+
+ssize_t z_impl_zsock_sendmsg(int sock, const struct msghdr *msg, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (!vtable->sendmsg) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	return vtable->sendmsg(ctx, msg, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+/* Copy the iovec array of a message from user mode into iov, point the
+ * message to it, and check that the buffers the message points to can be
+ * accessed.
+ */
+static int msg_iov_from_user(struct msghdr *msg, struct iovec *iov,
+			     bool write)
+{
+	size_t i;
+
+	if (z_user_from_copy(iov, msg->msg_iov,
+			     msg->msg_iovlen * sizeof(struct iovec))) {
+		return -EFAULT;
+	}
+
+	msg->msg_iov = iov;
+
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		if (Z_SYSCALL_MEMORY(msg->msg_iov[i].iov_base,
+				     msg->msg_iov[i].iov_len, write)) {
+			return -EFAULT;
+		}
+	}
+
+	if (msg->msg_name &&
+	    Z_SYSCALL_MEMORY(msg->msg_name, msg->msg_namelen, write)) {
+		return -EFAULT;
+	}
+
+	if (msg->msg_control &&
+	    Z_SYSCALL_MEMORY(msg->msg_control, msg->msg_controllen, write)) {
+		return -EFAULT;
+	}
+
+	return 0;
+}
+
+/* Copy a message from user mode, with its iovec array in an allocation
+ * freed with k_free(). Returns -EFAULT if the caller passed memory it
+ * cannot access, so that the system call handler oopses the calling
+ * thread.
+ */
+static int msg_from_user(struct msghdr *msg, const struct msghdr *umsg,
+			 bool write)
+{
+	struct iovec *iov = NULL;
+	size_t size;
+	int ret;
+
+	if (z_user_from_copy(msg, (void *)umsg, sizeof(*msg))) {
+		return -EFAULT;
+	}
+
+	if (__builtin_mul_overflow(msg->msg_iovlen, sizeof(struct iovec),
+				   &size)) {
+		return -EFAULT;
+	}
+
+	if (size) {
+		iov = z_thread_malloc(size);
+		if (!iov) {
+			return -ENOMEM;
+		}
+	}
+
+	ret = msg_iov_from_user(msg, iov, write);
+	if (ret < 0) {
+		k_free(iov);
+	}
+
+	return ret;
+}
+
+Z_SYSCALL_HANDLER(zsock_sendmsg, sock, msg, flags)
+{
+	struct msghdr msg_copy;
+	ssize_t ret;
+
+	ret = msg_from_user(&msg_copy, (const struct msghdr *)msg, false);
+	Z_OOPS(ret == -EFAULT);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	ret = z_impl_zsock_sendmsg(sock, &msg_copy, flags);
+	k_free(msg_copy.msg_iov);
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
+int z_impl_zsock_sendmmsg(int sock, struct mmsghdr *msgvec, unsigned int vlen,
+			  int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+	unsigned int i;
+	ssize_t ret;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (!vtable->sendmsg) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	/* The socket is looked up only once for the whole batch */
+	for (i = 0U; i < vlen; i++) {
+		ret = vtable->sendmsg(ctx, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			return i > 0 ? i : -1;
+		}
+
+		msgvec[i].msg_len = ret;
+	}
+
+	return i;
+}
+
+#ifdef CONFIG_USERSPACE
+/* Copy a message vector from user mode, with the iovec arrays of all the
+ * messages in one allocation placed after it, and check that the buffers
+ * the messages point to can be accessed. The copy is freed with k_free().
+ * Returns -EFAULT if the caller passed memory it cannot access, so that
+ * the system call handler oopses the calling thread.
+ */
+static int mmsg_from_user(struct mmsghdr **msgvec_out,
+			  struct mmsghdr *umsgvec, unsigned int vlen,
+			  bool write)
+{
+	struct mmsghdr *msgvec;
+	struct iovec *iov;
+	size_t vec_size, iov_count = 0, size;
+	unsigned int i;
+
+	if (Z_SYSCALL_MEMORY_ARRAY_WRITE(umsgvec, vlen,
+					 sizeof(struct mmsghdr))) {
+		return -EFAULT;
+	}
+
+	vec_size = vlen * sizeof(struct mmsghdr);
+
+	for (i = 0U; i < vlen; i++) {
+		if (__builtin_add_overflow(iov_count,
+					   umsgvec[i].msg_hdr.msg_iovlen,
+					   &iov_count)) {
+			return -EFAULT;
+		}
+	}
+
+	if (__builtin_mul_overflow(iov_count, sizeof(struct iovec), &size) ||
+	    __builtin_add_overflow(size, vec_size, &size)) {
+		return -EFAULT;
+	}
+
+	msgvec = z_thread_malloc(size);
+	if (!msgvec) {
+		return -ENOMEM;
+	}
+
+	(void)memcpy(msgvec, umsgvec, vec_size);
+	iov = (struct iovec *)((u8_t *)msgvec + vec_size);
+
+	for (i = 0U; i < vlen; i++) {
+		struct msghdr *msg = &msgvec[i].msg_hdr;
+
+		/* The iovec array was counted above, and a concurrent
+		 * change of its length must not overrun the allocation.
+		 */
+		if (msg->msg_iovlen > iov_count ||
+		    msg_iov_from_user(msg, iov, write) < 0) {
+			k_free(msgvec);
+			return -EFAULT;
+		}
+
+		iov += msg->msg_iovlen;
+		iov_count -= msg->msg_iovlen;
+	}
+
+	*msgvec_out = msgvec;
+	return 0;
+}
+
+/* Return the results of the messages that were transferred to user mode */
+static void mmsg_to_user(struct mmsghdr *umsgvec, struct mmsghdr *msgvec,
+			 int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		umsgvec[i].msg_len = msgvec[i].msg_len;
+		umsgvec[i].msg_hdr.msg_namelen = msgvec[i].msg_hdr.msg_namelen;
+		umsgvec[i].msg_hdr.msg_controllen =
+			msgvec[i].msg_hdr.msg_controllen;
+		umsgvec[i].msg_hdr.msg_flags = msgvec[i].msg_hdr.msg_flags;
+	}
+}
+
+Z_SYSCALL_HANDLER(zsock_sendmmsg, sock, msgvec_param, vlen, flags)
+{
+	struct mmsghdr *umsgvec = (struct mmsghdr *)msgvec_param;
+	struct mmsghdr *msgvec;
+	int ret;
+
+	ret = mmsg_from_user(&msgvec, umsgvec, vlen, false);
+	Z_OOPS(ret == -EFAULT);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	ret = z_impl_zsock_sendmmsg(sock, msgvec, vlen, flags);
+	mmsg_to_user(umsgvec, msgvec, ret);
+	k_free(msgvec);
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
 static int sock_get_pkt_src_addr(struct net_pkt *pkt,
 				 enum net_ip_protocol proto,
 				 struct sockaddr *addr,
@@ -612,7 +904,129 @@ error:
 	return ret;
 }
 
+static int sock_add_cmsg(struct msghdr *msg, size_t *used, int level,
+			 int type, const void *data, size_t len)
+{
+	struct cmsghdr *cmsg;
+
+	if (*used + CMSG_SPACE(len) > msg->msg_controllen) {
+		msg->msg_flags |= ZSOCK_MSG_CTRUNC;
+		return -ENOMEM;
+	}
+
+	cmsg = (struct cmsghdr *)((u8_t *)msg->msg_control + *used);
+	cmsg->cmsg_len = CMSG_LEN(len);
+	cmsg->cmsg_level = level;
+	cmsg->cmsg_type = type;
+	memcpy(CMSG_DATA(cmsg), data, len);
+
+	*used += CMSG_SPACE(len);
+
+	return 0;
+}
+
+static void sock_add_pktinfo(struct net_pkt *pkt, struct msghdr *msg,
+			     size_t *used)
+{
+	struct net_pkt_cursor backup;
+	int ifindex = net_if_get_by_iface(net_pkt_iface(pkt));
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) &&
+	    net_pkt_family(pkt) == AF_INET) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *ipv4_hdr;
+		struct in_pktinfo info;
+
+		ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(
+							pkt, &ipv4_access);
+		if (ipv4_hdr) {
+			info.ipi_ifindex = ifindex;
+			net_ipaddr_copy(&info.ipi_spec_dst, &ipv4_hdr->dst);
+			net_ipaddr_copy(&info.ipi_addr, &ipv4_hdr->dst);
+
+			sock_add_cmsg(msg, used, IPPROTO_IP, IP_PKTINFO,
+				      &info, sizeof(info));
+		}
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		struct net_ipv6_hdr *ipv6_hdr;
+		struct in6_pktinfo info;
+
+		ipv6_hdr = (struct net_ipv6_hdr *)net_pkt_get_data(
+							pkt, &ipv6_access);
+		if (ipv6_hdr) {
+			info.ipi6_ifindex = ifindex;
+			net_ipaddr_copy(&info.ipi6_addr, &ipv6_hdr->dst);
+
+			sock_add_cmsg(msg, used, IPPROTO_IPV6, IPV6_PKTINFO,
+				      &info, sizeof(info));
+		}
+	}
+
+	net_pkt_cursor_restore(pkt, &backup);
+}
+
+/* Fill in the ancillary data enabled for the socket. */
+static void sock_get_pkt_cmsgs(struct net_context *ctx, struct net_pkt *pkt,
+			       struct msghdr *msg)
+{
+	size_t used = 0;
+
+	if (!msg->msg_control) {
+		msg->msg_controllen = 0;
+		return;
+	}
+
+	if (sock_get_flag(ctx, SOCK_PKTINFO)) {
+		sock_add_pktinfo(pkt, msg, &used);
+	}
+
+#if defined(CONFIG_NET_PKT_TIMESTAMP)
+	if (sock_get_flag(ctx, SOCK_TIMESTAMP)) {
+		sock_add_cmsg(msg, &used, SOL_SOCKET, SO_TIMESTAMPING,
+			      net_pkt_timestamp(pkt),
+			      sizeof(struct net_ptp_time));
+	}
+#endif
+
+	msg->msg_controllen = used;
+}
+
+/* Copy the data of the packet into the iovec array of the msghdr */
+static int sock_read_iov(struct net_pkt *pkt, struct msghdr *msg,
+			 size_t *recv_len)
+{
+	size_t remaining = net_pkt_remaining_data(pkt);
+	size_t i, len;
+
+	*recv_len = 0;
+
+	for (i = 0; i < msg->msg_iovlen && remaining; i++) {
+		len = MIN(msg->msg_iov[i].iov_len, remaining);
+
+		if (net_pkt_read(pkt, msg->msg_iov[i].iov_base, len)) {
+			return -ENOBUFS;
+		}
+
+		*recv_len += len;
+		remaining -= len;
+	}
+
+	if (remaining) {
+		msg->msg_flags |= ZSOCK_MSG_TRUNC;
+	}
+
+	return 0;
+}
+
 static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
+				       struct msghdr *msg,
 				       void *buf,
 				       size_t max_len,
 				       int flags,
@@ -673,14 +1087,23 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 		}
 	}
 
-	recv_len = net_pkt_remaining_data(pkt);
-	if (recv_len > max_len) {
-		recv_len = max_len;
-	}
+	if (msg) {
+		if (sock_read_iov(pkt, msg, &recv_len)) {
+			errno = ENOBUFS;
+			return -1;
+		}
 
-	if (net_pkt_read(pkt, buf, recv_len)) {
-		errno = ENOBUFS;
-		return -1;
+		sock_get_pkt_cmsgs(ctx, pkt, msg);
+	} else {
+		recv_len = net_pkt_remaining_data(pkt);
+		if (recv_len > max_len) {
+			recv_len = max_len;
+		}
+
+		if (net_pkt_read(pkt, buf, recv_len)) {
+			errno = ENOBUFS;
+			return -1;
+		}
 	}
 
 	if (!(flags & ZSOCK_MSG_PEEK)) {
@@ -785,7 +1208,8 @@ ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 	enum net_sock_type sock_type = net_context_get_type(ctx);
 
 	if (sock_type == SOCK_DGRAM) {
-		return zsock_recv_dgram(ctx, buf, max_len, flags, src_addr, addrlen);
+		return zsock_recv_dgram(ctx, NULL, buf, max_len, flags,
+					src_addr, addrlen);
 	} else if (sock_type == SOCK_STREAM) {
 		return zsock_recv_stream(ctx, buf, max_len, flags);
 	} else {
@@ -834,6 +1258,336 @@ Z_SYSCALL_HANDLER(zsock_recvfrom, sock, buf, max_len, flags, src_addr,
 }
 #endif /* CONFIG_USERSPACE */
 
+/* A stream has no message boundaries, so fill the buffers one after
+ * the other as long as there is data available without blocking.
+ */
+static ssize_t zsock_recvmsg_stream(struct net_context *ctx,
+				    struct msghdr *msg, int flags)
+{
+	ssize_t recv_len = 0;
+	ssize_t ret;
+	size_t i;
+
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		if (!msg->msg_iov[i].iov_len) {
+			continue;
+		}
+
+		ret = zsock_recv_stream(ctx, msg->msg_iov[i].iov_base,
+					msg->msg_iov[i].iov_len, flags);
+		if (ret < 0) {
+			if (recv_len > 0 && errno == EAGAIN) {
+				break;
+			}
+
+			return ret;
+		}
+
+		recv_len += ret;
+
+		/* Peeking would return the same data again */
+		if ((size_t)ret < msg->msg_iov[i].iov_len || ret == 0 ||
+		    (flags & ZSOCK_MSG_PEEK)) {
+			break;
+		}
+
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return recv_len;
+}
+
+ssize_t zsock_recvmsg_ctx(struct net_context *ctx, struct msghdr *msg,
+			  int flags)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+
+	msg->msg_flags = 0;
+
+	if (sock_type == SOCK_DGRAM) {
+		return zsock_recv_dgram(ctx, msg, NULL, 0, flags,
+					msg->msg_name,
+					msg->msg_name ? &msg->msg_namelen :
+					NULL);
+	} else if (sock_type == SOCK_STREAM) {
+		msg->msg_controllen = 0;
+
+		return zsock_recvmsg_stream(ctx, msg, flags);
+	} else {
+		__ASSERT(0, "Unknown socket type");
+	}
+
+	return 0;
+}
+
+ssize_t z_impl_zsock_recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (!vtable->recvmsg) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	return vtable->recvmsg(ctx, msg, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_recvmsg, sock, msg, flags)
+{
+	struct msghdr *umsg = (struct msghdr *)msg;
+	struct msghdr msg_copy;
+	ssize_t ret;
+
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(umsg, sizeof(*umsg)));
+
+	ret = msg_from_user(&msg_copy, umsg, true);
+	Z_OOPS(ret == -EFAULT);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	ret = z_impl_zsock_recvmsg(sock, &msg_copy, flags);
+	if (ret >= 0) {
+		umsg->msg_namelen = msg_copy.msg_namelen;
+		umsg->msg_controllen = msg_copy.msg_controllen;
+		umsg->msg_flags = msg_copy.msg_flags;
+	}
+
+	k_free(msg_copy.msg_iov);
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
+int z_impl_zsock_recvmmsg(int sock, struct mmsghdr *msgvec, unsigned int vlen,
+			  int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+	unsigned int i;
+	ssize_t ret;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (!vtable->recvmsg) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	for (i = 0U; i < vlen; i++) {
+		ret = vtable->recvmsg(ctx, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			return i > 0 ? i : -1;
+		}
+
+		msgvec[i].msg_len = ret;
+
+		/* Only wait for the first message, and return the rest
+		 * that are already queued.
+		 */
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return i;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_recvmmsg, sock, msgvec_param, vlen, flags)
+{
+	struct mmsghdr *umsgvec = (struct mmsghdr *)msgvec_param;
+	struct mmsghdr *msgvec;
+	int ret;
+
+	ret = mmsg_from_user(&msgvec, umsgvec, vlen, true);
+	Z_OOPS(ret == -EFAULT);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	ret = z_impl_zsock_recvmmsg(sock, msgvec, vlen, flags);
+	mmsg_to_user(umsgvec, msgvec, ret);
+	k_free(msgvec);
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
+/* Point the iovec array to the packet data from the cursor on, and
+ * return the number of bytes covered.
+ */
+static size_t sock_lend_frags(struct net_pkt *pkt,
+			      struct zsock_zerocopy_rx *zc)
+{
+	struct net_buf *buf = pkt->cursor.buf;
+	u8_t *pos = pkt->cursor.pos;
+	size_t count = 0;
+	size_t len = 0;
+
+	while (buf && count < zc->iovcnt) {
+		size_t frag_len = buf->data + buf->len - pos;
+
+		if (frag_len) {
+			zc->iov[count].iov_base = pos;
+			zc->iov[count].iov_len = frag_len;
+			len += frag_len;
+			count++;
+		}
+
+		buf = buf->frags;
+		if (buf) {
+			pos = buf->data;
+		}
+	}
+
+	zc->iovcnt = count;
+
+	return len;
+}
+
+ssize_t zsock_recv_zerocopy_ctx(struct net_context *ctx,
+				struct zsock_zerocopy_rx *zc, int flags)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+	s32_t timeout = K_FOREVER;
+	struct net_pkt *pkt;
+	size_t data_len;
+	size_t len;
+	int res;
+
+	if ((flags & ZSOCK_MSG_PEEK) || !zc->iov || !zc->iovcnt) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	zc->pkt = NULL;
+	zc->len = 0;
+
+	do {
+		if (sock_type == SOCK_STREAM && sock_is_eof(ctx)) {
+			zc->iovcnt = 0;
+			return 0;
+		}
+
+		res = k_fifo_wait_non_empty(&ctx->recv_q, timeout);
+		/* EAGAIN when timeout expired, EINTR when cancelled */
+		if (res && res != -EAGAIN && res != -EINTR) {
+			errno = -res;
+			return -1;
+		}
+
+		pkt = k_fifo_peek_head(&ctx->recv_q);
+		if (!pkt) {
+			if (sock_type == SOCK_STREAM && sock_is_eof(ctx)) {
+				zc->iovcnt = 0;
+				return 0;
+			}
+
+			errno = EAGAIN;
+			return -1;
+		}
+
+		data_len = net_pkt_remaining_data(pkt);
+		len = sock_lend_frags(pkt, zc);
+
+		if (len < data_len && sock_type == SOCK_STREAM) {
+			/* The rest of the packet stays queued, so the lent
+			 * part needs a reference of its own.
+			 */
+			net_pkt_ref(pkt);
+			net_pkt_skip(pkt, len);
+			break;
+		}
+
+		k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+
+		if (sock_type != SOCK_STREAM) {
+			break;
+		}
+
+		if (net_pkt_eof(pkt)) {
+			sock_set_eof(ctx);
+		}
+
+		if (!len) {
+			net_pkt_unref(pkt);
+		}
+	} while (len == 0);
+
+	zc->pkt = pkt;
+	zc->len = len;
+
+	return len;
+}
+
+ssize_t zsock_recv_zerocopy(int sock, struct zsock_zerocopy_rx *zc,
+			    int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (!vtable->recv_zerocopy) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	return vtable->recv_zerocopy(ctx, zc, flags);
+}
+
+int zsock_recv_zerocopy_release_ctx(struct net_context *ctx,
+				    struct zsock_zerocopy_rx *zc)
+{
+	if (!zc->pkt) {
+		return 0;
+	}
+
+	net_pkt_unref(zc->pkt);
+
+	/* The window was not updated when the data was lent */
+	if (net_context_get_type(ctx) == SOCK_STREAM) {
+		net_context_update_recv_wnd(ctx, zc->len);
+	}
+
+	zc->pkt = NULL;
+	zc->len = 0;
+
+	return 0;
+}
+
+int zsock_recv_zerocopy_release(int sock, struct zsock_zerocopy_rx *zc)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (!vtable->recv_zerocopy_release) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	return vtable->recv_zerocopy_release(ctx, zc);
+}
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -1097,9 +1851,96 @@ Z_SYSCALL_HANDLER(zsock_inet_pton, family, src, dst)
 }
 #endif
 
+static int sock_buf_option(int optname)
+{
+	return optname == SO_RCVBUF ? NET_OPT_RCVBUF : NET_OPT_SNDBUF;
+}
+
+/* Socket flag of the options enabling ancillary data, 0 if optname is
+ * not one of them.
+ */
+static u32_t sock_cmsg_flag(int level, int optname)
+{
+	if (level == IPPROTO_IP && optname == IP_PKTINFO) {
+		return SOCK_PKTINFO;
+	}
+
+	if (level == IPPROTO_IPV6 && optname == IPV6_RECVPKTINFO) {
+		return SOCK_PKTINFO;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_PKT_TIMESTAMP) &&
+	    level == SOL_SOCKET && optname == SO_TIMESTAMPING) {
+		return SOCK_TIMESTAMP;
+	}
+
+	return 0;
+}
+
 int zsock_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 void *optval, socklen_t *optlen)
 {
+	u32_t flag = sock_cmsg_flag(level, optname);
+	size_t len = sizeof(int);
+	int ret;
+
+	if (flag) {
+		if (*optlen < sizeof(int)) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		*(int *)optval = !!sock_get_flag(ctx, flag);
+		*optlen = sizeof(int);
+
+		return 0;
+	}
+
+	switch (level) {
+	case SOL_SOCKET:
+		switch (optname) {
+		case SO_RCVBUF:
+		case SO_SNDBUF:
+			if (net_context_get_ip_proto(ctx) != IPPROTO_TCP) {
+				break;
+			}
+
+			if (*optlen < sizeof(int)) {
+				errno = EINVAL;
+				return -1;
+			}
+
+			ret = net_context_get_option(ctx,
+						     sock_buf_option(optname),
+						     optval, &len);
+			SET_ERRNO(ret);
+
+			*optlen = len;
+
+			return 0;
+
+		case SO_REUSEPORT: {
+			bool reuseport;
+
+			if (*optlen < sizeof(int)) {
+				errno = EINVAL;
+				return -1;
+			}
+
+			len = sizeof(reuseport);
+			ret = net_context_get_option(ctx, NET_OPT_REUSEPORT,
+						     &reuseport, &len);
+			SET_ERRNO(ret);
+
+			*(int *)optval = reuseport;
+			*optlen = sizeof(int);
+
+			return 0;
+		}
+		}
+		break;
+	}
+
 	errno = ENOPROTOOPT;
 	return -1;
 }
@@ -1113,6 +1954,19 @@ int zsock_getsockopt(int sock, int level, int optname,
 int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 const void *optval, socklen_t optlen)
 {
+	u32_t flag = sock_cmsg_flag(level, optname);
+
+	if (flag) {
+		if (optlen != sizeof(int)) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		sock_set_flag(ctx, flag, *(const int *)optval ? flag : 0);
+
+		return 0;
+	}
+
 	switch (level) {
 	case SOL_SOCKET:
 		switch (optname) {
@@ -1121,6 +1975,40 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 * existing apps.
 			 */
 			return 0;
+
+		case SO_RCVBUF:
+		case SO_SNDBUF:
+			if (net_context_get_ip_proto(ctx) != IPPROTO_TCP) {
+				break;
+			}
+
+			if (optlen != sizeof(int)) {
+				errno = EINVAL;
+				return -1;
+			}
+
+			SET_ERRNO(net_context_set_option(ctx,
+							 sock_buf_option(optname),
+							 optval, optlen));
+
+			return 0;
+
+		case SO_REUSEPORT: {
+			bool reuseport;
+
+			if (optlen != sizeof(int)) {
+				errno = EINVAL;
+				return -1;
+			}
+
+			reuseport = *(const int *)optval != 0;
+
+			SET_ERRNO(net_context_set_option(ctx, NET_OPT_REUSEPORT,
+							 &reuseport,
+							 sizeof(reuseport)));
+
+			return 0;
+		}
 		}
 		break;
 
@@ -1260,6 +2148,30 @@ static ssize_t sock_recvfrom_vmeth(void *obj, void *buf, size_t max_len,
 				  src_addr, addrlen);
 }
 
+static ssize_t sock_sendmsg_vmeth(void *obj, const struct msghdr *msg,
+				  int flags)
+{
+	return zsock_sendmsg_ctx(obj, msg, flags);
+}
+
+static ssize_t sock_recvmsg_vmeth(void *obj, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg_ctx(obj, msg, flags);
+}
+
+static ssize_t sock_recv_zerocopy_vmeth(void *obj,
+					struct zsock_zerocopy_rx *zc,
+					int flags)
+{
+	return zsock_recv_zerocopy_ctx(obj, zc, flags);
+}
+
+static int sock_recv_zerocopy_release_vmeth(void *obj,
+					    struct zsock_zerocopy_rx *zc)
+{
+	return zsock_recv_zerocopy_release_ctx(obj, zc);
+}
+
 static int sock_getsockopt_vmeth(void *obj, int level, int optname,
 				 void *optval, socklen_t *optlen)
 {
@@ -1285,6 +2197,10 @@ const struct socket_op_vtable sock_fd_op_vtable = {
 	.accept = sock_accept_vmeth,
 	.sendto = sock_sendto_vmeth,
 	.recvfrom = sock_recvfrom_vmeth,
+	.sendmsg = sock_sendmsg_vmeth,
+	.recvmsg = sock_recvmsg_vmeth,
+	.recv_zerocopy = sock_recv_zerocopy_vmeth,
+	.recv_zerocopy_release = sock_recv_zerocopy_release_vmeth,
 	.getsockopt = sock_getsockopt_vmeth,
 	.setsockopt = sock_setsockopt_vmeth,
 };
@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_sock_epoll, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <misc/dlist.h>
+#include <misc/slist.h>
+#include <misc/fdtable.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+#include <syscall_handler.h>
+
+#include "sockets_internal.h"
+
+extern const struct socket_op_vtable sock_fd_op_vtable;
+
+static const struct fd_op_vtable epoll_fd_op_vtable;
+
+struct epoll_instance {
+	/** Items with a pending event, in the order they became ready */
+	sys_dlist_t ready;
+	/** Given when an item is put on the ready list */
+	struct k_sem ready_sem;
+	bool in_use;
+};
+
+struct epoll_item {
+	/** Node in the list of the watched socket */
+	sys_snode_t ctx_node;
+	/** Node in the ready list of the instance */
+	sys_dnode_t ready_node;
+	/** Owning instance, NULL if the item is free */
+	struct epoll_instance *ep;
+	struct net_context *ctx;
+	struct zsock_epoll_event event;
+};
+
+static struct epoll_instance epoll_instances[CONFIG_NET_SOCKETS_EPOLL_MAX];
+static struct epoll_item epoll_items[CONFIG_NET_SOCKETS_EPOLL_MAX_ITEMS];
+
+/* Protects the ready lists, and the item lists of the sockets which are
+ * also walked from the receive callbacks.
+ */
+static K_MUTEX_DEFINE(epoll_lock);
+
+static u32_t epoll_item_events(struct epoll_item *item)
+{
+	struct net_context *ctx = item->ctx;
+	u32_t events = 0U;
+
+	/* Disabled by ZSOCK_EPOLLONESHOT */
+	if (!item->event.events) {
+		return 0U;
+	}
+
+	/* recv_q and accept_q are in union */
+	if (!k_fifo_is_empty(&ctx->recv_q) || sock_is_eof(ctx)) {
+		events |= ZSOCK_EPOLLIN;
+	}
+
+	if (sock_is_hup(ctx)) {
+		events |= ZSOCK_EPOLLHUP;
+	}
+
+	if (sock_is_reset(ctx)) {
+		events |= ZSOCK_EPOLLERR;
+	}
+
+	/* For now, assume that socket is always writable, as poll() does */
+	events |= ZSOCK_EPOLLOUT;
+
+	/* Hang up and errors are reported even if not asked for */
+	return events & (item->event.events | ZSOCK_EPOLLERR | ZSOCK_EPOLLHUP);
+}
+
+static void epoll_item_set_ready(struct epoll_item *item)
+{
+	if (!sys_dnode_is_linked(&item->ready_node)) {
+		sys_dlist_append(&item->ep->ready, &item->ready_node);
+		k_sem_give(&item->ep->ready_sem);
+	}
+}
+
+static void epoll_item_free(struct epoll_item *item)
+{
+	if (sys_dnode_is_linked(&item->ready_node)) {
+		sys_dlist_remove(&item->ready_node);
+	}
+
+	item->ep = NULL;
+	item->ctx = NULL;
+}
+
+static struct epoll_item *epoll_item_find(struct epoll_instance *ep,
+					  struct net_context *ctx)
+{
+	struct epoll_item *item;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		if (item->ep == ep) {
+			return item;
+		}
+	}
+
+	return NULL;
+}
+
+static struct epoll_item *epoll_item_alloc(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (!epoll_items[i].ep) {
+			sys_dnode_init(&epoll_items[i].ready_node);
+			return &epoll_items[i];
+		}
+	}
+
+	return NULL;
+}
+
+void zsock_epoll_notify(struct net_context *ctx)
+{
+	struct epoll_item *item;
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		if (epoll_item_events(item) &
+		    (ZSOCK_EPOLLIN | ZSOCK_EPOLLERR | ZSOCK_EPOLLHUP)) {
+			epoll_item_set_ready(item);
+		}
+	}
+
+	k_mutex_unlock(&epoll_lock);
+}
+
+void zsock_epoll_close_ctx(struct net_context *ctx)
+{
+	struct epoll_item *item;
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		epoll_item_free(item);
+	}
+
+	sys_slist_init(&ctx->epoll_items);
+
+	k_mutex_unlock(&epoll_lock);
+}
+
+int z_impl_zsock_epoll_create(int size)
+{
+	struct epoll_instance *ep = NULL;
+	int fd;
+	int i;
+
+	if (size <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		return -1;
+	}
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_instances); i++) {
+		if (!epoll_instances[i].in_use) {
+			ep = &epoll_instances[i];
+			ep->in_use = true;
+			break;
+		}
+	}
+
+	k_mutex_unlock(&epoll_lock);
+
+	if (!ep) {
+		z_free_fd(fd);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	sys_dlist_init(&ep->ready);
+	k_sem_init(&ep->ready_sem, 0, 1);
+
+	z_finalize_fd(fd, ep, &epoll_fd_op_vtable);
+
+	NET_DBG("epoll: ep=%p, fd=%d", ep, fd);
+
+	return fd;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_create, size)
+{
+	return z_impl_zsock_epoll_create(size);
+}
+#endif /* CONFIG_USERSPACE */
+
+static struct epoll_instance *epoll_get(int epfd)
+{
+	const struct fd_op_vtable *vtable;
+	struct epoll_instance *ep;
+
+	ep = z_get_fd_obj_and_vtable(epfd, &vtable);
+	if (ep == NULL) {
+		return NULL;
+	}
+
+	if (vtable != &epoll_fd_op_vtable) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return ep;
+}
+
+static int epoll_ctl_locked(struct epoll_instance *ep, int op,
+			    struct net_context *ctx,
+			    struct zsock_epoll_event *event)
+{
+	struct epoll_item *item = epoll_item_find(ep, ctx);
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		if (item) {
+			return -EEXIST;
+		}
+
+		item = epoll_item_alloc();
+		if (!item) {
+			return -ENOMEM;
+		}
+
+		item->ep = ep;
+		item->ctx = ctx;
+		sys_slist_append(&ctx->epoll_items, &item->ctx_node);
+		break;
+
+	case ZSOCK_EPOLL_CTL_MOD:
+		if (!item) {
+			return -ENOENT;
+		}
+
+		break;
+
+	case ZSOCK_EPOLL_CTL_DEL:
+		if (!item) {
+			return -ENOENT;
+		}
+
+		sys_slist_find_and_remove(&ctx->epoll_items, &item->ctx_node);
+		epoll_item_free(item);
+
+		return 0;
+
+	default:
+		return -EINVAL;
+	}
+
+	item->event = *event;
+
+	/* Report the events that are already pending */
+	if (epoll_item_events(item)) {
+		epoll_item_set_ready(item);
+	} else if (sys_dnode_is_linked(&item->ready_node)) {
+		sys_dlist_remove(&item->ready_node);
+	}
+
+	return 0;
+}
+
+int z_impl_zsock_epoll_ctl(int epfd, int op, int fd,
+			   struct zsock_epoll_event *event)
+{
+	const struct fd_op_vtable *vtable;
+	struct epoll_instance *ep;
+	struct net_context *ctx;
+	int ret;
+
+	ep = epoll_get(epfd);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	ctx = z_get_fd_obj_and_vtable(fd, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (fd == epfd) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Only native sockets feed the ready list */
+	if (vtable != (const struct fd_op_vtable *)&sock_fd_op_vtable) {
+		errno = EPERM;
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL && event == NULL) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+	ret = epoll_ctl_locked(ep, op, ctx, event);
+	k_mutex_unlock(&epoll_lock);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_ctl, epfd, op, fd, event)
+{
+	struct zsock_epoll_event event_copy;
+
+	if (event) {
+		Z_OOPS(z_user_from_copy(&event_copy, (void *)event,
+					sizeof(event_copy)));
+	}
+
+	return z_impl_zsock_epoll_ctl(epfd, op, fd,
+				      event ? &event_copy : NULL);
+}
+#endif /* CONFIG_USERSPACE */
+
+/* Move the events of the ready items to the events array. Level-triggered
+ * items that are still ready go to the end of the ready list, so that
+ * all ready sockets get their turn.
+ */
+static int epoll_collect(struct epoll_instance *ep,
+			 struct zsock_epoll_event *events, int maxevents)
+{
+	struct epoll_item *item, *next;
+	sys_dlist_t again;
+	int count = 0;
+
+	sys_dlist_init(&again);
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&ep->ready, item, next,
+					  ready_node) {
+		u32_t revents;
+
+		if (count == maxevents) {
+			break;
+		}
+
+		sys_dlist_remove(&item->ready_node);
+
+		revents = epoll_item_events(item);
+		if (!revents) {
+			continue;
+		}
+
+		events[count].events = revents;
+		events[count].data = item->event.data;
+		count++;
+
+		if (item->event.events & ZSOCK_EPOLLONESHOT) {
+			/* Disabled until re-armed with ZSOCK_EPOLL_CTL_MOD */
+			item->event.events = 0U;
+		} else if (!(item->event.events & ZSOCK_EPOLLET)) {
+			sys_dlist_append(&again, &item->ready_node);
+		}
+	}
+
+	while (!sys_dlist_is_empty(&again)) {
+		sys_dlist_append(&ep->ready, sys_dlist_get(&again));
+	}
+
+	return count;
+}
+
+static inline int time_left(u32_t start, u32_t timeout)
+{
+	u32_t elapsed = k_uptime_get_32() - start;
+
+	return timeout - elapsed;
+}
+
+int z_impl_zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+			    int maxevents, int timeout)
+{
+	u32_t entry_time = k_uptime_get_32();
+	struct epoll_instance *ep;
+	int remaining_time;
+	int count;
+
+	ep = epoll_get(epfd);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (timeout < 0) {
+		timeout = K_FOREVER;
+	}
+
+	remaining_time = timeout;
+
+	while (true) {
+		k_mutex_lock(&epoll_lock, K_FOREVER);
+		count = epoll_collect(ep, events, maxevents);
+		k_mutex_unlock(&epoll_lock);
+
+		if (count > 0 || timeout == K_NO_WAIT) {
+			break;
+		}
+
+		if (timeout != K_FOREVER) {
+			remaining_time = time_left(entry_time, timeout);
+			if (remaining_time <= 0) {
+				break;
+			}
+		}
+
+		/* A wakeup can be stale if the item was already collected
+		 * by a previous call, so the ready list is checked again.
+		 */
+		if (k_sem_take(&ep->ready_sem, remaining_time) == -EAGAIN) {
+			remaining_time = 0;
+		}
+	}
+
+	return count;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_epoll_wait, epfd, events, maxevents, timeout)
+{
+	/* The events are written directly to the checked user buffer */
+	if (maxevents > 0 &&
+	    Z_SYSCALL_MEMORY_ARRAY_WRITE(events, maxevents,
+					 sizeof(struct zsock_epoll_event))) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	return z_impl_zsock_epoll_wait(epfd, (struct zsock_epoll_event *)events,
+				       maxevents, timeout);
+}
+#endif /* CONFIG_USERSPACE */
+
+static int epoll_close(struct epoll_instance *ep)
+{
+	int i;
+
+	k_mutex_lock(&epoll_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		struct epoll_item *item = &epoll_items[i];
+
+		if (item->ep == ep) {
+			sys_slist_find_and_remove(&item->ctx->epoll_items,
+						  &item->ctx_node);
+			epoll_item_free(item);
+		}
+	}
+
+	ep->in_use = false;
+
+	k_mutex_unlock(&epoll_lock);
+
+	return 0;
+}
+
+static ssize_t epoll_read_vmeth(void *obj, void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_vmeth(void *obj, const void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static int epoll_ioctl_vmeth(void *obj, unsigned int request, va_list args)
+{
+	switch (request) {
+	case ZFD_IOCTL_CLOSE:
+		return epoll_close(obj);
+
+	default:
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+}
+
+static const struct fd_op_vtable epoll_fd_op_vtable = {
+	.read = epoll_read_vmeth,
+	.write = epoll_write_vmeth,
+	.ioctl = epoll_ioctl_vmeth,
+};
@@ -11,6 +11,10 @@
 
 #define SOCK_EOF 1
 #define SOCK_NONBLOCK 2
+#define SOCK_PKTINFO 4
+#define SOCK_TIMESTAMP 8
+#define SOCK_HUP 16
+#define SOCK_RESET 32
 
 static inline void sock_set_flag(struct net_context *ctx, u32_t mask,
 				 u32_t flag)
@@ -29,6 +33,10 @@ static inline u32_t sock_get_flag(struct net_context *ctx, u32_t mask)
 #define sock_is_eof(ctx) sock_get_flag(ctx, SOCK_EOF)
 #define sock_set_eof(ctx) sock_set_flag(ctx, SOCK_EOF, SOCK_EOF)
 #define sock_is_nonblock(ctx) sock_get_flag(ctx, SOCK_NONBLOCK)
+#define sock_is_hup(ctx) sock_get_flag(ctx, SOCK_HUP)
+#define sock_set_hup(ctx) sock_set_flag(ctx, SOCK_HUP, SOCK_HUP)
+#define sock_is_reset(ctx) sock_get_flag(ctx, SOCK_RESET)
+#define sock_set_reset(ctx) sock_set_flag(ctx, SOCK_RESET, SOCK_RESET)
 
 struct socket_op_vtable {
 	struct fd_op_vtable fd_vtable;
@@ -41,12 +49,42 @@ struct socket_op_vtable {
 			  const struct sockaddr *dest_addr, socklen_t addrlen);
 	ssize_t (*recvfrom)(void *obj, void *buf, size_t max_len, int flags,
 			    struct sockaddr *src_addr, socklen_t *addrlen);
+	ssize_t (*sendmsg)(void *obj, const struct msghdr *msg, int flags);
+	ssize_t (*recvmsg)(void *obj, struct msghdr *msg, int flags);
+	ssize_t (*recv_zerocopy)(void *obj, struct zsock_zerocopy_rx *zc,
+				 int flags);
+	int (*recv_zerocopy_release)(void *obj, struct zsock_zerocopy_rx *zc);
 	int (*getsockopt)(void *obj, int level, int optname,
 			  void *optval, socklen_t *optlen);
 	int (*setsockopt)(void *obj, int level, int optname,
 			  const void *optval, socklen_t optlen);
 };
 
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+static inline void zsock_epoll_init_ctx(struct net_context *ctx)
+{
+	sys_slist_init(&ctx->epoll_items);
+}
+
+void zsock_epoll_notify(struct net_context *ctx);
+void zsock_epoll_close_ctx(struct net_context *ctx);
+#else
+static inline void zsock_epoll_init_ctx(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+static inline void zsock_epoll_notify(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+static inline void zsock_epoll_close_ctx(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
+
 int ztls_socket(int family, int type, int proto);
 
 int zpacket_socket(int family, int type, int proto);
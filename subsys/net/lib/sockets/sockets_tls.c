@@ -32,6 +32,8 @@ LOG_MODULE_REGISTER(net_sock_tls, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <mbedtls/x509_crt.h>
 #include <mbedtls/ssl.h>
 #include <mbedtls/ssl_cookie.h>
+#include <mbedtls/ssl_cache.h>
+#include <mbedtls/ssl_ticket.h>
 #include <mbedtls/error.h>
 #include <mbedtls/debug.h>
 #endif /* CONFIG_MBEDTLS */
@@ -102,8 +104,33 @@ struct tls_context {
 
 		/** DTLS role, client by default. */
 		s8_t role;
+
+		/** Information if the session cache is used. */
+		bool cache_enabled;
 	} options;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	/** Information whether the handshake resumed a cached session. */
+	bool session_resumed;
+#endif
+
+#if CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE > 0
+	/** Data sent with MSG_MORE, to be written in the next TLS record. */
+	u8_t tx_record[CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE];
+
+	/** Length of the buffered data. */
+	u16_t tx_len;
+
+	/** Length of the buffered data already written. */
+	u16_t tx_sent;
+
+	/** Information whether the buffered data is being written. mbedTLS
+	 *  expects the same data when a write is retried, so no data is
+	 *  added to the buffer until it is completely written.
+	 */
+	bool tx_flushing;
+#endif /* CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE > 0 */
+
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 	/** Context information for DTLS timing. */
 	struct dtls_timing_context dtls_timing;
@@ -139,6 +166,29 @@ struct tls_context {
 #endif /* CONFIG_MBEDTLS */
 };
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+/** A session kept by the clients, to resume their next connection. */
+struct tls_session_cache {
+	/** Information whether the cache entry is used. */
+	bool is_used;
+
+	/** Uptime in ms when the session was last stored or restored. */
+	s64_t timestamp;
+
+	/** Secure tags of the connection. */
+	struct sec_tag_list sec_tag_list;
+
+	/** Peer hostname, empty if no hostname was set on the socket. */
+	char hostname[CONFIG_NET_SOCKETS_TLS_SESSION_CACHE_HOSTNAME_LEN + 1];
+
+	/** Peer address, only used when no hostname was set. */
+	struct sockaddr peer_addr;
+
+	/** mbedTLS session, with the session ID and ticket. */
+	mbedtls_ssl_session session;
+};
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 static mbedtls_ctr_drbg_context tls_ctr_drbg;
 
 /* A global pool of TLS contexts. */
@@ -147,6 +197,26 @@ static struct tls_context tls_contexts[CONFIG_NET_SOCKETS_TLS_MAX_CONTEXTS];
 /* A mutex for protecting TLS context allocation. */
 static struct k_mutex context_lock;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+/* Sessions of the clients. */
+static struct tls_session_cache client_sessions[
+				CONFIG_NET_SOCKETS_TLS_SESSION_CACHE_SIZE];
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+/* Sessions of the servers. */
+static mbedtls_ssl_cache_context server_sessions;
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+/* Keys of the session tickets issued by the servers. */
+static mbedtls_ssl_ticket_context server_tickets;
+static bool server_tickets_ready;
+#endif
+
+/* A mutex for protecting the session caches. */
+static struct k_mutex session_lock;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 #define IS_LISTENING(context) (net_context_get_state(context) == \
 			       NET_CONTEXT_LISTENING)
 
@@ -289,6 +359,31 @@ static int tls_init(struct device *unused)
 	mbedtls_debug_set_threshold(CONFIG_MBEDTLS_DEBUG_LEVEL);
 #endif
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	k_mutex_init(&session_lock);
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_cache_init(&server_sessions);
+	mbedtls_ssl_cache_set_max_entries(
+		&server_sessions, CONFIG_NET_SOCKETS_TLS_SESSION_CACHE_SIZE);
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	mbedtls_ssl_ticket_init(&server_tickets);
+
+	ret = mbedtls_ssl_ticket_setup(
+		&server_tickets, mbedtls_ctr_drbg_random, &tls_ctr_drbg,
+		MBEDTLS_CIPHER_AES_128_GCM,
+		CONFIG_NET_SOCKETS_TLS_SESSION_TICKET_LIFETIME);
+	if (ret == 0) {
+		server_tickets_ready = true;
+	} else {
+		/* Servers still resume sessions with the session cache */
+		NET_WARN("TLS session ticket initialization failed");
+	}
+#endif
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 	return 0;
 }
 
@@ -399,6 +494,240 @@ static int tls_release(struct tls_context *tls)
 	return 0;
 }
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+static const struct sockaddr *tls_peer_addr(struct net_context *context)
+{
+#if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
+	if (net_context_get_type(context) == SOCK_DGRAM) {
+		return &context->tls->dtls_peer_addr;
+	}
+#endif
+
+	return &context->remote;
+}
+
+static bool tls_session_addr_cmp(const struct sockaddr *addr1,
+				 const struct sockaddr *addr2)
+{
+	if (addr1->sa_family != addr2->sa_family) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && addr1->sa_family == AF_INET6) {
+		struct sockaddr_in6 *in6_1 = net_sin6(addr1);
+		struct sockaddr_in6 *in6_2 = net_sin6(addr2);
+
+		return (in6_1->sin6_port == in6_2->sin6_port) &&
+			net_ipv6_addr_cmp(&in6_1->sin6_addr, &in6_2->sin6_addr);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) && addr1->sa_family == AF_INET) {
+		struct sockaddr_in *in_1 = net_sin(addr1);
+		struct sockaddr_in *in_2 = net_sin(addr2);
+
+		return (in_1->sin_port == in_2->sin_port) &&
+			net_ipv4_addr_cmp(&in_1->sin_addr, &in_2->sin_addr);
+	}
+
+	return false;
+}
+
+static const char *tls_session_hostname(struct net_context *context)
+{
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	if (context->tls->options.is_hostname_set &&
+	    context->tls->ssl.hostname != NULL) {
+		return context->tls->ssl.hostname;
+	}
+#endif
+
+	return "";
+}
+
+/* Find the cached session of the peer of a client, the session_lock must be
+ * held.
+ */
+static struct tls_session_cache *tls_session_find(struct net_context *context)
+{
+	const char *hostname = tls_session_hostname(context);
+	struct tls_session_cache *entry;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client_sessions); i++) {
+		entry = &client_sessions[i];
+
+		if (!entry->is_used ||
+		    entry->sec_tag_list.sec_tag_count !=
+		    context->tls->options.sec_tag_list.sec_tag_count ||
+		    memcmp(entry->sec_tag_list.sec_tags,
+			   context->tls->options.sec_tag_list.sec_tags,
+			   entry->sec_tag_list.sec_tag_count *
+			   sizeof(sec_tag_t)) != 0 ||
+		    strcmp(entry->hostname, hostname) != 0) {
+			continue;
+		}
+
+		if (hostname[0] == '\0' &&
+		    !tls_session_addr_cmp(&entry->peer_addr,
+					  tls_peer_addr(context))) {
+			continue;
+		}
+
+		return entry;
+	}
+
+	return NULL;
+}
+
+/* Give the cached session of the peer to a client, to resume it. */
+static void tls_session_restore(struct net_context *context)
+{
+	struct tls_session_cache *entry;
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(context);
+	if (entry) {
+		ret = mbedtls_ssl_set_session(&context->tls->ssl,
+					      &entry->session);
+		if (ret == 0) {
+			entry->timestamp = k_uptime_get();
+		} else {
+			NET_WARN("Cannot restore TLS session: -%x", -ret);
+		}
+	}
+
+	k_mutex_unlock(&session_lock);
+}
+
+/* Keep the session of a client once the handshake is complete, replacing
+ * the previous session of the peer, or else the least recently used one.
+ */
+static void tls_session_store(struct net_context *context)
+{
+	const char *hostname = tls_session_hostname(context);
+	struct tls_session_cache *entry;
+	int ret;
+	int i;
+
+	if (strlen(hostname) > sizeof(client_sessions[0].hostname) - 1) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(context);
+
+	/* The cached session was resumed if the handshake kept its master
+	 * secret, whether with the session ID or with the session ticket.
+	 */
+	context->tls->session_resumed =
+		entry != NULL &&
+		memcmp(entry->session.master,
+		       context->tls->ssl.session->master,
+		       sizeof(entry->session.master)) == 0;
+
+	if (!entry) {
+		entry = &client_sessions[0];
+
+		for (i = 0; i < ARRAY_SIZE(client_sessions); i++) {
+			if (!client_sessions[i].is_used) {
+				entry = &client_sessions[i];
+				break;
+			}
+
+			if (client_sessions[i].timestamp < entry->timestamp) {
+				entry = &client_sessions[i];
+			}
+		}
+	}
+
+	if (entry->is_used) {
+		mbedtls_ssl_session_free(&entry->session);
+		entry->is_used = false;
+	}
+
+	mbedtls_ssl_session_init(&entry->session);
+
+	ret = mbedtls_ssl_get_session(&context->tls->ssl, &entry->session);
+	if (ret != 0) {
+		NET_WARN("Cannot store TLS session: -%x", -ret);
+		mbedtls_ssl_session_free(&entry->session);
+		goto out;
+	}
+
+	memcpy(&entry->sec_tag_list, &context->tls->options.sec_tag_list,
+	       sizeof(entry->sec_tag_list));
+	strcpy(entry->hostname, hostname);
+	memcpy(&entry->peer_addr, tls_peer_addr(context),
+	       sizeof(entry->peer_addr));
+	entry->timestamp = k_uptime_get();
+	entry->is_used = true;
+
+out:
+	k_mutex_unlock(&session_lock);
+}
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+static int tls_session_cache_get(void *data, mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_get(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int tls_session_cache_set(void *data,
+				 const mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_set(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+#endif /* MBEDTLS_SSL_CACHE_C */
+
+static void tls_session_cache_conf(struct net_context *context,
+				   bool is_server)
+{
+	if (!is_server) {
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+		mbedtls_ssl_conf_session_tickets(
+			&context->tls->config,
+			context->tls->options.cache_enabled ?
+			MBEDTLS_SSL_SESSION_TICKETS_ENABLED :
+			MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+#endif
+		return;
+	}
+
+	if (!context->tls->options.cache_enabled) {
+		return;
+	}
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_conf_session_cache(&context->tls->config,
+				       &server_sessions,
+				       tls_session_cache_get,
+				       tls_session_cache_set);
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	if (server_tickets_ready) {
+		mbedtls_ssl_conf_session_tickets_cb(&context->tls->config,
+						    mbedtls_ssl_ticket_write,
+						    mbedtls_ssl_ticket_parse,
+						    &server_tickets);
+	}
+#endif
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 static inline int time_left(u32_t start, u32_t timeout)
 {
 	u32_t elapsed = k_uptime_get_32() - start;
@@ -804,6 +1133,13 @@ static int tls_mbedtls_handshake(struct net_context *context, bool block)
 	}
 
 	if (ret == 0) {
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+		if (context->tls->options.cache_enabled &&
+		    context->tls->config.endpoint == MBEDTLS_SSL_IS_CLIENT) {
+			tls_session_store(context);
+		}
+#endif
+
 		k_sem_give(&context->tls->tls_established);
 	}
 
@@ -893,6 +1229,10 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 			     mbedtls_ctr_drbg_random,
 			     &tls_ctr_drbg);
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	tls_session_cache_conf(context, is_server);
+#endif
+
 	ret = tls_mbedtls_set_credentials(context->tls);
 	if (ret != 0) {
 		return ret;
@@ -907,6 +1247,12 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 		return -ENOMEM;
 	}
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	if (!is_server && context->tls->options.cache_enabled) {
+		tls_session_restore(context);
+	}
+#endif
+
 	context->tls->is_initialized = true;
 
 	return 0;
@@ -1100,6 +1446,139 @@ static int tls_opt_dtls_role_set(struct net_context *context,
 	return 0;
 }
 
+static int tls_opt_session_cache_set(struct net_context *context,
+				     const void *optval, socklen_t optlen)
+{
+	int *cache;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	cache = (int *)optval;
+	if (*cache != TLS_SESSION_CACHE_DISABLED &&
+	    *cache != TLS_SESSION_CACHE_ENABLED) {
+		return -EINVAL;
+	}
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	context->tls->options.cache_enabled =
+				(*cache == TLS_SESSION_CACHE_ENABLED);
+#else
+	return -ENOPROTOOPT;
+#endif
+
+	return 0;
+}
+
+static int tls_opt_session_cache_get(struct net_context *context,
+				     void *optval, socklen_t *optlen)
+{
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*(int *)optval = context->tls->options.cache_enabled ?
+			 TLS_SESSION_CACHE_ENABLED :
+			 TLS_SESSION_CACHE_DISABLED;
+
+	return 0;
+}
+
+static int tls_opt_session_resumed_get(struct net_context *context,
+				       void *optval, socklen_t *optlen)
+{
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	*(int *)optval = context->tls->session_resumed ? 1 : 0;
+#else
+	return -ENOPROTOOPT;
+#endif
+
+	return 0;
+}
+
+/* Write the data in as many TLS records as needed. Return the number of
+ * bytes written, or a negative errno value if none could be.
+ */
+static ssize_t tls_write(struct net_context *ctx, const u8_t *buf,
+			 size_t len)
+{
+	size_t sent = 0;
+	int ret;
+
+	while (sent < len) {
+		ret = mbedtls_ssl_write(&ctx->tls->ssl, buf + sent,
+					len - sent);
+		if (ret < 0) {
+			if (sent > 0) {
+				break;
+			}
+
+			if (ret == MBEDTLS_ERR_SSL_WANT_READ ||
+			    ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+				return -EAGAIN;
+			}
+
+			return -EIO;
+		}
+
+		sent += ret;
+	}
+
+	return sent;
+}
+
+#if CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE > 0
+/* Write the data buffered with MSG_MORE. */
+static int tls_tx_flush(struct net_context *ctx)
+{
+	struct tls_context *tls = ctx->tls;
+	ssize_t ret;
+
+	tls->tx_flushing = true;
+
+	while (tls->tx_sent < tls->tx_len) {
+		ret = tls_write(ctx, tls->tx_record + tls->tx_sent,
+				tls->tx_len - tls->tx_sent);
+		if (ret < 0) {
+			return ret;
+		}
+
+		tls->tx_sent += ret;
+	}
+
+	tls->tx_len = 0U;
+	tls->tx_sent = 0U;
+	tls->tx_flushing = false;
+
+	return 0;
+}
+
+/* Buffer the data to send with the next one, if it fits. */
+static bool tls_tx_buffer(struct net_context *ctx, const void *buf,
+			  size_t len)
+{
+	struct tls_context *tls = ctx->tls;
+
+	if (tls->tx_flushing || len > sizeof(tls->tx_record) - tls->tx_len) {
+		return false;
+	}
+
+	memcpy(tls->tx_record + tls->tx_len, buf, len);
+	tls->tx_len += len;
+
+	return true;
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE > 0 */
+
 int ztls_socket(int family, int type, int proto)
 {
 	enum net_ip_protocol_secure tls_proto = 0;
@@ -1179,8 +1658,16 @@ int ztls_close_ctx(struct net_context *ctx)
 
 
 	if (ctx->tls != NULL) {
-		/* Try to send close notification. */
 		ctx->tls->flags = 0;
+
+#if CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE > 0
+		/* Try to send the data buffered with MSG_MORE. */
+		if (ctx->tls->tx_len > 0) {
+			(void)tls_tx_flush(ctx);
+		}
+#endif
+
+		/* Try to send close notification. */
 		(void)mbedtls_ssl_close_notify(&ctx->tls->ssl);
 
 		err = tls_release(ctx->tls);
@@ -1352,6 +1839,58 @@ static ssize_t send_tls(struct net_context *ctx, const void *buf,
 	return -1;
 }
 
+static ssize_t send_tls_stream(struct net_context *ctx, const void *buf,
+			       size_t len, int flags)
+{
+	ssize_t ret;
+
+#if CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE > 0
+	bool buffered = false;
+
+	/* Small data goes in the record of the data already buffered */
+	if ((flags & ZSOCK_MSG_MORE) || ctx->tls->tx_len > 0) {
+		buffered = tls_tx_buffer(ctx, buf, len);
+		if (buffered && (flags & ZSOCK_MSG_MORE) &&
+		    ctx->tls->tx_len < sizeof(ctx->tls->tx_record)) {
+			return len;
+		}
+	}
+
+	if (ctx->tls->tx_len > 0) {
+		ret = tls_tx_flush(ctx);
+		if (ret < 0) {
+			/* The data is in the record buffer now, so it must not
+			 * be given again. It is written, or the error is
+			 * reported, with the next call.
+			 */
+			if (buffered) {
+				return len;
+			}
+
+			errno = -ret;
+			return -1;
+		}
+	}
+
+	if (buffered) {
+		return len;
+	}
+
+	if ((flags & ZSOCK_MSG_MORE) && tls_tx_buffer(ctx, buf, len)) {
+		return len;
+	}
+#endif /* CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE > 0 */
+
+	/* Bulk data is written in full records, with a single call */
+	ret = tls_write(ctx, buf, len);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return ret;
+}
+
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 static ssize_t sendto_dtls_client(struct net_context *ctx, const void *buf,
 				  size_t len, int flags,
@@ -1438,7 +1977,7 @@ ssize_t ztls_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 
 	/* TLS */
 	if (net_context_get_type(ctx) == SOCK_STREAM) {
-		return send_tls(ctx, buf, len, flags);
+		return send_tls_stream(ctx, buf, len, flags);
 	}
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
@@ -1455,6 +1994,46 @@ ssize_t ztls_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 }
 
+ssize_t ztls_sendmsg_ctx(struct net_context *ctx, const struct msghdr *msg,
+			 int flags)
+{
+	ssize_t len = 0;
+	ssize_t ret;
+	int i;
+
+	if (ctx->tls == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	if (net_context_get_type(ctx) != SOCK_STREAM) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	ctx->tls->flags = flags;
+
+	for (i = 0; i < msg->msg_iovlen; i++) {
+		const struct iovec *iov = &msg->msg_iov[i];
+
+		/* The iovecs are coalesced in the same records */
+		ret = send_tls_stream(ctx, iov->iov_base, iov->iov_len,
+				      (i < msg->msg_iovlen - 1) ?
+				      (flags | ZSOCK_MSG_MORE) : flags);
+		if (ret < 0) {
+			return (len > 0) ? len : -1;
+		}
+
+		len += ret;
+
+		if (ret < iov->iov_len) {
+			break;
+		}
+	}
+
+	return len;
+}
+
 static ssize_t recv_tls(struct net_context *ctx, void *buf,
 			size_t max_len, int flags)
 {
@@ -1834,6 +2413,14 @@ int ztls_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 		err = tls_opt_ciphersuite_used_get(ctx, optval, optlen);
 		break;
 
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_get(ctx, optval, optlen);
+		break;
+
+	case TLS_SESSION_RESUMED:
+		err = tls_opt_session_resumed_get(ctx, optval, optlen);
+		break;
+
 	default:
 		/* Unknown or write-only option. */
 		err = -ENOPROTOOPT;
@@ -1884,6 +2471,10 @@ int ztls_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 		err = tls_opt_dtls_role_set(ctx, optval, optlen);
 		break;
 
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_set(ctx, optval, optlen);
+		break;
+
 	default:
 		/* Unknown or read-only option. */
 		err = -ENOPROTOOPT;
@@ -1989,6 +2580,12 @@ static ssize_t tls_sock_recvfrom_vmeth(void *obj, void *buf, size_t max_len,
 				 src_addr, addrlen);
 }
 
+static ssize_t tls_sock_sendmsg_vmeth(void *obj, const struct msghdr *msg,
+				      int flags)
+{
+	return ztls_sendmsg_ctx(obj, msg, flags);
+}
+
 static int tls_sock_getsockopt_vmeth(void *obj, int level, int optname,
 				     void *optval, socklen_t *optlen)
 {
@@ -2014,6 +2611,7 @@ static const struct socket_op_vtable tls_sock_fd_op_vtable = {
 	.accept = tls_sock_accept_vmeth,
 	.sendto = tls_sock_sendto_vmeth,
 	.recvfrom = tls_sock_recvfrom_vmeth,
+	.sendmsg = tls_sock_sendmsg_vmeth,
 	.getsockopt = tls_sock_getsockopt_vmeth,
 	.setsockopt = tls_sock_setsockopt_vmeth,
 };
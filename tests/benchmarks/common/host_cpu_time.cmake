@@ -0,0 +1,8 @@
+# The simulated time of native_posix does not advance while computing, so
+# the CPU time of the process is read from the host C library.
+if(CONFIG_BOARD_NATIVE_POSIX)
+  target_include_directories(app PRIVATE ${CMAKE_CURRENT_LIST_DIR})
+  target_sources(app PRIVATE ${CMAKE_CURRENT_LIST_DIR}/host_cpu_time.c)
+  set_source_files_properties(${CMAKE_CURRENT_LIST_DIR}/host_cpu_time.c
+    PROPERTIES COMPILE_DEFINITIONS NO_POSIX_CHEATS)
+endif()
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __HOST_CPU_TIME_H__
+#define __HOST_CPU_TIME_H__
+
+/* Return the CPU time used by the native_posix process, in microseconds.
+ * The simulated time does not advance while computing, so the benchmarks
+ * running on native_posix read it from the host instead.
+ */
+unsigned long long host_cpu_time_us(void);
+
+#endif /* __HOST_CPU_TIME_H__ */
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/dummy.h>
+
+#include <ztest.h>
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+/* This is a microbenchmark of the connection lookup done for every
+ * received UDP and TCP packet. A server with many clients is emulated
+ * by registering N_CONNS connected UDP handlers that share the local
+ * port, and one listener for the same port. A UDP packet is injected
+ * with net_recv_data() for each connection in turn, and one for the
+ * listener, and the time from injecting the packet to its handler
+ * being called is averaged over N_ROUNDS rounds.
+ */
+
+#define N_CONNS (CONFIG_NET_MAX_CONN - 1)
+#define N_ROUNDS 4
+
+#define LOCAL_PORT 4242
+#define REMOTE_PORT_BASE 10000
+
+/* Packets to this port have no connected handler */
+#define LISTENER_PORT (REMOTE_PORT_BASE - 1)
+#define LISTENER_IDX N_CONNS
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static K_SEM_DEFINE(recv_sem, 0, UINT_MAX);
+static u32_t recv_stamp;
+static int recv_idx;
+
+static int tester_init(struct device *dev)
+{
+	return 0;
+}
+
+static void tester_iface_init(struct net_if *iface)
+{
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	static u8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int tester_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api tester_api = {
+	.iface_api.init = tester_iface_init,
+	.send = tester_send,
+};
+
+NET_DEVICE_INIT(net_conn_bench, "net_conn_bench", tester_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &tester_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+static enum net_verdict conn_cb(struct net_conn *conn,
+				struct net_pkt *pkt,
+				union net_ip_header *ip_hdr,
+				union net_proto_header *proto_hdr,
+				void *user_data)
+{
+	recv_stamp = k_cycle_get_32();
+	recv_idx = POINTER_TO_INT(user_data);
+
+	net_pkt_unref(pkt);
+	k_sem_give(&recv_sem);
+
+	return NET_OK;
+}
+
+/* Returns the cycles spent from injecting the packet to its handler */
+static u32_t measure(struct net_if *iface, u16_t remote_port, int idx)
+{
+	struct net_pkt *pkt;
+	u32_t start;
+
+	pkt = net_pkt_alloc_with_buffer(iface, 0, AF_INET, IPPROTO_UDP,
+					K_SECONDS(1));
+	zassert_not_null(pkt, "Out of mem");
+
+	zassert_equal(net_ipv4_create(pkt, &peer_addr, &my_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_udp_create(pkt, htons(remote_port),
+				     htons(LOCAL_PORT)), 0,
+		      "Cannot create UDP header");
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	start = k_cycle_get_32();
+
+	zassert_true(net_recv_data(iface, pkt) >= 0, "Cannot recv pkt");
+	zassert_equal(k_sem_take(&recv_sem, K_SECONDS(1)), 0,
+		      "Packet not received");
+	zassert_equal(recv_idx, idx, "Packet passed to wrong handler");
+
+	return recv_stamp - start;
+}
+
+static void test_conn_lookup(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct sockaddr_in local = { .sin_family = AF_INET };
+	struct sockaddr_in remote = { .sin_family = AF_INET };
+	u64_t connected = 0U;
+	u64_t listener = 0U;
+	int i, round, ret;
+
+	zassert_not_null(net_if_ipv4_addr_add(iface, &my_addr,
+					      NET_ADDR_MANUAL, 0),
+			 "Cannot add IPv4 address");
+
+	net_ipaddr_copy(&local.sin_addr, &my_addr);
+	net_ipaddr_copy(&remote.sin_addr, &peer_addr);
+
+	ret = net_udp_register(AF_INET, NULL, (struct sockaddr *)&local,
+			       0, LOCAL_PORT, conn_cb,
+			       INT_TO_POINTER(LISTENER_IDX), NULL);
+	zassert_equal(ret, 0, "Cannot register listener");
+
+	for (i = 0; i < N_CONNS; i++) {
+		ret = net_udp_register(AF_INET, (struct sockaddr *)&remote,
+				       (struct sockaddr *)&local,
+				       REMOTE_PORT_BASE + i, LOCAL_PORT,
+				       conn_cb, INT_TO_POINTER(i), NULL);
+		zassert_equal(ret, 0, "Cannot register connection %d", i);
+	}
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		for (i = 0; i < N_CONNS; i++) {
+			connected += measure(iface, REMOTE_PORT_BASE + i, i);
+		}
+
+		listener += measure(iface, LISTENER_PORT, LISTENER_IDX);
+	}
+
+	printk("%d connections, lookup %s: connected %u listener %u "
+	       "cycles per packet\n", N_CONNS,
+	       IS_ENABLED(CONFIG_NET_CONN_HASH) ? "hash" : "linear",
+	       (u32_t)(connected / (N_ROUNDS * N_CONNS)),
+	       (u32_t)(listener / N_ROUNDS));
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_conn_bench,
+			 ztest_unit_test(test_conn_lookup));
+
+	ztest_run_test_suite(net_conn_bench);
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+
+#include <ztest.h>
+
+/* This is a benchmark of waiting for socket events with many sockets of
+ * which only a few are active. N_IDLE bound UDP sockets never receive
+ * anything, while a datagram is sent to each of the N_ACTIVE sockets in
+ * every round. The cycles spent waiting for and reading the datagrams of
+ * a round are averaged over N_ROUNDS rounds, first with poll() over all
+ * sockets and then with epoll_wait().
+ */
+
+#define N_IDLE 200
+#define N_ACTIVE 4
+#define N_SOCKS (N_IDLE + N_ACTIVE)
+#define N_ROUNDS 64
+
+#define PORT_BASE 10000
+
+static struct sockaddr_in addrs[N_SOCKS];
+static int socks[N_SOCKS];
+static int client_sock;
+
+static struct pollfd pollfds[N_SOCKS];
+static struct epoll_event events[N_ACTIVE];
+
+static void test_setup(void)
+{
+	int ret;
+	int i;
+
+	for (i = 0; i < N_SOCKS; i++) {
+		addrs[i].sin_family = AF_INET;
+		addrs[i].sin_port = htons(PORT_BASE + i);
+		ret = inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&addrs[i].sin_addr);
+		zassert_equal(ret, 1, "inet_pton failed");
+
+		socks[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		zassert_true(socks[i] >= 0, "socket %d open failed", i);
+
+		ret = bind(socks[i], (struct sockaddr *)&addrs[i],
+			   sizeof(addrs[i]));
+		zassert_equal(ret, 0, "bind %d failed", i);
+
+		pollfds[i].fd = socks[i];
+		pollfds[i].events = POLLIN;
+	}
+
+	client_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(client_sock >= 0, "socket open failed");
+}
+
+/* The active sockets are spread among the idle ones */
+static int active_idx(int i)
+{
+	return (i + 1) * (N_SOCKS / N_ACTIVE) - 1;
+}
+
+static void send_round(void)
+{
+	u8_t data = 0U;
+	ssize_t ret;
+	int i;
+
+	for (i = 0; i < N_ACTIVE; i++) {
+		int idx = active_idx(i);
+
+		ret = sendto(client_sock, &data, sizeof(data), 0,
+			     (struct sockaddr *)&addrs[idx],
+			     sizeof(addrs[idx]));
+		zassert_equal(ret, sizeof(data), "sendto failed");
+	}
+}
+
+static void recv_sock(int sock)
+{
+	u8_t data;
+
+	zassert_equal(recv(sock, &data, sizeof(data), MSG_DONTWAIT),
+		      sizeof(data), "recv failed");
+}
+
+static void test_poll(void)
+{
+	u64_t cycles = 0U;
+	int received;
+	int round;
+	u32_t start;
+	int ret;
+	int i;
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		send_round();
+
+		start = k_cycle_get_32();
+
+		for (received = 0; received < N_ACTIVE; ) {
+			ret = poll(pollfds, N_SOCKS, 1000);
+			zassert_true(ret > 0, "poll failed");
+
+			for (i = 0; i < N_SOCKS; i++) {
+				if (pollfds[i].revents & POLLIN) {
+					recv_sock(pollfds[i].fd);
+					received++;
+				}
+			}
+		}
+
+		cycles += k_cycle_get_32() - start;
+	}
+
+	printk("%d sockets, poll(): %u cycles per round\n", N_SOCKS,
+	       (u32_t)(cycles / N_ROUNDS));
+}
+
+static void test_epoll(void)
+{
+	u64_t cycles = 0U;
+	int received;
+	int round;
+	u32_t start;
+	int epfd;
+	int ret;
+	int i;
+
+	epfd = epoll_create(N_SOCKS);
+	zassert_true(epfd >= 0, "epoll_create failed");
+
+	for (i = 0; i < N_SOCKS; i++) {
+		struct epoll_event ev = {
+			.events = EPOLLIN,
+			.data.fd = socks[i],
+		};
+
+		ret = epoll_ctl(epfd, EPOLL_CTL_ADD, socks[i], &ev);
+		zassert_equal(ret, 0, "epoll_ctl %d failed", i);
+	}
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		send_round();
+
+		start = k_cycle_get_32();
+
+		for (received = 0; received < N_ACTIVE; ) {
+			ret = epoll_wait(epfd, events, ARRAY_SIZE(events),
+					 1000);
+			zassert_true(ret > 0, "epoll_wait failed");
+
+			for (i = 0; i < ret; i++) {
+				recv_sock(events[i].data.fd);
+				received++;
+			}
+		}
+
+		cycles += k_cycle_get_32() - start;
+	}
+
+	printk("%d sockets, epoll_wait(): %u cycles per round\n", N_SOCKS,
+	       (u32_t)(cycles / N_ROUNDS));
+
+	zassert_equal(close(epfd), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_epoll_bench,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_poll),
+			 ztest_unit_test(test_epoll));
+
+	ztest_run_test_suite(net_epoll_bench);
+}
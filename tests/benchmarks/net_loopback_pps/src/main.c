@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+
+#include <ztest.h>
+
+/* This is a packet rate benchmark of the transmit path through the
+ * loopback interface. Small UDP datagrams are sent to the local address,
+ * first one at a time waiting for each to be received, and then in
+ * bursts of BURST datagrams. The cycles per datagram and the resulting
+ * packet rate are printed. Compare the results with and without
+ * CONFIG_NET_TC_TX_DIRECT.
+ */
+
+#define N_PKTS 1024
+#define BURST 8
+#define PKT_LEN 64
+
+#define SERVER_PORT 4242
+
+static u8_t tx_data[PKT_LEN];
+static u8_t rx_data[PKT_LEN];
+
+static struct sockaddr_in server_addr;
+static int client_sock;
+static int server_sock;
+
+static void test_setup(void)
+{
+	int ret;
+
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	ret = inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			&server_addr.sin_addr);
+	zassert_equal(ret, 1, "inet_pton failed");
+
+	server_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(server_sock >= 0, "socket open failed");
+	client_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(client_sock >= 0, "socket open failed");
+
+	ret = bind(server_sock, (struct sockaddr *)&server_addr,
+		   sizeof(server_addr));
+	zassert_equal(ret, 0, "bind failed");
+
+	printk("Direct Tx path %s\n",
+	       IS_ENABLED(CONFIG_NET_TC_TX_DIRECT) ? "enabled" : "disabled");
+}
+
+static void report(const char *name, u32_t cycles)
+{
+	u64_t ns = SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+
+	printk("%s: %u cycles per datagram, %u datagrams/s\n", name,
+	       cycles / N_PKTS,
+	       ns ? (u32_t)((u64_t)N_PKTS * NSEC_PER_SEC / ns) : 0);
+}
+
+static void send_pkt(void)
+{
+	ssize_t ret;
+
+	ret = sendto(client_sock, tx_data, sizeof(tx_data), 0,
+		     (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(ret, sizeof(tx_data), "sendto failed");
+}
+
+static void recv_pkt(void)
+{
+	ssize_t ret;
+
+	ret = recv(server_sock, rx_data, sizeof(rx_data), 0);
+	zassert_equal(ret, sizeof(rx_data), "recv failed");
+}
+
+static void test_single(void)
+{
+	u32_t start;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < N_PKTS; i++) {
+		send_pkt();
+		recv_pkt();
+	}
+
+	report("single", k_cycle_get_32() - start);
+}
+
+static void test_burst(void)
+{
+	u32_t start;
+	int i, j;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < N_PKTS; i += BURST) {
+		for (j = 0; j < BURST; j++) {
+			send_pkt();
+		}
+
+		for (j = 0; j < BURST; j++) {
+			recv_pkt();
+		}
+	}
+
+	report("burst", k_cycle_get_32() - start);
+}
+
+static void test_close(void)
+{
+	zassert_equal(close(client_sock), 0, "close failed");
+	zassert_equal(close(server_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_loopback_pps_bench,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_single),
+			 ztest_unit_test(test_burst),
+			 ztest_unit_test(test_close));
+
+	ztest_run_test_suite(net_loopback_pps_bench);
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+#include <net/tls_credentials.h>
+
+#include <ztest.h>
+
+/* This is a benchmark of the TLS handshake over the loopback interface.
+ * A client connects N_ROUNDS times to a server running in another thread,
+ * first with full handshakes and then resuming the session of the previous
+ * connection with TLS_SESSION_CACHE. The time spent computing the handshake
+ * on both sides is averaged over the rounds. On native_posix, where the
+ * simulated time does not advance while computing, the CPU time of the
+ * process is read from the host instead of the cycle counter.
+ */
+
+#define N_ROUNDS 16
+
+#define SERVER_PORT 4243
+#define SEC_TAG 1
+
+/* TLS-ECDHE-PSK-WITH-AES-128-CBC-SHA256 */
+#define CIPHERSUITE 0xC037
+
+#define WAIT_TIME K_SECONDS(10)
+
+#define SERVER_STACK_SIZE 8192
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+static const unsigned char psk[] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+	0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10
+};
+static const char psk_id[] = "bench";
+
+static const sec_tag_t sec_tags[] = { SEC_TAG };
+static const int ciphersuites[] = { CIPHERSUITE };
+
+static struct sockaddr_in server_addr;
+static int server_sock;
+
+static K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static K_SEM_DEFINE(handshake_done, 0, 1);
+
+#if defined(CONFIG_BOARD_NATIVE_POSIX)
+#include <host_cpu_time.h>
+
+static u64_t timestamp(void)
+{
+	return host_cpu_time_us();
+}
+
+static u32_t elapsed_us(u64_t start)
+{
+	return host_cpu_time_us() - start;
+}
+#else
+static u64_t timestamp(void)
+{
+	return k_cycle_get_32();
+}
+
+static u32_t elapsed_us(u64_t start)
+{
+	u32_t cycles = k_cycle_get_32() - (u32_t)start;
+
+	return SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) / NSEC_PER_USEC;
+}
+#endif
+
+static void set_tls_options(int sock, int cache)
+{
+	int ret;
+
+	ret = setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tags,
+			 sizeof(sec_tags));
+	zassert_equal(ret, 0, "Cannot set secure tags");
+
+	ret = setsockopt(sock, SOL_TLS, TLS_CIPHERSUITE_LIST, ciphersuites,
+			 sizeof(ciphersuites));
+	zassert_equal(ret, 0, "Cannot set ciphersuites");
+
+	ret = setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE, &cache,
+			 sizeof(cache));
+	zassert_equal(ret, 0, "Cannot set session cache");
+}
+
+static void server_fn(void *p1, void *p2, void *p3)
+{
+	u8_t data;
+	int sock;
+
+	while (true) {
+		sock = accept(server_sock, NULL, NULL);
+		if (sock < 0) {
+			printk("accept failed: %d\n", errno);
+			return;
+		}
+
+		k_sem_give(&handshake_done);
+
+		/* Wait for the client to close the connection */
+		(void)recv(sock, &data, sizeof(data), 0);
+		(void)close(sock);
+	}
+}
+
+static void test_setup(void)
+{
+	int ret;
+
+	ret = tls_credential_add(SEC_TAG, TLS_CREDENTIAL_PSK, psk,
+				 sizeof(psk));
+	zassert_equal(ret, 0, "Cannot add PSK");
+
+	ret = tls_credential_add(SEC_TAG, TLS_CREDENTIAL_PSK_ID, psk_id,
+				 strlen(psk_id));
+	zassert_equal(ret, 0, "Cannot add PSK ID");
+
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	ret = inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			&server_addr.sin_addr);
+	zassert_equal(ret, 1, "inet_pton failed");
+
+	server_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(server_sock >= 0, "socket open failed");
+
+	/* The server keeps the sessions in both runs, only the client
+	 * decides whether to resume them.
+	 */
+	set_tls_options(server_sock, TLS_SESSION_CACHE_ENABLED);
+
+	ret = bind(server_sock, (struct sockaddr *)&server_addr,
+		   sizeof(server_addr));
+	zassert_equal(ret, 0, "bind failed");
+
+	ret = listen(server_sock, 1);
+	zassert_equal(ret, 0, "listen failed");
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server_fn,
+			NULL, NULL, NULL, SERVER_PRIORITY, 0, K_NO_WAIT);
+}
+
+/* Connect and return the time spent until the handshake is complete on
+ * both sides.
+ */
+static u32_t handshake(int cache)
+{
+	u64_t start;
+	u32_t time;
+	int sock;
+	int ret;
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(sock >= 0, "socket open failed");
+
+	set_tls_options(sock, cache);
+
+	start = timestamp();
+
+	ret = connect(sock, (struct sockaddr *)&server_addr,
+		      sizeof(server_addr));
+	zassert_equal(ret, 0, "connect failed");
+
+	zassert_equal(k_sem_take(&handshake_done, WAIT_TIME), 0,
+		      "Handshake not complete");
+
+	time = elapsed_us(start);
+
+	zassert_equal(close(sock), 0, "close failed");
+
+	/* Let the server close its side of the connection */
+	k_sleep(K_MSEC(10));
+
+	return time;
+}
+
+static void run(const char *name, int cache)
+{
+	u64_t total = 0U;
+	int round;
+
+	/* The first connection gives the session to resume */
+	(void)handshake(cache);
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		total += handshake(cache);
+	}
+
+	printk("%s handshake: %u us\n", name, (u32_t)(total / N_ROUNDS));
+}
+
+static void test_full_handshake(void)
+{
+	run("Full", TLS_SESSION_CACHE_DISABLED);
+}
+
+static void test_resumed_handshake(void)
+{
+	run("Resumed", TLS_SESSION_CACHE_ENABLED);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tls_handshake_bench,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_full_handshake),
+			 ztest_unit_test(test_resumed_handshake));
+
+	ztest_run_test_suite(net_tls_handshake_bench);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+
+#include <ztest.h>
+
+/* This is a throughput benchmark of UDP sockets over the local address.
+ * N_PKTS small datagrams are sent and received, BATCH at a time, first
+ * with one sendto()/recvfrom() call per datagram and then with one
+ * sendmmsg()/recvmmsg() call per batch. The cycles spent per datagram
+ * and the resulting packet rate are printed for both. With
+ * CONFIG_TEST_USERSPACE the benchmark runs in user mode, where each call
+ * is a system call.
+ */
+
+#define N_PKTS 1024
+#define BATCH 8
+#define PKT_LEN 64
+
+#define SERVER_PORT 4242
+
+static ZTEST_BMEM u8_t tx_data[PKT_LEN];
+static ZTEST_BMEM u8_t rx_data[BATCH][PKT_LEN];
+
+static ZTEST_BMEM struct sockaddr_in server_addr;
+static ZTEST_BMEM int client_sock;
+static ZTEST_BMEM int server_sock;
+
+/* The sockets are opened by each test, as a user mode thread can only
+ * use the sockets it has created itself.
+ */
+static void open_sockets(void)
+{
+	struct sockaddr_in client_addr = {
+		.sin_family = AF_INET,
+	};
+	int ret;
+
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	ret = inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			&server_addr.sin_addr);
+	zassert_equal(ret, 1, "inet_pton failed");
+
+	server_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(server_sock >= 0, "socket open failed");
+	client_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(client_sock >= 0, "socket open failed");
+
+	ret = bind(server_sock, (struct sockaddr *)&server_addr,
+		   sizeof(server_addr));
+	zassert_equal(ret, 0, "bind failed");
+
+	ret = bind(client_sock, (struct sockaddr *)&client_addr,
+		   sizeof(client_addr));
+	zassert_equal(ret, 0, "bind failed");
+}
+
+static void close_sockets(void)
+{
+	zassert_equal(close(client_sock), 0, "close failed");
+	zassert_equal(close(server_sock), 0, "close failed");
+}
+
+static void report(const char *name, u32_t cycles)
+{
+	u64_t ns = SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+
+	printk("%s: %u cycles per datagram, %u datagrams/s\n", name,
+	       cycles / N_PKTS,
+	       ns ? (u32_t)((u64_t)N_PKTS * NSEC_PER_SEC / ns) : 0);
+}
+
+static void test_single(void)
+{
+	u32_t start;
+	int i, j;
+	ssize_t ret;
+
+	open_sockets();
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < N_PKTS; i += BATCH) {
+		for (j = 0; j < BATCH; j++) {
+			ret = sendto(client_sock, tx_data, sizeof(tx_data), 0,
+				     (struct sockaddr *)&server_addr,
+				     sizeof(server_addr));
+			zassert_equal(ret, sizeof(tx_data), "sendto failed");
+		}
+
+		for (j = 0; j < BATCH; j++) {
+			ret = recvfrom(server_sock, rx_data[j],
+				       sizeof(rx_data[j]), 0, NULL, NULL);
+			zassert_equal(ret, sizeof(tx_data), "recvfrom failed");
+		}
+	}
+
+	report("sendto/recvfrom", k_cycle_get_32() - start);
+
+	close_sockets();
+}
+
+static void test_batched(void)
+{
+	struct mmsghdr tx_msgs[BATCH];
+	struct mmsghdr rx_msgs[BATCH];
+	struct iovec tx_iov = {
+		.iov_base = tx_data,
+		.iov_len = sizeof(tx_data),
+	};
+	struct iovec rx_iov[BATCH];
+	int received;
+	u32_t start;
+	int i, j;
+
+	memset(tx_msgs, 0, sizeof(tx_msgs));
+	memset(rx_msgs, 0, sizeof(rx_msgs));
+
+	for (j = 0; j < BATCH; j++) {
+		tx_msgs[j].msg_hdr.msg_name = &server_addr;
+		tx_msgs[j].msg_hdr.msg_namelen = sizeof(server_addr);
+		tx_msgs[j].msg_hdr.msg_iov = &tx_iov;
+		tx_msgs[j].msg_hdr.msg_iovlen = 1;
+
+		rx_iov[j].iov_base = rx_data[j];
+		rx_iov[j].iov_len = sizeof(rx_data[j]);
+		rx_msgs[j].msg_hdr.msg_iov = &rx_iov[j];
+		rx_msgs[j].msg_hdr.msg_iovlen = 1;
+	}
+
+	open_sockets();
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < N_PKTS; i += BATCH) {
+		zassert_equal(sendmmsg(client_sock, tx_msgs, BATCH, 0), BATCH,
+			      "sendmmsg failed");
+
+		/* Datagrams still in flight are picked up by the next call */
+		for (received = 0; received < BATCH; ) {
+			int ret = recvmmsg(server_sock, rx_msgs,
+					   BATCH - received, 0);
+
+			zassert_true(ret > 0, "recvmmsg failed");
+			received += ret;
+		}
+	}
+
+	report("sendmmsg/recvmmsg", k_cycle_get_32() - start);
+
+	close_sockets();
+}
+
+void test_main(void)
+{
+	/* For the copies of the message vectors made by the system calls */
+	k_thread_system_pool_assign(k_current_get());
+
+	ztest_test_suite(net_udp_batch_bench,
+			 ztest_user_unit_test(test_single),
+			 ztest_user_unit_test(test_batched));
+
+	ztest_run_test_suite(net_udp_batch_bench);
+}
@@ -24,6 +24,8 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_ARP_LOG_LEVEL);
 #include <net/net_pkt.h>
 #include <net/net_ip.h>
 #include <net/dummy.h>
+#include <net/net_mgmt.h>
+#include <net/net_stats.h>
 #include <ztest.h>
 
 #include "arp.h"
@@ -44,6 +46,8 @@ static struct net_eth_addr hwaddr = { { 0x42, 0x11, 0x69, 0xde, 0xfa, 0xec } };
 
 static int send_status = -EINVAL;
 
+static int refresh_count;
+
 struct net_arp_context {
 	u8_t mac_addr[sizeof(struct net_eth_addr)];
 	struct net_linkaddr ll_addr;
@@ -97,6 +101,21 @@ static int tester_send(struct device *dev, struct net_pkt *pkt)
 		/* First frag has eth hdr */
 		struct net_arp_hdr *arp_hdr =
 			(struct net_arp_hdr *)pkt->frags->frags;
+		struct net_arp_hdr *req_hdr =
+			(struct net_arp_hdr *)pkt->frags->frags->data;
+
+		if (ntohs(req_hdr->opcode) == NET_ARP_REQUEST &&
+		    !net_eth_is_addr_broadcast(&hdr->dst)) {
+			/* Unicast request refreshing a cache entry */
+			if (!memcmp(&hdr->dst, &hwaddr,
+				    sizeof(struct net_eth_addr)) &&
+			    !memcmp(&req_hdr->dst_hwaddr, &hwaddr,
+				    sizeof(struct net_eth_addr))) {
+				refresh_count++;
+			}
+
+			return 0;
+		}
 
 		if (ntohs(arp_hdr->opcode) == NET_ARP_REPLY) {
 			if (!req_test && pkt != pending_pkt) {
@@ -633,9 +652,162 @@ void test_arp(void)
 	}
 }
 
+static struct net_pkt *prepare_ipv4_pkt(struct net_if *iface,
+					struct in_addr *src,
+					struct in_addr *dst)
+{
+	struct net_ipv4_hdr *ipv4;
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_ipv4_hdr),
+					AF_INET, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem");
+
+	ipv4 = (struct net_ipv4_hdr *)net_buf_add(pkt->buffer,
+						  sizeof(struct net_ipv4_hdr));
+	net_ipaddr_copy(&ipv4->src, src);
+	net_ipaddr_copy(&ipv4->dst, dst);
+
+	return pkt;
+}
+
+/* Returns true if the destination was found in the ARP cache */
+static bool arp_lookup(struct net_if *iface, struct in_addr *src,
+		       struct in_addr *dst)
+{
+	struct net_pkt *pkt, *pkt2;
+
+	pkt = prepare_ipv4_pkt(iface, src, dst);
+	pkt2 = net_arp_prepare(pkt, &NET_IPV4_HDR(pkt)->dst, NULL);
+	zassert_not_null(pkt2, "ARP prepare failed");
+
+	if (pkt2 != pkt) {
+		/* The request is not sent, the cache keeps its own
+		 * reference to the pending packet.
+		 */
+		net_pkt_unref(pkt2);
+	}
+
+	net_pkt_unref(pkt);
+
+	return pkt2 == pkt;
+}
+
+static void arp_reply(struct net_if *iface, struct in_addr *src,
+		      struct in_addr *dst)
+{
+	struct net_eth_hdr *eth_hdr;
+	struct net_arp_hdr *arp_hdr;
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_eth_hdr) +
+					sizeof(struct net_arp_hdr),
+					AF_UNSPEC, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem reply");
+
+	setup_eth_header(iface, pkt, net_if_get_link_addr(iface)->addr,
+			 NET_ETH_PTYPE_ARP);
+	memcpy(&NET_ETH_HDR(pkt)->src, &hwaddr, sizeof(struct net_eth_addr));
+
+	eth_hdr = (struct net_eth_hdr *)net_pkt_data(pkt);
+	net_buf_add(pkt->buffer, sizeof(struct net_eth_hdr));
+	net_buf_pull(pkt->buffer, sizeof(struct net_eth_hdr));
+
+	arp_hdr = NET_ARP_HDR(pkt);
+	net_buf_add(pkt->buffer, sizeof(struct net_arp_hdr));
+
+	arp_hdr->hwtype = htons(NET_ARP_HTYPE_ETH);
+	arp_hdr->protocol = htons(NET_ETH_PTYPE_IP);
+	arp_hdr->hwlen = sizeof(struct net_eth_addr);
+	arp_hdr->protolen = sizeof(struct in_addr);
+	arp_hdr->opcode = htons(NET_ARP_REPLY);
+	memcpy(&arp_hdr->src_hwaddr, &hwaddr, sizeof(struct net_eth_addr));
+	memcpy(&arp_hdr->dst_hwaddr, net_if_get_link_addr(iface)->addr,
+	       sizeof(struct net_eth_addr));
+	net_ipaddr_copy(&arp_hdr->src_ipaddr, dst);
+	net_ipaddr_copy(&arp_hdr->dst_ipaddr, src);
+
+	zassert_equal(net_arp_input(pkt, eth_hdr), NET_OK,
+		      "ARP reply dropped");
+
+	/* Let the TX thread send the packet waiting for the reply */
+	k_sleep(K_MSEC(10));
+}
+
+void test_arp_refresh(void)
+{
+	struct in_addr src = { { { 192, 168, 0, 1 } } };
+	struct in_addr dst = { { { 192, 168, 0, 3 } } };
+	struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+	struct net_if *iface = net_if_get_default();
+	struct net_if *addr_iface;
+	struct net_if_addr *ifaddr;
+	struct net_stats_arp stats;
+	int ret;
+
+	/* Start from an empty cache, with the address and the counters of
+	 * this test only.
+	 */
+	net_arp_init();
+	net_arp_clear_cache(NULL);
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	if (!net_if_ipv4_addr_lookup(&src, &addr_iface)) {
+		ifaddr = net_if_ipv4_addr_add(iface, &src, NET_ADDR_MANUAL, 0);
+		zassert_not_null(ifaddr, "Cannot add address");
+		ifaddr->addr_state = NET_ADDR_PREFERRED;
+	}
+
+	refresh_count = 0;
+	(void)memset(&iface->stats.arp, 0, sizeof(iface->stats.arp));
+
+	zassert_false(arp_lookup(iface, &src, &dst), "Entry found");
+	arp_reply(iface, &src, &dst);
+
+	zassert_true(arp_lookup(iface, &src, &dst), "Entry not found");
+
+	/* An entry in use is refreshed before it goes stale and is used
+	 * meanwhile.
+	 */
+	k_sleep(K_SECONDS(CONFIG_NET_ARP_REACHABLE_TIME) - K_SECONDS(1));
+	zassert_equal(refresh_count, 1, "Entry not refreshed");
+	zassert_true(arp_lookup(iface, &src, &dst), "Entry not found");
+
+	arp_reply(iface, &src, &dst);
+
+	/* An idle entry goes stale, and is refreshed when used again */
+	k_sleep(K_SECONDS(CONFIG_NET_ARP_REACHABLE_TIME));
+	zassert_equal(refresh_count, 1, "Idle entry refreshed");
+	zassert_true(arp_lookup(iface, &src, &dst), "Stale entry not used");
+
+	k_sleep(K_MSEC(10));
+	zassert_equal(refresh_count, 2, "Stale entry not refreshed");
+
+	/* Without a reply the entry is removed after the last probe */
+	k_sleep(CONFIG_NET_ARP_MAX_PROBES * K_SECONDS(2) + K_MSEC(100));
+	zassert_equal(refresh_count, 1 + CONFIG_NET_ARP_MAX_PROBES,
+		      "Wrong number of refresh requests");
+	zassert_false(arp_lookup(iface, &src, &dst), "Entry not removed");
+
+	ret = net_mgmt(NET_REQUEST_STATS_GET_ARP, iface, &stats,
+		       sizeof(stats));
+	zassert_equal(ret, 0, "Cannot get ARP stats");
+
+	/* The packet waiting for the reply is looked up again when sent */
+	zassert_equal(stats.hit, 4, "Wrong number of hits");
+	zassert_equal(stats.miss, 2, "Wrong number of misses");
+	zassert_equal(stats.queued, 2, "Wrong number of queued packets");
+	zassert_equal(stats.refresh, refresh_count,
+		      "Wrong number of refresh requests");
+
+	net_arp_clear_cache(NULL);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_arp_fn,
-		ztest_unit_test(test_arp));
+		ztest_unit_test(test_arp),
+		ztest_unit_test(test_arp_refresh));
 	ztest_run_test_suite(test_arp_fn);
 }
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
+
+#include <zephyr.h>
+
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/ethernet.h>
+
+#include <ztest.h>
+
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+#include "tcp_internal.h"
+
+#define BATCH_SIZE CONFIG_NET_ETHERNET_TX_BATCH_SIZE
+
+#define WAIT_TIME K_MSEC(100)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+struct eth_fake_context {
+	struct net_if *iface;
+	u8_t mac_address[6];
+};
+
+static struct eth_fake_context eth_fake_data = {
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	.mac_address = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 },
+};
+
+static int send_calls;
+static int batch_calls;
+static int batch_pkts;
+static int batch_max;
+
+/* How many packets of a batch the driver takes, all if negative */
+static int batch_limit = -1;
+
+/* Threads in the driver, and whether there ever were two at once */
+static int in_driver;
+static bool reentered;
+
+/* Whether a batched packet had no or several L2 headers */
+static bool bad_l2_header;
+
+/* The next send() waits for send_unblock if set */
+static bool send_block;
+static K_SEM_DEFINE(send_unblock, 0, 1);
+
+static void driver_enter(void)
+{
+	if (in_driver++) {
+		reentered = true;
+	}
+}
+
+static void eth_fake_iface_init(struct net_if *iface)
+{
+	struct device *dev = net_if_get_device(iface);
+	struct eth_fake_context *ctx = dev->driver_data;
+
+	ctx->iface = iface;
+
+	net_if_set_link_addr(iface, ctx->mac_address,
+			     sizeof(ctx->mac_address),
+			     NET_LINK_ETHERNET);
+
+	ethernet_init(iface);
+}
+
+static int eth_fake_send(struct device *dev, struct net_pkt *pkt)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(pkt);
+
+	driver_enter();
+	send_calls++;
+
+	if (send_block) {
+		send_block = false;
+		k_sem_take(&send_unblock, K_FOREVER);
+	}
+
+	in_driver--;
+
+	return 0;
+}
+
+static int eth_fake_send_batch(struct device *dev, struct net_pkt **pkts,
+			       int count)
+{
+	int i;
+
+	ARG_UNUSED(dev);
+
+	driver_enter();
+	in_driver--;
+
+	/* The L2 header is in a buffer of its own, followed by the IPv4
+	 * header.
+	 */
+	for (i = 0; i < count; i++) {
+		struct net_buf *buf = pkts[i]->buffer;
+
+		if (buf->len != sizeof(struct net_eth_hdr) ||
+		    !buf->frags || (buf->frags->data[0] & 0xf0) != 0x40) {
+			bad_l2_header = true;
+		}
+	}
+
+	batch_calls++;
+	batch_max = MAX(batch_max, count);
+
+	if (batch_limit >= 0 && count > batch_limit) {
+		count = batch_limit;
+	}
+
+	batch_pkts += count;
+
+	return count ? count : -EIO;
+}
+
+static int eth_fake_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+static const struct ethernet_api eth_fake_api_funcs = {
+	.iface_api.init = eth_fake_iface_init,
+	.send = eth_fake_send,
+	.send_batch = eth_fake_send_batch,
+};
+
+ETH_NET_DEVICE_INIT(eth_fake, "eth_fake", eth_fake_init, &eth_fake_data,
+		    NULL, CONFIG_ETH_INIT_PRIORITY, &eth_fake_api_funcs,
+		    NET_ETH_MTU);
+
+static void reset_counters(void)
+{
+	send_calls = 0;
+	batch_calls = 0;
+	batch_pkts = 0;
+	batch_max = 0;
+	batch_limit = -1;
+	reentered = false;
+	bad_l2_header = false;
+}
+
+static void send_udp_pkt(void)
+{
+	struct net_if *iface = net_if_get_default();
+	static const u8_t data[] = "batch";
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(data), AF_INET,
+					IPPROTO_UDP, K_NO_WAIT);
+	zassert_not_null(pkt, "Out of mem");
+
+	zassert_equal(net_ipv4_create(pkt, &my_addr, &peer_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_udp_create(pkt, htons(4242), htons(4242)), 0,
+		      "Cannot create UDP header");
+	zassert_equal(net_pkt_write(pkt, data, sizeof(data)), 0,
+		      "Cannot write data");
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	zassert_true(net_send_data(pkt) >= 0, "Send failed");
+}
+
+static void send_udp_pkts(int count)
+{
+	int i;
+
+	/* The test thread is cooperative, so the Tx queue thread does not
+	 * run before all the packets are queued.
+	 */
+	for (i = 0; i < count; i++) {
+		send_udp_pkt();
+	}
+
+	k_sleep(WAIT_TIME);
+}
+
+static void test_setup(void)
+{
+	zassert_not_null(net_if_ipv4_addr_add(net_if_get_default(), &my_addr,
+					      NET_ADDR_MANUAL, 0),
+			 "Cannot add IPv4 address");
+}
+
+static void check_direct(int count)
+{
+	/* Nothing is waiting in the queue, so each packet is sent right
+	 * away by the sending thread.
+	 */
+	zassert_equal(send_calls, count, "Packets not sent directly");
+	zassert_equal(batch_calls, 0, "Packets sent in batches");
+}
+
+static void test_tx_batch(void)
+{
+	reset_counters();
+	send_udp_pkts(BATCH_SIZE - 1);
+
+	if (IS_ENABLED(CONFIG_NET_TC_TX_DIRECT)) {
+		check_direct(BATCH_SIZE - 1);
+		return;
+	}
+
+	zassert_equal(send_calls, 0, "Packets sent one by one");
+	zassert_equal(batch_calls, 1, "Packets not sent in one batch");
+	zassert_equal(batch_pkts, BATCH_SIZE - 1, "Packets lost");
+}
+
+static void test_tx_batch_full(void)
+{
+	reset_counters();
+	send_udp_pkts(2 * BATCH_SIZE + 1);
+
+	if (IS_ENABLED(CONFIG_NET_TC_TX_DIRECT)) {
+		check_direct(2 * BATCH_SIZE + 1);
+		return;
+	}
+
+	zassert_equal(batch_calls, 3, "Full batches not sent");
+	zassert_equal(batch_max, BATCH_SIZE, "Batch too long");
+	zassert_equal(batch_pkts, 2 * BATCH_SIZE + 1, "Packets lost");
+}
+
+static void test_tx_batch_partial(void)
+{
+	reset_counters();
+	batch_limit = 1;
+
+	/* The packets the driver does not take are dropped */
+	send_udp_pkts(BATCH_SIZE);
+
+	if (IS_ENABLED(CONFIG_NET_TC_TX_DIRECT)) {
+		check_direct(BATCH_SIZE);
+		return;
+	}
+
+	zassert_equal(batch_calls, 1, "Packets not sent in one batch");
+	zassert_equal(batch_pkts, 1, "Wrong number of packets taken");
+
+	/* The dropped packets were freed */
+	reset_counters();
+	send_udp_pkts(CONFIG_NET_PKT_TX_COUNT);
+
+	zassert_equal(batch_pkts, CONFIG_NET_PKT_TX_COUNT, "Packets lost");
+}
+
+static struct net_pkt *create_tcp_pkt(void)
+{
+	struct net_if *iface = net_if_get_default();
+	static const u8_t data[] = "segment";
+	struct net_tcp_hdr tcp_hdr = {
+		.src_port = htons(4242),
+		.dst_port = htons(4242),
+		.offset = (sizeof(tcp_hdr) / 4) << 4,
+		.flags = NET_TCP_PSH | NET_TCP_ACK,
+	};
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(tcp_hdr) + sizeof(data),
+					AF_INET, IPPROTO_TCP, K_NO_WAIT);
+	zassert_not_null(pkt, "Out of mem");
+
+	zassert_equal(net_ipv4_create(pkt, &my_addr, &peer_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_pkt_write(pkt, &tcp_hdr, sizeof(tcp_hdr)), 0,
+		      "Cannot write TCP header");
+	zassert_equal(net_pkt_write(pkt, data, sizeof(data)), 0,
+		      "Cannot write data");
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_TCP);
+
+	/* Done by net_if_send_data() for the other packets */
+	net_pkt_lladdr_src(pkt)->addr = net_pkt_lladdr_if(pkt)->addr;
+	net_pkt_lladdr_src(pkt)->len = net_pkt_lladdr_if(pkt)->len;
+
+	return pkt;
+}
+
+static void test_tx_batch_retransmit(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct net_pkt *pkt;
+
+	reset_counters();
+
+	/* TCP keeps its segments until they are acknowledged, and the
+	 * retransmission timer may send one again while the first
+	 * transmission still waits in the batch. This test thread plays
+	 * the Tx queue thread, giving the packet to L2 as net_if_tx() does.
+	 */
+	pkt = create_tcp_pkt();
+
+	zassert_true(net_eth_tx_batch_start(iface), "Batch not started");
+
+	net_pkt_ref(pkt);
+	zassert_true(net_if_l2(iface)->send(iface, pkt) > 0, "Send failed");
+
+	net_pkt_ref(pkt);
+	zassert_true(net_if_l2(iface)->send(iface, pkt) > 0,
+		     "Retransmission failed");
+
+	net_eth_tx_batch_flush(iface);
+
+	zassert_equal(batch_calls, 1, "Packets not sent in one batch");
+	zassert_equal(batch_pkts, 1, "Queued segment sent twice");
+	zassert_false(bad_l2_header, "Wrong L2 header");
+
+	/* Both transmissions released their reference */
+	zassert_equal(atomic_get(&pkt->atomic_ref), 1, "Wrong reference count");
+	net_pkt_unref(pkt);
+}
+
+static K_THREAD_STACK_DEFINE(sender_stack, 2048);
+static struct k_thread sender_thread;
+
+static void sender(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	send_udp_pkt();
+}
+
+static void test_tx_direct_serialized(void)
+{
+	if (!IS_ENABLED(CONFIG_NET_TC_TX_DIRECT)) {
+		ztest_test_skip();
+		return;
+	}
+
+	reset_counters();
+	send_block = true;
+
+	/* The other thread sends its packet directly and stays in the
+	 * driver.
+	 */
+	k_thread_create(&sender_thread, sender_stack,
+			K_THREAD_STACK_SIZEOF(sender_stack), sender,
+			NULL, NULL, NULL, K_PRIO_COOP(7), 0, K_NO_WAIT);
+	k_sleep(K_MSEC(10));
+
+	zassert_equal(in_driver, 1, "Packet not sent directly");
+
+	/* This packet is queued, and the Tx queue thread must wait for
+	 * the direct send to finish.
+	 */
+	send_udp_pkt();
+	k_sleep(K_MSEC(10));
+
+	zassert_equal(in_driver, 1, "Driver entered while busy");
+
+	k_sem_give(&send_unblock);
+	k_sleep(WAIT_TIME);
+
+	zassert_false(reentered, "Driver entered concurrently");
+	zassert_equal(send_calls + batch_pkts, 2, "Packets lost");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ethernet_tx_batch_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_tx_batch),
+			 ztest_unit_test(test_tx_batch_full),
+			 ztest_unit_test(test_tx_batch_partial),
+			 ztest_unit_test(test_tx_batch_retransmit),
+			 ztest_unit_test(test_tx_direct_serialized)
+			 );
+
+	ztest_run_test_suite(net_ethernet_tx_batch_test);
+}
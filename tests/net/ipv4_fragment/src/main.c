@@ -0,0 +1,350 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#define MTU 576
+
+/* Fits into three fragments with the MTU above */
+#define DATA_LEN 1400
+#define FRAG_COUNT 3
+
+#define MY_PORT 4242
+#define PEER_PORT 4243
+
+#define WAIT_TIME K_SECONDS(1)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static u8_t data[DATA_LEN];
+
+/* Fragments captured from the sending side */
+static struct net_pkt *frags[FRAG_COUNT];
+static int frag_count;
+static K_SEM_DEFINE(frag_sem, 0, UINT_MAX);
+
+static K_SEM_DEFINE(recv_sem, 0, UINT_MAX);
+static bool recv_ok;
+
+static int tester_init(struct device *dev)
+{
+	return 0;
+}
+
+static void tester_iface_init(struct net_if *iface)
+{
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	static u8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int tester_send(struct device *dev, struct net_pkt *pkt)
+{
+	if (frag_count < FRAG_COUNT) {
+		frags[frag_count++] = net_pkt_ref(pkt);
+	}
+
+	k_sem_give(&frag_sem);
+
+	return 0;
+}
+
+static struct dummy_api tester_api = {
+	.iface_api.init = tester_iface_init,
+	.send = tester_send,
+};
+
+NET_DEVICE_INIT(net_ipv4_frag_test, "net_ipv4_frag_test", tester_init, NULL,
+		NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &tester_api,
+		DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), MTU);
+
+static enum net_verdict udp_cb(struct net_conn *conn,
+			       struct net_pkt *pkt,
+			       union net_ip_header *ip_hdr,
+			       union net_proto_header *proto_hdr,
+			       void *user_data)
+{
+	static u8_t buf[DATA_LEN];
+
+	recv_ok = net_pkt_remaining_data(pkt) == DATA_LEN &&
+		  !net_pkt_read(pkt, buf, DATA_LEN) &&
+		  !memcmp(buf, data, DATA_LEN);
+
+	net_pkt_unref(pkt);
+	k_sem_give(&recv_sem);
+
+	return NET_OK;
+}
+
+static void test_setup(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_port = htons(PEER_PORT),
+	};
+	int i, ret;
+
+	for (i = 0; i < DATA_LEN; i++) {
+		data[i] = i;
+	}
+
+	zassert_not_null(net_if_ipv4_addr_add(iface, &my_addr,
+					      NET_ADDR_MANUAL, 0),
+			 "Cannot add IPv4 address");
+
+	/* The captured fragments are fed back with the addresses swapped,
+	 * so they are received on the peer port.
+	 */
+	net_ipaddr_copy(&local.sin_addr, &my_addr);
+
+	ret = net_udp_register(AF_INET, NULL, (struct sockaddr *)&local,
+			       MY_PORT, PEER_PORT, udp_cb, NULL, NULL);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+}
+
+static struct net_pkt *create_udp_pkt(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(iface, DATA_LEN, AF_INET,
+					IPPROTO_UDP, WAIT_TIME);
+	zassert_not_null(pkt, "Out of mem");
+
+	zassert_equal(net_ipv4_create(pkt, &my_addr, &peer_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_udp_create(pkt, htons(MY_PORT),
+				     htons(PEER_PORT)), 0,
+		      "Cannot create UDP header");
+	zassert_equal(net_pkt_write(pkt, data, DATA_LEN), 0,
+		      "Cannot write data");
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	return pkt;
+}
+
+static void test_send_ipv4_fragment(void)
+{
+	u16_t offset = 0U;
+	u16_t id = 0U;
+	int i;
+
+	zassert_true(net_send_data(create_udp_pkt()) >= 0, "Send failed");
+
+	for (i = 0; i < FRAG_COUNT; i++) {
+		zassert_equal(k_sem_take(&frag_sem, WAIT_TIME), 0,
+			      "Fragment %d not sent", i);
+	}
+
+	zassert_not_equal(k_sem_take(&frag_sem, K_MSEC(100)), 0,
+			  "Too many fragments sent");
+
+	for (i = 0; i < FRAG_COUNT; i++) {
+		struct net_ipv4_hdr *hdr = NET_IPV4_HDR(frags[i]);
+		u16_t flag = sys_get_be16(hdr->offset);
+		struct in_addr tmp;
+
+		zassert_true(net_pkt_get_len(frags[i]) <= MTU,
+			     "Fragment %d too long", i);
+		zassert_equal(ntohs(hdr->len), net_pkt_get_len(frags[i]),
+			      "Invalid length in fragment %d", i);
+		zassert_equal(net_calc_chksum_ipv4(frags[i]), 0,
+			      "Invalid checksum in fragment %d", i);
+		zassert_equal((flag & NET_IPV4_FRAGH_OFFSET_MASK) * 8U,
+			      offset, "Invalid offset in fragment %d", i);
+		zassert_equal(!!(flag & NET_IPV4_MF), i < FRAG_COUNT - 1,
+			      "Invalid MF flag in fragment %d", i);
+
+		if (i == 0) {
+			id = sys_get_be16(hdr->id);
+		} else {
+			zassert_equal(sys_get_be16(hdr->id), id,
+				      "Invalid id in fragment %d", i);
+		}
+
+		offset += net_pkt_get_len(frags[i]) - NET_IPV4H_LEN;
+
+		/* Make the fragment look like it came from the peer. This
+		 * does not change the checksums.
+		 */
+		net_ipaddr_copy(&tmp, &hdr->src);
+		net_ipaddr_copy(&hdr->src, &hdr->dst);
+		net_ipaddr_copy(&hdr->dst, &tmp);
+	}
+
+	zassert_equal(offset, NET_UDPH_LEN + DATA_LEN, "Invalid total length");
+}
+
+static void recv_fragment_id(int i, s16_t offset_change, u16_t id_change)
+{
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_clone(frags[i], WAIT_TIME);
+	zassert_not_null(pkt, "Cannot clone fragment %d", i);
+
+	if (offset_change || id_change) {
+		struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+
+		sys_put_be16(sys_get_be16(hdr->offset) + offset_change,
+			     hdr->offset);
+		sys_put_be16(sys_get_be16(hdr->id) + id_change, hdr->id);
+		hdr->chksum = 0U;
+		hdr->chksum = net_calc_chksum_ipv4(pkt);
+	}
+
+	zassert_true(net_recv_data(net_if_get_default(), pkt) >= 0,
+		     "Cannot receive fragment %d", i);
+}
+
+static void recv_fragment(int i, s16_t offset_change)
+{
+	recv_fragment_id(i, offset_change, 0U);
+}
+
+static void check_received(bool expected)
+{
+	if (!expected) {
+		zassert_not_equal(k_sem_take(&recv_sem, K_MSEC(100)), 0,
+				  "Packet should not be received");
+		return;
+	}
+
+	zassert_equal(k_sem_take(&recv_sem, WAIT_TIME), 0,
+		      "Packet not received");
+	zassert_true(recv_ok, "Invalid data received");
+}
+
+static void test_recv_ipv4_fragment(void)
+{
+	recv_fragment(0, 0);
+	recv_fragment(1, 0);
+	check_received(false);
+
+	recv_fragment(2, 0);
+	check_received(true);
+}
+
+static void test_recv_ipv4_fragment_out_of_order(void)
+{
+	recv_fragment(2, 0);
+	recv_fragment(0, 0);
+
+	/* Duplicates are dropped without disturbing the reassembly */
+	recv_fragment(0, 0);
+	recv_fragment(2, 0);
+	check_received(false);
+
+	recv_fragment(1, 0);
+	check_received(true);
+	check_received(false);
+}
+
+static void test_recv_ipv4_fragment_overlap(void)
+{
+	/* The 2nd fragment is moved back by 8 bytes so that it overlaps
+	 * with the 1st one, which discards the whole packet.
+	 */
+	recv_fragment(0, 0);
+	recv_fragment(1, -1);
+	recv_fragment(1, 0);
+	recv_fragment(2, 0);
+	check_received(false);
+}
+
+static void test_recv_ipv4_fragment_timeout(void)
+{
+	/* The fragments received after the overlap above stay pending
+	 * until the reassembly times out.
+	 */
+	k_sleep(K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT) + K_MSEC(100));
+
+	recv_fragment(0, 0);
+	check_received(false);
+
+	recv_fragment(1, 0);
+	recv_fragment(2, 0);
+	check_received(true);
+}
+
+static void test_recv_ipv4_fragment_mem_limit(void)
+{
+	/* Two partial packets do not fit in the memory limit, so the older
+	 * one is discarded when the second one grows.
+	 */
+	recv_fragment_id(0, 0, 1U);
+	recv_fragment_id(1, 0, 1U);
+	recv_fragment_id(0, 0, 2U);
+	recv_fragment_id(1, 0, 2U);
+
+	recv_fragment_id(2, 0, 1U);
+	check_received(false);
+
+	recv_fragment_id(2, 0, 2U);
+	check_received(true);
+
+	/* Let the restarted reassembly of the first packet time out */
+	k_sleep(K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT) + K_MSEC(100));
+}
+
+static void test_send_ipv4_dont_fragment(void)
+{
+	struct net_pkt *pkt = create_udp_pkt();
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+
+	sys_put_be16(NET_IPV4_DF, hdr->offset);
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	zassert_true(net_send_data(pkt) < 0, "Packet with DF should fail");
+	zassert_not_equal(k_sem_take(&frag_sem, K_MSEC(100)), 0,
+			  "Packet with DF should not be sent");
+
+	net_pkt_unref(pkt);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment_out_of_order),
+			 ztest_unit_test(test_recv_ipv4_fragment_overlap),
+			 ztest_unit_test(test_recv_ipv4_fragment_timeout),
+			 ztest_unit_test(test_recv_ipv4_fragment_mem_limit),
+			 ztest_unit_test(test_send_ipv4_dont_fragment)
+			 );
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
@@ -1930,11 +1930,201 @@ static void test_send_ipv6_fragment_without_hbho(void)
 	}
 }
 
+#define RECV_PAYLOAD_LEN 1500
+#define RECV_PORT_SRC 7777
+#define RECV_PORT_DST 8888
+
+/* The original packet, from which the received fragments are cut */
+static u8_t recv_pkt[NET_IPV6H_LEN + NET_UDPH_LEN + RECV_PAYLOAD_LEN];
+static u8_t recv_buf[sizeof(recv_pkt)];
+static struct k_sem recv_data;
+
+static enum net_verdict udp_reassembled(struct net_conn *conn,
+					struct net_pkt *pkt,
+					union net_ip_header *ip_hdr,
+					union net_proto_header *proto_hdr,
+					void *user_data)
+{
+	size_t len = net_pkt_get_len(pkt);
+
+	net_pkt_cursor_init(pkt);
+
+	if (len == sizeof(recv_pkt) && !net_pkt_read(pkt, recv_buf, len) &&
+	    !memcmp(recv_buf, recv_pkt, len)) {
+		k_sem_give(&recv_data);
+	} else {
+		DBG("Invalid reassembled pkt %p len %zd\n", pkt, len);
+	}
+
+	net_pkt_unref(pkt);
+
+	return NET_OK;
+}
+
+static void recv_frag(u32_t id, u16_t offset, u16_t len, bool more)
+{
+	struct net_ipv6_frag_hdr frag_hdr = {
+		.nexthdr = IPPROTO_UDP,
+		.offset = htons(offset | more),
+		.id = htonl(id),
+	};
+	struct net_ipv6_hdr hdr;
+	struct net_pkt *pkt;
+
+	memcpy(&hdr, recv_pkt, sizeof(hdr));
+	hdr.nexthdr = NET_IPV6_NEXTHDR_FRAG;
+	hdr.len = htons(sizeof(frag_hdr) + len);
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface1, sizeof(hdr) +
+					   sizeof(frag_hdr) + len,
+					   AF_INET6, 0, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	zassert_equal(net_pkt_write(pkt, &hdr, sizeof(hdr)), 0,
+		      "IPv6 header append failed");
+	zassert_equal(net_pkt_write(pkt, &frag_hdr, sizeof(frag_hdr)), 0,
+		      "Fragment header append failed");
+	zassert_equal(net_pkt_write(pkt, recv_pkt + sizeof(hdr) + offset,
+				    len), 0, "Payload append failed");
+
+	zassert_true(net_recv_data(iface1, pkt) >= 0, "Cannot receive");
+}
+
+static void reassembly_cb(struct net_ipv6_reassembly *reass,
+			  void *user_data)
+{
+	u32_t *mem = user_data;
+
+	mem[0]++;
+	mem[1] += reass->common.mem;
+}
+
+static u32_t reassembly_count(u32_t *mem)
+{
+	u32_t data[2] = { 0 };
+
+	/* Let the Rx thread handle the fragments first */
+	k_sleep(K_MSEC(50));
+
+	net_ipv6_frag_foreach(reassembly_cb, data);
+
+	if (mem) {
+		*mem = data[1];
+	}
+
+	return data[0];
+}
+
+static void test_recv_ipv6_fragment_setup(void)
+{
+	struct sockaddr remote_addr = { 0 };
+	struct sockaddr local_addr = { 0 };
+	struct net_conn_handle *handle;
+	struct net_pkt *pkt;
+	int i, ret;
+
+	test_started = false;
+
+	k_sem_init(&recv_data, 0, UINT_MAX);
+
+	/* The packet is larger than the IPv6 MTU */
+	pkt = net_pkt_alloc_with_buffer(iface1, sizeof(recv_pkt), AF_UNSPEC,
+					0, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	net_pkt_set_family(pkt, AF_INET6);
+
+	zassert_equal(net_ipv6_create(pkt, &my_addr2, &my_addr1), 0,
+		      "Cannot create IPv6 header");
+	zassert_equal(net_udp_create(pkt, htons(RECV_PORT_SRC),
+				     htons(RECV_PORT_DST)), 0,
+		      "Cannot create UDP header");
+
+	for (i = 0; i < RECV_PAYLOAD_LEN; i++) {
+		zassert_equal(net_pkt_write_u8(pkt, i), 0, "Cannot write data");
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_ipv6_finalize(pkt, IPPROTO_UDP);
+
+	net_pkt_cursor_init(pkt);
+	zassert_equal(net_pkt_read(pkt, recv_pkt, sizeof(recv_pkt)), 0,
+		      "Cannot read packet");
+
+	net_pkt_unref(pkt);
+
+	net_ipaddr_copy(&net_sin6(&local_addr)->sin6_addr, &my_addr1);
+	local_addr.sa_family = AF_INET6;
+
+	net_ipaddr_copy(&net_sin6(&remote_addr)->sin6_addr, &my_addr2);
+	remote_addr.sa_family = AF_INET6;
+
+	ret = net_udp_register(AF_INET6, &remote_addr, &local_addr,
+			       RECV_PORT_SRC, RECV_PORT_DST, udp_reassembled,
+			       NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+}
+
 static void test_recv_ipv6_fragment(void)
 {
-	/* TODO: Verify that we can receive individual fragments and
-	 * then reassemble them back.
-	 */
+	/* The fragments arrive out of order */
+	recv_frag(1, 1024, 484, false);
+	recv_frag(1, 0, 512, true);
+	recv_frag(1, 512, 512, true);
+
+	zassert_equal(k_sem_take(&recv_data, WAIT_TIME), 0,
+		      "Packet not reassembled");
+	zassert_equal(reassembly_count(NULL), 0, "Reassembly pending");
+}
+
+static void test_recv_ipv6_fragment_overlap(void)
+{
+	recv_frag(2, 0, 512, true);
+	recv_frag(2, 256, 512, true);
+
+	/* The overlap discards the whole reassembly */
+	zassert_equal(reassembly_count(NULL), 0, "Reassembly pending");
+
+	recv_frag(2, 512, 512, true);
+	recv_frag(2, 1024, 484, false);
+
+	zassert_not_equal(k_sem_take(&recv_data, K_MSEC(100)), 0,
+			  "Packet reassembled with missing data");
+
+	/* So does data after the last fragment */
+	recv_frag(2, 512, 512, true);
+	recv_frag(2, 0, 512, false);
+
+	zassert_equal(reassembly_count(NULL), 0, "Reassembly pending");
+}
+
+static void test_recv_ipv6_fragment_mem_limit(void)
+{
+	u32_t mem;
+	u32_t id;
+
+	/* A flood of first fragments that are never completed */
+	for (id = 100; id < 100 + CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT; id++) {
+		recv_frag(id, 0, 512, true);
+	}
+
+	zassert_true(reassembly_count(&mem) < CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT,
+		     "Old reassemblies not discarded");
+	zassert_true(mem <= CONFIG_NET_IPV6_FRAGMENT_MAX_MEM,
+		     "Memory limit exceeded");
+
+	/* The pending ones do not prevent a new packet from being received */
+	recv_frag(3, 0, 512, true);
+	recv_frag(3, 512, 512, true);
+	recv_frag(3, 1024, 484, false);
+
+	zassert_equal(k_sem_take(&recv_data, WAIT_TIME), 0,
+		      "Packet not reassembled");
+
+	k_sleep(K_SECONDS(CONFIG_NET_IPV6_FRAGMENT_TIMEOUT + 1));
+
+	zassert_equal(reassembly_count(&mem), 0, "Reassembly not timed out");
+	zassert_equal(mem, 0, "Memory not released");
 }
 
 void test_main(void)
@@ -1953,7 +2143,10 @@ void test_main(void)
 			 ztest_unit_test(test_send_ipv6_fragment),
 			 ztest_unit_test(test_send_ipv6_fragment_large_hbho),
 			 ztest_unit_test(test_send_ipv6_fragment_without_hbho),
-			 ztest_unit_test(test_recv_ipv6_fragment)
+			 ztest_unit_test(test_recv_ipv6_fragment_setup),
+			 ztest_unit_test(test_recv_ipv6_fragment),
+			 ztest_unit_test(test_recv_ipv6_fragment_overlap),
+			 ztest_unit_test(test_recv_ipv6_fragment_mem_limit)
 			 );
 
 	ztest_run_test_suite(net_ipv6_fragment_test);
@@ -1456,6 +1456,504 @@ done:
 	return result;
 }
 
+static struct coap_resource *dispatched;
+
+static int index_method(struct coap_resource *resource,
+			struct coap_packet *request,
+			struct sockaddr *addr, socklen_t addr_len)
+{
+	dispatched = resource;
+
+	return 0;
+}
+
+static const char * const index_a_b_path[] = { "a", "b", NULL };
+static const char * const index_a_c_path[] = { "a", "c", NULL };
+static const char * const index_a_path[] = { "a", NULL };
+static const char * const index_x_path[] = { "x", NULL };
+static struct coap_resource index_resources[] = {
+	{ .path = index_a_b_path, .get = index_method, },
+	{ .path = index_a_c_path, .get = index_method, },
+	{ .path = index_a_path, .get = index_method, .put = index_method, },
+	{ .path = index_x_path, .get = index_method, },
+	/* Shadowed by the first resource */
+	{ .path = index_a_b_path, .get = index_method, },
+	{ },
+};
+
+static int index_request(const char *uri, u8_t method,
+			 const struct coap_resource_index *index,
+			 struct coap_resource **linear)
+{
+	struct coap_option options[4];
+	struct coap_packet req;
+	u8_t data[COAP_BUF_SIZE];
+	const char *end;
+	int r;
+
+	r = coap_packet_init(&req, data, sizeof(data), 1, COAP_TYPE_CON,
+			     0, NULL, method, coap_next_id());
+	if (r < 0) {
+		return r;
+	}
+
+	/* An Observe option precedes the Uri-Path ones in options[] */
+	r = coap_append_option_int(&req, COAP_OPTION_OBSERVE, 0);
+	if (r < 0) {
+		return r;
+	}
+
+	while (*uri) {
+		end = strchr(uri, '/');
+		if (!end) {
+			end = uri + strlen(uri);
+		}
+
+		r = coap_packet_append_option(&req, COAP_OPTION_URI_PATH,
+					      uri, end - uri);
+		if (r < 0) {
+			return r;
+		}
+
+		uri = *end ? end + 1 : end;
+	}
+
+	r = coap_packet_parse(&req, data, req.offset, options,
+			      ARRAY_SIZE(options));
+	if (r < 0) {
+		return r;
+	}
+
+	dispatched = NULL;
+	r = coap_handle_request(&req, index_resources, options,
+				ARRAY_SIZE(options),
+				(struct sockaddr *) &dummy_addr,
+				sizeof(dummy_addr));
+	*linear = r == 0 ? dispatched : NULL;
+
+	dispatched = NULL;
+	return coap_handle_request_index(&req, index, options,
+					 ARRAY_SIZE(options),
+					 (struct sockaddr *) &dummy_addr,
+					 sizeof(dummy_addr));
+}
+
+static int test_resource_index(void)
+{
+	static const struct {
+		const char *uri;
+		u8_t method;
+		int result;
+		int resource;
+	} requests[] = {
+		{ "a/b", COAP_METHOD_GET, 0, 0 },
+		{ "a/c", COAP_METHOD_GET, 0, 1 },
+		{ "a", COAP_METHOD_GET, 0, 2 },
+		{ "a", COAP_METHOD_PUT, 0, 2 },
+		{ "x", COAP_METHOD_GET, 0, 3 },
+		{ "a/b", COAP_METHOD_POST, -EPERM, -1 },
+		{ "a/b/c", COAP_METHOD_GET, -ENOENT, -1 },
+		{ "a/bb", COAP_METHOD_GET, -ENOENT, -1 },
+		{ "b", COAP_METHOD_GET, -ENOENT, -1 },
+		{ "", COAP_METHOD_GET, -ENOENT, -1 },
+	};
+	struct coap_resource_index index;
+	struct coap_resource_node nodes[5];
+	struct coap_resource *linear;
+	struct coap_resource *expected;
+	int result = TC_FAIL;
+	int r;
+	u8_t i;
+
+	/* root, "a", "a/b", "a/c" and "x" */
+	r = coap_resource_index_init(&index, index_resources, nodes, 4);
+	if (r != -ENOMEM) {
+		TC_PRINT("Index should not fit in 4 nodes (%d)\n", r);
+		goto done;
+	}
+
+	r = coap_resource_index_init(&index, index_resources, nodes,
+				     ARRAY_SIZE(nodes));
+	if (r < 0) {
+		TC_PRINT("Could not build the index (%d)\n", r);
+		goto done;
+	}
+
+	for (i = 0U; i < ARRAY_SIZE(requests); i++) {
+		expected = requests[i].resource < 0 ? NULL :
+			&index_resources[requests[i].resource];
+
+		r = index_request(requests[i].uri, requests[i].method, &index,
+				  &linear);
+		if (r != requests[i].result || dispatched != expected) {
+			TC_PRINT("Wrong dispatch of \"%s\" (%d)\n",
+				 requests[i].uri, r);
+			goto done;
+		}
+
+		if (linear != expected) {
+			TC_PRINT("Index and resource array disagree on \"%s\"\n",
+				 requests[i].uri);
+			goto done;
+		}
+	}
+
+	result = TC_PASS;
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+#define STREAM_BODY_SIZE 200
+
+static u8_t stream_body[STREAM_BODY_SIZE];
+static u8_t stream_sink[STREAM_BODY_SIZE];
+static size_t stream_written;
+static int stream_writes;
+static bool stream_last;
+
+static void stream_body_init(void)
+{
+	int i;
+
+	for (i = 0; i < sizeof(stream_body); i++) {
+		stream_body[i] = i * 7 + 1;
+	}
+}
+
+static int stream_read(size_t offset, u8_t *buf, size_t len,
+		       void *user_data)
+{
+	size_t size = *(size_t *)user_data;
+
+	if (offset > size) {
+		return -EINVAL;
+	}
+
+	len = MIN(len, size - offset);
+	memcpy(buf, stream_body + offset, len);
+
+	return len;
+}
+
+static int stream_write(size_t offset, const u8_t *buf, size_t len,
+			bool last, void *user_data)
+{
+	if (offset + len > sizeof(stream_sink) || stream_last) {
+		return -EINVAL;
+	}
+
+	memcpy(stream_sink + offset, buf, len);
+	stream_written = offset + len;
+	stream_writes++;
+	stream_last = last;
+
+	return 0;
+}
+
+/* Gets the blocks of a body of the given size, as a client would */
+static int block2_stream(size_t size, size_t total_size,
+			 enum coap_block_size block_size, int *blocks)
+{
+	struct coap_block_context ctx;
+	struct coap_option option;
+	struct coap_packet req;
+	struct coap_packet rsp;
+	u8_t req_data[COAP_BUF_SIZE];
+	u8_t rsp_data[COAP_BUF_SIZE];
+	const u8_t *payload;
+	size_t offset = 0;
+	u16_t bytes = coap_block_size_to_bytes(block_size);
+	u16_t len;
+	int block;
+	int more;
+	int r;
+
+	coap_block_transfer_init(&ctx, COAP_BLOCK_64, total_size);
+	*blocks = 0;
+
+	do {
+		r = coap_packet_init(&req, req_data, sizeof(req_data), 1,
+				     COAP_TYPE_CON, 0, NULL, COAP_METHOD_GET,
+				     coap_next_id());
+		if (r < 0) {
+			return r;
+		}
+
+		/* The first request does not ask for a block */
+		if (offset) {
+			r = coap_append_option_int(&req, COAP_OPTION_BLOCK2,
+						   (offset / bytes) << 4 |
+						   block_size);
+			if (r < 0) {
+				return r;
+			}
+		}
+
+		r = coap_packet_parse(&req, req_data, req.offset, NULL, 0);
+		if (r < 0) {
+			return r;
+		}
+
+		r = coap_packet_init(&rsp, rsp_data, sizeof(rsp_data), 1,
+				     COAP_TYPE_ACK, 0, NULL,
+				     COAP_RESPONSE_CODE_CONTENT,
+				     coap_header_get_id(&req));
+		if (r < 0) {
+			return r;
+		}
+
+		more = coap_block2_response(&rsp, &req, &ctx, stream_read,
+					    &size);
+		if (more < 0) {
+			return more;
+		}
+
+		r = coap_packet_parse(&rsp, rsp_data, rsp.offset, NULL, 0);
+		if (r < 0) {
+			return r;
+		}
+
+		r = coap_find_options(&rsp, COAP_OPTION_BLOCK2, &option, 1);
+		if (r != 1) {
+			return -ENOENT;
+		}
+
+		block = coap_option_value_to_int(&option);
+		if (!!(block & 0x08) != more) {
+			TC_PRINT("More flag does not match (%d)\n", more);
+			return -EINVAL;
+		}
+
+		if ((block >> 4) << ((block & 0x07) + 4) != offset) {
+			TC_PRINT("Wrong block number %d\n", block >> 4);
+			return -EINVAL;
+		}
+
+		if (!offset && *blocks == 0 && (block & 0x07) != COAP_BLOCK_64) {
+			TC_PRINT("Wrong block size %d\n", block & 0x07);
+			return -EINVAL;
+		}
+
+		r = coap_find_options(&rsp, COAP_OPTION_SIZE2, &option, 1);
+		if (r != (!offset && total_size ? 1 : 0)) {
+			TC_PRINT("Size2 option expected on the first block\n");
+			return -EINVAL;
+		}
+
+		payload = coap_packet_get_payload(&rsp, &len);
+		if (len && memcmp(payload, stream_body + offset, len)) {
+			TC_PRINT("Wrong payload at %zu\n", offset);
+			return -EINVAL;
+		}
+
+		offset += len;
+		(*blocks)++;
+	} while (more);
+
+	return offset == size ? 0 : -EINVAL;
+}
+
+static int test_block2_stream(void)
+{
+	int result = TC_FAIL;
+	int blocks;
+	int r;
+
+	stream_body_init();
+
+	/* Known size: 64, 64, 64 and 8 bytes */
+	r = block2_stream(STREAM_BODY_SIZE, STREAM_BODY_SIZE, COAP_BLOCK_64,
+			  &blocks);
+	if (r < 0 || blocks != 4) {
+		TC_PRINT("Known size transfer failed (%d, %d)\n", r, blocks);
+		goto done;
+	}
+
+	/* Smaller blocks asked for by the client: 64, 4 * 32 and 8 bytes */
+	r = block2_stream(STREAM_BODY_SIZE, STREAM_BODY_SIZE, COAP_BLOCK_32,
+			  &blocks);
+	if (r < 0 || blocks != 6) {
+		TC_PRINT("Smaller blocks transfer failed (%d, %d)\n", r,
+			 blocks);
+		goto done;
+	}
+
+	/* Unknown size, the last block tells where the body ends */
+	r = block2_stream(STREAM_BODY_SIZE, 0, COAP_BLOCK_64, &blocks);
+	if (r < 0 || blocks != 4) {
+		TC_PRINT("Unknown size transfer failed (%d, %d)\n", r, blocks);
+		goto done;
+	}
+
+	/* Unknown size multiple of the block size, ends with no payload */
+	r = block2_stream(128, 0, COAP_BLOCK_64, &blocks);
+	if (r < 0 || blocks != 3) {
+		TC_PRINT("Empty last block transfer failed (%d, %d)\n", r,
+			 blocks);
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+/* Sends the block at req_ctx->current, as a client would */
+static int block1_send(struct coap_block_context *req_ctx,
+		       struct coap_block_context *rsp_ctx)
+{
+	struct coap_option option;
+	struct coap_packet req;
+	struct coap_packet rsp;
+	u8_t req_data[COAP_BUF_SIZE];
+	u8_t rsp_data[COAP_BUF_SIZE];
+	u16_t bytes = coap_block_size_to_bytes(req_ctx->block_size);
+	size_t len;
+	int more;
+	int r;
+
+	r = coap_packet_init(&req, req_data, sizeof(req_data), 1,
+			     COAP_TYPE_CON, 0, NULL, COAP_METHOD_PUT,
+			     coap_next_id());
+	if (r < 0) {
+		return r;
+	}
+
+	r = coap_append_block1_option(&req, req_ctx);
+	if (r < 0) {
+		return r;
+	}
+
+	if (!req_ctx->current) {
+		r = coap_append_size1_option(&req, req_ctx);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	r = coap_packet_append_payload_marker(&req);
+	if (r < 0) {
+		return r;
+	}
+
+	len = MIN(bytes, req_ctx->total_size - req_ctx->current);
+	r = coap_packet_append_payload(&req, stream_body + req_ctx->current,
+				       len);
+	if (r < 0) {
+		return r;
+	}
+
+	r = coap_packet_parse(&req, req_data, req.offset, NULL, 0);
+	if (r < 0) {
+		return r;
+	}
+
+	more = coap_block1_receive(&req, rsp_ctx, stream_write, NULL);
+	if (more < 0) {
+		return more;
+	}
+
+	/* The response acknowledges the block received */
+	r = coap_packet_init(&rsp, rsp_data, sizeof(rsp_data), 1,
+			     COAP_TYPE_ACK, 0, NULL,
+			     more ? COAP_RESPONSE_CODE_CONTINUE :
+			     COAP_RESPONSE_CODE_CHANGED,
+			     coap_header_get_id(&req));
+	if (r < 0) {
+		return r;
+	}
+
+	r = coap_append_block1_option(&rsp, rsp_ctx);
+	if (r < 0) {
+		return r;
+	}
+
+	r = coap_packet_parse(&rsp, rsp_data, rsp.offset, NULL, 0);
+	if (r < 0) {
+		return r;
+	}
+
+	r = coap_find_options(&rsp, COAP_OPTION_BLOCK1, &option, 1);
+	if (r != 1 ||
+	    coap_option_value_to_int(&option) >> 4 !=
+	    req_ctx->current / bytes) {
+		TC_PRINT("Wrong acknowledgment of block %zu\n",
+			 req_ctx->current / bytes);
+		return -EINVAL;
+	}
+
+	return more;
+}
+
+static int test_block1_stream(void)
+{
+	struct coap_block_context req_ctx;
+	struct coap_block_context rsp_ctx;
+	int result = TC_FAIL;
+	int more;
+	int r;
+
+	stream_body_init();
+	memset(stream_sink, 0, sizeof(stream_sink));
+	stream_written = 0;
+	stream_writes = 0;
+	stream_last = false;
+
+	coap_block_transfer_init(&req_ctx, COAP_BLOCK_32, STREAM_BODY_SIZE);
+	coap_block_transfer_init(&rsp_ctx, COAP_BLOCK_64, 0);
+
+	do {
+		more = block1_send(&req_ctx, &rsp_ctx);
+		if (more < 0) {
+			TC_PRINT("Block at %zu not received (%d)\n",
+				 req_ctx.current, more);
+			goto done;
+		}
+
+		if (req_ctx.current == 64) {
+			/* A retransmission is not written twice */
+			r = block1_send(&req_ctx, &rsp_ctx);
+			if (r != 1 || stream_writes != 3) {
+				TC_PRINT("Retransmission written (%d)\n", r);
+				goto done;
+			}
+
+			/* A block cannot be skipped */
+			req_ctx.current += 64;
+			r = block1_send(&req_ctx, &rsp_ctx);
+			if (r != -EINVAL) {
+				TC_PRINT("Out of order block accepted\n");
+				goto done;
+			}
+
+			req_ctx.current -= 64;
+		}
+
+		req_ctx.current += coap_block_size_to_bytes(req_ctx.block_size);
+	} while (more);
+
+	if (!stream_last || stream_writes != 7 ||
+	    stream_written != STREAM_BODY_SIZE ||
+	    rsp_ctx.total_size != STREAM_BODY_SIZE ||
+	    memcmp(stream_sink, stream_body, STREAM_BODY_SIZE)) {
+		TC_PRINT("Body not reassembled (%d writes)\n", stream_writes);
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
 static const struct {
 	const char *name;
 	int (*func)(void);
@@ -1478,6 +1976,9 @@ static const struct {
 	{ "Test retransmission", test_retransmit_second_round, },
 	{ "Test observer server", test_observer_server, },
 	{ "Test observer client", test_observer_client, },
+	{ "Test resource index", test_resource_index, },
+	{ "Test block2 streaming", test_block2_stream, },
+	{ "Test block1 streaming", test_block1_stream, },
 };
 
 int main(int argc, char *argv[])
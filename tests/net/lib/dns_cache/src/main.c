@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <string.h>
+#include <misc/byteorder.h>
+#include <net/socket.h>
+#include <net/dns_resolve.h>
+
+#include <ztest.h>
+
+/* The test thread plays the DNS server, over a loopback UDP socket */
+
+#define SERVER_PORT 5353
+
+#define NAME "broker.example"
+#define MISSING_NAME "missing.example"
+
+#define TTL 1
+#define EXPIRED K_MSEC(TTL * 1000 + 100)
+
+#define DNS_TIMEOUT K_MSEC(300)
+#define WAIT_TIME K_MSEC(500)
+
+/* Answer with a compressed name, type A, class IN, the TTL, and the
+ * length of the address.
+ */
+static const u8_t answer_hdr[] = {
+	0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01, 0, 0, 0, TTL, 0x00, 0x04
+};
+
+static struct dns_resolve_context ctx;
+static struct sockaddr_in server;
+static int s_sock;
+
+static struct k_sem result_sem;
+static int result_status;
+static int result_count;
+static struct in_addr result_addr;
+
+static void dns_result_cb(enum dns_resolve_status status,
+			  struct dns_addrinfo *info,
+			  void *user_data)
+{
+	if (info) {
+		zassert_equal(status, DNS_EAI_INPROGRESS, "Wrong status");
+		zassert_equal(info->ai_family, AF_INET, "Wrong family");
+
+		result_addr = net_sin(&info->ai_addr)->sin_addr;
+		result_count++;
+		return;
+	}
+
+	result_status = status;
+	k_sem_give(&result_sem);
+}
+
+static void result_reset(void)
+{
+	result_status = 0;
+	result_count = 0;
+	result_addr.s_addr = 0U;
+}
+
+static void check_stats(u32_t hits, u32_t negative_hits, u32_t stale_hits,
+			u32_t misses, u32_t evictions)
+{
+	struct dns_resolve_cache_stats stats;
+
+	dns_resolve_cache_stats_get(&stats);
+
+	zassert_equal(stats.hits, hits, "Wrong hits");
+	zassert_equal(stats.negative_hits, negative_hits,
+		      "Wrong negative hits");
+	zassert_equal(stats.stale_hits, stale_hits, "Wrong stale hits");
+	zassert_equal(stats.misses, misses, "Wrong misses");
+	zassert_equal(stats.evictions, evictions, "Wrong evictions");
+}
+
+/* Receive the query, and answer it with one address unless the name is
+ * not to be found.
+ */
+static void server_answer(u8_t rcode, u8_t addr_byte)
+{
+	struct sockaddr_in client;
+	socklen_t addrlen = sizeof(client);
+	u8_t data[128];
+	ssize_t len;
+
+	len = recvfrom(s_sock, data, sizeof(data) - sizeof(answer_hdr) - 4, 0,
+		       (struct sockaddr *)&client, &addrlen);
+	zassert_true(len > 12, "recvfrom failed");
+
+	data[2] |= 0x80;
+	data[3] = rcode;
+
+	if (rcode == 0U) {
+		sys_put_be16(1, &data[6]);
+
+		memcpy(&data[len], answer_hdr, sizeof(answer_hdr));
+		len += sizeof(answer_hdr);
+
+		data[len++] = 192;
+		data[len++] = 0;
+		data[len++] = 2;
+		data[len++] = addr_byte;
+	}
+
+	zassert_equal(sendto(s_sock, data, len, 0,
+			     (struct sockaddr *)&client, addrlen), len,
+		      "sendto failed");
+}
+
+static void server_drop(void)
+{
+	u8_t data[64];
+
+	zassert_true(recv(s_sock, data, sizeof(data), 0) > 0, "recv failed");
+}
+
+static void check_no_query(void)
+{
+	u8_t data[64];
+
+	k_sleep(K_MSEC(50));
+
+	zassert_equal(recv(s_sock, data, sizeof(data), MSG_DONTWAIT), -1,
+		      "Query sent");
+	zassert_equal(errno, EAGAIN, "recv failed");
+}
+
+static void resolve(const char *name)
+{
+	result_reset();
+
+	zassert_equal(dns_resolve_name(&ctx, name, DNS_QUERY_TYPE_A, NULL,
+				       dns_result_cb, NULL, DNS_TIMEOUT), 0,
+		      "Cannot resolve");
+}
+
+static void check_result(int status, u8_t addr_byte)
+{
+	zassert_equal(k_sem_take(&result_sem, WAIT_TIME), 0,
+		      "No result");
+	zassert_equal(result_status, status, "Wrong status");
+
+	if (status == DNS_EAI_ALLDONE) {
+		zassert_equal(result_count, 1, "Wrong number of addresses");
+		zassert_equal(result_addr.s4_addr[3], addr_byte,
+			      "Wrong address");
+	} else {
+		zassert_equal(result_count, 0, "Address returned");
+	}
+}
+
+/* Resolve a name that is not cached */
+static void resolve_query(const char *name, u8_t addr_byte)
+{
+	resolve(name);
+	server_answer(0, addr_byte);
+	check_result(DNS_EAI_ALLDONE, addr_byte);
+}
+
+/* Resolve a name that is cached, it is answered before returning */
+static void resolve_cached(const char *name, int status, u8_t addr_byte)
+{
+	u16_t dns_id = 1U;
+
+	result_reset();
+
+	zassert_equal(dns_resolve_name(&ctx, name, DNS_QUERY_TYPE_A, &dns_id,
+				       dns_result_cb, NULL, DNS_TIMEOUT), 0,
+		      "Cannot resolve");
+	zassert_equal(dns_id, 0U, "Query sent");
+
+	check_result(status, addr_byte);
+	check_no_query();
+}
+
+static void test_setup(void)
+{
+	const struct sockaddr *servers[] = {
+		(struct sockaddr *)&server, NULL
+	};
+
+	k_sem_init(&result_sem, 0, UINT_MAX);
+
+	server.sin_family = AF_INET;
+	server.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&server.sin_addr), 1, "inet_pton failed");
+
+	s_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(s_sock >= 0, "socket open failed");
+	zassert_equal(bind(s_sock, (struct sockaddr *)&server,
+			   sizeof(server)), 0, "bind failed");
+
+	zassert_equal(dns_resolve_init(&ctx, NULL, servers), 0,
+		      "Cannot init DNS context");
+}
+
+static void test_cache_hit(void)
+{
+	resolve_query(NAME, 10);
+	check_stats(0, 0, 0, 1, 0);
+
+	resolve_cached(NAME, DNS_EAI_ALLDONE, 10);
+	check_stats(1, 0, 0, 1, 0);
+}
+
+static void test_cache_expiry(void)
+{
+	k_sleep(EXPIRED);
+
+	/* The fresh answer replaces the expired one */
+	resolve_query(NAME, 11);
+	check_stats(1, 0, 0, 2, 0);
+
+	resolve_cached(NAME, DNS_EAI_ALLDONE, 11);
+	check_stats(2, 0, 0, 2, 0);
+}
+
+static void test_cache_negative(void)
+{
+	resolve(MISSING_NAME);
+	server_answer(3, 0);
+	check_result(DNS_EAI_NODATA, 0);
+	check_stats(2, 0, 0, 3, 0);
+
+	resolve_cached(MISSING_NAME, DNS_EAI_NODATA, 0);
+	check_stats(2, 1, 0, 3, 0);
+}
+
+static void test_cache_stale(void)
+{
+	k_sleep(EXPIRED);
+
+	/* The expired answer is served when the server does not respond */
+	resolve(NAME);
+	server_drop();
+	check_result(DNS_EAI_ALLDONE, 11);
+	check_stats(2, 1, 1, 4, 0);
+
+	/* A negative answer is not served stale */
+	resolve(MISSING_NAME);
+	server_drop();
+	check_result(DNS_EAI_CANCELED, 0);
+	check_stats(2, 1, 1, 5, 0);
+}
+
+static void test_cache_lru(void)
+{
+	char name[] = "0.example";
+	int i;
+
+	dns_resolve_cache_flush();
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES; i++) {
+		name[0] = '0' + i;
+		resolve_query(name, 20 + i);
+	}
+
+	check_stats(2, 1, 1, 5 + i, 0);
+
+	/* The first entry is now the most recently used one */
+	resolve_cached("0.example", DNS_EAI_ALLDONE, 20);
+
+	name[0] = '0' + i;
+	resolve_query(name, 20 + i);
+	check_stats(3, 1, 1, 6 + i, 1);
+
+	/* The second entry was dropped */
+	resolve_cached("0.example", DNS_EAI_ALLDONE, 20);
+	resolve_query("1.example", 21);
+	check_stats(4, 1, 1, 7 + i, 2);
+
+	/* Names are not case sensitive */
+	resolve_cached("1.EXAMPLE", DNS_EAI_ALLDONE, 21);
+}
+
+static void test_teardown(void)
+{
+	zassert_equal(dns_resolve_close(&ctx), 0, "Cannot close DNS context");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dns_cache,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_cache_hit),
+			 ztest_unit_test(test_cache_expiry),
+			 ztest_unit_test(test_cache_negative),
+			 ztest_unit_test(test_cache_stale),
+			 ztest_unit_test(test_cache_lru),
+			 ztest_unit_test(test_teardown));
+
+	ztest_run_test_suite(dns_cache);
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <string.h>
+#include <misc/byteorder.h>
+#include <net/socket.h>
+#include <net/dns_resolve.h>
+
+#include <ztest.h>
+
+/* The test thread plays the DNS servers, over loopback UDP sockets */
+
+#define SERVER_COUNT CONFIG_DNS_RESOLVER_MAX_SERVERS
+#define SERVER_PORT 5353
+
+#define NAME "broker.example"
+
+#define DNS_TIMEOUT K_MSEC(300)
+#define WAIT_TIME K_MSEC(500)
+#define SLOW_TIME K_MSEC(20)
+
+/* Answer with a compressed name, type A, class IN, a TTL of 60 seconds,
+ * and the length of the address.
+ */
+static const u8_t answer_hdr[] = {
+	0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01, 0, 0, 0, 60, 0x00, 0x04
+};
+
+static struct dns_resolve_context ctx;
+
+static struct test_server {
+	struct sockaddr_in addr;
+	struct sockaddr_in client;
+	u8_t data[128];
+	ssize_t len;
+	int sock;
+} servers[SERVER_COUNT];
+
+static struct k_sem result_sem;
+static int result_status;
+static int result_count;
+static struct in_addr result_addr;
+
+static void dns_result_cb(enum dns_resolve_status status,
+			  struct dns_addrinfo *info,
+			  void *user_data)
+{
+	if (info) {
+		result_addr = net_sin(&info->ai_addr)->sin_addr;
+		result_count++;
+		return;
+	}
+
+	result_status = status;
+	k_sem_give(&result_sem);
+}
+
+static void resolve(void)
+{
+	result_status = 0;
+	result_count = 0;
+	result_addr.s_addr = 0U;
+
+	zassert_equal(dns_resolve_name(&ctx, NAME, DNS_QUERY_TYPE_A, NULL,
+				       dns_result_cb, NULL, DNS_TIMEOUT), 0,
+		      "Cannot resolve");
+}
+
+/* Return the mask of the servers which received the query */
+static u32_t server_queries(void)
+{
+	socklen_t addrlen;
+	u32_t mask = 0U;
+	int i;
+
+	k_sleep(K_MSEC(50));
+
+	for (i = 0; i < SERVER_COUNT; i++) {
+		addrlen = sizeof(servers[i].client);
+		servers[i].len = recvfrom(servers[i].sock, servers[i].data,
+					  sizeof(servers[i].data) -
+					  sizeof(answer_hdr) - 4,
+					  MSG_DONTWAIT,
+					  (struct sockaddr *)&servers[i].client,
+					  &addrlen);
+		if (servers[i].len > 0) {
+			mask |= BIT(i);
+		}
+	}
+
+	return mask;
+}
+
+/* Answer the received query, with one address unless failing */
+static void server_answer(int idx, u8_t rcode, u8_t addr_byte)
+{
+	struct test_server *server = &servers[idx];
+	u8_t *data = server->data;
+	ssize_t len = server->len;
+
+	zassert_true(len > 12, "No query received");
+
+	data[2] |= 0x80;
+	data[3] = rcode;
+
+	if (rcode == 0U) {
+		sys_put_be16(1, &data[6]);
+
+		memcpy(&data[len], answer_hdr, sizeof(answer_hdr));
+		len += sizeof(answer_hdr);
+
+		data[len++] = 192;
+		data[len++] = 0;
+		data[len++] = 2;
+		data[len++] = addr_byte;
+	}
+
+	zassert_equal(sendto(server->sock, data, len, 0,
+			     (struct sockaddr *)&server->client,
+			     sizeof(server->client)), len, "sendto failed");
+}
+
+static void check_result(int status, u8_t addr_byte)
+{
+	zassert_equal(k_sem_take(&result_sem, WAIT_TIME), 0, "No result");
+	zassert_equal(result_status, status, "Wrong status");
+
+	if (status == DNS_EAI_ALLDONE) {
+		zassert_equal(result_count, 1, "Wrong number of addresses");
+		zassert_equal(result_addr.s4_addr[3], addr_byte,
+			      "Wrong address");
+	}
+}
+
+static void check_no_result(void)
+{
+	zassert_not_equal(k_sem_take(&result_sem, K_MSEC(50)), 0,
+			  "Unexpected result");
+}
+
+static void init_ctx(void)
+{
+	const struct sockaddr *addrs[SERVER_COUNT + 1] = { NULL };
+	int i;
+
+	for (i = 0; i < SERVER_COUNT; i++) {
+		addrs[i] = (struct sockaddr *)&servers[i].addr;
+	}
+
+	zassert_equal(dns_resolve_init(&ctx, NULL, addrs), 0,
+		      "Cannot init DNS context");
+}
+
+static void test_setup(void)
+{
+	struct test_server *server;
+	int i;
+
+	k_sem_init(&result_sem, 0, UINT_MAX);
+
+	for (i = 0; i < SERVER_COUNT; i++) {
+		server = &servers[i];
+
+		server->addr.sin_family = AF_INET;
+		server->addr.sin_port = htons(SERVER_PORT + i);
+		zassert_equal(inet_pton(AF_INET,
+					CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+					&server->addr.sin_addr), 1,
+			      "inet_pton failed");
+
+		server->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		zassert_true(server->sock >= 0, "socket open failed");
+		zassert_equal(bind(server->sock,
+				   (struct sockaddr *)&server->addr,
+				   sizeof(server->addr)), 0, "bind failed");
+	}
+
+	init_ctx();
+}
+
+static void test_fanout(void)
+{
+	/* The servers whose round trip time is not known are used first */
+	resolve();
+	zassert_equal(server_queries(), BIT(0) | BIT(1), "Wrong servers");
+
+	/* The first answer is used */
+	server_answer(1, 0, 11);
+	check_result(DNS_EAI_ALLDONE, 11);
+
+	k_sleep(SLOW_TIME);
+
+	server_answer(0, 0, 10);
+	check_no_result();
+
+	/* The late answer still gives the round trip time */
+	zassert_true(ctx.servers[0].rtt >= SLOW_TIME, "Wrong rtt");
+	zassert_true(ctx.servers[1].rtt < ctx.servers[0].rtt, "Wrong rtt");
+	zassert_equal(ctx.servers[2].rtt, 0, "Wrong rtt");
+}
+
+static void test_prefer_fastest(void)
+{
+	resolve();
+	zassert_equal(server_queries(), BIT(1) | BIT(2), "Wrong servers");
+
+	server_answer(2, 0, 12);
+	check_result(DNS_EAI_ALLDONE, 12);
+
+	server_answer(1, 0, 11);
+	check_no_result();
+}
+
+static void test_backoff(void)
+{
+	resolve();
+	zassert_equal(server_queries(), BIT(1) | BIT(2), "Wrong servers");
+
+	/* Neither server answers */
+	check_result(DNS_EAI_CANCELED, 0);
+
+	zassert_equal(ctx.servers[1].failures, 1, "Failure not counted");
+	zassert_equal(ctx.servers[2].failures, 1, "Failure not counted");
+
+	/* The slow server is now preferred over the failed ones */
+	resolve();
+	zassert_equal(server_queries(), BIT(0) | BIT(1), "Wrong servers");
+
+	server_answer(0, 0, 10);
+	check_result(DNS_EAI_ALLDONE, 10);
+
+	server_answer(1, 0, 11);
+	check_no_result();
+
+	zassert_equal(ctx.servers[0].failures, 0, "Wrong failures");
+	zassert_equal(ctx.servers[1].failures, 0, "Failures not reset");
+	zassert_equal(ctx.servers[2].failures, 1, "Wrong failures");
+}
+
+static void test_failed_answer(void)
+{
+	zassert_equal(dns_resolve_close(&ctx), 0, "Cannot close DNS context");
+	init_ctx();
+
+	/* A failure is not used while another server may answer */
+	resolve();
+	zassert_equal(server_queries(), BIT(0) | BIT(1), "Wrong servers");
+
+	server_answer(0, 5, 0);
+	check_no_result();
+
+	server_answer(1, 0, 11);
+	check_result(DNS_EAI_ALLDONE, 11);
+
+	/* But it is when all the servers fail */
+	resolve();
+	zassert_equal(server_queries(), BIT(0) | BIT(2), "Wrong servers");
+
+	server_answer(0, 2, 0);
+	check_no_result();
+
+	server_answer(2, 5, 0);
+	check_result(DNS_EAI_FAIL, 0);
+}
+
+static void test_teardown(void)
+{
+	int i;
+
+	zassert_equal(dns_resolve_close(&ctx), 0, "Cannot close DNS context");
+
+	for (i = 0; i < SERVER_COUNT; i++) {
+		zassert_equal(close(servers[i].sock), 0, "close failed");
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dns_fanout,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_fanout),
+			 ztest_unit_test(test_prefer_fastest),
+			 ztest_unit_test(test_backoff),
+			 ztest_unit_test(test_failed_answer),
+			 ztest_unit_test(test_teardown));
+
+	ztest_run_test_suite(dns_fanout);
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/coap.h>
+#include <net/lwm2m.h>
+
+#include <ztest.h>
+
+#include "lwm2m_engine.h"
+#include "lwm2m_rw_plain_text.h"
+#include "lwm2m_rw_oma_tlv.h"
+#include "lwm2m_rw_json.h"
+#include "lwm2m_rw_cbor.h"
+#include "lwm2m_rw_senml_cbor.h"
+
+/* The operations of the content formats are run on the message of a
+ * request, as the engine does. The last test is a benchmark of the
+ * payload size and the encoding time of an object instance, averaged over
+ * N_ROUNDS reads, in the TLV, JSON and SenML-CBOR content formats. On
+ * native_posix, where the simulated time does not advance while
+ * computing, the CPU time of the process is read from the host instead of
+ * the cycle counter.
+ */
+
+#define N_ROUNDS 1000
+
+#define VALUE_PATH "3303/0/5700"
+
+typedef int (*read_op_t)(struct lwm2m_engine_obj *obj,
+			 struct lwm2m_message *msg, int content_format);
+
+struct content_format {
+	const char *name;
+	u16_t format;
+	const struct lwm2m_writer *writer;
+	read_op_t read_op;
+};
+
+static const struct content_format formats[] = {
+	{ "TLV", LWM2M_FORMAT_OMA_TLV, &oma_tlv_writer, do_read_op_tlv },
+	{ "JSON", LWM2M_FORMAT_OMA_JSON, &json_writer, do_read_op_json },
+	{ "SenML-CBOR", LWM2M_FORMAT_APP_SENML_CBOR, &senml_cbor_writer,
+	  do_read_op_senml_cbor },
+};
+
+static struct lwm2m_ctx client_ctx;
+static struct lwm2m_message msg;
+static struct coap_packet request;
+static struct coap_packet response;
+static u8_t request_data[128];
+
+#if defined(CONFIG_BOARD_NATIVE_POSIX)
+#include <host_cpu_time.h>
+
+static u64_t timestamp(void)
+{
+	return host_cpu_time_us() * NSEC_PER_USEC;
+}
+
+static u32_t elapsed_ns(u64_t start)
+{
+	return timestamp() - start;
+}
+#else
+static u64_t timestamp(void)
+{
+	return k_cycle_get_32();
+}
+
+static u32_t elapsed_ns(u64_t start)
+{
+	u32_t cycles = k_cycle_get_32() - (u32_t)start;
+
+	return SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+}
+#endif
+
+static void init_msg(u8_t operation, u16_t obj_id, u16_t obj_inst_id,
+		     u16_t res_id, u8_t level)
+{
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.ctx = &client_ctx;
+	msg.operation = operation;
+	msg.path.obj_id = obj_id;
+	msg.path.obj_inst_id = obj_inst_id;
+	msg.path.res_id = res_id;
+	msg.path.level = level;
+	msg.out.out_cpkt = &msg.cpkt;
+}
+
+/* Encode the path of the message in the response */
+static void encode(const struct lwm2m_writer *writer, read_op_t read_op,
+		   u16_t format)
+{
+	zassert_equal(coap_packet_init(&msg.cpkt, msg.msg_data,
+				       sizeof(msg.msg_data), 1, COAP_TYPE_ACK,
+				       0, NULL, COAP_RESPONSE_CODE_CONTENT, 0),
+		      0, "Cannot init response");
+
+	msg.out.writer = writer;
+	zassert_equal(read_op(NULL, &msg, format), 0, "Cannot read");
+}
+
+static const u8_t *get_payload(u16_t *len)
+{
+	zassert_equal(coap_packet_parse(&response, msg.msg_data,
+					msg.cpkt.offset, NULL, 0), 0,
+		      "Cannot parse response");
+
+	return coap_packet_get_payload(&response, len);
+}
+
+/* Set the payload of the request of the message */
+static void set_request(const u8_t *payload, u16_t len)
+{
+	struct coap_packet cpkt;
+
+	zassert_equal(coap_packet_init(&cpkt, request_data,
+				       sizeof(request_data), 1, COAP_TYPE_CON,
+				       0, NULL, COAP_METHOD_PUT, 1),
+		      0, "Cannot init request");
+	zassert_equal(coap_packet_append_payload_marker(&cpkt), 0,
+		      "Cannot add payload marker");
+	zassert_equal(coap_packet_append_payload(&cpkt, (u8_t *)payload, len),
+		      0, "Cannot add payload");
+
+	zassert_equal(coap_packet_parse(&request, request_data, cpkt.offset,
+					NULL, 0), 0, "Cannot parse request");
+
+	msg.in.in_cpkt = &request;
+	msg.in.offset = request.hdr_len + request.opt_len;
+	msg.in.reader = &cbor_reader;
+}
+
+static struct lwm2m_engine_obj *get_obj(void)
+{
+	struct lwm2m_engine_obj_inst *obj_inst;
+	u8_t created;
+
+	zassert_equal(lwm2m_get_or_create_engine_obj(&msg, &obj_inst,
+						     &created), 0,
+		      "Cannot get object instance");
+
+	return obj_inst->obj;
+}
+
+static void test_setup(void)
+{
+	float32_value_t value = { 21, 500000 };
+
+	zassert_equal(lwm2m_engine_create_obj_inst("3303/0"), 0,
+		      "Cannot create object instance");
+	zassert_equal(lwm2m_engine_set_float32(VALUE_PATH, &value), 0,
+		      "Cannot set value");
+}
+
+static void test_cbor_read(void)
+{
+	/* 21.5 */
+	static const u8_t expected[] = { 0xfa, 0x41, 0xac, 0x00, 0x00 };
+	const u8_t *payload;
+	u16_t len;
+
+	init_msg(LWM2M_OP_READ, 3303, 0, 5700, 3);
+	encode(&cbor_writer, do_read_op_plain_text, LWM2M_FORMAT_APP_CBOR);
+	payload = get_payload(&len);
+
+	zassert_equal(len, sizeof(expected), "Wrong payload length");
+	zassert_mem_equal(payload, expected, len, "Wrong payload");
+}
+
+static void test_cbor_write(void)
+{
+	/* 30 */
+	static const u8_t payload[] = { 0x18, 0x1e };
+	u32_t value;
+
+	init_msg(LWM2M_OP_WRITE, LWM2M_OBJECT_SERVER_ID, 0, 2, 3);
+	set_request(payload, sizeof(payload));
+
+	zassert_equal(do_write_op_plain_text(get_obj(), &msg), 0,
+		      "Cannot write");
+	zassert_equal(lwm2m_engine_get_u32("1/0/2", &value), 0,
+		      "Cannot get value");
+	zassert_equal(value, 30, "Wrong value");
+}
+
+static void test_cbor_decode(void)
+{
+	static const u8_t payload[] = {
+		/* 21.5 as binary32, binary16 and binary64 */
+		0xfa, 0x41, 0xac, 0x00, 0x00,
+		0xf9, 0x4d, 0x60,
+		0xfb, 0x40, 0x35, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00,
+		/* -500, true, "abc" and h'0102' */
+		0x39, 0x01, 0xf3,
+		0xf5,
+		0x63, 'a', 'b', 'c',
+		0x42, 0x01, 0x02,
+	};
+	float32_value_t f32;
+	float64_value_t f64;
+	u8_t buf[4];
+	bool last_block = false;
+	bool b = false;
+	s32_t i;
+
+	init_msg(LWM2M_OP_WRITE, 0, 0, 0, 0);
+	set_request(payload, sizeof(payload));
+
+	zassert_equal(engine_get_float32fix(&msg.in, &f32), 5, "Not decoded");
+	zassert_true(f32.val1 == 21 && f32.val2 == 500000, "Wrong value");
+	zassert_equal(engine_get_float32fix(&msg.in, &f32), 3, "Not decoded");
+	zassert_true(f32.val1 == 21 && f32.val2 == 500000, "Wrong value");
+	zassert_equal(engine_get_float64fix(&msg.in, &f64), 9, "Not decoded");
+	zassert_true(f64.val1 == 21 && f64.val2 == 500000000, "Wrong value");
+	zassert_equal(engine_get_s32(&msg.in, &i), 3, "Not decoded");
+	zassert_equal(i, -500, "Wrong value");
+	zassert_equal(engine_get_bool(&msg.in, &b), 1, "Not decoded");
+	zassert_true(b, "Wrong value");
+	zassert_equal(engine_get_string(&msg.in, buf, sizeof(buf)), 4,
+		      "Not decoded");
+	zassert_equal(strcmp((char *)buf, "abc"), 0, "Wrong value");
+	zassert_equal(engine_get_opaque(&msg.in, buf, sizeof(buf),
+					&last_block), 2, "Not decoded");
+	zassert_true(last_block, "Not the last block");
+	zassert_true(buf[0] == 0x01 && buf[1] == 0x02, "Wrong value");
+}
+
+static void test_senml_cbor_read(void)
+{
+	/* [{-2: "/3303/0/", 0: "5700", 2: 21.5}] */
+	static const u8_t expected[] = {
+		0x81, 0xa3,
+		0x21, 0x68, '/', '3', '3', '0', '3', '/', '0', '/',
+		0x00, 0x64, '5', '7', '0', '0',
+		0x02, 0xfa, 0x41, 0xac, 0x00, 0x00,
+	};
+	const u8_t *payload;
+	u16_t len;
+
+	init_msg(LWM2M_OP_READ, 3303, 0, 5700, 3);
+	encode(&senml_cbor_writer, do_read_op_senml_cbor,
+	       LWM2M_FORMAT_APP_SENML_CBOR);
+	payload = get_payload(&len);
+
+	zassert_equal(len, sizeof(expected), "Wrong payload length");
+	zassert_mem_equal(payload, expected, len, "Wrong payload");
+}
+
+static void test_senml_cbor_read_overflow(void)
+{
+	/* the response has a 4 bytes header, the content format option and
+	 * the payload marker
+	 */
+	static const u16_t header_len = 7U;
+
+	init_msg(LWM2M_OP_READ, 3303, 0, 5700, 3);
+
+	/* the head of the pack does not fit, nothing is written */
+	zassert_equal(coap_packet_init(&msg.cpkt, msg.msg_data,
+				       header_len + 1U, 1, COAP_TYPE_ACK,
+				       0, NULL, COAP_RESPONSE_CODE_CONTENT, 0),
+		      0, "Cannot init response");
+	msg.out.writer = &senml_cbor_writer;
+	(void)do_read_op_senml_cbor(NULL, &msg, LWM2M_FORMAT_APP_SENML_CBOR);
+	zassert_equal(msg.cpkt.offset, header_len, "Wrong payload length");
+
+	/* the record does not fit, the pack is empty */
+	zassert_equal(coap_packet_init(&msg.cpkt, msg.msg_data,
+				       header_len + 4U, 1, COAP_TYPE_ACK,
+				       0, NULL, COAP_RESPONSE_CODE_CONTENT, 0),
+		      0, "Cannot init response");
+	(void)do_read_op_senml_cbor(NULL, &msg, LWM2M_FORMAT_APP_SENML_CBOR);
+	zassert_equal(msg.cpkt.offset, header_len + 1U,
+		      "Wrong payload length");
+	zassert_equal(msg.msg_data[header_len], 0x80, "Wrong payload");
+}
+
+static void test_senml_cbor_write(void)
+{
+	/* [{-2: "/1/0/", 0: "1", 2: 3600}, {0: "6", 2: 1}, {0: "7", 3: "UQ"}]
+	 * with an extension label, which is ignored.
+	 */
+	static const u8_t payload[] = {
+		0x83,
+		0xa3, 0x21, 0x65, '/', '1', '/', '0', '/',
+		0x00, 0x61, '1', 0x02, 0x19, 0x0e, 0x10,
+		0xa2, 0x00, 0x61, '6', 0x02, 0x01,
+		0xa3, 0x00, 0x61, '7', 0x03, 0x62, 'U', 'Q',
+		0x63, 'e', 'x', 't', 0x82, 0x01, 0x02,
+	};
+	char binding[4];
+	u32_t lifetime;
+	u8_t store;
+
+	init_msg(LWM2M_OP_WRITE, LWM2M_OBJECT_SERVER_ID, 0, 0, 2);
+	set_request(payload, sizeof(payload));
+
+	zassert_equal(do_write_op_senml_cbor(get_obj(), &msg), 0,
+		      "Cannot write");
+
+	zassert_equal(lwm2m_engine_get_u32("1/0/1", &lifetime), 0,
+		      "Cannot get value");
+	zassert_equal(lifetime, 3600, "Wrong value");
+	zassert_equal(lwm2m_engine_get_u8("1/0/6", &store), 0,
+		      "Cannot get value");
+	zassert_equal(store, 1, "Wrong value");
+	zassert_equal(lwm2m_engine_get_string("1/0/7", binding,
+					      sizeof(binding)), 0,
+		      "Cannot get value");
+	zassert_equal(strcmp(binding, "UQ"), 0, "Wrong value");
+}
+
+static void test_senml_cbor_write_errors(void)
+{
+	/* [{-2: "/3/0/", 0: "13", 2: 1}] */
+	static const u8_t wrong_object[] = {
+		0x81, 0xa3, 0x21, 0x65, '/', '3', '/', '0', '/',
+		0x00, 0x62, '1', '3', 0x02, 0x01,
+	};
+	/* [{0: "0/1", 2: h'..., with a truncated value */
+	static const u8_t truncated[] = {
+		0x81, 0xa2, 0x00, 0x63, '0', '/', '1', 0x02, 0x41,
+	};
+
+	init_msg(LWM2M_OP_WRITE, LWM2M_OBJECT_SERVER_ID, 0, 0, 2);
+	set_request(wrong_object, sizeof(wrong_object));
+	zassert_equal(do_write_op_senml_cbor(get_obj(), &msg), -EINVAL,
+		      "Other object written");
+
+	init_msg(LWM2M_OP_WRITE, LWM2M_OBJECT_SERVER_ID, 0, 0, 2);
+	set_request(truncated, sizeof(truncated));
+	zassert_equal(do_write_op_senml_cbor(get_obj(), &msg), -EINVAL,
+		      "Truncated pack written");
+}
+
+static void bench(const struct content_format *cf, u16_t obj_id)
+{
+	u32_t time;
+	u64_t start;
+	u16_t len;
+	int i;
+
+	init_msg(LWM2M_OP_READ, obj_id, 0, 0, 2);
+
+	start = timestamp();
+
+	for (i = 0; i < N_ROUNDS; i++) {
+		encode(cf->writer, cf->read_op, cf->format);
+	}
+
+	time = elapsed_ns(start) / N_ROUNDS;
+	(void)get_payload(&len);
+
+	printk("/%u/0 %s: %u bytes, %u ns\n", obj_id, cf->name, len, time);
+}
+
+static void test_bench(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(formats); i++) {
+		bench(&formats[i], 3303);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(formats); i++) {
+		bench(&formats[i], LWM2M_OBJECT_DEVICE_ID);
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lwm2m_content_format,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_cbor_read),
+			 ztest_unit_test(test_cbor_write),
+			 ztest_unit_test(test_cbor_decode),
+			 ztest_unit_test(test_senml_cbor_read),
+			 ztest_unit_test(test_senml_cbor_read_overflow),
+			 ztest_unit_test(test_senml_cbor_write),
+			 ztest_unit_test(test_senml_cbor_write_errors),
+			 ztest_unit_test(test_bench));
+
+	ztest_run_test_suite(lwm2m_content_format);
+}
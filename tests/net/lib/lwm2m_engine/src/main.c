@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/lwm2m.h>
+
+#include <ztest.h>
+
+#include "lwm2m_engine.h"
+
+/* The resources are accessed through their path string and through
+ * resource handles. The last test is a benchmark of both, the time of an
+ * access is averaged over N_ROUNDS set and get calls. On native_posix,
+ * where the simulated time does not advance while computing, the CPU time
+ * of the process is read from the host instead of the cycle counter.
+ */
+
+#define N_ROUNDS 10000
+
+#define TEMP_SENSOR_ID 3303
+#define INSTANCE_COUNT CONFIG_LWM2M_IPSO_TEMP_SENSOR_INSTANCE_COUNT
+#define LAST_INSTANCE (INSTANCE_COUNT - 1)
+
+#define VALUE_PATH "3303/5/5700"
+#define LAST_VALUE_PATH "3303/7/5700"
+
+#if defined(CONFIG_BOARD_NATIVE_POSIX)
+#include <host_cpu_time.h>
+
+static u64_t timestamp(void)
+{
+	return host_cpu_time_us() * NSEC_PER_USEC;
+}
+
+static u32_t elapsed_ns(u64_t start)
+{
+	return timestamp() - start;
+}
+#else
+static u64_t timestamp(void)
+{
+	return k_cycle_get_32();
+}
+
+static u32_t elapsed_ns(u64_t start)
+{
+	u32_t cycles = k_cycle_get_32() - (u32_t)start;
+
+	return SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+}
+#endif
+
+static void check_value(float32_value_t *value, s32_t val1, s32_t val2)
+{
+	zassert_equal(value->val1, val1, "Wrong value");
+	zassert_equal(value->val2, val2, "Wrong value");
+}
+
+static void test_setup(void)
+{
+	char path[] = "3303/0";
+	int i;
+
+	for (i = 0; i < INSTANCE_COUNT; i++) {
+		path[5] = '0' + i;
+		zassert_equal(lwm2m_engine_create_obj_inst(path), 0,
+			      "Cannot create object instance");
+	}
+}
+
+static void test_handle_access(void)
+{
+	struct lwm2m_res_handle handle;
+	float32_value_t value = { 21, 500000 };
+	float32_value_t read;
+
+	zassert_equal(lwm2m_engine_get_res_handle(VALUE_PATH, &handle), 0,
+		      "Cannot resolve handle");
+
+	/* Both accesses give the same resource */
+	zassert_equal(lwm2m_engine_handle_set_float32(&handle, &value), 0,
+		      "Cannot set value");
+	zassert_equal(lwm2m_engine_get_float32(VALUE_PATH, &read), 0,
+		      "Cannot get value");
+	check_value(&read, 21, 500000);
+
+	value.val1 = 22;
+	zassert_equal(lwm2m_engine_set_float32(VALUE_PATH, &value), 0,
+		      "Cannot set value");
+	zassert_equal(lwm2m_engine_handle_get_float32(&handle, &read), 0,
+		      "Cannot get value");
+	check_value(&read, 22, 500000);
+}
+
+static void test_handle_errors(void)
+{
+	struct lwm2m_res_handle handle;
+
+	zassert_equal(lwm2m_engine_get_res_handle("3303/5", &handle),
+		      -EINVAL, "Object instance path resolved");
+	zassert_equal(lwm2m_engine_get_res_handle("3303/9/5700", &handle),
+		      -ENOENT, "Missing object instance resolved");
+	zassert_equal(lwm2m_engine_get_res_handle("3303/5/9999", &handle),
+		      -ENOENT, "Missing resource resolved");
+}
+
+static void test_handle_resolve_again(void)
+{
+	struct lwm2m_res_handle handle;
+	float32_value_t value = { 30, 0 };
+	float32_value_t read;
+
+	zassert_equal(lwm2m_engine_get_res_handle(LAST_VALUE_PATH, &handle),
+		      0, "Cannot resolve handle");
+
+	/* The handle of a deleted object instance is not used */
+	zassert_equal(lwm2m_delete_obj_inst(TEMP_SENSOR_ID, LAST_INSTANCE), 0,
+		      "Cannot delete object instance");
+	zassert_equal(lwm2m_engine_handle_set_float32(&handle, &value),
+		      -ENOENT, "Deleted object instance set");
+
+	/* Until the object instance is created again */
+	zassert_equal(lwm2m_engine_create_obj_inst("3303/7"), 0,
+		      "Cannot create object instance");
+	zassert_equal(lwm2m_engine_handle_set_float32(&handle, &value), 0,
+		      "Cannot set value");
+	zassert_equal(lwm2m_engine_get_float32(LAST_VALUE_PATH, &read), 0,
+		      "Cannot get value");
+	check_value(&read, 30, 0);
+}
+
+static void test_bench(void)
+{
+	struct lwm2m_res_handle handle;
+	float32_value_t value = { 0, 0 };
+	u32_t string_time, handle_time;
+	u64_t start;
+	int i;
+
+	zassert_equal(lwm2m_engine_get_res_handle(LAST_VALUE_PATH, &handle),
+		      0, "Cannot resolve handle");
+
+	start = timestamp();
+
+	for (i = 0; i < N_ROUNDS; i++) {
+		value.val1 = i;
+		(void)lwm2m_engine_set_float32(LAST_VALUE_PATH, &value);
+		(void)lwm2m_engine_get_float32(LAST_VALUE_PATH, &value);
+	}
+
+	string_time = elapsed_ns(start) / (2 * N_ROUNDS);
+	check_value(&value, N_ROUNDS - 1, 0);
+
+	start = timestamp();
+
+	for (i = 0; i < N_ROUNDS; i++) {
+		value.val1 = i;
+		(void)lwm2m_engine_handle_set_float32(&handle, &value);
+		(void)lwm2m_engine_handle_get_float32(&handle, &value);
+	}
+
+	handle_time = elapsed_ns(start) / (2 * N_ROUNDS);
+	check_value(&value, N_ROUNDS - 1, 0);
+
+	printk("String path access: %u ns\n", string_time);
+	printk("Resource handle access: %u ns\n", handle_time);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lwm2m_engine,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_handle_access),
+			 ztest_unit_test(test_handle_errors),
+			 ztest_unit_test(test_handle_resolve_again),
+			 ztest_unit_test(test_bench));
+
+	ztest_run_test_suite(lwm2m_engine);
+}
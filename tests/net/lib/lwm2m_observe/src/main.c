@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_LWM2M_LOG_LEVEL);
+
+#include <string.h>
+#include <net/socket.h>
+#include <net/coap.h>
+#include <net/lwm2m.h>
+
+#include <ztest.h>
+
+#include "lwm2m_engine.h"
+
+/* The test thread plays the LwM2M server, over a loopback UDP socket.
+ * The temperature sensor values are observed with a pmin of 1 second and
+ * a pmax of 3 seconds.
+ */
+
+#define SERVER_PORT 5683
+#define SERVER_URL "coap://192.0.2.1:5683"
+
+#define PMIN K_SECONDS(1)
+#define PMAX K_SECONDS(3)
+
+/* Margin for the time of a notification */
+#define MARGIN K_MSEC(200)
+#define WAIT_TIME K_SECONDS(5)
+
+#define MAX_OPTIONS 8
+
+static struct lwm2m_ctx client_ctx;
+static struct sockaddr_in server_addr;
+static struct sockaddr_in client_addr;
+static int s_sock;
+
+static struct test_msg {
+	u8_t data[256];
+	struct coap_packet cpkt;
+	struct coap_option options[MAX_OPTIONS];
+	u8_t token;
+	s64_t time;
+} msg;
+
+static void server_send(struct coap_packet *cpkt)
+{
+	zassert_equal(sendto(s_sock, cpkt->data, cpkt->offset, 0,
+			     (struct sockaddr *)&client_addr,
+			     sizeof(client_addr)), cpkt->offset,
+		      "sendto failed");
+}
+
+/* Receive the next message of the client, and acknowledge it if needed */
+static int server_recv(s32_t timeout)
+{
+	struct pollfd pfd = { .fd = s_sock, .events = POLLIN };
+	struct coap_packet ack;
+	u8_t ack_data[8];
+	ssize_t len;
+
+	if (poll(&pfd, 1, timeout) <= 0) {
+		return -EAGAIN;
+	}
+
+	len = recv(s_sock, msg.data, sizeof(msg.data), 0);
+	zassert_true(len > 0, "recv failed");
+
+	msg.time = k_uptime_get();
+	zassert_equal(coap_packet_parse(&msg.cpkt, msg.data, len,
+					msg.options, MAX_OPTIONS), 0,
+		      "Cannot parse message");
+
+	msg.token = 0U;
+	(void)coap_header_get_token(&msg.cpkt, &msg.token);
+
+	if (coap_header_get_type(&msg.cpkt) == COAP_TYPE_CON) {
+		zassert_equal(coap_packet_init(&ack, ack_data,
+					       sizeof(ack_data), 1,
+					       COAP_TYPE_ACK, 0, NULL, 0,
+					       coap_header_get_id(&msg.cpkt)),
+			      0, "Cannot init ACK");
+		server_send(&ack);
+	}
+
+	return 0;
+}
+
+/* Send a request, the path and the query are modified */
+static void server_request(u8_t code, char *path, char *query, int observe,
+			   u8_t token)
+{
+	struct coap_packet cpkt;
+	u8_t data[64];
+	char *part;
+
+	zassert_equal(coap_packet_init(&cpkt, data, sizeof(data), 1,
+				       COAP_TYPE_CON, 1, &token, code,
+				       coap_next_id()), 0,
+		      "Cannot init request");
+
+	if (observe >= 0) {
+		zassert_equal(coap_append_option_int(&cpkt, COAP_OPTION_OBSERVE,
+						     observe), 0,
+			      "Cannot add option");
+	}
+
+	for (part = strtok(path, "/"); part; part = strtok(NULL, "/")) {
+		zassert_equal(coap_packet_append_option(&cpkt,
+							COAP_OPTION_URI_PATH,
+							part, strlen(part)), 0,
+			      "Cannot add option");
+	}
+
+	for (part = strtok(query, "&"); part; part = strtok(NULL, "&")) {
+		zassert_equal(coap_packet_append_option(&cpkt,
+							COAP_OPTION_URI_QUERY,
+							part, strlen(part)), 0,
+			      "Cannot add option");
+	}
+
+	server_send(&cpkt);
+
+	/* The response is piggybacked in the ACK */
+	zassert_equal(server_recv(WAIT_TIME), 0, "No response");
+	zassert_equal(coap_header_get_type(&msg.cpkt), COAP_TYPE_ACK,
+		      "Not an ACK");
+	zassert_equal(msg.token, token, "Wrong token");
+}
+
+static void observe(char *path, u8_t token)
+{
+	char query[] = "";
+
+	server_request(COAP_METHOD_GET, path, query, 0, token);
+	zassert_equal(coap_header_get_code(&msg.cpkt),
+		      COAP_RESPONSE_CODE_CONTENT, "Not observed");
+}
+
+static void check_notify(u8_t token, s64_t after, s64_t before)
+{
+	zassert_equal(server_recv(WAIT_TIME), 0, "No notification");
+	zassert_equal(msg.token, token, "Wrong token");
+	zassert_equal(coap_header_get_type(&msg.cpkt), COAP_TYPE_CON,
+		      "Not a notification");
+	zassert_true(msg.time >= after, "Notified too early");
+	zassert_true(msg.time <= before, "Notified too late");
+}
+
+static void test_setup(void)
+{
+	char path[] = "3303/0";
+	char attr_path[] = "3303";
+	char query[] = "pmin=1&pmax=3";
+	socklen_t addrlen = sizeof(client_addr);
+	int i;
+
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&server_addr.sin_addr), 1, "inet_pton failed");
+
+	s_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(s_sock >= 0, "socket open failed");
+	zassert_equal(bind(s_sock, (struct sockaddr *)&server_addr,
+			   sizeof(server_addr)), 0, "bind failed");
+
+	for (i = 0; i < CONFIG_LWM2M_IPSO_TEMP_SENSOR_INSTANCE_COUNT; i++) {
+		path[5] = '0' + i;
+		zassert_equal(lwm2m_engine_create_obj_inst(path), 0,
+			      "Cannot create object instance");
+	}
+
+	zassert_equal(lwm2m_engine_set_string("0/0/0", SERVER_URL), 0,
+		      "Cannot set server URL");
+	zassert_equal(lwm2m_engine_start(&client_ctx), 0,
+		      "Cannot start engine");
+
+	/* Learn the address of the client */
+	zassert_equal(send(client_ctx.sock_fd, "", 1, 0), 1, "send failed");
+	zassert_equal(recvfrom(s_sock, msg.data, sizeof(msg.data), 0,
+			       (struct sockaddr *)&client_addr, &addrlen), 1,
+		      "recvfrom failed");
+
+	server_request(COAP_METHOD_PUT, attr_path, query, -1, 0);
+	zassert_equal(coap_header_get_code(&msg.cpkt),
+		      COAP_RESPONSE_CODE_CHANGED, "Attributes not written");
+}
+
+static void test_notify_pmax(void)
+{
+	char path[] = "3303/0/5700";
+	s64_t start;
+
+	observe(path, 'a');
+	start = msg.time;
+
+	/* Without change, the value is notified after pmax only */
+	check_notify('a', start + PMAX - MARGIN, start + PMAX + MARGIN);
+}
+
+static void test_notify_pmin(void)
+{
+	float32_value_t value = { 25, 0 };
+	s64_t start = msg.time;
+
+	/* The change is notified once pmin has elapsed */
+	zassert_equal(lwm2m_engine_set_float32("3303/0/5700", &value), 0,
+		      "Cannot set value");
+	check_notify('a', start + PMIN - MARGIN, start + PMIN + MARGIN);
+
+	/* Or right away if it has */
+	k_sleep(PMIN + MARGIN);
+	start = k_uptime_get();
+
+	value.val1 = 26;
+	zassert_equal(lwm2m_engine_set_float32("3303/0/5700", &value), 0,
+		      "Cannot set value");
+	check_notify('a', start, start + MARGIN);
+}
+
+static void test_notify_batch(void)
+{
+	char path_a[] = "3303/0/5700";
+	char path_b[] = "3303/1/5700";
+	char path_c[] = "3303/2/5700";
+	char query[] = "";
+	s64_t start;
+
+	/* Only the new observers are notified */
+	server_request(COAP_METHOD_GET, path_a, query, 1, 'a');
+
+	observe(path_b, 'b');
+	start = msg.time;
+
+	k_sleep(K_MSEC(500));
+	observe(path_c, 'c');
+
+	/* The notification due soon for the same server is sent with the
+	 * first one.
+	 */
+	check_notify('b', start + PMAX - MARGIN, start + PMAX + MARGIN);
+	check_notify('c', start + PMAX - MARGIN, start + PMAX + MARGIN);
+}
+
+static void test_teardown(void)
+{
+	zassert_equal(lwm2m_engine_context_close(&client_ctx), 0,
+		      "Cannot close engine");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lwm2m_observe,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_notify_pmax),
+			 ztest_unit_test(test_notify_pmin),
+			 ztest_unit_test(test_notify_batch),
+			 ztest_unit_test(test_teardown));
+
+	ztest_run_test_suite(lwm2m_observe);
+}
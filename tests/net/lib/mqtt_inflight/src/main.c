@@ -0,0 +1,433 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_MQTT_LOG_LEVEL);
+
+#include <string.h>
+#include <misc/byteorder.h>
+#include <net/socket.h>
+#include <net/mqtt.h>
+
+#include <ztest.h>
+
+/* The test thread plays both the MQTT client and the broker, over
+ * a loopback TCP connection.
+ */
+
+#define SERVER_PORT 1883
+
+#define TOPIC "sensors"
+
+#define WINDOW CONFIG_MQTT_INFLIGHT_MAX
+#define TIMEOUT K_MSEC(CONFIG_MQTT_INFLIGHT_TIMEOUT * 1000 + 100)
+
+#define WAIT_TIME K_MSEC(50)
+
+/* Room for four PUBLISH headers of TOPIC only, so that larger batches
+ * take several transport writes.
+ */
+static u8_t tx_buffer[64];
+static u8_t rx_buffer[64];
+
+static struct mqtt_client client;
+static struct sockaddr_in broker;
+
+static int s_sock;
+static int b_sock;
+
+static struct mqtt_evt events[WINDOW];
+static int event_count;
+
+static u8_t payloads[2 * WINDOW][1];
+
+/* Longer than the receive buffer */
+#define STREAM_LEN 150
+
+static u8_t stream_payload[STREAM_LEN];
+static int stream_len;
+static int stream_chunks;
+
+static void mqtt_evt_handler(struct mqtt_client *const c,
+			     const struct mqtt_evt *evt)
+{
+	if (evt->type == MQTT_EVT_PUBLISH_PAYLOAD) {
+		const struct mqtt_binstr *data = &evt->param.publish_payload.data;
+
+		zassert_true(stream_len + data->len <= STREAM_LEN,
+			     "Too much payload");
+		zassert_true(data->len <= sizeof(rx_buffer), "Chunk too long");
+		zassert_equal(evt->param.publish_payload.remaining,
+			      STREAM_LEN - stream_len - data->len,
+			      "Wrong remaining length");
+
+		memcpy(&stream_payload[stream_len], data->data, data->len);
+		stream_len += data->len;
+		stream_chunks++;
+		return;
+	}
+
+	if (event_count < ARRAY_SIZE(events)) {
+		events[event_count] = *evt;
+	}
+
+	event_count++;
+}
+
+static void broker_recv(u8_t *data, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = recv(b_sock, data, len, 0);
+		zassert_true(ret > 0, "recv failed");
+
+		data += ret;
+		len -= ret;
+	}
+}
+
+/* Receive a packet of less than 128 bytes, return its first byte */
+static u8_t broker_recv_packet(u8_t *data, u8_t *len)
+{
+	u8_t hdr[2];
+
+	broker_recv(hdr, sizeof(hdr));
+	zassert_true(hdr[1] < 128, "Packet too long");
+
+	broker_recv(data, hdr[1]);
+	*len = hdr[1];
+
+	return hdr[0];
+}
+
+static void broker_recv_publish(u8_t flags, u16_t message_id,
+				u8_t payload)
+{
+	u8_t data[32];
+	u8_t len;
+	u8_t pos = 2 + strlen(TOPIC);
+
+	zassert_equal(broker_recv_packet(data, &len), 0x30 | flags,
+		      "Not a PUBLISH packet");
+	zassert_equal(data[1], strlen(TOPIC), "Wrong topic length");
+	zassert_mem_equal(&data[2], TOPIC, strlen(TOPIC), "Wrong topic");
+
+	if (flags & 0x06) {
+		zassert_equal((data[pos] << 8) | data[pos + 1], message_id,
+			      "Wrong message id");
+		pos += 2;
+	}
+
+	zassert_equal(len, pos + 1, "Wrong payload length");
+	zassert_equal(data[pos], payload, "Wrong payload");
+}
+
+/* Send acknowledgments of consecutive message ids in one segment */
+static void broker_send_acks(u8_t type, u16_t message_id, int count)
+{
+	u8_t data[4 * WINDOW];
+	int i;
+
+	for (i = 0; i < count; i++) {
+		data[4 * i] = type;
+		data[4 * i + 1] = 2U;
+		sys_put_be16(message_id + i, &data[4 * i + 2]);
+	}
+
+	zassert_equal(send(b_sock, data, 4 * count, 0), 4 * count,
+		      "send failed");
+}
+
+static void broker_send(u8_t type, u16_t message_id)
+{
+	broker_send_acks(type, message_id, 1);
+}
+
+/* Let the client handle what the broker sent */
+static void client_input(int packets)
+{
+	k_sleep(WAIT_TIME);
+
+	while (packets-- > 0) {
+		zassert_equal(mqtt_input(&client), 0, "mqtt_input failed");
+	}
+}
+
+static void publish_param_init(struct mqtt_publish_param *param,
+			       enum mqtt_qos qos, u16_t message_id)
+{
+	memset(param, 0, sizeof(*param));
+
+	param->message.topic.qos = qos;
+	param->message.topic.topic.utf8 = TOPIC;
+	param->message.topic.topic.size = strlen(TOPIC);
+	param->message.payload.data = payloads[message_id];
+	param->message.payload.len = sizeof(payloads[message_id]);
+	param->message_id = message_id;
+}
+
+static void check_events(enum mqtt_evt_type type, int result, int count)
+{
+	int i;
+
+	zassert_equal(event_count, count, "Wrong number of events");
+
+	for (i = 0; i < count; i++) {
+		zassert_equal(events[i].type, type, "Wrong event");
+		zassert_equal(events[i].result, result, "Wrong result");
+	}
+
+	event_count = 0;
+}
+
+static void test_connect(void)
+{
+	u8_t data[32];
+	u8_t len;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(payloads); i++) {
+		payloads[i][0] = 0xa0 + i;
+	}
+
+	broker.sin_family = AF_INET;
+	broker.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&broker.sin_addr), 1, "inet_pton failed");
+
+	s_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(s_sock >= 0, "socket open failed");
+	zassert_equal(bind(s_sock, (struct sockaddr *)&broker,
+			   sizeof(broker)), 0, "bind failed");
+	zassert_equal(listen(s_sock, 1), 0, "listen failed");
+
+	mqtt_client_init(&client);
+
+	client.broker = &broker;
+	client.evt_cb = mqtt_evt_handler;
+	client.client_id.utf8 = (u8_t *)"zephyr";
+	client.client_id.size = strlen("zephyr");
+	client.protocol_version = MQTT_VERSION_3_1_1;
+	client.transport.type = MQTT_TRANSPORT_NON_SECURE;
+	client.rx_buf = rx_buffer;
+	client.rx_buf_size = sizeof(rx_buffer);
+	client.tx_buf = tx_buffer;
+	client.tx_buf_size = sizeof(tx_buffer);
+
+	zassert_equal(mqtt_connect(&client), 0, "mqtt_connect failed");
+
+	b_sock = accept(s_sock, NULL, NULL);
+	zassert_true(b_sock >= 0, "accept failed");
+
+	zassert_equal(broker_recv_packet(data, &len), 0x10,
+		      "Not a CONNECT packet");
+
+	broker_send(0x20, 0);
+	client_input(1);
+
+	check_events(MQTT_EVT_CONNACK, 0, 1);
+}
+
+static void test_publish(void)
+{
+	struct mqtt_publish_param param;
+
+	publish_param_init(&param, MQTT_QOS_0_AT_MOST_ONCE, 0);
+
+	zassert_equal(mqtt_publish(&client, &param), 0, "publish failed");
+
+	broker_recv_publish(0x00, 0, payloads[0][0]);
+}
+
+static void test_publish_batch(void)
+{
+	struct mqtt_publish_param params[2 * WINDOW];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(params); i++) {
+		publish_param_init(&params[i], MQTT_QOS_0_AT_MOST_ONCE, i);
+	}
+
+	/* QoS 0 messages are not limited by the window */
+	zassert_equal(mqtt_publish_batch(&client, params, ARRAY_SIZE(params)),
+		      ARRAY_SIZE(params), "Messages not published");
+
+	for (i = 0; i < ARRAY_SIZE(params); i++) {
+		broker_recv_publish(0x00, 0, payloads[i][0]);
+	}
+}
+
+static void test_inflight_window(void)
+{
+	struct mqtt_publish_param params[WINDOW + 2];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(params); i++) {
+		publish_param_init(&params[i], MQTT_QOS_1_AT_LEAST_ONCE, i + 1);
+	}
+
+	/* Publishing stops when the window is full */
+	zassert_equal(mqtt_publish_batch(&client, params, ARRAY_SIZE(params)),
+		      WINDOW, "Window not respected");
+
+	for (i = 0; i < WINDOW; i++) {
+		broker_recv_publish(0x02, i + 1, payloads[i + 1][0]);
+	}
+
+	zassert_equal(mqtt_publish(&client, &params[WINDOW]), -EAGAIN,
+		      "Window not respected");
+
+	/* The remaining messages report why they were not published */
+	zassert_equal(mqtt_publish_batch(&client, &params[WINDOW], 2),
+		      -EAGAIN, "Error not reported");
+
+	/* An acknowledgment makes room for one more message */
+	broker_send(0x40, 1);
+	client_input(1);
+	check_events(MQTT_EVT_PUBACK, 0, 1);
+
+	zassert_equal(mqtt_publish(&client, &params[WINDOW]), 0,
+		      "publish failed");
+	zassert_equal(mqtt_publish(&client, &params[WINDOW + 1]), -EAGAIN,
+		      "Window not respected");
+
+	broker_recv_publish(0x02, WINDOW + 1, payloads[WINDOW + 1][0]);
+}
+
+static void test_inflight_timeout(void)
+{
+	struct mqtt_publish_param param;
+
+	k_sleep(TIMEOUT);
+
+	zassert_equal(mqtt_live(&client), 0, "mqtt_live failed");
+	check_events(MQTT_EVT_PUBACK, -ETIMEDOUT, WINDOW);
+
+	/* A retransmission takes the entry of the original message */
+	publish_param_init(&param, MQTT_QOS_1_AT_LEAST_ONCE, 2);
+	param.dup_flag = 1U;
+
+	zassert_equal(mqtt_publish(&client, &param), 0, "publish failed");
+	broker_recv_publish(0x0a, 2, payloads[2][0]);
+
+	broker_send_acks(0x40, 2, WINDOW);
+	client_input(WINDOW);
+	check_events(MQTT_EVT_PUBACK, 0, WINDOW);
+
+	/* Acknowledged messages do not time out */
+	k_sleep(TIMEOUT);
+
+	zassert_equal(mqtt_live(&client), 0, "mqtt_live failed");
+	check_events(MQTT_EVT_PUBACK, 0, 0);
+}
+
+static void test_inflight_qos2(void)
+{
+	struct mqtt_publish_param param;
+	struct mqtt_pubrel_param rel_param = { .message_id = 7 };
+	u8_t data[2];
+	u8_t len;
+
+	publish_param_init(&param, MQTT_QOS_2_EXACTLY_ONCE, 7);
+
+	zassert_equal(mqtt_publish(&client, &param), 0, "publish failed");
+	broker_recv_publish(0x04, 7, payloads[7][0]);
+
+	broker_send(0x50, 7);
+	client_input(1);
+	check_events(MQTT_EVT_PUBREC, 0, 1);
+
+	zassert_equal(mqtt_publish_qos2_release(&client, &rel_param), 0,
+		      "release failed");
+	zassert_equal(broker_recv_packet(data, &len), 0x62,
+		      "Not a PUBREL packet");
+
+	/* The completion is awaited now */
+	k_sleep(TIMEOUT);
+
+	zassert_equal(mqtt_live(&client), 0, "mqtt_live failed");
+	check_events(MQTT_EVT_PUBCOMP, -ETIMEDOUT, 1);
+
+	broker_send(0x70, 7);
+	client_input(1);
+	check_events(MQTT_EVT_PUBCOMP, 0, 1);
+
+	k_sleep(TIMEOUT);
+
+	zassert_equal(mqtt_live(&client), 0, "mqtt_live failed");
+	check_events(MQTT_EVT_PUBCOMP, 0, 0);
+}
+
+static void test_publish_payload_stream(void)
+{
+	static const u8_t header[] = {
+		0x30, 0x9f, 0x01, 0x00, sizeof(TOPIC) - 1,
+		's', 'e', 'n', 's', 'o', 'r', 's'
+	};
+	u8_t data[sizeof(header) + STREAM_LEN];
+	size_t first = sizeof(header) + 28;
+	int i;
+
+	memcpy(data, header, sizeof(header));
+
+	for (i = 0; i < STREAM_LEN; i++) {
+		data[sizeof(header) + i] = i;
+	}
+
+	/* The payload is delivered as it arrives, the handler of the
+	 * PUBLISH event does not read it.
+	 */
+	zassert_equal(send(b_sock, data, first, 0), first, "send failed");
+	client_input(1);
+
+	check_events(MQTT_EVT_PUBLISH, 0, 1);
+	zassert_equal(events[0].param.publish.message.payload.len, STREAM_LEN,
+		      "Wrong payload length");
+	zassert_equal(stream_len, first - sizeof(header),
+		      "Payload not delivered");
+
+	zassert_equal(send(b_sock, &data[first], sizeof(data) - first, 0),
+		      sizeof(data) - first, "send failed");
+	client_input(1);
+
+	zassert_equal(stream_len, STREAM_LEN, "Payload not delivered");
+	zassert_true(stream_chunks >= 3, "Payload not delivered in chunks");
+	zassert_mem_equal(stream_payload, &data[sizeof(header)], STREAM_LEN,
+			  "Wrong payload");
+	check_events(MQTT_EVT_PUBLISH, 0, 0);
+}
+
+static void test_disconnect(void)
+{
+	u8_t data[2];
+	u8_t len;
+
+	zassert_equal(mqtt_disconnect(&client), 0, "disconnect failed");
+	zassert_equal(broker_recv_packet(data, &len), 0xe0,
+		      "Not a DISCONNECT packet");
+
+	zassert_equal(mqtt_live(&client), 0, "mqtt_live failed");
+	check_events(MQTT_EVT_DISCONNECT, 0, 1);
+
+	zassert_equal(close(b_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mqtt_inflight,
+			 ztest_unit_test(test_connect),
+			 ztest_unit_test(test_publish),
+			 ztest_unit_test(test_publish_batch),
+			 ztest_unit_test(test_inflight_window),
+			 ztest_unit_test(test_inflight_timeout),
+			 ztest_unit_test(test_inflight_qos2),
+			 ztest_unit_test(test_publish_payload_stream),
+			 ztest_unit_test(test_disconnect));
+
+	ztest_run_test_suite(mqtt_inflight);
+}
@@ -293,12 +293,74 @@ static void test_neighbor(void)
 	return;
 }
 
+static void test_neighbor_index(void)
+{
+	struct net_if *iface1 = INT_TO_POINTER(1);
+	struct net_if *iface2 = INT_TO_POINTER(2);
+	struct net_nbr *nbr1, *nbr2, *nbr;
+	struct net_linkaddr lladdr;
+	int ret;
+
+	lladdr.len = sizeof(struct net_eth_addr);
+
+	nbr1 = net_nbr_get(&net_test_neighbor.table);
+	zassert_not_null(nbr1, "Cannot get neighbor");
+	nbr2 = net_nbr_get(&net_test_neighbor.table);
+	zassert_not_null(nbr2, "Cannot get neighbor");
+
+	lladdr.addr = hwaddr1.addr;
+	ret = net_nbr_link(nbr1, iface1, &lladdr);
+	zassert_equal(ret, 0, "Cannot link neighbor (%d)", ret);
+
+	/* The neighbors sharing a lladdr are found by interface */
+	ret = net_nbr_link(nbr2, iface2, &lladdr);
+	zassert_equal(ret, 0, "Cannot link neighbor (%d)", ret);
+	zassert_equal(nbr1->idx, nbr2->idx, "lladdr not shared");
+
+	nbr = net_nbr_lookup_by_index(&net_test_neighbor.table, iface2,
+				      nbr1->idx);
+	zassert_equal_ptr(nbr, nbr2, "Wrong neighbor for iface2");
+
+	nbr = net_nbr_lookup_by_index(&net_test_neighbor.table, NULL,
+				      nbr1->idx);
+	zassert_equal_ptr(nbr, nbr1, "Wrong neighbor for any iface");
+
+	/* A changed lladdr is found with the new address only */
+	net_nbr_set_lladdr(nbr1->idx, hwaddr3.addr,
+			   sizeof(struct net_eth_addr));
+
+	nbr = net_nbr_lookup(&net_test_neighbor.table, iface1, &lladdr);
+	zassert_is_null(nbr, "Neighbor found with old lladdr");
+
+	lladdr.addr = hwaddr3.addr;
+	nbr = net_nbr_lookup(&net_test_neighbor.table, iface1, &lladdr);
+	zassert_equal_ptr(nbr, nbr1, "Neighbor not found with new lladdr");
+	nbr = net_nbr_lookup(&net_test_neighbor.table, iface2, &lladdr);
+	zassert_equal_ptr(nbr, nbr2, "Neighbor not found with new lladdr");
+
+	/* An unlinked neighbor is not found anymore */
+	net_nbr_unlink(nbr2, &lladdr);
+
+	nbr = net_nbr_lookup(&net_test_neighbor.table, iface2, &lladdr);
+	zassert_is_null(nbr, "Unlinked neighbor found");
+	nbr = net_nbr_lookup(&net_test_neighbor.table, iface1, &lladdr);
+	zassert_equal_ptr(nbr, nbr1, "Linked neighbor not found");
+
+	net_nbr_unlink(nbr1, &lladdr);
+
+	nbr = net_nbr_lookup(&net_test_neighbor.table, iface1, &lladdr);
+	zassert_is_null(nbr, "Unlinked neighbor found");
+
+	net_nbr_unref(nbr1);
+	net_nbr_unref(nbr2);
+}
 
 /*test case main entry*/
 void test_main(void)
 {
 	k_thread_priority_set(k_current_get(), K_PRIO_COOP(7));
 	ztest_test_suite(neighbor,
-			 ztest_unit_test(test_neighbor));
+			 ztest_unit_test(test_neighbor),
+			 ztest_unit_test(test_neighbor_index));
 	ztest_run_test_suite(neighbor);
 }
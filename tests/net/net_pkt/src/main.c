@@ -601,6 +601,51 @@ void test_net_pkt_copy(void)
 		     "Pkt not properly unreferenced");
 }
 
+static void check_pull(size_t pull_len)
+{
+	u8_t data[300];
+	struct net_pkt *pkt;
+	size_t i;
+
+	pkt = net_pkt_alloc_with_buffer(eth_if, sizeof(data),
+					AF_UNSPEC, 0, K_NO_WAIT);
+	zassert_true(pkt != NULL, "Pkt not allocated");
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = (u8_t)i;
+	}
+
+	zassert_true(net_pkt_write(pkt, data, sizeof(data)) == 0,
+		     "Pkt write failed");
+
+	net_pkt_cursor_init(pkt);
+	zassert_true(net_pkt_pull(pkt, pull_len) == 0, "Pkt pull failed");
+	zassert_true(net_pkt_get_len(pkt) == sizeof(data) - pull_len,
+		     "Pkt length mismatch");
+
+	/* The data after the pulled bytes is kept as is */
+	(void)memset(data, 0, sizeof(data));
+	net_pkt_cursor_init(pkt);
+	zassert_true(net_pkt_read(pkt, data, sizeof(data) - pull_len) == 0,
+		     "Pkt read failed");
+
+	for (i = 0; i < sizeof(data) - pull_len; i++) {
+		zassert_equal(data[i], (u8_t)(i + pull_len),
+			      "Wrong data at %zu", i);
+	}
+
+	net_pkt_unref(pkt);
+	zassert_true(atomic_get(&pkt->atomic_ref) == 0,
+		     "Pkt not properly unreferenced");
+}
+
+void test_net_pkt_pull(void)
+{
+	/* Within the first buffer, then over the first buffer */
+	check_pull(20);
+	check_pull(200);
+}
+
 void test_main(void)
 {
 	eth_if = net_if_get_default();
@@ -611,7 +656,8 @@ void test_main(void)
 			 ztest_unit_test(test_net_pkt_basics_of_rw),
 			 ztest_unit_test(test_net_pkt_advanced_basics),
 			 ztest_unit_test(test_net_pkt_easier_rw_usage),
-			 ztest_unit_test(test_net_pkt_copy)
+			 ztest_unit_test(test_net_pkt_copy),
+			 ztest_unit_test(test_net_pkt_pull)
 		);
 
 	ztest_run_test_suite(net_pkt_tests);
@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <stdio.h>
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+
+#include "../../socket_helpers.h"
+
+#define BUF_AND_SIZE(buf) buf, sizeof(buf) - 1
+
+#define TEST_STR_SMALL "test"
+
+#define ANY_PORT 0
+#define SERVER_PORT 4242
+#define CLIENT_PORT 9898
+
+/* On QEMU, a wait takes +10ms from the requested time. */
+#define FUZZ 10
+
+static int c_sock;
+static int s_sock;
+static int epfd;
+
+static void setup_udp(void)
+{
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	int res;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, CLIENT_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = connect(c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+
+	epfd = epoll_create(1);
+	zassert_true(epfd >= 0, "epoll_create failed");
+}
+
+static void teardown_udp(void)
+{
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+static void add_sock(int sock, u32_t events)
+{
+	struct epoll_event ev = {
+		.events = events,
+		.data.fd = sock,
+	};
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, sock, &ev), 0,
+		      "epoll_ctl failed");
+}
+
+static void send_small(void)
+{
+	zassert_equal(send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0),
+		      sizeof(TEST_STR_SMALL) - 1, "send failed");
+}
+
+static void recv_small(void)
+{
+	char buf[10];
+
+	zassert_equal(recv(s_sock, buf, sizeof(buf), 0),
+		      sizeof(TEST_STR_SMALL) - 1, "recv failed");
+}
+
+void test_epoll_level(void)
+{
+	struct epoll_event events[2];
+	u32_t tstamp;
+	int res;
+
+	setup_udp();
+	add_sock(s_sock, EPOLLIN);
+
+	/* Wait on non-ready socket with timeout of 0 */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_true(k_uptime_get_32() - tstamp <= FUZZ, "");
+	zassert_equal(res, 0, "");
+
+	/* Wait on non-ready socket with timeout of 30ms */
+	tstamp = k_uptime_get_32();
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	tstamp = k_uptime_get_32() - tstamp;
+	zassert_true(tstamp >= 30U && tstamp <= 30 + FUZZ, "");
+	zassert_equal(res, 0, "");
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLIN, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	/* Level-triggered: still reported until the data is read */
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+
+	recv_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	teardown_udp();
+}
+
+void test_epoll_edge(void)
+{
+	struct epoll_event events[2];
+	int res;
+
+	setup_udp();
+	add_sock(s_sock, EPOLLIN | EPOLLET);
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLIN, "");
+
+	/* Edge-triggered: not reported again without new data */
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+
+	recv_small();
+	recv_small();
+
+	teardown_udp();
+}
+
+void test_epoll_oneshot(void)
+{
+	struct epoll_event events[2];
+	struct epoll_event ev = {
+		.events = EPOLLIN | EPOLLONESHOT,
+		.data.u32 = 42,
+	};
+	int res;
+
+	setup_udp();
+	add_sock(s_sock, EPOLLIN | EPOLLONESHOT);
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 1, "");
+
+	send_small();
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 0, "disabled socket reported");
+
+	/* Re-arming reports the pending data */
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &ev);
+	zassert_equal(res, 0, "epoll_ctl failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.u32, 42, "");
+
+	recv_small();
+	recv_small();
+
+	teardown_udp();
+}
+
+void test_epoll_out(void)
+{
+	struct epoll_event events[2];
+	int res;
+
+	setup_udp();
+	add_sock(c_sock, EPOLLOUT);
+	add_sock(s_sock, EPOLLIN);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLOUT, "");
+	zassert_equal(events[0].data.fd, c_sock, "");
+
+	send_small();
+	k_sleep(K_MSEC(10));
+
+	/* Only as many events as there is room for are returned */
+	res = epoll_wait(epfd, events, 1, 0);
+	zassert_equal(res, 1, "");
+	res = epoll_wait(epfd, events, 1, 0);
+	zassert_equal(res, 1, "");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 2, "");
+
+	recv_small();
+
+	teardown_udp();
+}
+
+void test_epoll_ctl(void)
+{
+	struct epoll_event events[2];
+	struct epoll_event ev = { .events = EPOLLIN };
+	int res;
+
+	setup_udp();
+
+	res = epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &ev);
+	zassert_equal(res, -1, "");
+	zassert_equal(errno, ENOENT, "");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_DEL, s_sock, NULL);
+	zassert_equal(res, -1, "");
+	zassert_equal(errno, ENOENT, "");
+
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, epfd, &ev);
+	zassert_equal(res, -1, "");
+	zassert_equal(errno, EINVAL, "");
+
+	add_sock(s_sock, EPOLLIN);
+
+	res = epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &ev);
+	zassert_equal(res, -1, "");
+	zassert_equal(errno, EEXIST, "");
+
+	send_small();
+
+	res = epoll_ctl(epfd, EPOLL_CTL_DEL, s_sock, NULL);
+	zassert_equal(res, 0, "epoll_ctl failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 30);
+	zassert_equal(res, 0, "removed socket reported");
+
+	add_sock(s_sock, EPOLLIN);
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 1, "");
+
+	/* Closing the socket removes it from the epoll instance */
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "closed socket reported");
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, -1, "");
+	zassert_equal(errno, EBADF, "");
+}
+
+void test_epoll_accept(void)
+{
+	struct sockaddr_in c_addr;
+	struct sockaddr_in s_addr;
+	struct epoll_event events[2];
+	int new_sock;
+	int res;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+	res = listen(s_sock, 1);
+	zassert_equal(res, 0, "listen failed");
+
+	epfd = epoll_create(1);
+	zassert_true(epfd >= 0, "epoll_create failed");
+	add_sock(s_sock, EPOLLIN);
+
+	res = connect(c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 100);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, s_sock, "");
+
+	new_sock = accept(s_sock, NULL, NULL);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	add_sock(new_sock, EPOLLIN);
+
+	res = send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(res, sizeof(TEST_STR_SMALL) - 1, "send failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 100);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, new_sock, "");
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	k_sleep(K_SECONDS(1));
+}
+
+void test_epoll_hup(void)
+{
+	struct sockaddr_in c_addr;
+	struct sockaddr_in s_addr;
+	struct epoll_event events[2];
+	char buf[10];
+	int new_sock;
+	int res;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_addr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_addr);
+
+	res = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "bind failed");
+	res = listen(s_sock, 1);
+	zassert_equal(res, 0, "listen failed");
+
+	res = connect(c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(res, 0, "connect failed");
+	new_sock = accept(s_sock, NULL, NULL);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	epfd = epoll_create(1);
+	zassert_true(epfd >= 0, "epoll_create failed");
+	add_sock(new_sock, EPOLLIN | EPOLLET);
+
+	res = send(c_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0);
+	zassert_equal(res, sizeof(TEST_STR_SMALL) - 1, "send failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 100);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].events, EPOLLIN, "");
+
+	/* The hang up is reported without being asked for, when the
+	 * connection has been closed, even though the data has not been
+	 * read yet.
+	 */
+	zassert_equal(close(c_sock), 0, "close failed");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 2000);
+	zassert_equal(res, 1, "");
+	zassert_equal(events[0].data.fd, new_sock, "");
+	zassert_equal(events[0].events, EPOLLIN | EPOLLHUP, "");
+
+	zassert_equal(recv(new_sock, buf, sizeof(buf), 0),
+		      sizeof(TEST_STR_SMALL) - 1, "recv failed");
+	zassert_equal(recv(new_sock, buf, sizeof(buf), 0), 0,
+		      "EOF not detected");
+
+	res = epoll_wait(epfd, events, ARRAY_SIZE(events), 0);
+	zassert_equal(res, 0, "");
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	k_sleep(K_SECONDS(1));
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_epoll,
+			 ztest_unit_test(test_epoll_level),
+			 ztest_unit_test(test_epoll_edge),
+			 ztest_unit_test(test_epoll_oneshot),
+			 ztest_unit_test(test_epoll_out),
+			 ztest_unit_test(test_epoll_ctl),
+			 ztest_unit_test(test_epoll_accept),
+			 ztest_unit_test(test_epoll_hup));
+
+	ztest_run_test_suite(socket_epoll);
+}
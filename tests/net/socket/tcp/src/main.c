@@ -16,6 +16,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 
 #define ANY_PORT 0
 #define SERVER_PORT 4242
+#define CLIENT_PORT 9898
 
 #define MAX_CONNS 5
 
@@ -352,15 +353,428 @@ void test_v6_sendto_recvfrom_null_dest(void)
 	k_sleep(TCP_TEARDOWN_TIMEOUT);
 }
 
+void test_v4_sockopt_buf_size(void)
+{
+	/* Test SO_RCVBUF/SO_SNDBUF on ipv4 stream sockets, and that data
+	 * still flows when the buffers are small.
+	 */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	static char tx_buf[1000];
+	char rx_buf[100];
+	socklen_t optlen;
+	int optval;
+	ssize_t ret;
+	int sent;
+	int recved;
+	int i;
+
+	for (i = 0; i < sizeof(tx_buf); i++) {
+		tx_buf[i] = i;
+	}
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	optval = 600;
+	zassert_equal(setsockopt(s_sock, SOL_SOCKET, SO_RCVBUF,
+				 &optval, sizeof(optval)),
+		      0, "setsockopt SO_RCVBUF failed");
+	optval = 600;
+	zassert_equal(setsockopt(c_sock, SOL_SOCKET, SO_SNDBUF,
+				 &optval, sizeof(optval)),
+		      0, "setsockopt SO_SNDBUF failed");
+
+	optval = 0;
+	optlen = sizeof(optval);
+	zassert_equal(getsockopt(s_sock, SOL_SOCKET, SO_RCVBUF,
+				 &optval, &optlen),
+		      0, "getsockopt SO_RCVBUF failed");
+	zassert_equal(optlen, sizeof(optval), "wrong optlen");
+	zassert_equal(optval, 600, "wrong SO_RCVBUF value");
+
+	optval = 0;
+	optlen = sizeof(optval);
+	zassert_equal(getsockopt(c_sock, SOL_SOCKET, SO_SNDBUF,
+				 &optval, &optlen),
+		      0, "getsockopt SO_SNDBUF failed");
+	zassert_equal(optval, 600, "wrong SO_SNDBUF value");
+
+	optval = -1;
+	zassert_equal(setsockopt(c_sock, SOL_SOCKET, SO_SNDBUF,
+				 &optval, sizeof(optval)),
+		      -1, "negative SO_SNDBUF accepted");
+	zassert_equal(errno, EINVAL, "wrong errno");
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	/* The accepted socket inherits the listener's receive buffer */
+	optval = 0;
+	optlen = sizeof(optval);
+	zassert_equal(getsockopt(new_sock, SOL_SOCKET, SO_RCVBUF,
+				 &optval, &optlen),
+		      0, "getsockopt SO_RCVBUF failed");
+	zassert_equal(optval, 600, "SO_RCVBUF not inherited");
+
+	sent = 0;
+	recved = 0;
+
+	while (recved < sizeof(tx_buf)) {
+		if (sent < sizeof(tx_buf)) {
+			ret = send(c_sock, tx_buf + sent,
+				   MIN(sizeof(rx_buf), sizeof(tx_buf) - sent),
+				   0);
+			zassert_true(ret > 0, "send failed");
+			sent += ret;
+		}
+
+		ret = recv(new_sock, rx_buf, sizeof(rx_buf), MSG_DONTWAIT);
+		if (ret < 0) {
+			zassert_equal(errno, EAGAIN, "recv failed");
+			continue;
+		}
+
+		zassert_true(ret > 0, "unexpected EOF");
+		zassert_equal(memcmp(rx_buf, tx_buf + recved, ret), 0,
+			      "unexpected data");
+		recved += ret;
+	}
+
+	test_close(c_sock);
+	test_eof(new_sock);
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v4_send_recv_bulk(void)
+{
+	/* Test that sends larger than one segment arrive intact */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	static char tx_buf[4000];
+	static char rx_buf[256];
+	ssize_t ret;
+	int sent;
+	int recved;
+	int i;
+
+	for (i = 0; i < sizeof(tx_buf); i++) {
+		tx_buf[i] = i % 251;
+	}
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	sent = 0;
+	recved = 0;
+
+	while (sent < sizeof(tx_buf)) {
+		ret = send(c_sock, tx_buf + sent,
+			   MIN(1000, sizeof(tx_buf) - sent), 0);
+		zassert_true(ret > 0, "send failed");
+		sent += ret;
+
+		/* Read everything before sending more, so that the data
+		 * stays within the receive window.
+		 */
+		while (recved < sent) {
+			ret = recv(new_sock, rx_buf, sizeof(rx_buf), 0);
+			zassert_true(ret > 0, "recv failed");
+			zassert_equal(memcmp(rx_buf, tx_buf + recved, ret), 0,
+				      "unexpected data");
+			recved += ret;
+		}
+	}
+
+	test_close(c_sock);
+	test_eof(new_sock);
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v4_recv_zerocopy(void)
+{
+	/* Test that data can be received without copying it */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	static char tx_buf[3000];
+	struct iovec iov[2];
+	struct zsock_zerocopy_rx zc;
+	ssize_t ret;
+	int sent;
+	int recved;
+	size_t i;
+
+	for (i = 0; i < sizeof(tx_buf); i++) {
+		tx_buf[i] = i % 251;
+	}
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	sent = 0;
+	recved = 0;
+
+	while (sent < sizeof(tx_buf)) {
+		ret = send(c_sock, tx_buf + sent,
+			   MIN(1000, sizeof(tx_buf) - sent), 0);
+		zassert_true(ret > 0, "send failed");
+		sent += ret;
+
+		while (recved < sent) {
+			zc.iov = iov;
+			zc.iovcnt = ARRAY_SIZE(iov);
+
+			ret = zsock_recv_zerocopy(new_sock, &zc, 0);
+			zassert_true(ret > 0, "zero-copy recv failed");
+			zassert_true(zc.iovcnt > 0 &&
+				     zc.iovcnt <= ARRAY_SIZE(iov),
+				     "wrong fragment count");
+
+			for (i = 0; i < zc.iovcnt; i++) {
+				zassert_equal(memcmp(iov[i].iov_base,
+						     tx_buf + recved,
+						     iov[i].iov_len), 0,
+					      "unexpected data");
+				recved += iov[i].iov_len;
+				ret -= iov[i].iov_len;
+			}
+
+			zassert_equal(ret, 0, "wrong length");
+			zassert_equal(zsock_recv_zerocopy_release(new_sock,
+								  &zc),
+				      0, "release failed");
+		}
+	}
+
+	test_close(c_sock);
+
+	zc.iov = iov;
+	zc.iovcnt = ARRAY_SIZE(iov);
+	zassert_equal(zsock_recv_zerocopy(new_sock, &zc, 0), 0,
+		      "EOF not detected");
+	zassert_equal(zc.iovcnt, 0, "unexpected fragments");
+	zassert_equal(zsock_recv_zerocopy_release(new_sock, &zc), 0,
+		      "release failed");
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v4_sendmsg_recvmsg(void)
+{
+	/* Test if sendmsg() and recvmsg() gather and scatter the data of
+	 * a ipv4 stream socket.
+	 */
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	char tx_head[] = "sendmsg ";
+	char tx_tail[] = "gathers";
+	char rx_head[sizeof(tx_head) - 1];
+	char rx_tail[sizeof(tx_tail)];
+	struct iovec iov[2];
+	struct msghdr msg;
+	ssize_t len = sizeof(tx_head) - 1 + sizeof(tx_tail) - 1;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_accept(s_sock, &new_sock, NULL, NULL);
+
+	iov[0].iov_base = tx_head;
+	iov[0].iov_len = sizeof(tx_head) - 1;
+	iov[1].iov_base = tx_tail;
+	iov[1].iov_len = sizeof(tx_tail) - 1;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = ARRAY_SIZE(iov);
+
+	zassert_equal(sendmsg(c_sock, &msg, 0), len, "sendmsg failed");
+
+	memset(rx_tail, 0, sizeof(rx_tail));
+	iov[0].iov_base = rx_head;
+	iov[0].iov_len = sizeof(rx_head);
+	iov[1].iov_base = rx_tail;
+	iov[1].iov_len = sizeof(rx_tail);
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = ARRAY_SIZE(iov);
+	msg.msg_flags = -1;
+
+	zassert_equal(recvmsg(new_sock, &msg, 0), len,
+		      "recvmsg failed");
+	zassert_equal(memcmp(rx_head, tx_head, sizeof(rx_head)), 0,
+		      "unexpected data in the first buffer");
+	zassert_equal(strcmp(rx_tail, tx_tail), 0,
+		      "unexpected data in the second buffer");
+	zassert_equal(msg.msg_flags, 0, "msg_flags not written back");
+
+	test_close(c_sock);
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+#define REUSEPORT_FLOWS 8
+
+/* Connect from the given port, and return the index of the listener that
+ * got the connection after exchanging data over it.
+ */
+static int reuseport_connect(int *listeners, u16_t client_port)
+{
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct pollfd pfds[2];
+	int c_sock;
+	int new_sock;
+	int idx;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, client_port,
+			    &c_sock, &c_saddr);
+	s_saddr.sin_family = AF_INET;
+	s_saddr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&s_saddr.sin_addr), 1, "inet_pton failed");
+
+	test_bind(c_sock, (struct sockaddr *)&c_saddr, sizeof(c_saddr));
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+
+	for (idx = 0; idx < ARRAY_SIZE(pfds); idx++) {
+		pfds[idx].fd = listeners[idx];
+		pfds[idx].events = POLLIN;
+	}
+
+	zassert_equal(poll(pfds, ARRAY_SIZE(pfds), 100), 1,
+		      "connection not queued on exactly one listener");
+	idx = (pfds[0].revents & POLLIN) ? 0 : 1;
+
+	test_accept(listeners[idx], &new_sock, NULL, NULL);
+
+	test_send(c_sock, TEST_STR_SMALL, strlen(TEST_STR_SMALL), 0);
+	test_recv(new_sock, 0);
+	test_send(new_sock, TEST_STR_SMALL, strlen(TEST_STR_SMALL), 0);
+	test_recv(c_sock, 0);
+
+	test_close(c_sock);
+	test_close(new_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+
+	return idx;
+}
+
+void test_v4_reuseport(void)
+{
+	/* Test that listeners sharing a port each get connections, and
+	 * that a flow is always given to the same listener.
+	 */
+	int listeners[2];
+	struct sockaddr_in s_saddr;
+	int optval = 1;
+	int used = 0;
+	int idx;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(listeners); i++) {
+		prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+				    &listeners[i], &s_saddr);
+		zassert_equal(setsockopt(listeners[i], SOL_SOCKET,
+					 SO_REUSEPORT, &optval,
+					 sizeof(optval)),
+			      0, "setsockopt failed");
+		test_bind(listeners[i], (struct sockaddr *)&s_saddr,
+			  sizeof(s_saddr));
+		test_listen(listeners[i]);
+	}
+
+	for (i = 0; i < REUSEPORT_FLOWS; i++) {
+		idx = reuseport_connect(listeners, CLIENT_PORT + i);
+		zassert_equal(reuseport_connect(listeners, CLIENT_PORT + i),
+			      idx, "flow %d moved to another listener", i);
+		used |= BIT(idx);
+	}
+
+	zassert_equal(used, BIT(0) | BIT(1),
+		      "flows not spread among listeners");
+
+	for (i = 0; i < ARRAY_SIZE(listeners); i++) {
+		test_close(listeners[i]);
+	}
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
 void test_main(void)
 {
+	k_thread_system_pool_assign(k_current_get());
+
 	ztest_test_suite(socket_tcp,
 			 ztest_user_unit_test(test_v4_send_recv),
 			 ztest_user_unit_test(test_v6_send_recv),
 			 ztest_user_unit_test(test_v4_sendto_recvfrom),
 			 ztest_user_unit_test(test_v6_sendto_recvfrom),
 			 ztest_user_unit_test(test_v4_sendto_recvfrom_null_dest),
-			 ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest));
+			 ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest),
+			 ztest_user_unit_test(test_v4_sockopt_buf_size),
+			 ztest_user_unit_test(test_v4_send_recv_bulk),
+			 ztest_unit_test(test_v4_recv_zerocopy),
+			 ztest_user_unit_test(test_v4_sendmsg_recvmsg),
+			 ztest_user_unit_test(test_v4_reuseport));
 
 	ztest_run_test_suite(socket_tcp);
 }
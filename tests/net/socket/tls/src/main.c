@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <string.h>
+#include <net/socket.h>
+#include <net/tls_credentials.h>
+
+#include <ztest.h>
+
+/* The peer of the client is accepted by a server thread, and read by the
+ * test thread. As the peer reads at most one TLS record per recv() call,
+ * the data of a record is received at once.
+ */
+
+#define SERVER_PORT 4244
+#define SEC_TAG 1
+#define OTHER_SEC_TAG 2
+
+#define RECORD_SIZE CONFIG_NET_SOCKETS_TLS_TX_RECORD_SIZE
+#define BULK_SIZE (2 * CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN + 100)
+
+#define WAIT_TIME K_SECONDS(5)
+
+#define SERVER_STACK_SIZE 4096
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+static const unsigned char psk[] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+	0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10
+};
+static const char psk_id[] = "test";
+
+static const sec_tag_t sec_tags[] = { SEC_TAG };
+static const sec_tag_t other_sec_tags[] = { OTHER_SEC_TAG };
+
+static struct sockaddr_in server_addr;
+static int server_sock;
+static int peer_sock;
+static int c_sock;
+
+static u8_t tx_data[BULK_SIZE];
+static u8_t rx_data[BULK_SIZE];
+
+static K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static K_SEM_DEFINE(accepted, 0, 1);
+
+static void server_fn(void *p1, void *p2, void *p3)
+{
+	while (true) {
+		peer_sock = accept(server_sock, NULL, NULL);
+		if (peer_sock < 0) {
+			return;
+		}
+
+		k_sem_give(&accepted);
+	}
+}
+
+static void set_sec_tags(int sock)
+{
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tags,
+				 sizeof(sec_tags)), 0,
+		      "Cannot set secure tags");
+}
+
+static void connect_client(void)
+{
+	c_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(c_sock >= 0, "socket open failed");
+
+	set_sec_tags(c_sock);
+
+	zassert_equal(connect(c_sock, (struct sockaddr *)&server_addr,
+			      sizeof(server_addr)), 0, "connect failed");
+	zassert_equal(k_sem_take(&accepted, WAIT_TIME), 0, "Not accepted");
+}
+
+static void close_client(void)
+{
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(peer_sock), 0, "close failed");
+}
+
+/* Connect a client with the session cache, and return whether the session
+ * of a previous connection was resumed.
+ */
+static int connect_session(const char *hostname, const sec_tag_t *tags)
+{
+	int cache = TLS_SESSION_CACHE_ENABLED;
+	socklen_t optlen = sizeof(int);
+	int resumed;
+
+	c_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(c_sock >= 0, "socket open failed");
+
+	zassert_equal(setsockopt(c_sock, SOL_TLS, TLS_SEC_TAG_LIST, tags,
+				 sizeof(sec_tag_t)), 0,
+		      "Cannot set secure tags");
+	zassert_equal(setsockopt(c_sock, SOL_TLS, TLS_HOSTNAME, hostname,
+				 strlen(hostname)), 0,
+		      "Cannot set hostname");
+	zassert_equal(setsockopt(c_sock, SOL_TLS, TLS_SESSION_CACHE, &cache,
+				 sizeof(cache)), 0,
+		      "Cannot set session cache");
+
+	zassert_equal(connect(c_sock, (struct sockaddr *)&server_addr,
+			      sizeof(server_addr)), 0, "connect failed");
+	zassert_equal(k_sem_take(&accepted, WAIT_TIME), 0, "Not accepted");
+
+	zassert_equal(getsockopt(c_sock, SOL_TLS, TLS_SESSION_RESUMED,
+				 &resumed, &optlen), 0,
+		      "Cannot get session resumption");
+
+	close_client();
+
+	return resumed;
+}
+
+static void send_data(const u8_t *data, size_t len, int flags)
+{
+	zassert_equal(send(c_sock, data, len, flags), len, "send failed");
+}
+
+/* Receive the data of the next record */
+static void check_record(const u8_t *data, size_t len)
+{
+	zassert_equal(recv(peer_sock, rx_data, sizeof(rx_data), 0), len,
+		      "Wrong record length");
+	zassert_mem_equal(rx_data, data, len, "Wrong data");
+}
+
+static void test_setup(void)
+{
+	int cache = TLS_SESSION_CACHE_ENABLED;
+	int i;
+
+	for (i = 0; i < sizeof(tx_data); i++) {
+		tx_data[i] = i;
+	}
+
+	zassert_equal(tls_credential_add(SEC_TAG, TLS_CREDENTIAL_PSK, psk,
+					 sizeof(psk)), 0, "Cannot add PSK");
+	zassert_equal(tls_credential_add(SEC_TAG, TLS_CREDENTIAL_PSK_ID,
+					 psk_id, strlen(psk_id)), 0,
+		      "Cannot add PSK ID");
+
+	/* The same credentials with another secure tag */
+	zassert_equal(tls_credential_add(OTHER_SEC_TAG, TLS_CREDENTIAL_PSK,
+					 psk, sizeof(psk)), 0, "Cannot add PSK");
+	zassert_equal(tls_credential_add(OTHER_SEC_TAG, TLS_CREDENTIAL_PSK_ID,
+					 psk_id, strlen(psk_id)), 0,
+		      "Cannot add PSK ID");
+
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&server_addr.sin_addr), 1, "inet_pton failed");
+
+	server_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(server_sock >= 0, "socket open failed");
+
+	set_sec_tags(server_sock);
+
+	/* Only the clients with the option set resume their sessions */
+	zassert_equal(setsockopt(server_sock, SOL_TLS, TLS_SESSION_CACHE,
+				 &cache, sizeof(cache)), 0,
+		      "Cannot set session cache");
+
+	zassert_equal(bind(server_sock, (struct sockaddr *)&server_addr,
+			   sizeof(server_addr)), 0, "bind failed");
+	zassert_equal(listen(server_sock, 1), 0, "listen failed");
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server_fn,
+			NULL, NULL, NULL, SERVER_PRIORITY, 0, K_NO_WAIT);
+
+	connect_client();
+}
+
+static void test_send_more(void)
+{
+	/* The data sent with MSG_MORE is kept in the next record */
+	send_data(tx_data, 3, MSG_MORE);
+	send_data(tx_data + 3, 4, MSG_MORE);
+	send_data(tx_data + 7, 2, 0);
+
+	check_record(tx_data, 9);
+
+	send_data(tx_data, 10, 0);
+	check_record(tx_data, 10);
+}
+
+static void test_send_more_full(void)
+{
+	/* The buffered record is sent when the next data does not fit */
+	send_data(tx_data, RECORD_SIZE - 10, MSG_MORE);
+	send_data(tx_data, 20, MSG_MORE);
+	send_data(tx_data + 20, 5, 0);
+
+	check_record(tx_data, RECORD_SIZE - 10);
+	check_record(tx_data, 25);
+
+	/* Or when it is full */
+	send_data(tx_data, RECORD_SIZE, MSG_MORE);
+	check_record(tx_data, RECORD_SIZE);
+
+	/* Bulk data is not buffered */
+	send_data(tx_data, 5, MSG_MORE);
+	send_data(tx_data, RECORD_SIZE + 1, MSG_MORE);
+
+	check_record(tx_data, 5);
+	check_record(tx_data, RECORD_SIZE + 1);
+}
+
+static void test_send_bulk(void)
+{
+	size_t received = 0;
+	ssize_t len;
+
+	/* The data is sent in full records with a single call */
+	send_data(tx_data, BULK_SIZE, 0);
+
+	check_record(tx_data, CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN);
+	received += CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN;
+
+	while (received < BULK_SIZE) {
+		len = recv(peer_sock, rx_data + received,
+			   sizeof(rx_data) - received, 0);
+		zassert_true(len > 0, "recv failed");
+
+		received += len;
+	}
+
+	zassert_mem_equal(rx_data, tx_data, BULK_SIZE, "Wrong data");
+}
+
+static void test_sendmsg(void)
+{
+	struct iovec iov[3] = {
+		{ .iov_base = tx_data, .iov_len = 2 },
+		{ .iov_base = tx_data + 2, .iov_len = 0 },
+		{ .iov_base = tx_data + 2, .iov_len = 7 },
+	};
+	struct msghdr msg = {
+		.msg_iov = iov,
+		.msg_iovlen = ARRAY_SIZE(iov),
+	};
+
+	/* The iovecs are sent in the same record */
+	zassert_equal(sendmsg(c_sock, &msg, 0), 9, "sendmsg failed");
+	check_record(tx_data, 9);
+}
+
+static void test_close(void)
+{
+	/* The buffered data is sent before closing */
+	send_data(tx_data, 6, MSG_MORE);
+	zassert_equal(close(c_sock), 0, "close failed");
+
+	check_record(tx_data, 6);
+	zassert_equal(recv(peer_sock, rx_data, sizeof(rx_data), 0), 0,
+		      "Not closed");
+	zassert_equal(close(peer_sock), 0, "close failed");
+}
+
+/* The session is resumed with the session ticket issued by the server, or
+ * with the session ID kept in the cache of the server when the session
+ * tickets are disabled.
+ */
+static void test_session_resume(void)
+{
+	zassert_false(connect_session("server1", sec_tags),
+		      "First connection resumed");
+	zassert_true(connect_session("server1", sec_tags),
+		     "Session not resumed");
+	zassert_true(connect_session("server1", sec_tags),
+		     "Resumed session not resumed again");
+}
+
+static void test_session_other_hostname(void)
+{
+	zassert_false(connect_session("server2", sec_tags),
+		      "Session of another hostname resumed");
+
+	/* The session of the other hostname is kept */
+	zassert_true(connect_session("server1", sec_tags),
+		     "Session not resumed");
+}
+
+static void test_session_other_sec_tag(void)
+{
+	zassert_false(connect_session("server1", other_sec_tags),
+		      "Session of other secure tags resumed");
+
+	/* The session of the other secure tags is kept */
+	zassert_true(connect_session("server1", sec_tags),
+		     "Session not resumed");
+}
+
+static void test_teardown(void)
+{
+	zassert_equal(close(server_sock), 0, "close failed");
+	k_thread_abort(&server_thread);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_tls,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_more),
+			 ztest_unit_test(test_send_more_full),
+			 ztest_unit_test(test_send_bulk),
+			 ztest_unit_test(test_sendmsg),
+			 ztest_unit_test(test_close),
+			 ztest_unit_test(test_session_resume),
+			 ztest_unit_test(test_session_other_hostname),
+			 ztest_unit_test(test_session_other_sec_tag),
+			 ztest_unit_test(test_teardown));
+
+	ztest_run_test_suite(socket_tls);
+}
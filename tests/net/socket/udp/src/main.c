@@ -301,6 +301,479 @@ void test_send_recv_2_sock(void)
 	zassert_equal(rv, 0, "close failed");
 }
 
+/* Common routine to send a datagram with sendmsg() in several pieces
+ * and receive it with recvmsg() into several buffers.
+ */
+static void comm_sendmsg_recvmsg(int client_sock,
+				 int server_sock,
+				 struct sockaddr *server_addr,
+				 socklen_t server_addrlen,
+				 int pktinfo_level,
+				 int pktinfo_type)
+{
+	static char rx_buf1[20];
+	static char rx_buf2[400];
+	struct iovec tx_iov[3] = {
+		{ .iov_base = TEST_STR2, .iov_len = 10 },
+		{ .iov_base = TEST_STR2 + 10, .iov_len = 90 },
+		{ .iov_base = TEST_STR2 + 100, .iov_len = STRLEN(TEST_STR2) - 100 },
+	};
+	struct iovec rx_iov[2] = {
+		{ .iov_base = rx_buf1, .iov_len = sizeof(rx_buf1) },
+		{ .iov_base = rx_buf2, .iov_len = sizeof(rx_buf2) },
+	};
+	u8_t control[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+	struct sockaddr_storage addr;
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	ssize_t sent, recved;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = server_addr;
+	msg.msg_namelen = server_addrlen;
+	msg.msg_iov = tx_iov;
+	msg.msg_iovlen = ARRAY_SIZE(tx_iov);
+
+	sent = sendmsg(client_sock, &msg, 0);
+	zassert_equal(sent, STRLEN(TEST_STR2), "sendmsg failed");
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &addr;
+	msg.msg_namelen = sizeof(addr);
+	msg.msg_iov = rx_iov;
+	msg.msg_iovlen = ARRAY_SIZE(rx_iov);
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	clear_buf(rx_buf1);
+	clear_buf(rx_buf2);
+	recved = recvmsg(server_sock, &msg, 0);
+	zassert_equal(recved, STRLEN(TEST_STR2), "unexpected received bytes");
+	zassert_mem_equal(rx_buf1, TEST_STR2, sizeof(rx_buf1), "wrong data");
+	zassert_mem_equal(rx_buf2, TEST_STR2 + sizeof(rx_buf1),
+			  STRLEN(TEST_STR2) - sizeof(rx_buf1), "wrong data");
+	zassert_equal(msg.msg_flags, 0, "unexpected flags");
+	zassert_equal(addr.ss_family, server_addr->sa_family,
+		      "unexpected family");
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	zassert_not_null(cmsg, "no packet info");
+	zassert_equal(cmsg->cmsg_level, pktinfo_level, "wrong cmsg level");
+	zassert_equal(cmsg->cmsg_type, pktinfo_type, "wrong cmsg type");
+
+	if (pktinfo_type == IP_PKTINFO) {
+		struct in_pktinfo *info = (struct in_pktinfo *)CMSG_DATA(cmsg);
+
+		zassert_true(net_ipv4_addr_cmp(&info->ipi_addr,
+					       &net_sin(server_addr)->sin_addr),
+			     "wrong destination address");
+		zassert_true(info->ipi_ifindex > 0, "wrong interface");
+	} else {
+		struct in6_pktinfo *info =
+			(struct in6_pktinfo *)CMSG_DATA(cmsg);
+
+		zassert_true(net_ipv6_addr_cmp(&info->ipi6_addr,
+					&net_sin6(server_addr)->sin6_addr),
+			     "wrong destination address");
+		zassert_true(info->ipi6_ifindex > 0, "wrong interface");
+	}
+
+	zassert_is_null(CMSG_NXTHDR(&msg, cmsg), "unexpected cmsg");
+
+	/* Datagram and control data that do not fit are truncated */
+	sent = sendmsg(client_sock, &(struct msghdr){
+				.msg_name = server_addr,
+				.msg_namelen = server_addrlen,
+				.msg_iov = tx_iov,
+				.msg_iovlen = ARRAY_SIZE(tx_iov) }, 0);
+	zassert_equal(sent, STRLEN(TEST_STR2), "sendmsg failed");
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = rx_iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(struct cmsghdr);
+
+	recved = recvmsg(server_sock, &msg, 0);
+	zassert_equal(recved, sizeof(rx_buf1), "unexpected received bytes");
+	zassert_equal(msg.msg_flags, MSG_TRUNC | MSG_CTRUNC,
+		      "unexpected flags");
+	zassert_equal(msg.msg_controllen, 0, "unexpected control data");
+}
+
+void test_v4_sendmsg_recvmsg(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	int optval = 1;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = setsockopt(server_sock, IPPROTO_IP, IP_PKTINFO,
+			&optval, sizeof(optval));
+	zassert_equal(rv, 0, "setsockopt failed");
+
+	comm_sendmsg_recvmsg(client_sock,
+			     server_sock,
+			     (struct sockaddr *)&server_addr,
+			     sizeof(server_addr),
+			     IPPROTO_IP, IP_PKTINFO);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v6_sendmsg_recvmsg(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	int optval = 1;
+	struct sockaddr_in6 client_addr;
+	struct sockaddr_in6 server_addr;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	rv = setsockopt(server_sock, IPPROTO_IPV6, IPV6_RECVPKTINFO,
+			&optval, sizeof(optval));
+	zassert_equal(rv, 0, "setsockopt failed");
+
+	comm_sendmsg_recvmsg(client_sock,
+			     server_sock,
+			     (struct sockaddr *)&server_addr,
+			     sizeof(server_addr),
+			     IPPROTO_IPV6, IPV6_PKTINFO);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+#define MMSG_COUNT 4
+
+void test_v4_sendmmsg_recvmmsg(void)
+{
+	static char rx_buf[MMSG_COUNT][sizeof(TEST_STR_SMALL)];
+	struct mmsghdr tx_msgs[MMSG_COUNT];
+	struct mmsghdr rx_msgs[MMSG_COUNT + 1];
+	struct iovec tx_iov[MMSG_COUNT];
+	struct iovec rx_iov[MMSG_COUNT + 1];
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	int client_sock;
+	int server_sock;
+	int rv, i;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	memset(tx_msgs, 0, sizeof(tx_msgs));
+	memset(rx_msgs, 0, sizeof(rx_msgs));
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		tx_iov[i].iov_base = TEST_STR_SMALL;
+		tx_iov[i].iov_len = STRLEN(TEST_STR_SMALL) - i;
+		tx_msgs[i].msg_hdr.msg_name = &server_addr;
+		tx_msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+		tx_msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+		tx_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	for (i = 0; i < MMSG_COUNT + 1; i++) {
+		rx_iov[i].iov_base = rx_buf[i % MMSG_COUNT];
+		rx_iov[i].iov_len = sizeof(rx_buf[0]);
+		rx_msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+		rx_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	rv = sendmmsg(client_sock, tx_msgs, MMSG_COUNT, 0);
+	zassert_equal(rv, MMSG_COUNT, "sendmmsg failed");
+
+	/* Only the queued datagrams are returned, without blocking */
+	rv = recvmmsg(server_sock, rx_msgs, MMSG_COUNT + 1, 0);
+	zassert_equal(rv, MMSG_COUNT, "recvmmsg failed");
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(tx_msgs[i].msg_len, STRLEN(TEST_STR_SMALL) - i,
+			      "wrong sent length");
+		zassert_equal(rx_msgs[i].msg_len, STRLEN(TEST_STR_SMALL) - i,
+			      "wrong received length");
+		zassert_mem_equal(rx_buf[i], TEST_STR_SMALL,
+				  rx_msgs[i].msg_len, "wrong data");
+	}
+
+	rv = recvmmsg(server_sock, rx_msgs, MMSG_COUNT, MSG_DONTWAIT);
+	zassert_equal(rv, -1, "recvmmsg should fail");
+	zassert_equal(errno, EAGAIN, "unexpected errno");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+#define ZC_LARGE_LEN 300
+
+static void send_zc_test_data(int sock, struct sockaddr_in *addr,
+			      const void *data, size_t len)
+{
+	ssize_t rv;
+
+	rv = sendto(sock, data, len, 0, (struct sockaddr *)addr,
+		    sizeof(*addr));
+	zassert_equal(rv, len, "sendto failed");
+}
+
+static ssize_t recv_zc(int sock, struct zsock_zerocopy_rx *zc,
+		       struct iovec *iov, size_t iovcnt)
+{
+	zc->iov = iov;
+	zc->iovcnt = iovcnt;
+
+	return zsock_recv_zerocopy(sock, zc, MSG_DONTWAIT);
+}
+
+void test_v4_recv_zerocopy(void)
+{
+	static char large_buf[ZC_LARGE_LEN];
+	struct zsock_zerocopy_rx zc, zc2;
+	struct iovec iov[4];
+	struct iovec iov2[4];
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	int client_sock;
+	int server_sock;
+	size_t len;
+	ssize_t rv;
+	int i;
+
+	for (i = 0; i < sizeof(large_buf); i++) {
+		large_buf[i] = i % 251;
+	}
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "bind failed");
+
+	/* Each datagram is lent as a whole, and stays valid while the
+	 * next ones are received.
+	 */
+	send_zc_test_data(client_sock, &server_addr,
+			  BUF_AND_SIZE(TEST_STR_SMALL));
+	rv = recv_zc(server_sock, &zc, iov, ARRAY_SIZE(iov));
+	zassert_equal(rv, STRLEN(TEST_STR_SMALL), "wrong length");
+	zassert_equal(zc.iovcnt, 1, "wrong fragment count");
+	zassert_equal(iov[0].iov_len, rv, "wrong fragment length");
+
+	send_zc_test_data(client_sock, &server_addr,
+			  BUF_AND_SIZE(TEST_STR_SMALL));
+	rv = recv_zc(server_sock, &zc2, iov2, ARRAY_SIZE(iov2));
+	zassert_equal(rv, STRLEN(TEST_STR_SMALL), "wrong length");
+	zassert_not_equal(iov2[0].iov_base, iov[0].iov_base,
+			  "data not lent from the datagram");
+	zassert_mem_equal(iov2[0].iov_base, TEST_STR_SMALL, rv, "wrong data");
+	zassert_mem_equal(iov[0].iov_base, TEST_STR_SMALL,
+			  STRLEN(TEST_STR_SMALL), "lent data changed");
+
+	zassert_equal(zsock_recv_zerocopy_release(server_sock, &zc), 0,
+		      "release failed");
+	zassert_equal(zsock_recv_zerocopy_release(server_sock, &zc2), 0,
+		      "release failed");
+	zassert_equal(zsock_recv_zerocopy_release(server_sock, &zc), 0,
+		      "second release failed");
+
+	/* Released packets are freed, so more datagrams than there are
+	 * packets can be received.
+	 */
+	for (i = 0; i < 2 * CONFIG_NET_PKT_RX_COUNT; i++) {
+		send_zc_test_data(client_sock, &server_addr,
+				  BUF_AND_SIZE(TEST_STR_SMALL));
+		rv = recv_zc(server_sock, &zc, iov, ARRAY_SIZE(iov));
+		zassert_equal(rv, STRLEN(TEST_STR_SMALL),
+			      "recv failed after %d datagrams", i);
+		zassert_equal(zsock_recv_zerocopy_release(server_sock, &zc),
+			      0, "release failed");
+	}
+
+	/* A datagram larger than a network buffer spans several
+	 * fragments.
+	 */
+	send_zc_test_data(client_sock, &server_addr, large_buf,
+			  sizeof(large_buf));
+	rv = recv_zc(server_sock, &zc, iov, ARRAY_SIZE(iov));
+	zassert_equal(rv, sizeof(large_buf), "wrong length");
+	zassert_true(zc.iovcnt > 1, "expected several fragments");
+
+	for (i = 0, len = 0; i < zc.iovcnt; i++) {
+		zassert_mem_equal(iov[i].iov_base, large_buf + len,
+				  iov[i].iov_len, "wrong data");
+		len += iov[i].iov_len;
+	}
+
+	zassert_equal(len, sizeof(large_buf), "wrong fragment lengths");
+	zassert_equal(zsock_recv_zerocopy_release(server_sock, &zc), 0,
+		      "release failed");
+
+	/* The part of a datagram that does not fit into the iov array is
+	 * discarded, and the next call returns the next datagram.
+	 */
+	send_zc_test_data(client_sock, &server_addr, large_buf,
+			  sizeof(large_buf));
+	send_zc_test_data(client_sock, &server_addr,
+			  BUF_AND_SIZE(TEST_STR_SMALL));
+
+	rv = recv_zc(server_sock, &zc, iov, 1);
+	zassert_true(rv > 0 && rv < sizeof(large_buf), "not truncated");
+	zassert_equal(zc.iovcnt, 1, "wrong fragment count");
+	zassert_equal(iov[0].iov_len, rv, "wrong fragment length");
+	zassert_mem_equal(iov[0].iov_base, large_buf, rv, "wrong data");
+	zassert_equal(zsock_recv_zerocopy_release(server_sock, &zc), 0,
+		      "release failed");
+
+	rv = recv_zc(server_sock, &zc, iov, ARRAY_SIZE(iov));
+	zassert_equal(rv, STRLEN(TEST_STR_SMALL), "wrong length");
+	zassert_mem_equal(iov[0].iov_base, TEST_STR_SMALL, rv, "wrong data");
+	zassert_equal(zsock_recv_zerocopy_release(server_sock, &zc), 0,
+		      "release failed");
+
+	rv = recv_zc(server_sock, &zc, iov, ARRAY_SIZE(iov));
+	zassert_equal(rv, -1, "recv should fail");
+	zassert_equal(errno, EAGAIN, "unexpected errno");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+#define REUSEPORT_FLOWS 8
+
+static int recv_count(int sock)
+{
+	char buf[sizeof(TEST_STR_SMALL)];
+	int count = 0;
+
+	while (recv(sock, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+		count++;
+	}
+
+	return count;
+}
+
+void test_v4_reuseport(void)
+{
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	int server_socks[2];
+	int client_sock;
+	int sock;
+	int counts[2];
+	int used = 0;
+	int optval = 1;
+	socklen_t optlen = sizeof(optval);
+	int rv, i;
+
+	for (i = 0; i < ARRAY_SIZE(server_socks); i++) {
+		prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+				    &server_socks[i], &server_addr);
+
+		rv = setsockopt(server_socks[i], SOL_SOCKET, SO_REUSEPORT,
+				&optval, sizeof(optval));
+		zassert_equal(rv, 0, "setsockopt failed");
+
+		rv = bind(server_socks[i], (struct sockaddr *)&server_addr,
+			  sizeof(server_addr));
+		zassert_equal(rv, 0, "bind failed");
+	}
+
+	rv = getsockopt(server_socks[0], SOL_SOCKET, SO_REUSEPORT,
+			&optval, &optlen);
+	zassert_equal(rv, 0, "getsockopt failed");
+	zassert_equal(optval, 1, "option not set");
+
+	/* All the sockets sharing the port must have the option set */
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &sock, &server_addr);
+	rv = bind(sock, (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, -1, "bind should fail");
+	rv = close(sock);
+	zassert_equal(rv, 0, "close failed");
+
+	/* Every flow is sent twice, and must stick to the same socket */
+	for (i = 0; i < REUSEPORT_FLOWS; i++) {
+		prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				    CLIENT_PORT + i, &client_sock,
+				    &client_addr);
+
+		rv = bind(client_sock, (struct sockaddr *)&client_addr,
+			  sizeof(client_addr));
+		zassert_equal(rv, 0, "bind failed");
+
+		rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0,
+			    (struct sockaddr *)&server_addr,
+			    sizeof(server_addr));
+		zassert_equal(rv, STRLEN(TEST_STR_SMALL), "sendto failed");
+		rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0,
+			    (struct sockaddr *)&server_addr,
+			    sizeof(server_addr));
+		zassert_equal(rv, STRLEN(TEST_STR_SMALL), "sendto failed");
+
+		k_sleep(K_MSEC(10));
+
+		counts[0] = recv_count(server_socks[0]);
+		counts[1] = recv_count(server_socks[1]);
+		zassert_true((counts[0] == 2 && counts[1] == 0) ||
+			     (counts[0] == 0 && counts[1] == 2),
+			     "flow %d split among sockets", i);
+
+		rv = close(client_sock);
+		zassert_equal(rv, 0, "close failed");
+
+		used |= counts[0] ? BIT(0) : BIT(1);
+	}
+
+	zassert_equal(used, BIT(0) | BIT(1), "flows not spread among sockets");
+
+	for (i = 0; i < ARRAY_SIZE(server_socks); i++) {
+		rv = close(server_socks[i]);
+		zassert_equal(rv, 0, "close failed");
+	}
+}
+
 void test_main(void)
 {
 	ztest_test_suite(socket_udp,
@@ -308,7 +781,12 @@ void test_main(void)
 			 ztest_unit_test(test_v4_sendto_recvfrom),
 			 ztest_unit_test(test_v6_sendto_recvfrom),
 			 ztest_unit_test(test_v4_bind_sendto),
-			 ztest_unit_test(test_v6_bind_sendto));
+			 ztest_unit_test(test_v6_bind_sendto),
+			 ztest_unit_test(test_v4_sendmsg_recvmsg),
+			 ztest_unit_test(test_v6_sendmsg_recvmsg),
+			 ztest_unit_test(test_v4_sendmmsg_recvmmsg),
+			 ztest_unit_test(test_v4_recv_zerocopy),
+			 ztest_unit_test(test_v4_reuseport));
 
 	ztest_run_test_suite(socket_udp);
 }
@@ -0,0 +1,209 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TC_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_mgmt.h>
+#include <net/net_stats.h>
+
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+
+#define FLOW_COUNT 16
+#define PKTS_PER_FLOW 4
+
+#define MY_PORT 4242
+#define PEER_PORT_BASE 10000
+
+#define WAIT_TIME K_SECONDS(1)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+struct flow_data {
+	u8_t flow;
+	u8_t seq;
+};
+
+/* Thread that handled each flow, and the next expected sequence number */
+static k_tid_t flow_thread[FLOW_COUNT];
+static u8_t flow_seq[FLOW_COUNT];
+static bool flow_ok = true;
+
+static K_SEM_DEFINE(recv_sem, 0, UINT_MAX);
+
+static int tester_init(struct device *dev)
+{
+	return 0;
+}
+
+static void tester_iface_init(struct net_if *iface)
+{
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	static u8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int tester_send(struct device *dev, struct net_pkt *pkt)
+{
+	net_pkt_unref(pkt);
+
+	return 0;
+}
+
+static struct dummy_api tester_api = {
+	.iface_api.init = tester_iface_init,
+	.send = tester_send,
+};
+
+NET_DEVICE_INIT(net_tc_flow_test, "net_tc_flow_test", tester_init, NULL,
+		NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &tester_api,
+		DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+static enum net_verdict udp_cb(struct net_conn *conn,
+			       struct net_pkt *pkt,
+			       union net_ip_header *ip_hdr,
+			       union net_proto_header *proto_hdr,
+			       void *user_data)
+{
+	struct flow_data data;
+
+	if (net_pkt_read(pkt, &data, sizeof(data)) ||
+	    data.flow >= FLOW_COUNT) {
+		flow_ok = false;
+		goto out;
+	}
+
+	if (!flow_thread[data.flow]) {
+		flow_thread[data.flow] = k_current_get();
+	}
+
+	/* A flow must be handled by one queue, in order */
+	if (flow_thread[data.flow] != k_current_get() ||
+	    flow_seq[data.flow] != data.seq) {
+		flow_ok = false;
+	}
+
+	flow_seq[data.flow]++;
+
+out:
+	net_pkt_unref(pkt);
+	k_sem_give(&recv_sem);
+
+	return NET_OK;
+}
+
+static void test_setup(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_port = htons(MY_PORT),
+	};
+	int ret;
+
+	zassert_not_null(net_if_ipv4_addr_add(iface, &my_addr,
+					      NET_ADDR_MANUAL, 0),
+			 "Cannot add IPv4 address");
+
+	net_ipaddr_copy(&local.sin_addr, &my_addr);
+
+	ret = net_udp_register(AF_INET, NULL, (struct sockaddr *)&local,
+			       0, MY_PORT, udp_cb, NULL, NULL);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+}
+
+static void recv_udp_pkt(u8_t flow, u8_t seq)
+{
+	struct net_if *iface = net_if_get_default();
+	struct flow_data data = { .flow = flow, .seq = seq };
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, sizeof(data), AF_INET,
+					   IPPROTO_UDP, WAIT_TIME);
+	zassert_not_null(pkt, "Out of mem");
+
+	zassert_equal(net_ipv4_create(pkt, &peer_addr, &my_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_udp_create(pkt, htons(PEER_PORT_BASE + flow),
+				     htons(MY_PORT)), 0,
+		      "Cannot create UDP header");
+	zassert_equal(net_pkt_write(pkt, &data, sizeof(data)), 0,
+		      "Cannot write data");
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	zassert_true(net_recv_data(iface, pkt) >= 0, "Cannot receive packet");
+}
+
+static void test_flow_hash(void)
+{
+	struct net_stats stats;
+	int queues_used = 0;
+	u32_t total = 0U;
+	int flow, seq, i;
+
+	/* The packets of the flows are interleaved */
+	for (seq = 0; seq < PKTS_PER_FLOW; seq++) {
+		for (flow = 0; flow < FLOW_COUNT; flow++) {
+			recv_udp_pkt(flow, seq);
+		}
+	}
+
+	for (i = 0; i < FLOW_COUNT * PKTS_PER_FLOW; i++) {
+		zassert_equal(k_sem_take(&recv_sem, WAIT_TIME), 0,
+			      "Packet %d not received", i);
+	}
+
+	zassert_true(flow_ok, "Flow handled out of order or by many queues");
+
+	zassert_equal(net_mgmt(NET_REQUEST_STATS_GET_ALL, NULL,
+			       &stats, sizeof(stats)), 0,
+		      "Cannot get statistics");
+
+	for (i = 0; i < NET_TC_RX_COUNT; i++) {
+		total += stats.tc.recv[i].pkts;
+
+		if (stats.tc.recv[i].pkts) {
+			queues_used++;
+		}
+	}
+
+	zassert_equal(total, FLOW_COUNT * PKTS_PER_FLOW,
+		      "Invalid queue statistics");
+	zassert_true(queues_used > 1, "Flows not spread among queues");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tc_flow_hash_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_flow_hash)
+			 );
+
+	ztest_run_test_suite(net_tc_flow_hash_test);
+}
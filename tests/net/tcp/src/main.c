@@ -681,7 +681,7 @@ static bool test_register(void)
 		ret = net_tcp_register(family,				\
 				       (struct sockaddr *)raddr,	\
 				       (struct sockaddr *)laddr,	\
-				       rport, lport,			\
+				       rport, lport, NULL,		\
 				       test_ok, &user_data,		\
 				       &handlers[i]);			\
 		if (ret) {						\
@@ -697,7 +697,7 @@ static bool test_register(void)
 	ret = net_tcp_register(AF_INET,					\
 			       (struct sockaddr *)raddr,		\
 			       (struct sockaddr *)laddr,		\
-			       rport, lport,				\
+			       rport, lport, NULL,			\
 			       test_fail, INT_TO_POINTER(0), NULL);	\
 	if (!ret) {							\
 		DBG("TCP register invalid match %s failed\n",		\
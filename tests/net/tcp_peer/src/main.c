@@ -0,0 +1,767 @@
+/* main.c - TCP tests against a scripted peer */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define NET_LOG_LEVEL CONFIG_NET_TCP_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, NET_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+
+#include "tcp_internal.h"
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#if NET_LOG_LEVEL >= LOG_LEVEL_DBG
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+#define WAIT_TIME K_MSEC(500)
+
+/* Small MTU so that a few hundred bytes of data already span several
+ * segments.
+ */
+#define TEST_MTU 576
+#define PEER_MSS 500
+#define PEER_PORT 4242
+
+#define FRAME_MAX 2048
+#define ETH_HDR_LEN sizeof(struct net_eth_hdr)
+#define IPV4_HDR_LEN sizeof(struct net_ipv4_hdr)
+#define TCP_HDR_LEN sizeof(struct net_tcp_hdr)
+
+static struct in_addr my_addr_no_tso = { { { 192, 0, 2, 1 } } };
+static struct in_addr my_addr_tso = { { { 198, 51, 100, 1 } } };
+static struct in_addr peer_addr_no_tso = { { { 192, 0, 2, 2 } } };
+static struct in_addr peer_addr_tso = { { { 198, 51, 100, 2 } } };
+static struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+
+static u8_t peer_mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0xfe };
+
+/* Frames sent by the stack. The driver copies each frame to the next
+ * slot of a ring, the test is always far enough behind.
+ */
+struct frame {
+	struct net_if *iface;
+	u16_t gso_size;
+	u16_t len;
+	u8_t data[FRAME_MAX];
+};
+
+static struct frame frames[16];
+static atomic_t frame_next;
+
+K_MSGQ_DEFINE(frame_queue, sizeof(struct frame *), ARRAY_SIZE(frames), 4);
+
+struct eth_context {
+	struct net_if *iface;
+	u8_t mac_addr[6];
+};
+
+static struct eth_context eth_context_no_tso;
+static struct eth_context eth_context_tso;
+
+static struct net_if *iface_no_tso;
+static struct net_if *iface_tso;
+
+/* One connection to the peer */
+struct test_conn {
+	struct net_if *iface;
+	struct net_context *ctx;
+	struct in_addr *my_addr;
+	struct in_addr *peer_addr;
+	u16_t port;
+	/* Next sequence number of the stack and of the peer */
+	u32_t seq;
+	u32_t peer_seq;
+};
+
+static K_SEM_DEFINE(recv_sem, 0, UINT_MAX);
+static u8_t recv_data[4096];
+static size_t recv_len;
+static int recv_calls;
+
+static inline struct net_ipv4_hdr *frame_ipv4(struct frame *frame)
+{
+	return (struct net_ipv4_hdr *)(frame->data + ETH_HDR_LEN);
+}
+
+static inline struct net_tcp_hdr *frame_tcp(struct frame *frame)
+{
+	return (struct net_tcp_hdr *)(frame->data + ETH_HDR_LEN +
+				      IPV4_HDR_LEN);
+}
+
+static inline u8_t *frame_payload(struct frame *frame)
+{
+	return (u8_t *)frame_tcp(frame) + NET_TCP_HDR_LEN(frame_tcp(frame));
+}
+
+static inline u16_t frame_payload_len(struct frame *frame)
+{
+	return ntohs(frame_ipv4(frame)->len) - IPV4_HDR_LEN -
+		NET_TCP_HDR_LEN(frame_tcp(frame));
+}
+
+static u32_t chksum_add(u32_t sum, const u8_t *data, size_t len)
+{
+	while (len > 1) {
+		sum += (data[0] << 8) | data[1];
+		data += 2;
+		len -= 2;
+	}
+
+	if (len) {
+		sum += data[0] << 8;
+	}
+
+	return sum;
+}
+
+static u16_t chksum_fold(u32_t sum)
+{
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return sum;
+}
+
+static u16_t tcp_chksum(struct net_ipv4_hdr *ip, u8_t *tcp, u16_t len)
+{
+	u32_t sum;
+
+	sum = chksum_add(0, (u8_t *)&ip->src, 2 * sizeof(struct in_addr));
+	sum += IPPROTO_TCP + len;
+
+	return chksum_fold(chksum_add(sum, tcp, len));
+}
+
+static void check_frame_chksums(struct frame *frame)
+{
+	struct net_ipv4_hdr *ip = frame_ipv4(frame);
+	u16_t len = ntohs(ip->len) - IPV4_HDR_LEN;
+
+	zassert_equal(chksum_fold(chksum_add(0, (u8_t *)ip, IPV4_HDR_LEN)),
+		      0xffff, "Invalid IPv4 checksum");
+	zassert_equal(tcp_chksum(ip, (u8_t *)frame_tcp(frame), len), 0xffff,
+		      "Invalid TCP checksum");
+}
+
+static void eth_iface_init(struct net_if *iface)
+{
+	struct device *dev = net_if_get_device(iface);
+	struct eth_context *context = dev->driver_data;
+
+	context->iface = iface;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr),
+			     NET_LINK_ETHERNET);
+
+	ethernet_init(iface);
+}
+
+static int eth_tx(struct device *dev, struct net_pkt *pkt)
+{
+	struct frame *frame;
+
+	frame = &frames[atomic_inc(&frame_next) % ARRAY_SIZE(frames)];
+
+	frame->iface = net_pkt_iface(pkt);
+	frame->gso_size = net_pkt_gso_size(pkt);
+	frame->len = net_pkt_get_len(pkt);
+
+	if (frame->len > sizeof(frame->data)) {
+		return -EMSGSIZE;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_read(pkt, frame->data, frame->len)) {
+		return -EIO;
+	}
+
+	if (frame->len < ETH_HDR_LEN + IPV4_HDR_LEN + TCP_HDR_LEN ||
+	    frame_ipv4(frame)->proto != IPPROTO_TCP) {
+		return 0;
+	}
+
+	DBG("Frame %p len %u seq %u flags 0x%02x\n", frame, frame->len,
+	    sys_get_be32(frame_tcp(frame)->seq), frame_tcp(frame)->flags);
+
+	k_msgq_put(&frame_queue, &frame, K_NO_WAIT);
+
+	return 0;
+}
+
+static enum ethernet_hw_caps eth_caps_no_tso(struct device *dev)
+{
+	return 0;
+}
+
+static enum ethernet_hw_caps eth_caps_tso(struct device *dev)
+{
+	return ETHERNET_HW_TX_TSO;
+}
+
+static struct ethernet_api api_funcs_no_tso = {
+	.iface_api.init = eth_iface_init,
+
+	.get_capabilities = eth_caps_no_tso,
+	.send = eth_tx,
+};
+
+static struct ethernet_api api_funcs_tso = {
+	.iface_api.init = eth_iface_init,
+
+	.get_capabilities = eth_caps_tso,
+	.send = eth_tx,
+};
+
+static int eth_init(struct device *dev)
+{
+	struct eth_context *context = dev->driver_data;
+
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	context->mac_addr[0] = 0x00;
+	context->mac_addr[1] = 0x00;
+	context->mac_addr[2] = 0x5E;
+	context->mac_addr[3] = 0x00;
+	context->mac_addr[4] = 0x53;
+	context->mac_addr[5] = context == &eth_context_tso ? 0x02 : 0x01;
+
+	return 0;
+}
+
+ETH_NET_DEVICE_INIT(eth_no_tso_test, "eth_no_tso_test",
+		    eth_init, &eth_context_no_tso,
+		    NULL, CONFIG_ETH_INIT_PRIORITY,
+		    &api_funcs_no_tso, NET_ETH_MTU);
+
+ETH_NET_DEVICE_INIT(eth_tso_test, "eth_tso_test",
+		    eth_init, &eth_context_tso,
+		    NULL, CONFIG_ETH_INIT_PRIORITY,
+		    &api_funcs_tso, NET_ETH_MTU);
+
+/* Next frame the stack sent on the connection */
+static struct frame *get_frame(struct test_conn *conn, s32_t timeout)
+{
+	struct frame *frame;
+
+	while (!k_msgq_get(&frame_queue, &frame, timeout)) {
+		if (frame->iface == conn->iface &&
+		    ntohs(frame_tcp(frame)->src_port) == conn->port) {
+			return frame;
+		}
+	}
+
+	return NULL;
+}
+
+/* Inject a segment from the peer */
+static void peer_send(struct test_conn *conn, u8_t flags,
+		      const u8_t *data, u16_t len)
+{
+	static u8_t buf[FRAME_MAX];
+	struct net_linkaddr *lladdr = net_if_get_link_addr(conn->iface);
+	struct net_eth_hdr *eth = (struct net_eth_hdr *)buf;
+	struct net_ipv4_hdr *ip = (struct net_ipv4_hdr *)(buf + ETH_HDR_LEN);
+	struct net_tcp_hdr *tcp = (struct net_tcp_hdr *)(buf + ETH_HDR_LEN +
+							 IPV4_HDR_LEN);
+	u16_t tcp_len = TCP_HDR_LEN;
+	struct net_pkt *pkt;
+
+	memset(buf, 0, ETH_HDR_LEN + IPV4_HDR_LEN + TCP_HDR_LEN + 4);
+
+	memcpy(eth->dst.addr, lladdr->addr, sizeof(eth->dst.addr));
+	memcpy(eth->src.addr, peer_mac, sizeof(eth->src.addr));
+	eth->type = htons(NET_ETH_PTYPE_IP);
+
+	if (flags & NET_TCP_SYN) {
+		/* MSS option */
+		tcp->optdata[0] = NET_TCP_MSS_OPT;
+		tcp->optdata[1] = NET_TCP_MSS_SIZE;
+		sys_put_be16(PEER_MSS, &tcp->optdata[2]);
+		tcp_len += NET_TCP_MSS_SIZE;
+	}
+
+	tcp->src_port = htons(PEER_PORT);
+	tcp->dst_port = htons(conn->port);
+	sys_put_be32(conn->peer_seq, tcp->seq);
+	sys_put_be32(conn->seq, tcp->ack);
+	tcp->offset = (tcp_len / 4) << 4;
+	tcp->flags = flags;
+	sys_put_be16(UINT16_MAX, tcp->wnd);
+
+	memcpy((u8_t *)tcp + tcp_len, data, len);
+	tcp_len += len;
+
+	ip->vhl = 0x45;
+	ip->len = htons(IPV4_HDR_LEN + tcp_len);
+	ip->ttl = 64;
+	ip->proto = IPPROTO_TCP;
+	net_ipaddr_copy(&ip->src, conn->peer_addr);
+	net_ipaddr_copy(&ip->dst, conn->my_addr);
+	ip->chksum = htons(~chksum_fold(chksum_add(0, (u8_t *)ip,
+						   IPV4_HDR_LEN)));
+
+	tcp->chksum = htons(~tcp_chksum(ip, (u8_t *)tcp, tcp_len));
+
+	pkt = net_pkt_rx_alloc_with_buffer(conn->iface,
+					   ETH_HDR_LEN + IPV4_HDR_LEN + tcp_len,
+					   AF_UNSPEC, 0, K_FOREVER);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	zassert_equal(net_pkt_write(pkt, buf, ETH_HDR_LEN + IPV4_HDR_LEN +
+				    tcp_len), 0, "Cannot write pkt");
+
+	zassert_equal(net_recv_data(conn->iface, pkt), 0, "Cannot inject pkt");
+
+	conn->peer_seq += len;
+	if (flags & (NET_TCP_SYN | NET_TCP_FIN)) {
+		conn->peer_seq++;
+	}
+}
+
+static void recv_cb(struct net_context *context, struct net_pkt *pkt,
+		    union net_ip_header *ip_hdr,
+		    union net_proto_header *proto_hdr,
+		    int status, void *user_data)
+{
+	size_t len;
+
+	if (!pkt) {
+		return;
+	}
+
+	len = net_pkt_remaining_data(pkt);
+
+	DBG("Received %zu bytes\n", len);
+
+	if (recv_len + len <= sizeof(recv_data) &&
+	    !net_pkt_read(pkt, recv_data + recv_len, len)) {
+		recv_len += len;
+	}
+
+	recv_calls++;
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&recv_sem);
+}
+
+static void conn_open(struct test_conn *conn, struct net_if *iface,
+		      u16_t port)
+{
+	struct sockaddr_in my_addr = { 0 };
+	struct sockaddr_in peer_addr = { 0 };
+	struct net_tcp_hdr *tcp;
+	struct frame *frame;
+	int ret;
+
+	conn->iface = iface;
+	conn->port = port;
+	conn->peer_seq = sys_rand32_get();
+
+	if (iface == iface_tso) {
+		conn->my_addr = &my_addr_tso;
+		conn->peer_addr = &peer_addr_tso;
+	} else {
+		conn->my_addr = &my_addr_no_tso;
+		conn->peer_addr = &peer_addr_no_tso;
+	}
+
+	my_addr.sin_family = AF_INET;
+	my_addr.sin_port = htons(port);
+	net_ipaddr_copy(&my_addr.sin_addr, conn->my_addr);
+
+	peer_addr.sin_family = AF_INET;
+	peer_addr.sin_port = htons(PEER_PORT);
+	net_ipaddr_copy(&peer_addr.sin_addr, conn->peer_addr);
+
+	k_msgq_purge(&frame_queue);
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &conn->ctx);
+	zassert_equal(ret, 0, "Cannot get context (%d)", ret);
+
+	ret = net_context_bind(conn->ctx, (struct sockaddr *)&my_addr,
+			       sizeof(my_addr));
+	zassert_equal(ret, 0, "Cannot bind (%d)", ret);
+
+	ret = net_context_connect(conn->ctx, (struct sockaddr *)&peer_addr,
+				  sizeof(peer_addr), NULL, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot connect (%d)", ret);
+
+	frame = get_frame(conn, WAIT_TIME);
+	zassert_not_null(frame, "No SYN sent");
+
+	tcp = frame_tcp(frame);
+	zassert_equal(NET_TCP_FLAGS(tcp), NET_TCP_SYN, "Not a SYN");
+
+	conn->seq = sys_get_be32(tcp->seq) + 1;
+
+	peer_send(conn, NET_TCP_SYN | NET_TCP_ACK, NULL, 0);
+
+	frame = get_frame(conn, WAIT_TIME);
+	zassert_not_null(frame, "No ACK for SYN-ACK sent");
+	zassert_equal(NET_TCP_FLAGS(frame_tcp(frame)), NET_TCP_ACK,
+		      "Not an ACK");
+	zassert_equal(sys_get_be32(frame_tcp(frame)->ack), conn->peer_seq,
+		      "Invalid ACK");
+
+	recv_len = 0;
+	recv_calls = 0;
+	k_sem_reset(&recv_sem);
+
+	ret = net_context_recv(conn->ctx, recv_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot set recv callback (%d)", ret);
+}
+
+static void conn_close(struct test_conn *conn)
+{
+	net_context_put(conn->ctx);
+
+	/* Do not wait for the peer to close, or for our unacked data to
+	 * time out.
+	 */
+	peer_send(conn, NET_TCP_ACK | NET_TCP_RST, NULL, 0);
+}
+
+static void test_init(void)
+{
+	struct net_if_addr *ifaddr;
+
+	iface_no_tso = eth_context_no_tso.iface;
+	iface_tso = eth_context_tso.iface;
+
+	zassert_not_null(iface_no_tso, "Interface without TSO");
+	zassert_not_null(iface_tso, "Interface with TSO");
+
+	net_if_set_mtu(iface_no_tso, TEST_MTU);
+	net_if_set_mtu(iface_tso, TEST_MTU);
+
+	ifaddr = net_if_ipv4_addr_add(iface_no_tso, &my_addr_no_tso,
+				      NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	ifaddr = net_if_ipv4_addr_add(iface_tso, &my_addr_tso,
+				      NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_ipv4_set_netmask(iface_no_tso, &netmask);
+	net_if_ipv4_set_netmask(iface_tso, &netmask);
+}
+
+static u8_t *test_data(size_t len)
+{
+	static u8_t data[2048];
+	size_t i;
+
+	zassert_true(len <= sizeof(data), "Too much test data");
+
+	for (i = 0; i < len; i++) {
+		data[i] = i % 251;
+	}
+
+	return data;
+}
+
+static void test_gso_segments(void)
+{
+	struct test_conn conn;
+	struct frame *frame;
+	u8_t *data = test_data(1800);
+	size_t offset = 0;
+	int ret;
+
+	conn_open(&conn, iface_no_tso, 5001);
+
+	ret = net_context_send(conn.ctx, data, 1800, NULL, K_NO_WAIT, NULL);
+	zassert_equal(ret, 1800, "Send failed (%d)", ret);
+
+	/* The device cannot segment, so the stack sends MSS sized
+	 * segments with their own sequence numbers and checksums. Only
+	 * the last one has PSH set.
+	 */
+	while (offset < 1800) {
+		u16_t len = MIN(PEER_MSS, 1800 - offset);
+		struct net_tcp_hdr *tcp;
+
+		frame = get_frame(&conn, WAIT_TIME);
+		zassert_not_null(frame, "Segment at %zu not sent", offset);
+
+		tcp = frame_tcp(frame);
+
+		zassert_equal(frame->gso_size, 0, "GSO packet sent");
+		zassert_equal(frame_payload_len(frame), len,
+			      "Invalid segment size %u at %zu",
+			      frame_payload_len(frame), offset);
+		zassert_equal(sys_get_be32(tcp->seq), conn.seq + offset,
+			      "Invalid seq at %zu", offset);
+		zassert_equal(!!(tcp->flags & NET_TCP_PSH),
+			      offset + len == 1800, "Invalid PSH at %zu",
+			      offset);
+		zassert_equal(memcmp(frame_payload(frame), data + offset, len),
+			      0, "Invalid data at %zu", offset);
+
+		check_frame_chksums(frame);
+
+		offset += len;
+	}
+
+	conn.seq += offset;
+
+	conn_close(&conn);
+}
+
+static void test_gso_offload(void)
+{
+	struct test_conn conn;
+	struct net_tcp_hdr *tcp;
+	struct frame *frame;
+	u8_t *data = test_data(1800);
+	int ret;
+
+	conn_open(&conn, iface_tso, 5002);
+
+	ret = net_context_send(conn.ctx, data, 1800, NULL, K_NO_WAIT, NULL);
+	zassert_equal(ret, 1800, "Send failed (%d)", ret);
+
+	/* The device segments, so it gets all of the data at once */
+	frame = get_frame(&conn, WAIT_TIME);
+	zassert_not_null(frame, "Data not sent");
+
+	tcp = frame_tcp(frame);
+
+	zassert_equal(frame->gso_size, PEER_MSS, "Invalid GSO size %u",
+		      frame->gso_size);
+	zassert_equal(frame_payload_len(frame), 1800, "Invalid length %u",
+		      frame_payload_len(frame));
+	zassert_equal(sys_get_be32(tcp->seq), conn.seq, "Invalid seq");
+	zassert_true(tcp->flags & NET_TCP_PSH, "No PSH");
+	zassert_equal(memcmp(frame_payload(frame), data, 1800), 0,
+		      "Invalid data");
+
+	check_frame_chksums(frame);
+
+	zassert_is_null(get_frame(&conn, K_MSEC(50)), "Extra frame sent");
+
+	conn.seq += 1800;
+
+	conn_close(&conn);
+}
+
+static void test_gro_merge_push(void)
+{
+	struct test_conn conn;
+	u8_t *data = test_data(400);
+	int i;
+
+	conn_open(&conn, iface_no_tso, 5003);
+
+	/* Segments without PSH are held back and merged, the one with
+	 * PSH passes all of them to the application.
+	 */
+	for (i = 0; i < 3; i++) {
+		peer_send(&conn, NET_TCP_ACK, data + i * 100, 100);
+	}
+
+	peer_send(&conn, NET_TCP_ACK | NET_TCP_PSH, data + 300, 100);
+
+	zassert_equal(k_sem_take(&recv_sem, WAIT_TIME), 0, "No data");
+	zassert_not_equal(k_sem_take(&recv_sem, K_MSEC(50)), 0,
+			  "Data not merged");
+
+	zassert_equal(recv_calls, 1, "Invalid recv calls %d", recv_calls);
+	zassert_equal(recv_len, 400, "Invalid length %zu", recv_len);
+	zassert_equal(memcmp(recv_data, data, 400), 0, "Invalid data");
+
+	conn_close(&conn);
+}
+
+static void test_gro_merge_timeout(void)
+{
+	struct test_conn conn;
+	u8_t *data = test_data(200);
+
+	conn_open(&conn, iface_no_tso, 5004);
+
+	/* Without PSH the merged data is passed on when the timer
+	 * expires.
+	 */
+	peer_send(&conn, NET_TCP_ACK, data, 100);
+	peer_send(&conn, NET_TCP_ACK, data + 100, 100);
+
+	k_sleep(K_MSEC(1));
+
+	zassert_equal(recv_calls, 0, "Data not held back");
+
+	zassert_equal(k_sem_take(&recv_sem,
+				 K_MSEC(CONFIG_NET_TCP_GRO_TIMEOUT * 2)),
+		      0, "No data");
+
+	zassert_equal(recv_calls, 1, "Invalid recv calls %d", recv_calls);
+	zassert_equal(recv_len, 200, "Invalid length %zu", recv_len);
+	zassert_equal(memcmp(recv_data, data, 200), 0, "Invalid data");
+
+	conn_close(&conn);
+}
+
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+/* The tests expect CONFIG_NET_TCP_QUICKACK_SEGMENTS=0, so that the
+ * first data segments of a connection are not acked right away.
+ */
+#define FULL_SEG_LEN (TEST_MTU - NET_IPV4TCPH_LEN)
+#define DELAYED_ACK_TIMEOUT K_MSEC(CONFIG_NET_TCP_DELAYED_ACK_TIMEOUT)
+
+static void check_ack(struct test_conn *conn, s32_t timeout)
+{
+	struct frame *frame;
+
+	frame = get_frame(conn, timeout);
+	zassert_not_null(frame, "No ACK sent");
+	zassert_equal(NET_TCP_FLAGS(frame_tcp(frame)), NET_TCP_ACK,
+		      "Not an ACK");
+	zassert_equal(frame_payload_len(frame), 0, "Not a pure ACK");
+	zassert_equal(sys_get_be32(frame_tcp(frame)->ack), conn->peer_seq,
+		      "Invalid ACK");
+}
+
+static void test_delayed_ack_full_segments(void)
+{
+	struct test_conn conn;
+	u8_t *data = test_data(2 * FULL_SEG_LEN);
+	u32_t acks_sent;
+	u32_t segs_received;
+
+	conn_open(&conn, iface_no_tso, 5101);
+
+	acks_sent = conn.ctx->tcp->acks_sent;
+	segs_received = conn.ctx->tcp->segs_received;
+
+	/* One full-sized segment is not acked right away, the second
+	 * one is.
+	 */
+	peer_send(&conn, NET_TCP_ACK, data, FULL_SEG_LEN);
+	zassert_is_null(get_frame(&conn, DELAYED_ACK_TIMEOUT / 2),
+			"First segment acked");
+
+	peer_send(&conn, NET_TCP_ACK, data + FULL_SEG_LEN, FULL_SEG_LEN);
+	check_ack(&conn, DELAYED_ACK_TIMEOUT / 2);
+
+	zassert_equal(conn.ctx->tcp->acks_sent - acks_sent, 1,
+		      "Invalid number of ACKs sent");
+	zassert_equal(conn.ctx->tcp->segs_received - segs_received, 2,
+		      "Invalid number of segments received");
+
+	conn_close(&conn);
+}
+
+static void test_delayed_ack_push(void)
+{
+	struct test_conn conn;
+	u8_t *data = test_data(100);
+
+	conn_open(&conn, iface_no_tso, 5102);
+
+	peer_send(&conn, NET_TCP_ACK | NET_TCP_PSH, data, 100);
+	check_ack(&conn, DELAYED_ACK_TIMEOUT / 2);
+
+	conn_close(&conn);
+}
+
+static void test_delayed_ack_out_of_order(void)
+{
+	struct test_conn conn;
+	u8_t *data = test_data(200);
+	u32_t acks_sent;
+
+	conn_open(&conn, iface_no_tso, 5103);
+
+	acks_sent = conn.ctx->tcp->acks_sent;
+
+	/* Skip 100 bytes, the peer gets a duplicate ACK for the hole */
+	conn.peer_seq += 100;
+	peer_send(&conn, NET_TCP_ACK, data + 100, 100);
+	conn.peer_seq -= 200;
+
+	check_ack(&conn, DELAYED_ACK_TIMEOUT / 2);
+
+	zassert_equal(conn.ctx->tcp->acks_sent - acks_sent, 1,
+		      "Invalid number of ACKs sent");
+
+	conn_close(&conn);
+}
+
+static void test_delayed_ack_timeout(void)
+{
+	struct test_conn conn;
+	u8_t *data = test_data(100);
+	u32_t acks_sent;
+	u32_t segs_received;
+
+	conn_open(&conn, iface_no_tso, 5104);
+
+	acks_sent = conn.ctx->tcp->acks_sent;
+	segs_received = conn.ctx->tcp->segs_received;
+
+	/* A single small segment is acked when the timer expires */
+	peer_send(&conn, NET_TCP_ACK, data, 100);
+	zassert_is_null(get_frame(&conn, DELAYED_ACK_TIMEOUT / 2),
+			"ACK not delayed");
+
+	check_ack(&conn, DELAYED_ACK_TIMEOUT);
+
+	zassert_equal(conn.ctx->tcp->acks_sent - acks_sent, 1,
+		      "Invalid number of ACKs sent");
+	zassert_equal(conn.ctx->tcp->segs_received - segs_received, 1,
+		      "Invalid number of segments received");
+
+	conn_close(&conn);
+}
+#endif /* CONFIG_NET_TCP_DELAYED_ACK */
+
+void test_main(void)
+{
+	ztest_test_suite(net_tcp_peer,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_gso_segments),
+			 ztest_unit_test(test_gso_offload),
+			 ztest_unit_test(test_gro_merge_push),
+			 ztest_unit_test(test_gro_merge_timeout));
+
+	ztest_run_test_suite(net_tcp_peer);
+
+#if defined(CONFIG_NET_TCP_DELAYED_ACK)
+	ztest_test_suite(net_tcp_peer_delayed_ack,
+			 ztest_unit_test(test_delayed_ack_full_segments),
+			 ztest_unit_test(test_delayed_ack_push),
+			 ztest_unit_test(test_delayed_ack_out_of_order),
+			 ztest_unit_test(test_delayed_ack_timeout));
+
+	ztest_run_test_suite(net_tcp_peer_delayed_ack);
+#endif
+}